@@ -223,6 +223,13 @@ ApplicationWindow {
             root.showMaximized()
     }
 
+    // Show the Trace page scrolled to one frame (used by analysis reports).
+    function jumpToFrame(seconds, channel, id) {
+        stack.currentIndex = 0
+        if (tracePageLoader.item)
+            tracePageLoader.item.jumpToFrame(seconds, channel, id)
+    }
+
     header: Column {
         width: root.width
         spacing: 0
@@ -785,7 +792,9 @@ ApplicationWindow {
                         { shortName: "TR", label: "Trace" },
                         { shortName: "GN", label: "Generator" },
                         { shortName: "SM", label: "Simulation" },
-                        { shortName: "DG", label: "Diagnostics" }
+                        { shortName: "DG", label: "Diagnostics" },
+                        { shortName: "GW", label: "Gateway" },
+                        { shortName: "AN", label: "Analysis" }
                     ]
 
                     delegate: Rectangle {
@@ -909,6 +918,24 @@ ApplicationWindow {
                     Layout.fillWidth: true
                     Layout.fillHeight: true
                 }
+
+                Loader {
+                    id: gatewayPageLoader
+                    asynchronous: true
+                    active: stack.currentIndex === 4 || status === Loader.Ready
+                    source: "qml/pages/GatewayPage.qml"
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                }
+
+                Loader {
+                    id: analysisPageLoader
+                    asynchronous: true
+                    active: stack.currentIndex === 5 || status === Loader.Ready
+                    source: "qml/pages/AnalysisPage.qml"
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                }
             }
         }
     }
@@ -924,6 +951,15 @@ ApplicationWindow {
         appWindow: root
     }
 
+    // ── Flight recorder hotkey ──────────────────────────────────────────────
+    // Dumps the recorder's window (last N minutes) to a timestamped BLF in
+    // the background; works from any page, measuring or not.
+    Shortcut {
+        sequence: "Ctrl+Shift+D"
+        context:  Qt.ApplicationShortcut
+        onActivated: AppController.dumpFlightRecorder()
+    }
+
     Connections {
         target: AppController
         // Reveal logic moved to onReadyToRevealChanged above (combines initComplete
@@ -0,0 +1,231 @@
+/**
+ * @file DecodeMemoBench.cpp
+ * @brief Decode cost per frame with and without DecodeMemo.
+ *
+ *   bench_decode_memo [file.dbc] [seconds = 60] [passes = 5]
+ *
+ * The trace is the traffic DemoCANDriver plays in DBC mode: every message
+ * of the database at its GenMsgCycleTime (100 ms when unset), payloads
+ * encoded from GenSigStartValue and animated every 100 ms by the rules of
+ * DemoCANDriver::onStimulusTick().  It is generated in simulated time, so
+ * every run decodes exactly the same frames.
+ *
+ * Each pass times TraceEntryBuilder::build() over the whole trace once
+ * without a memo and once with a fresh one; the median of the passes is
+ * printed with the memo hit ratio.
+ */
+
+#include "dbc/DBCParser.h"
+#include "metrics/MetricsRegistry.h"
+#include "trace/DecodeMemo.h"
+#include "trace/TraceEntryBuilder.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+using namespace CANManager;
+using namespace DBCManager;
+
+namespace {
+
+constexpr int kStimulusMs     = 100;
+constexpr int kDefaultCycleMs = 100;
+
+bool hasFiniteRange(const DBCSignal& sig)
+{
+    return std::isfinite(sig.minimum) && std::isfinite(sig.maximum)
+        && sig.maximum > sig.minimum;
+}
+
+double clampToSignalRange(double value, const DBCSignal& sig)
+{
+    return hasFiniteRange(sig) ? std::clamp(value, sig.minimum, sig.maximum) : value;
+}
+
+struct SimMessage
+{
+    const DBCMessage* def = nullptr;
+    CANMessage        frame;
+    int               periodMs = kDefaultCycleMs;
+    int               muxSel   = -1;          ///< selector signal index
+    QList<int>        muxValues;              ///< distinct branch values
+    std::vector<double> last;                 ///< last value per signal
+};
+
+std::vector<SimMessage> buildSchedule(const DBCDatabase& db)
+{
+    std::vector<SimMessage> out;
+    for (const DBCMessage& def : db.messages) {
+        const int len = qBound(0, static_cast<int>(def.dlc), 64);
+        if (len == 0 || def.signalList.isEmpty())
+            continue;
+
+        SimMessage sim;
+        sim.def      = &def;
+        sim.periodMs = def.cycleTimeMs > 0 ? def.cycleTimeMs : kDefaultCycleMs;
+        sim.frame.id         = def.id;
+        sim.frame.isExtended = def.isExtended;
+        sim.frame.isFD       = len > 8;
+        sim.frame.dlc        = lengthToDlc(len);
+        sim.last.assign(size_t(def.signalList.size()), std::numeric_limits<double>::quiet_NaN());
+
+        for (int i = 0; i < def.signalList.size(); ++i) {
+            const DBCSignal& sig = def.signalList[i];
+            if (sig.muxIndicator == QLatin1String("M"))
+                sim.muxSel = i;
+            else if (sig.muxValue >= 0 && !sim.muxValues.contains(sig.muxValue))
+                sim.muxValues.append(sig.muxValue);
+        }
+        for (const DBCSignal& sig : def.signalList)
+            if (sig.muxValue < 0)
+                sig.encode(sig.initialValue, sim.frame.data, len);
+        out.push_back(std::move(sim));
+    }
+    return out;
+}
+
+/** One DemoCANDriver stimulus step for message @p h. */
+void stimulate(SimMessage& sim, int h, int step, double seconds)
+{
+    const DBCMessage& msg = *sim.def;
+    const int len = sim.frame.dataLength();
+
+    int activeMuxRaw = -1;
+    if (sim.muxSel >= 0)
+        activeMuxRaw = sim.muxValues.isEmpty()
+                           ? 0 : sim.muxValues[(step / 10 + h) % sim.muxValues.size()];
+
+    for (int i = 0; i < msg.signalList.size(); ++i) {
+        const DBCSignal& sig = msg.signalList[i];
+        const int signalIndex = i + 1;
+        double value = 0.0;
+
+        if (i == sim.muxSel) {
+            value = sig.rawToPhysical(activeMuxRaw);
+        } else if (activeMuxRaw >= 0 && sig.muxValue >= 0 && sig.muxValue != activeMuxRaw) {
+            sim.last[size_t(i)] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        } else if (!sig.valueDescriptions.isEmpty()) {
+            const QList<int64_t> rawKeys = sig.valueDescriptions.keys();
+            value = sig.rawToPhysical(rawKeys[(step / 10 + h + signalIndex) % rawKeys.size()]);
+        } else if (sig.bitLength == 1
+                   && sig.valueType != ValueType::Float32
+                   && sig.valueType != ValueType::Float64) {
+            value = sig.rawToPhysical((step / (5 + h % 8 + signalIndex)) % 2);
+        } else if (hasFiniteRange(sig)) {
+            const double center    = (sig.minimum + sig.maximum) * 0.5;
+            const double amplitude = (sig.maximum - sig.minimum) * 0.35;
+            const double freq      = 0.12 + (h % 8) * 0.03 + signalIndex * 0.015;
+            value = center + amplitude * std::sin(seconds * freq + h);
+        } else {
+            continue;
+        }
+
+        value = clampToSignalRange(value, sig);
+        if (sim.last[size_t(i)] == value)
+            continue;
+        sim.last[size_t(i)] = value;
+        sig.encode(value, sim.frame.data, len);
+    }
+}
+
+QVector<CANMessage> generateTrace(const DBCDatabase& db, int seconds)
+{
+    std::vector<SimMessage> schedule = buildSchedule(db);
+    QVector<CANMessage> frames;
+
+    for (int t = 0; t < seconds * 1000; ++t) {
+        if (t % kStimulusMs == 0) {
+            const int step = t / kStimulusMs + 1;
+            for (size_t h = 0; h < schedule.size(); ++h)
+                stimulate(schedule[h], int(h), step, t / 1000.0);
+        }
+        for (size_t h = 0; h < schedule.size(); ++h) {
+            SimMessage& sim = schedule[h];
+            if ((t + int(h)) % sim.periodMs != 0)
+                continue;   // staggered like the simulator's initial offsets
+            CANMessage f = sim.frame;
+            f.channel   = 1;
+            f.timestamp = uint64_t(t) * 1000000u;
+            frames.append(f);
+        }
+    }
+    return frames;
+}
+
+double median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+
+    const QString dbcPath = args.size() > 1
+        ? args[1]
+        : QStringLiteral(AUTOLENS_SOURCE_DIR "/resource/DBC/Modified_MLBevo_Gen2_MLBevo_ICAN_KMatrix_V8.30.00F.dbc");
+    const int seconds = args.size() > 2 ? qMax(1, args[2].toInt()) : 60;
+    const int passes  = args.size() > 3 ? qMax(1, args[3].toInt()) : 5;
+
+    DBCParser parser;
+    const DBCDatabase db = parser.parseFile(dbcPath);
+    if (db.messages.isEmpty()) {
+        std::fprintf(stderr, "No messages in %s\n", qPrintable(dbcPath));
+        return 1;
+    }
+
+    const QVector<CANMessage> frames = generateTrace(db, seconds);
+    std::printf("DBC     %s (%lld messages)\n", qPrintable(QFileInfo(dbcPath).fileName()),
+                static_cast<long long>(db.messages.size()));
+    std::printf("trace   %lld frames, %d s simulated\n",
+                static_cast<long long>(frames.size()), seconds);
+
+    auto& metrics = MetricsRegistry::instance();
+    const QString help = QStringLiteral("Signal decodes served from / missing in the decode memo");
+    MetricCounter* hits   = metrics.counter("autolens_decode_memo_lookups", help, "result=\"hit\"");
+    MetricCounter* misses = metrics.counter("autolens_decode_memo_lookups", help, "result=\"miss\"");
+
+    quint64 sink = 0;   // printed, so the builds cannot be optimised away
+    auto timePass = [&](DecodeMemo* memo) {
+        QElapsedTimer timer;
+        timer.start();
+        for (const CANMessage& msg : frames)
+            sink += TraceEntryBuilder::build(msg, &db, memo).decodedSignals.size();
+        return double(timer.nsecsElapsed()) / frames.size();
+    };
+
+    std::vector<double> plain, memoized;
+    quint64 hitCount = 0, missCount = 0;
+    for (int p = 0; p < passes; ++p) {
+        plain.push_back(timePass(nullptr));
+
+        DecodeMemo memo;
+        const quint64 h0 = hits->value(), m0 = misses->value();
+        memoized.push_back(timePass(&memo));
+        hitCount  += hits->value() - h0;
+        missCount += misses->value() - m0;
+    }
+
+    const double before = median(plain);
+    const double after  = median(memoized);
+    std::printf("decode  no memo   %8.0f ns/frame\n", before);
+    std::printf("decode  memo      %8.0f ns/frame  (%.2fx)\n", after, before / after);
+    std::printf("memo    hit ratio %.1f %%\n",
+                100.0 * hitCount / qMax<quint64>(1, hitCount + missCount));
+    std::printf("rows    %llu signal rows per pass\n",
+                static_cast<unsigned long long>(sink / (2 * quint64(passes))));
+    return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file TextFormatBench.cpp
+ * @brief ASC line formatting: the former QString::arg() chain vs ascLine().
+ *
+ *   bench_text_format [frames = 1000000] [passes = 5]
+ *
+ * The frames mix classic and FD payloads (8 / 64 bytes, BRS), standard and
+ * extended IDs, Tx echoes and the odd error or remote frame.  A third of
+ * the timestamps sit exactly on a half-µs tie, where rounding from integers
+ * and from ns / 1e9 can disagree.
+ *
+ * Before timing, every frame is formatted both ways and compared — the ASC
+ * line and the trace view's ms column — and any difference is printed.
+ * Each pass then streams all lines through a QTextStream into a buffer,
+ * as saveAsAsc() does; the median ns per frame of the passes is printed.
+ */
+
+#include "trace/TraceEntryBuilder.h"
+#include "trace/TraceExporter.h"
+#include "util/TextFormat.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace CANManager;
+
+namespace {
+
+QVector<CANMessage> generateFrames(int count)
+{
+    std::mt19937_64 rng(42);
+    QVector<CANMessage> frames;
+    frames.reserve(count);
+    uint64_t ns = 0;
+    for (int i = 0; i < count; ++i) {
+        CANMessage m;
+        ns += 50000 + rng() % 2000000;                 // 0.05 … 2 ms apart
+        m.timestamp   = i % 3 == 0 ? ns / 1000 * 1000 + 500 : ns;
+        m.isExtended  = i % 4 == 0;
+        m.id          = uint32_t(rng()) & (m.isExtended ? 0x1FFFFFFFu : 0x7FFu);
+        m.channel     = uint8_t(1 + i % 2);
+        m.isTxConfirm = i % 9 == 0;
+        m.isFD        = i % 5 == 0;
+        m.isBRS       = m.isFD && i % 10 == 0;
+        m.dlc         = m.isFD ? 15 : 8;
+        m.isError     = i % 997 == 0;
+        m.isRemote    = !m.isError && !m.isFD && i % 499 == 0;
+        for (int b = 0; b < m.dataLength(); ++b)
+            m.data[b] = uint8_t(rng());
+        frames.append(m);
+    }
+    return frames;
+}
+
+/** saveAsAsc()'s frame line before TextFormat, verbatim. */
+QString legacyAscLine(const CANMessage& msg)
+{
+    const double ts_s = static_cast<double>(msg.timestamp) / 1.0e9;
+
+    QString idStr;
+    if (msg.isExtended)
+        idStr = QString::number(msg.id, 16).toUpper().rightJustified(8, '0') + "x";
+    else
+        idStr = QString::number(msg.id, 16).toUpper().rightJustified(3, '0');
+
+    const QString dir = msg.isTxConfirm ? "Tx" : "Rx";
+
+    if (msg.isError)
+        return QString("   %1 %2  %3  %4   ErrorFrame\n")
+                   .arg(ts_s, 12, 'f', 6).arg(msg.channel).arg(idStr).arg(dir, -4);
+
+    if (msg.isRemote)
+        return QString("   %1 %2  %3  %4   r %5\n")
+                   .arg(ts_s, 12, 'f', 6).arg(msg.channel).arg(idStr).arg(dir, -4)
+                   .arg(msg.dlc);
+
+    const int len = msg.dataLength();
+    QString dataHex;
+    dataHex.reserve(len * 3);
+    for (int i = 0; i < len; ++i) {
+        if (i > 0) dataHex += ' ';
+        dataHex += QString::number(msg.data[i], 16).toUpper().rightJustified(2, '0');
+    }
+
+    if (msg.isFD) {
+        QString fdFlags;
+        if (msg.isBRS) fdFlags += "  BRS";
+        return QString("   %1 %2  %3  %4   CANFD %5 %6%7\n")
+                   .arg(ts_s, 12, 'f', 6).arg(msg.channel).arg(idStr).arg(dir, -4)
+                   .arg(msg.dlc).arg(dataHex).arg(fdFlags);
+    }
+
+    return QString("   %1 %2  %3  %4   d %5 %6\n")
+               .arg(ts_s, 12, 'f', 6).arg(msg.channel).arg(idStr).arg(dir, -4)
+               .arg(msg.dlc).arg(dataHex);
+}
+
+int compare(const QVector<CANMessage>& frames)
+{
+    int diffs = 0;
+    char line[TraceExporter::ASC_LINE_MAX];
+    for (const CANMessage& msg : frames) {
+        const QString before = legacyAscLine(msg);
+        const QString after  = QString::fromLatin1(line, TraceExporter::ascLine(line, msg));
+        const QString msBefore = QString::number(static_cast<double>(msg.timestamp) / 1.0e6, 'f', 6);
+        const QString msAfter  = TraceEntryBuilder::build(msg, nullptr).timeStr;
+        if (before == after && msBefore == msAfter)
+            continue;
+        if (++diffs <= 5)
+            std::printf("DIFF ns=%llu\n  old %s  new %s  old ms %s / new ms %s\n",
+                        static_cast<unsigned long long>(msg.timestamp),
+                        qPrintable(before), qPrintable(after),
+                        qPrintable(msBefore), qPrintable(msAfter));
+    }
+    return diffs;
+}
+
+template <typename WriteLine>
+double timePass(const QVector<CANMessage>& frames, WriteLine writeLine)
+{
+    QByteArray sink;
+    sink.reserve(frames.size() * 80);
+    QBuffer buffer(&sink);
+    buffer.open(QIODevice::WriteOnly);
+    QTextStream out(&buffer);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (const CANMessage& msg : frames)
+        writeLine(out, msg);
+    out.flush();
+    return double(timer.nsecsElapsed()) / frames.size();
+}
+
+double median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const int count  = args.size() > 1 ? qMax(1, args[1].toInt()) : 1000000;
+    const int passes = args.size() > 2 ? qMax(1, args[2].toInt()) : 5;
+
+    const QVector<CANMessage> frames = generateFrames(count);
+    const int diffs = compare(frames);
+    std::printf("frames  %d, %d formatted differently\n", count, diffs);
+
+    std::vector<double> legacy, kernels;
+    char line[TraceExporter::ASC_LINE_MAX];
+    for (int p = 0; p < passes; ++p) {
+        legacy.push_back(timePass(frames, [](QTextStream& out, const CANMessage& msg) {
+            out << legacyAscLine(msg);
+        }));
+        kernels.push_back(timePass(frames, [&line](QTextStream& out, const CANMessage& msg) {
+            out << QLatin1String(line, TraceExporter::ascLine(line, msg));
+        }));
+    }
+
+    const double before = median(legacy), after = median(kernels);
+    std::printf("QString::arg   %8.1f ns/frame\n", before);
+    std::printf("ascLine()      %8.1f ns/frame  (%.2fx)\n", after, before / after);
+    return diffs == 0 ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file TraceScrollBench.cpp
+ * @brief TraceModel data() traffic while a TreeView scrolls.
+ *
+ *   bench_trace_scroll [rows = 20000] [steps = 2000]
+ *
+ * Fills a TraceModel with classic frames, shows a TreeView of the trace
+ * page's size and scrolls it one row per step, letting the scene render a
+ * frame after every step.  It runs twice with the same rows: once with the
+ * old per-role delegate bindings (display, channel, isError, isFD,
+ * isDecoded, display again for the Tx check) and once with the current
+ * rowData binding.  Each run prints TraceModel::viewStats() per step —
+ * the figures AppController::traceViewStats() reports in the app.
+ *
+ * Runs headless with QT_QPA_PLATFORM=offscreen.
+ */
+
+#include "trace/TraceEntryBuilder.h"
+#include "trace/TraceModel.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QGuiApplication>
+#include <QQmlComponent>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QTimer>
+
+#include <cstdio>
+#include <memory>
+
+using namespace CANManager;
+
+namespace {
+
+constexpr int kRowHeight   = 22;     ///< TracePage rowH
+constexpr int kViewWidth   = 1280;
+constexpr int kViewHeight  = 720;
+
+/** TracePage's cell delegate reduced to its model bindings. */
+const char* const kPerRoleDelegate = R"(
+    Item {
+        required property int row
+        required property int column
+        implicitHeight: 22
+        readonly property int    channelNum: model.channel   ?? 1
+        readonly property bool   isError:    model.isError   ?? false
+        readonly property bool   isFD:       model.isFD      ?? false
+        readonly property bool   isDecoded:  model.isDecoded ?? false
+        readonly property string cellText:   model.display   ?? ""
+        readonly property bool   isTx:       model.display === "Tx" && column === 5
+        Text { text: parent.cellText; color: parent.isTx ? "orange" : "white" }
+    })";
+
+const char* const kRowDataDelegate = R"(
+    Item {
+        required property int row
+        required property int column
+        implicitHeight: 22
+        readonly property var    rowData:    model.rowData
+        readonly property int    channelNum: rowData ? (rowData.channel || 1) : 1
+        readonly property bool   isError:    rowData ? rowData.isError   : false
+        readonly property bool   isFD:       rowData ? rowData.isFD      : false
+        readonly property bool   isDecoded:  rowData ? rowData.isDecoded : false
+        readonly property string cellText:   rowData ? rowData.cell(column) : ""
+        readonly property bool   isTx:       cellText === "Tx" && column === 5
+        Text { text: parent.cellText; color: parent.isTx ? "orange" : "white" }
+    })";
+
+QVector<TraceEntry> makeEntries(int rows)
+{
+    QVector<TraceEntry> out;
+    out.reserve(rows);
+    for (int i = 0; i < rows; ++i) {
+        CANMessage m;
+        m.id          = 0x100 + uint32_t(i % 64);
+        m.dlc         = 8;
+        m.channel     = uint8_t(1 + i % 2);
+        m.isTxConfirm = i % 7 == 0;
+        m.timestamp   = quint64(i) * 1000000;   // 1 kHz
+        for (int b = 0; b < 8; ++b)
+            m.data[b] = uint8_t(i >> (b % 4 * 8));
+        out.append(TraceEntryBuilder::build(m, nullptr));
+    }
+    return out;
+}
+
+/** Let the window polish and render one frame (or give up after 100 ms). */
+void renderFrame(QQuickWindow& window)
+{
+    QEventLoop loop;
+    const auto conn = QObject::connect(&window, &QQuickWindow::frameSwapped, &loop, &QEventLoop::quit);
+    QTimer::singleShot(100, &loop, &QEventLoop::quit);
+    window.requestUpdate();
+    loop.exec();
+    QObject::disconnect(conn);
+}
+
+bool run(const char* label, const char* delegate, TraceModel& model, int steps)
+{
+    QQmlEngine engine;
+    engine.rootContext()->setContextProperty(QStringLiteral("traceModel"), &model);
+
+    const QByteArray qml = QByteArray(R"(
+        import QtQuick
+        TreeView {
+            width: )") + QByteArray::number(kViewWidth) + R"(
+            height: )" + QByteArray::number(kViewHeight) + R"(
+            model: traceModel
+            columnWidthProvider: function(col) { return 160 }
+            onContentYChanged: traceModel.noteScrollStep()
+            delegate: )" + delegate + R"(
+        })";
+
+    QQmlComponent component(&engine);
+    component.setData(qml, QUrl());
+    std::unique_ptr<QObject> root(component.create());
+    auto* view = qobject_cast<QQuickItem*>(root.get());
+    if (!view) {
+        std::fprintf(stderr, "%s: %s\n", label, qPrintable(component.errorString()));
+        return false;
+    }
+
+    QQuickWindow window;
+    window.resize(kViewWidth, kViewHeight);
+    view->setParentItem(window.contentItem());
+    window.show();
+    renderFrame(window);
+
+    model.resetViewStats();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 1; i <= steps; ++i) {
+        view->setProperty("contentY", i * kRowHeight);
+        renderFrame(window);
+    }
+    const double ms = timer.nsecsElapsed() / 1e6;
+
+    const TraceModel::ViewStats st = model.viewStats();
+    const double n = double(qMax<quint64>(1, st.scrollSteps));
+    std::printf("%-10s steps=%llu  dataCallsPerStep=%.2f  rowCallsPerStep=%.2f"
+                "  buildsPerStep=%.2f  %.3f ms/step\n",
+                label, static_cast<unsigned long long>(st.scrollSteps),
+                st.dataCalls / n, st.rowCalls / n, st.snapshotBuilds / n, ms / steps);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    const QStringList args = app.arguments();
+    const int rows  = args.size() > 1 ? args[1].toInt() : 20000;
+    const int steps = args.size() > 2 ? args[2].toInt() : 2000;
+    const int visible = kViewHeight / kRowHeight;
+    if (rows <= 0 || steps <= 0 || steps > rows - visible) {
+        std::fprintf(stderr, "usage: bench_trace_scroll [rows] [steps < rows - %d]\n", visible);
+        return 1;
+    }
+
+    TraceModel model;
+    model.addEntries(makeEntries(rows));
+    std::printf("%d rows, %d one-row steps, %dx%d view (%d rows visible)\n",
+                model.frameCount(), steps, kViewWidth, kViewHeight, visible);
+
+    if (!run("per-role", kPerRoleDelegate, model, steps)) return 1;
+    if (!run("rowData",  kRowDataDelegate, model, steps)) return 1;
+    return 0;
+}
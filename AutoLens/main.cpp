@@ -125,6 +125,11 @@ int main(int argc, char* argv[])
         QStringLiteral("TraceFilterProxy is owned by AppController — use AppController.traceProxy")
     );
 
+    qmlRegisterUncreatableType<CycleReportModel>(
+        "AutoLens", 1, 0, "CycleReportModel",
+        QStringLiteral("CycleReportModel is owned by AppController — use AppController.cycleReport")
+    );
+
     // ---------------------------------------------------------------------------
     //  Create the application controller.
     //  It will auto-detect whether Vector hardware is available and select
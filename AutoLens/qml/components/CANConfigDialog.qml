@@ -274,6 +274,47 @@ Popup {
 
                 Item { Layout.fillWidth: true }
 
+                // Driver backend selector (switching needs a closed port)
+                Rectangle {
+                    implicitWidth:  150
+                    implicitHeight: 26
+                    radius:         6
+                    color:          "transparent"
+                    border.color:   backendCombo.activeFocus ? dlg.accent : dlg.border
+                    border.width:   1
+                    opacity:        AppController.connected ? 0.5 : 1.0
+
+                    ComboBox {
+                        id:           backendCombo
+                        anchors.fill: parent
+                        enabled:      !AppController.connected
+
+                        readonly property var keys: ["auto", "demo", "virtual", "udp", "slcan"]
+                        model: ["Auto (Vector / Demo)", "Demo", "Virtual bus", "CAN over UDP", "SLCAN serial"]
+
+                        currentIndex: Math.max(0, keys.indexOf(AppController.driverBackend()))
+
+                        onActivated: function(index) {
+                            if (!AppController.setDriverBackend(keys[index]))
+                                currentIndex = Math.max(0, keys.indexOf(AppController.driverBackend()))
+                        }
+
+                        background: Rectangle {
+                            color:        "transparent"
+                            border.width: 0
+                        }
+
+                        contentItem: Label {
+                            leftPadding:  8
+                            text:         backendCombo.displayText
+                            color:        dlg.txtMain
+                            font.pixelSize: 11
+                            elide:        Text.ElideRight
+                            verticalAlignment: Text.AlignVCenter
+                        }
+                    }
+                }
+
                 // Refresh HW button
                 Rectangle {
                     implicitWidth:  110
@@ -337,10 +378,108 @@ Popup {
             }
         }
 
+        // ── UDP endpoint (only for the CAN-over-UDP backend) ──────────────────
+        Rectangle {
+            id:      udpStrip
+            width:   parent.width
+            height:  visible ? 40 : 0
+            visible: backendCombo.keys[backendCombo.currentIndex] === "udp"
+            color:   dlg.bgPanel
+
+            // Bottom border
+            Rectangle {
+                anchors.bottom: parent.bottom
+                width: parent.width; height: 1
+                color: dlg.border
+            }
+
+            function apply() {
+                if (!AppController.setUdpEndpoint(parseInt(udpPortField.text), udpPeerField.text)) {
+                    var ep = AppController.udpEndpoint()
+                    udpPortField.text = ep.localPort
+                    udpPeerField.text = ep.peer
+                }
+            }
+
+            RowLayout {
+                anchors.fill:        parent
+                anchors.leftMargin:  18
+                anchors.rightMargin: 12
+                spacing: 8
+
+                Label {
+                    text:           "Local port"
+                    color:          dlg.txtMute
+                    font.pixelSize: 10
+                    font.letterSpacing: 0.5
+                }
+                Rectangle {
+                    width:  70; height: 26
+                    radius: 6
+                    color:  dlg.bgInput
+                    border.color: udpPortField.activeFocus ? dlg.accent : dlg.border
+                    border.width: 1
+
+                    TextInput {
+                        id:           udpPortField
+                        anchors.fill: parent
+                        anchors.leftMargin:  8
+                        anchors.rightMargin: 8
+                        verticalAlignment: TextInput.AlignVCenter
+                        text:         AppController.udpEndpoint().localPort
+                        color:        dlg.txtMain
+                        font.pixelSize: 12
+                        font.family:  "Consolas"
+                        enabled:      !AppController.connected
+                        selectByMouse: true
+                        validator:    IntValidator { bottom: 1; top: 65535 }
+                        onEditingFinished: udpStrip.apply()
+                    }
+                }
+
+                Label {
+                    text:           "Peer"
+                    color:          dlg.txtMute
+                    font.pixelSize: 10
+                    font.letterSpacing: 0.5
+                }
+                Rectangle {
+                    Layout.fillWidth: true
+                    height: 26
+                    radius: 6
+                    color:  dlg.bgInput
+                    border.color: udpPeerField.activeFocus ? dlg.accent : dlg.border
+                    border.width: 1
+
+                    TextInput {
+                        id:           udpPeerField
+                        anchors.fill: parent
+                        anchors.leftMargin:  8
+                        anchors.rightMargin: 8
+                        verticalAlignment: TextInput.AlignVCenter
+                        text:         AppController.udpEndpoint().peer
+                        color:        dlg.txtMain
+                        font.pixelSize: 12
+                        font.family:  "Consolas"
+                        enabled:      !AppController.connected
+                        selectByMouse: true
+                        clip:         true
+                        onEditingFinished: udpStrip.apply()
+                    }
+                }
+
+                Label {
+                    text:           "cannelloni · same port on both sides = loopback"
+                    color:          dlg.txtMute
+                    font.pixelSize: 10
+                }
+            }
+        }
+
         // ── Channel sections (scrollable) ─────────────────────────────────────
         ScrollView {
             width:              parent.width
-            height:             Math.min(contentHeight, 640)
+            height:             Math.min(contentHeight, 606)   // 640 minus the services strip
             clip:               true
             ScrollBar.vertical.policy: ScrollBar.AsNeeded
 
@@ -420,6 +559,191 @@ Popup {
             }
         }
 
+        // ── Services: local outputs that apply immediately (no Apply needed) ──
+        Rectangle {
+            width:  parent.width
+            height: 34
+            color:  dlg.bgPanel
+
+            // Top border
+            Rectangle {
+                anchors.top: parent.top
+                width: parent.width; height: 1
+                color: dlg.border
+            }
+
+            RowLayout {
+                anchors.fill:        parent
+                anchors.leftMargin:  18
+                anchors.rightMargin: 18
+                spacing: 10
+
+                Label {
+                    text:           "Local services"
+                    color:          dlg.txtMute
+                    font.pixelSize: 11
+                    Layout.rightMargin: 4
+                }
+
+                // Shared-memory frame ring for other processes (takes effect at once)
+                CheckBox {
+                    id:      shareChk
+                    checked: AppController.frameSharing
+                    spacing: 5
+                    onToggled: AppController.frameSharing = checked
+
+                    ToolTip.visible: hovered
+                    ToolTip.text: "Publish every received frame to the shared-memory ring "
+                                  + AppController.frameSharingInfo().name
+                                  + " (reader: src/ipc/autolens_ring.h)"
+
+                    indicator: Rectangle {
+                        x: shareChk.leftPadding
+                        y: shareChk.topPadding + (shareChk.availableHeight - height) / 2
+                        implicitWidth: 14; implicitHeight: 14
+                        radius: 3
+                        color:        "transparent"
+                        border.color: shareChk.checked ? dlg.accent : dlg.border
+                        border.width: 1
+
+                        Rectangle {
+                            anchors.centerIn: parent
+                            width: 6; height: 6; radius: 1
+                            color:   dlg.accent
+                            visible: shareChk.checked
+                        }
+                    }
+
+                    contentItem: Label {
+                        leftPadding: shareChk.indicator.width + shareChk.spacing + 2
+                        text:           "Share frames"
+                        color:          dlg.txtMain
+                        font.pixelSize: 11
+                        verticalAlignment: Text.AlignVCenter
+                    }
+                }
+
+                // Decoded-signal server for local dashboards (takes effect at once)
+                CheckBox {
+                    id:      streamChk
+                    checked: AppController.signalStreaming
+                    spacing: 5
+                    Layout.leftMargin: 4
+                    onToggled: AppController.signalStreaming = checked
+
+                    ToolTip.visible: hovered
+                    ToolTip.text: "Serve decoded signal values on ws://127.0.0.1:"
+                                  + AppController.signalStreamInfo().port
+                                  + " while measuring"
+
+                    indicator: Rectangle {
+                        x: streamChk.leftPadding
+                        y: streamChk.topPadding + (streamChk.availableHeight - height) / 2
+                        implicitWidth: 14; implicitHeight: 14
+                        radius: 3
+                        color:        "transparent"
+                        border.color: streamChk.checked ? dlg.accent : dlg.border
+                        border.width: 1
+
+                        Rectangle {
+                            anchors.centerIn: parent
+                            width: 6; height: 6; radius: 1
+                            color:   dlg.accent
+                            visible: streamChk.checked
+                        }
+                    }
+
+                    contentItem: Label {
+                        leftPadding: streamChk.indicator.width + streamChk.spacing + 2
+                        text:           "Stream signals"
+                        color:          dlg.txtMain
+                        font.pixelSize: 11
+                        verticalAlignment: Text.AlignVCenter
+                    }
+                }
+
+
+                // Pipeline metrics as OpenMetrics text (takes effect at once)
+                CheckBox {
+                    id:      metricsChk
+                    checked: AppController.metricsEnabled
+                    spacing: 5
+                    Layout.leftMargin: 4
+                    onToggled: AppController.metricsEnabled = checked
+
+                    ToolTip.visible: hovered
+                    ToolTip.text: "Export frame rates, bus load, queue depths and decode latency at "
+                                  + "http://127.0.0.1:" + AppController.metricsInfo().port + "/metrics"
+
+                    indicator: Rectangle {
+                        x: metricsChk.leftPadding
+                        y: metricsChk.topPadding + (metricsChk.availableHeight - height) / 2
+                        implicitWidth: 14; implicitHeight: 14
+                        radius: 3
+                        color:        "transparent"
+                        border.color: metricsChk.checked ? dlg.accent : dlg.border
+                        border.width: 1
+
+                        Rectangle {
+                            anchors.centerIn: parent
+                            width: 6; height: 6; radius: 1
+                            color:   dlg.accent
+                            visible: metricsChk.checked
+                        }
+                    }
+
+                    contentItem: Label {
+                        leftPadding: metricsChk.indicator.width + metricsChk.spacing + 2
+                        text:           "Metrics"
+                        color:          dlg.txtMain
+                        font.pixelSize: 11
+                        verticalAlignment: Text.AlignVCenter
+                    }
+                }
+
+                // Compressed ring of the last N minutes, dumped with Ctrl+Shift+D
+                CheckBox {
+                    id:      recorderChk
+                    checked: AppController.flightRecorder
+                    spacing: 5
+                    Layout.leftMargin: 4
+                    onToggled: AppController.flightRecorder = checked
+
+                    ToolTip.visible: hovered
+                    ToolTip.text: "Keep the last " + AppController.flightRecorderStats().windowMin
+                                  + " min of all channels; Ctrl+Shift+D writes them to "
+                                  + AppController.flightRecorderStats().dir
+
+                    indicator: Rectangle {
+                        x: recorderChk.leftPadding
+                        y: recorderChk.topPadding + (recorderChk.availableHeight - height) / 2
+                        implicitWidth: 14; implicitHeight: 14
+                        radius: 3
+                        color:        "transparent"
+                        border.color: recorderChk.checked ? dlg.accent : dlg.border
+                        border.width: 1
+
+                        Rectangle {
+                            anchors.centerIn: parent
+                            width: 6; height: 6; radius: 1
+                            color:   dlg.accent
+                            visible: recorderChk.checked
+                        }
+                    }
+
+                    contentItem: Label {
+                        leftPadding: recorderChk.indicator.width + recorderChk.spacing + 2
+                        text:           "Flight recorder"
+                        color:          dlg.txtMain
+                        font.pixelSize: 11
+                        verticalAlignment: Text.AlignVCenter
+                    }
+                }
+
+                Item { Layout.fillWidth: true }
+            }
+        }
+
         // ── Footer: Cancel / Apply ─────────────────────────────────────────────
         Rectangle {
             width:  parent.width
@@ -0,0 +1,625 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+import QtQuick.Dialogs
+
+// ============================================================================
+//  AnalysisPage — offline reports over the trace or a log file
+//
+//  Cycle report: AppController.analyzeCycles() fills AppController.cycleReport
+//  in the background (src/analysis/CycleAnalyzer.h).  Header click sorts,
+//  a row shows its late frames, a late frame jumps to it on the Trace page.
+//
+//  Compare: AppController.compareTraces() diffs two log files in the
+//  background (src/analysis/TraceDiff.h); the result is read back with
+//  compareMessages() / compareHits() when compareRunning turns false.
+// ============================================================================
+
+Page {
+    id: analysisPage
+
+    readonly property var appWindow: ApplicationWindow.window
+    readonly property bool isDayTheme: appWindow ? appWindow.isDayTheme : false
+    readonly property color pageBg: appWindow ? appWindow.pageBg : "#0d1118"
+    readonly property color panelBg: appWindow ? appWindow.panelBg : "#10151c"
+    readonly property color border: appWindow ? appWindow.border : "#263242"
+    readonly property color accent: appWindow ? appWindow.accent : "#35b8ff"
+    readonly property color textMain: appWindow ? appWindow.textMain : "#e8eef8"
+    readonly property color textMuted: appWindow ? appWindow.textMuted : "#91a4c3"
+
+    readonly property string monoFont: {
+        if (Qt.platform.os === "windows") return "Consolas"
+        if (Qt.platform.os === "osx")     return "Menlo"
+        return "monospace"
+    }
+
+    readonly property var colWidths: [44, 90, -1, 80, 80, 80, 90, 80, 90]
+
+    property int  sortColumn:    8
+    property bool sortAscending: false
+    property int  selectedRow:   -1
+    property var  selectedGaps:  []
+
+    function selectRow(row) {
+        selectedRow  = row
+        selectedGaps = row >= 0 ? AppController.cycleReport.gaps(row) : []
+    }
+
+    Connections {
+        target: AppController.cycleReport
+        function onCountChanged() {
+            analysisPage.sortColumn    = 8
+            analysisPage.sortAscending = false
+            analysisPage.selectRow(-1)
+        }
+    }
+
+    FileDialog {
+        id: logDialog
+        title: "Analyse Log File"
+        nameFilters: ["Trace logs (*.asc *.blf *.alj)", "All files (*)"]
+        onAccepted: AppController.analyzeCycles(factorSpin.value / 10, selectedFile.toString())
+    }
+
+    background: Rectangle {
+        color: analysisPage.pageBg
+        radius: 10
+        border.color: analysisPage.border
+        border.width: 0
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 18
+        spacing: 12
+
+        TabBar {
+            id: analysisTabs
+            Layout.fillWidth: true
+            TabButton { text: "Cycle Report" }
+            TabButton { text: "Compare" }
+        }
+
+        StackLayout {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            currentIndex: analysisTabs.currentIndex
+
+            // ═════════════════════════════════════════════════════════════
+            //  Cycle report
+            // ═════════════════════════════════════════════════════════════
+            ColumnLayout {
+                spacing: 12
+
+                // ── Header + actions ──────────────────────────────────────────────
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 12
+
+                    ColumnLayout {
+                        spacing: 4
+                        Label {
+                            text: "Cycle Gaps & Jitter"
+                            color: analysisPage.textMain
+                            font.pixelSize: 22
+                            font.bold: true
+                        }
+                        Rectangle {
+                            width: 64
+                            height: 3
+                            radius: 2
+                            color: analysisPage.accent
+                        }
+                    }
+
+                    Item { Layout.fillWidth: true }
+
+                    Label {
+                        text: "Gap >"
+                        color: analysisPage.textMuted
+                        font.pixelSize: 12
+                    }
+
+                    // Tenths: 11 … 100 → 1.1× … 10.0× the nominal cycle
+                    SpinBox {
+                        id: factorSpin
+                        from: 11; to: 100; value: 20; stepSize: 5
+                        editable: true
+                        textFromValue: function(v) { return (v / 10).toFixed(1) + "×" }
+                        valueFromText: function(t) { return Math.round(parseFloat(t) * 10) }
+                    }
+
+                    BusyIndicator {
+                        running: AppController.cycleAnalysisRunning
+                        Layout.preferredWidth: 28
+                        Layout.preferredHeight: 28
+                    }
+
+                    Button {
+                        text: "Analyse Trace"
+                        highlighted: true
+                        enabled: !AppController.cycleAnalysisRunning && AppController.frameCount > 0
+                        onClicked: AppController.analyzeCycles(factorSpin.value / 10)
+                    }
+
+                    Button {
+                        text: "Analyse File…"
+                        enabled: !AppController.cycleAnalysisRunning
+                        onClicked: logDialog.open()
+                    }
+                }
+
+                Label {
+                    text: "Every interval above the factor × nominal cycle (DBC GenMsgCycleTime, else the median "
+                          + "interval) is a gap.  Jitter is the standard deviation of the interval."
+                    color: analysisPage.textMuted
+                    font.pixelSize: 12
+                    wrapMode: Text.WordWrap
+                    Layout.fillWidth: true
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    spacing: 12
+
+                    // ── Report table ──────────────────────────────────────────────
+                    Rectangle {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        radius: 8
+                        color: analysisPage.panelBg
+                        border.color: analysisPage.border
+                        border.width: 1
+                        clip: true
+
+                        HorizontalHeaderView {
+                            id: reportHeader
+                            anchors.top:   parent.top
+                            anchors.left:  parent.left
+                            anchors.right: parent.right
+                            anchors.margins: 1
+                            syncView: reportView
+                            clip: true
+
+                            delegate: Rectangle {
+                                implicitHeight: 26
+                                color: analysisPage.panelBg
+                                Label {
+                                    anchors.fill: parent
+                                    anchors.leftMargin: 6
+                                    text: (model.display ?? "")
+                                          + (analysisPage.sortColumn === column
+                                             ? (analysisPage.sortAscending ? "  ▲" : "  ▼") : "")
+                                    color: analysisPage.textMuted
+                                    font.pixelSize: 11
+                                    font.bold: true
+                                    elide: Text.ElideRight
+                                    verticalAlignment: Text.AlignVCenter
+                                }
+                                MouseArea {
+                                    anchors.fill: parent
+                                    cursorShape: Qt.PointingHandCursor
+                                    onClicked: {
+                                        if (analysisPage.sortColumn === column)
+                                            analysisPage.sortAscending = !analysisPage.sortAscending
+                                        else {
+                                            analysisPage.sortColumn    = column
+                                            analysisPage.sortAscending = column <= 2
+                                        }
+                                        AppController.cycleReport.sortByColumn(analysisPage.sortColumn,
+                                                                               analysisPage.sortAscending)
+                                        analysisPage.selectRow(-1)
+                                    }
+                                }
+                            }
+                        }
+
+                        TableView {
+                            id: reportView
+                            anchors.top:    reportHeader.bottom
+                            anchors.left:   parent.left
+                            anchors.right:  parent.right
+                            anchors.bottom: parent.bottom
+                            anchors.margins: 1
+                            clip: true
+                            model: AppController.cycleReport
+                            boundsBehavior: Flickable.StopAtBounds
+                            ScrollBar.vertical: ScrollBar {}
+
+                            columnWidthProvider: function(col) {
+                                var w = analysisPage.colWidths
+                                if (w[col] >= 0) return w[col]
+                                var used = 0
+                                for (var i = 0; i < w.length; ++i)
+                                    if (w[i] > 0) used += w[i]
+                                return Math.max(reportView.width - used, 120)
+                            }
+
+                            delegate: Rectangle {
+                                implicitHeight: 22
+                                color: row === analysisPage.selectedRow
+                                       ? Qt.rgba(analysisPage.accent.r, analysisPage.accent.g, analysisPage.accent.b, 0.18)
+                                       : "transparent"
+                                Label {
+                                    anchors.fill: parent
+                                    anchors.leftMargin: 6
+                                    text: model.display ?? ""
+                                    color: (column === 8 && model.hasGaps) ? "#e06c75"
+                                         : (column === 4 && !model.nominalFromDbc) ? analysisPage.textMuted
+                                         : analysisPage.textMain
+                                    font.pixelSize: 12
+                                    font.family: column === 2 ? analysisPage.font.family : analysisPage.monoFont
+                                    elide: Text.ElideRight
+                                    verticalAlignment: Text.AlignVCenter
+                                }
+                                MouseArea {
+                                    anchors.fill: parent
+                                    onClicked: analysisPage.selectRow(row)
+                                }
+                            }
+
+                            Label {
+                                anchors.centerIn: parent
+                                visible: reportView.rows === 0
+                                text: AppController.cycleAnalysisRunning ? "Analysing…"
+                                                                         : "No report yet — analyse the trace or a log file."
+                                color: analysisPage.textMuted
+                                font.pixelSize: 13
+                            }
+                        }
+                    }
+
+                    // ── Late frames of the selected row ───────────────────────────
+                    Rectangle {
+                        Layout.preferredWidth: 260
+                        Layout.fillHeight: true
+                        radius: 8
+                        color: analysisPage.panelBg
+                        border.color: analysisPage.border
+                        border.width: 1
+
+                        ListView {
+                            id: gapList
+                            anchors.fill: parent
+                            anchors.margins: 8
+                            clip: true
+                            model: analysisPage.selectedGaps
+                            boundsBehavior: Flickable.StopAtBounds
+                            ScrollBar.vertical: ScrollBar {}
+
+                            header: Label {
+                                width: gapList.width
+                                bottomPadding: 6
+                                text: "LATE FRAME          GAP"
+                                color: analysisPage.textMuted
+                                font.pixelSize: 10
+                                font.letterSpacing: 1.0
+                            }
+
+                            delegate: ItemDelegate {
+                                required property var modelData
+                                width: gapList.width
+                                height: 24
+                                contentItem: RowLayout {
+                                    Label {
+                                        text: modelData.timeSec.toFixed(6) + " s"
+                                        color: analysisPage.textMain
+                                        font.pixelSize: 12
+                                        font.family: analysisPage.monoFont
+                                        Layout.fillWidth: true
+                                    }
+                                    Label {
+                                        text: modelData.gapMs.toFixed(1) + " ms"
+                                        color: "#e06c75"
+                                        font.pixelSize: 12
+                                        font.family: analysisPage.monoFont
+                                    }
+                                }
+                                onClicked: {
+                                    if (analysisPage.appWindow)
+                                        analysisPage.appWindow.jumpToFrame(modelData.timeSec,
+                                                                           modelData.channel, modelData.id)
+                                }
+                            }
+
+                            Label {
+                                anchors.centerIn: parent
+                                width: parent.width
+                                visible: gapList.count === 0
+                                text: analysisPage.selectedRow < 0 ? "Select a row to list its gaps."
+                                                                   : "No gaps for this ID."
+                                color: analysisPage.textMuted
+                                font.pixelSize: 12
+                                wrapMode: Text.WordWrap
+                                horizontalAlignment: Text.AlignHCenter
+                            }
+                        }
+                    }
+                }
+            }
+
+            // ═════════════════════════════════════════════════════════════
+            //  Compare — baseline vs candidate (src/analysis/TraceDiff.h)
+            //
+            //  Left: messages that differ (missing/new ID, cycle change,
+            //  unaligned frames, signal divergence).  Right: the hit list
+            //  of the selected message, baseline and candidate side by side.
+            // ═════════════════════════════════════════════════════════════
+            ColumnLayout {
+                id: comparePane
+                spacing: 12
+
+                property string baselinePath:  ""
+                property string candidatePath: ""
+                property var    messages:      []
+                property int    selected:      -1    // index into messages
+                property var    hits:          []
+
+                function refresh() {
+                    messages = AppController.compareMessages(onlyDiffering.checked,
+                                                             cycleTolSpin.value / 100)
+                    select(-1)
+                }
+                function select(i) {
+                    selected = i
+                    hits = i >= 0 ? AppController.compareHits(messages[i].index) : []
+                }
+                function fileName(path) {
+                    const s = path.toString()
+                    return s.substring(s.lastIndexOf("/") + 1)
+                }
+
+                Connections {
+                    target: AppController
+                    function onCompareRunningChanged() {
+                        if (!AppController.compareRunning)
+                            comparePane.refresh()
+                    }
+                }
+
+                FileDialog {
+                    id: baselineDialog
+                    title: "Baseline Trace"
+                    nameFilters: ["Trace logs (*.asc *.blf *.alj)", "All files (*)"]
+                    onAccepted: comparePane.baselinePath = selectedFile.toString()
+                }
+                FileDialog {
+                    id: candidateDialog
+                    title: "Candidate Trace"
+                    nameFilters: ["Trace logs (*.asc *.blf *.alj)", "All files (*)"]
+                    onAccepted: comparePane.candidatePath = selectedFile.toString()
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+
+                    Button {
+                        text: comparePane.baselinePath === "" ? "Baseline…"
+                                                              : "A: " + comparePane.fileName(comparePane.baselinePath)
+                        onClicked: baselineDialog.open()
+                    }
+                    Button {
+                        text: comparePane.candidatePath === "" ? "Candidate…"
+                                                               : "B: " + comparePane.fileName(comparePane.candidatePath)
+                        onClicked: candidateDialog.open()
+                    }
+                    ComboBox {
+                        id: alignCombo
+                        model: ["Align by time", "Align by sequence"]
+                    }
+
+                    Item { Layout.fillWidth: true }
+
+                    CheckBox {
+                        id: onlyDiffering
+                        text: "Only differing"
+                        checked: true
+                        onToggled: comparePane.refresh()
+                    }
+                    Label {
+                        text: "Cycle ±"
+                        color: analysisPage.textMuted
+                        font.pixelSize: 12
+                    }
+                    SpinBox {
+                        id: cycleTolSpin
+                        from: 1; to: 100; value: 10
+                        editable: true
+                        textFromValue: function(v) { return v + " %" }
+                        valueFromText: function(t) { return parseInt(t) }
+                        onValueModified: comparePane.refresh()
+                    }
+                    BusyIndicator {
+                        running: AppController.compareRunning
+                        Layout.preferredWidth: 28
+                        Layout.preferredHeight: 28
+                    }
+                    Button {
+                        text: "Compare"
+                        highlighted: true
+                        enabled: !AppController.compareRunning
+                                 && comparePane.baselinePath !== "" && comparePane.candidatePath !== ""
+                        onClicked: AppController.compareTraces(comparePane.baselinePath,
+                                                               comparePane.candidatePath,
+                                                               alignCombo.currentIndex === 1)
+                    }
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    spacing: 12
+
+                    // ── Messages ──────────────────────────────────────────
+                    Rectangle {
+                        Layout.preferredWidth: 380
+                        Layout.fillHeight: true
+                        radius: 8
+                        color: analysisPage.panelBg
+                        border.color: analysisPage.border
+                        border.width: 1
+
+                        ListView {
+                            id: messageList
+                            anchors.fill: parent
+                            anchors.margins: 8
+                            clip: true
+                            model: comparePane.messages
+                            boundsBehavior: Flickable.StopAtBounds
+                            ScrollBar.vertical: ScrollBar {}
+
+                            delegate: ItemDelegate {
+                                required property var modelData
+                                required property int index
+                                width: messageList.width
+                                highlighted: index === comparePane.selected
+                                onClicked: comparePane.select(index)
+
+                                contentItem: ColumnLayout {
+                                    spacing: 2
+                                    RowLayout {
+                                        Label {
+                                            text: "CH" + modelData.channel + "  "
+                                                  + modelData.id.toString(16).toUpperCase()
+                                                  + (modelData.extended ? "x" : "h")
+                                            color: analysisPage.textMain
+                                            font.pixelSize: 12
+                                            font.family: analysisPage.monoFont
+                                        }
+                                        Label {
+                                            text: modelData.name
+                                            color: analysisPage.accent
+                                            font.pixelSize: 12
+                                            elide: Text.ElideRight
+                                            Layout.fillWidth: true
+                                        }
+                                        Label {
+                                            text: modelData.status === "baseline"  ? "MISSING"
+                                                : modelData.status === "candidate" ? "NEW"
+                                                : modelData.hitCount > 0 ? modelData.hitCount + " diffs" : ""
+                                            color: modelData.status === "common" ? analysisPage.textMuted : "#e06c75"
+                                            font.pixelSize: 11
+                                            font.bold: modelData.status !== "common"
+                                        }
+                                    }
+                                    Label {
+                                        text: modelData.baseCycleMs.toFixed(2) + " → "
+                                              + modelData.candCycleMs.toFixed(2) + " ms   "
+                                              + modelData.baseFrames + " / " + modelData.candFrames + " frames"
+                                              + (modelData.onlyBase + modelData.onlyCand > 0
+                                                 ? "   unaligned " + modelData.onlyBase + " / " + modelData.onlyCand : "")
+                                        color: analysisPage.textMuted
+                                        font.pixelSize: 11
+                                        font.family: analysisPage.monoFont
+                                        elide: Text.ElideRight
+                                        Layout.fillWidth: true
+                                    }
+                                }
+                            }
+
+                            Label {
+                                anchors.centerIn: parent
+                                width: parent.width
+                                visible: messageList.count === 0
+                                text: AppController.compareRunning ? "Comparing…"
+                                                                   : "Pick a baseline and a candidate log, then Compare."
+                                color: analysisPage.textMuted
+                                font.pixelSize: 12
+                                wrapMode: Text.WordWrap
+                                horizontalAlignment: Text.AlignHCenter
+                            }
+                        }
+                    }
+
+                    // ── Side-by-side hits ─────────────────────────────────
+                    Rectangle {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        radius: 8
+                        color: analysisPage.panelBg
+                        border.color: analysisPage.border
+                        border.width: 1
+
+                        ListView {
+                            id: hitList
+                            anchors.fill: parent
+                            anchors.margins: 8
+                            clip: true
+                            model: comparePane.hits
+                            boundsBehavior: Flickable.StopAtBounds
+                            ScrollBar.vertical: ScrollBar {}
+
+                            header: RowLayout {
+                                width: hitList.width
+                                spacing: 8
+                                Repeater {
+                                    model: ["SIGNAL", "BASELINE (A)", "CANDIDATE (B)"]
+                                    delegate: Label {
+                                        required property string modelData
+                                        required property int index
+                                        text: modelData
+                                        color: analysisPage.textMuted
+                                        font.pixelSize: 10
+                                        font.letterSpacing: 1.0
+                                        Layout.preferredWidth: index === 0 ? 160 : -1
+                                        Layout.fillWidth: index > 0
+                                    }
+                                }
+                            }
+
+                            delegate: RowLayout {
+                                required property var modelData
+                                width: hitList.width
+                                spacing: 8
+
+                                function side(sec, value, data) {
+                                    if (sec < 0) return "—"
+                                    return sec.toFixed(6) + " s   "
+                                           + (modelData.kind === "signal" ? value.toPrecision(6) : data)
+                                }
+
+                                Label {
+                                    text: modelData.kind === "signal"    ? modelData.signal
+                                        : modelData.kind === "payload"   ? "payload"
+                                        : modelData.kind === "baseline"  ? "only in A"
+                                                                         : "only in B"
+                                    color: modelData.kind === "signal" ? analysisPage.accent : "#e06c75"
+                                    font.pixelSize: 12
+                                    elide: Text.ElideRight
+                                    Layout.preferredWidth: 160
+                                }
+                                Label {
+                                    text: side(modelData.baseSec, modelData.baseValue, modelData.baseData)
+                                    color: analysisPage.textMain
+                                    font.pixelSize: 12
+                                    font.family: analysisPage.monoFont
+                                    elide: Text.ElideRight
+                                    Layout.fillWidth: true
+                                }
+                                Label {
+                                    text: side(modelData.candSec, modelData.candValue, modelData.candData)
+                                    color: analysisPage.textMain
+                                    font.pixelSize: 12
+                                    font.family: analysisPage.monoFont
+                                    elide: Text.ElideRight
+                                    Layout.fillWidth: true
+                                }
+                            }
+
+                            Label {
+                                anchors.centerIn: parent
+                                visible: hitList.count === 0
+                                text: comparePane.selected < 0 ? "Select a message."
+                                                               : "No listed differences."
+                                color: analysisPage.textMuted
+                                font.pixelSize: 12
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,242 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+import QtQuick.Dialogs
+
+// ============================================================================
+//  GatewayPage — frame routing between channels
+//
+//  Edits the gateway route table (JSON, see src/gateway/GatewayEngine.h).
+//  Apply compiles the table in C++; on error the previous table stays active
+//  and the message is shown below the editor.  Per-route counters and the
+//  forwarding latency (receive → transmit returned) are polled while visible.
+// ============================================================================
+
+Page {
+    id: gatewayPage
+
+    readonly property var appWindow: ApplicationWindow.window
+    readonly property bool isDayTheme: appWindow ? appWindow.isDayTheme : false
+    readonly property color pageBg: appWindow ? appWindow.pageBg : "#0d1118"
+    readonly property color panelBg: appWindow ? appWindow.panelBg : "#10151c"
+    readonly property color border: appWindow ? appWindow.border : "#263242"
+    readonly property color accent: appWindow ? appWindow.accent : "#35b8ff"
+    readonly property color textMain: appWindow ? appWindow.textMain : "#e8eef8"
+    readonly property color textMuted: appWindow ? appWindow.textMuted : "#91a4c3"
+
+    // Same platform-aware monospace choice as TracePage
+    readonly property string monoFont: {
+        if (Qt.platform.os === "windows") return "Consolas"
+        if (Qt.platform.os === "osx")     return "Menlo"
+        return "monospace"
+    }
+
+    property var routeStats: []
+    property string applyError: ""
+
+    function applyRoutes(json) {
+        gatewayPage.applyError = AppController.setGatewayRoutes(json)
+        gatewayPage.routeStats = AppController.gatewayStats()
+    }
+
+    Component.onCompleted: {
+        routeEditor.text = AppController.gatewayRoutes()
+        routeStats = AppController.gatewayStats()
+    }
+
+    // Counters are polled; the gateway runs on the driver thread.
+    Timer {
+        interval: 500
+        repeat: true
+        running: AppController.gatewayEnabled && gatewayPage.visible
+        onTriggered: gatewayPage.routeStats = AppController.gatewayStats()
+    }
+
+    FileDialog {
+        id: routeDialog
+        title: "Load Gateway Routes"
+        nameFilters: ["Route table (*.json)", "All files (*)"]
+        onAccepted: {
+            gatewayPage.applyError = AppController.loadGatewayRoutes(selectedFile.toString())
+            if (gatewayPage.applyError === "")
+                routeEditor.text = AppController.gatewayRoutes()
+            gatewayPage.routeStats = AppController.gatewayStats()
+        }
+    }
+
+    background: Rectangle {
+        color: gatewayPage.pageBg
+        radius: 10
+        border.color: gatewayPage.border
+        border.width: 0
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 18
+        spacing: 12
+
+        // ── Header + enable ───────────────────────────────────────────────
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 12
+
+            ColumnLayout {
+                spacing: 4
+                Label {
+                    text: "Gateway"
+                    color: gatewayPage.textMain
+                    font.pixelSize: 22
+                    font.bold: true
+                }
+                Rectangle {
+                    width: 64
+                    height: 3
+                    radius: 2
+                    color: gatewayPage.accent
+                }
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Button {
+                text: "Load…"
+                onClicked: routeDialog.open()
+            }
+
+            Button {
+                text: "Apply"
+                highlighted: true
+                onClicked: gatewayPage.applyRoutes(routeEditor.text)
+            }
+
+            Switch {
+                text: "Forwarding"
+                checked: AppController.gatewayEnabled
+                onToggled: AppController.gatewayEnabled = checked
+            }
+        }
+
+        Label {
+            text: "Routes run on the driver thread before the trace: remap IDs, rewrite DBC signals, "
+                  + "block or rate-limit frames.  Forwarded frames appear in the trace as Tx."
+            color: gatewayPage.textMuted
+            font.pixelSize: 12
+            wrapMode: Text.WordWrap
+            Layout.fillWidth: true
+        }
+
+        // ── Route table editor ────────────────────────────────────────────
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            radius: 8
+            color: gatewayPage.panelBg
+            border.color: gatewayPage.applyError !== "" ? "#e06c75" : gatewayPage.border
+            border.width: 1
+
+            ScrollView {
+                anchors.fill: parent
+                anchors.margins: 6
+                TextArea {
+                    id: routeEditor
+                    wrapMode: TextEdit.NoWrap
+                    selectByMouse: true
+                    color: gatewayPage.textMain
+                    font.pixelSize: 12
+                    font.family: gatewayPage.monoFont
+                    placeholderText: '{ "routes": [ { "from": { "channel": 1, "id": "0x100" }, '
+                                     + '"to": { "channel": 2, "id": "0x200" } } ] }'
+                    background: null
+                }
+            }
+        }
+
+        Label {
+            visible: gatewayPage.applyError !== ""
+            text: gatewayPage.applyError
+            color: "#e06c75"
+            font.pixelSize: 12
+            wrapMode: Text.WordWrap
+            Layout.fillWidth: true
+        }
+
+        // ── Per-route statistics ──────────────────────────────────────────
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 180
+            radius: 8
+            color: gatewayPage.panelBg
+            border.color: gatewayPage.border
+            border.width: 1
+
+            ListView {
+                id: routeList
+                anchors.fill: parent
+                anchors.margins: 8
+                clip: true
+                model: gatewayPage.routeStats
+                boundsBehavior: Flickable.StopAtBounds
+                ScrollBar.vertical: ScrollBar {}
+
+                header: RowLayout {
+                    width: routeList.width
+                    spacing: 8
+                    Repeater {
+                        model: ["ROUTE", "MATCHED", "FORWARDED", "FILTERED", "TX ERR", "AVG / MAX LATENCY"]
+                        delegate: Label {
+                            required property string modelData
+                            required property int index
+                            text: modelData
+                            color: gatewayPage.textMuted
+                            font.pixelSize: 10
+                            font.letterSpacing: 1.0
+                            Layout.fillWidth: index === 0
+                            Layout.preferredWidth: index === 0 ? -1 : (index === 5 ? 150 : 80)
+                        }
+                    }
+                }
+
+                delegate: RowLayout {
+                    required property var modelData
+                    width: routeList.width
+                    spacing: 8
+                    Label {
+                        text: modelData.route
+                        color: gatewayPage.textMain
+                        font.pixelSize: 12
+                        elide: Text.ElideRight
+                        Layout.fillWidth: true
+                    }
+                    Repeater {
+                        model: [modelData.matched, modelData.forwarded, modelData.filtered, modelData.txErrors]
+                        delegate: Label {
+                            required property var modelData
+                            required property int index
+                            text: modelData
+                            color: index === 3 && modelData > 0 ? "#e06c75" : gatewayPage.textMuted
+                            font.pixelSize: 12
+                            font.family: gatewayPage.monoFont
+                            Layout.preferredWidth: 80
+                        }
+                    }
+                    Label {
+                        text: modelData.avgUs.toFixed(1) + " / " + modelData.maxUs.toFixed(1) + " µs"
+                        color: gatewayPage.accent
+                        font.pixelSize: 12
+                        font.family: gatewayPage.monoFont
+                        Layout.preferredWidth: 150
+                    }
+                }
+
+                Label {
+                    anchors.centerIn: parent
+                    visible: routeList.count === 0
+                    text: "No routes — write a route table above and press Apply."
+                    color: gatewayPage.textMuted
+                    font.pixelSize: 13
+                }
+            }
+        }
+    }
+}
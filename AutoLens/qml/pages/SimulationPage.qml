@@ -1,6 +1,18 @@
 import QtQuick
 import QtQuick.Controls
 import QtQuick.Layouts
+import QtQuick.Dialogs
+
+// ============================================================================
+//  SimulationPage — residual bus simulation
+//
+//  Lists the DBC nodes (BU_) of every enabled channel.  Checked nodes are
+//  simulated: AppController transmits all their messages at GenMsgCycleTime
+//  through the connected driver.  Node selection is persisted by C++.
+//
+//  Below it, JavaScript node scripts (see src/sim/ScriptRuntime.h) can be
+//  loaded; each handler's call count and execution time is listed.
+// ============================================================================
 
 Page {
     id: simulationPage
@@ -14,6 +26,76 @@ Page {
     readonly property color textMain: appWindow ? appWindow.textMain : "#e8eef8"
     readonly property color textMuted: appWindow ? appWindow.textMuted : "#91a4c3"
 
+    // Same platform-aware monospace choice as TracePage
+    readonly property string monoFont: {
+        if (Qt.platform.os === "windows") return "Consolas"
+        if (Qt.platform.os === "osx")     return "Menlo"
+        return "monospace"
+    }
+
+    readonly property bool running: AppController.residualBusRunning
+    property var stats: ({})
+    property var handlerStats: []
+    property var busStats: ({})
+
+    function refreshNodes() {
+        nodeModel.clear()
+        const nodes = AppController.residualBusNodes()
+        for (let i = 0; i < nodes.length; ++i)
+            nodeModel.append(nodes[i])
+    }
+
+    // Node list depends on the channel DBCs — refresh whenever they change.
+    Component.onCompleted: refreshNodes()
+    Connections {
+        target: AppController
+        function onDbcInfoChanged() { simulationPage.refreshNodes() }
+        function onResidualBusRunningChanged() { simulationPage.stats = AppController.residualBusStats() }
+        function onScriptOutput(line) {
+            scriptLog.append(line)
+            if (scriptLog.lineCount > 500)
+                scriptLog.remove(0, scriptLog.text.indexOf("\n") + 1)
+        }
+    }
+
+    ListModel { id: nodeModel }
+
+    // Stats are polled; the simulator thread never posts to the UI.
+    Timer {
+        interval: 500
+        repeat: true
+        running: simulationPage.running && simulationPage.visible
+        onTriggered: simulationPage.stats = AppController.residualBusStats()
+    }
+
+    Timer {
+        interval: 500
+        repeat: true
+        running: AppController.scriptsRunning && simulationPage.visible
+        onTriggered: simulationPage.handlerStats = AppController.scriptHandlerStats()
+    }
+
+    // Virtual bus load / arbitration counters (only with the virtual driver).
+    Timer {
+        interval: 1000
+        repeat: true
+        running: AppController.connected && simulationPage.visible
+        onTriggered: simulationPage.busStats = AppController.virtualBusStats()
+    }
+
+    FileDialog {
+        id: scriptDialog
+        title: "Load Node Scripts"
+        fileMode: FileDialog.OpenFiles
+        nameFilters: ["JavaScript (*.js)", "All files (*)"]
+        onAccepted: {
+            const paths = []
+            for (let i = 0; i < selectedFiles.length; ++i)
+                paths.push(selectedFiles[i].toString())
+            AppController.loadScripts(paths)
+        }
+    }
+
     background: Rectangle {
         color: simulationPage.pageBg
         radius: 10
@@ -21,60 +103,322 @@ Page {
         border.width: 0
     }
 
-    Rectangle {
-        width: Math.min(parent.width * 0.78, 760)
-        height: 320
-        radius: 14
-        anchors.centerIn: parent
-        border.color: simulationPage.border
-        border.width: 0
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 18
+        spacing: 12
 
-        gradient: Gradient {
-            GradientStop { position: 0.0; color: simulationPage.isDayTheme ? "#f8fbff" : "#161f2b" }
-            GradientStop { position: 1.0; color: simulationPage.panelBg }
-        }
+        // ── Header + run control ──────────────────────────────────────────
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 12
 
-        ColumnLayout {
-            anchors.fill: parent
-            anchors.margins: 26
-            spacing: 14
+            ColumnLayout {
+                spacing: 4
+                Label {
+                    text: "Residual Bus Simulation"
+                    color: simulationPage.textMain
+                    font.pixelSize: 22
+                    font.bold: true
+                }
+                Rectangle {
+                    width: 64
+                    height: 3
+                    radius: 2
+                    color: simulationPage.accent
+                }
+            }
+
+            Item { Layout.fillWidth: true }
 
-            Label {
-                text: "Simulation"
-                color: simulationPage.textMain
-                font.pixelSize: 34
-                font.bold: true
+            Button {
+                text: "Refresh"
+                enabled: !simulationPage.running
+                onClicked: simulationPage.refreshNodes()
             }
 
-            Rectangle {
-                width: 64
-                height: 3
-                radius: 2
-                color: simulationPage.accent
+            Button {
+                text: simulationPage.running ? "Stop" : "Start"
+                enabled: simulationPage.running || AppController.connected
+                highlighted: !simulationPage.running
+                onClicked: simulationPage.running ? AppController.stopResidualBus()
+                                                  : AppController.startResidualBus()
             }
+        }
 
-            Label {
-                text: "Replay and traffic simulation are planned for Phase 3."
-                color: simulationPage.textMuted
-                font.pixelSize: 14
+        Label {
+            text: AppController.connected
+                  ? "Checked nodes are simulated: every message they send is transmitted at its GenMsgCycleTime."
+                  : "Connect to a channel to start the simulation (the port must not be listen-only)."
+            color: simulationPage.textMuted
+            font.pixelSize: 12
+            wrapMode: Text.WordWrap
+            Layout.fillWidth: true
+        }
+
+        // ── Node list ─────────────────────────────────────────────────────
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            radius: 8
+            color: simulationPage.panelBg
+            border.color: simulationPage.border
+            border.width: 1
+
+            ListView {
+                id: nodeList
+                anchors.fill: parent
+                anchors.margins: 6
+                clip: true
+                model: nodeModel
+                boundsBehavior: Flickable.StopAtBounds
+                ScrollBar.vertical: ScrollBar {}
+
+                delegate: RowLayout {
+                    id: nodeRow
+                    required property int index
+                    required property int channel
+                    required property string name
+                    required property int messageCount
+                    required property int cyclicCount
+                    required property bool selected
+
+                    width: nodeList.width
+                    spacing: 10
+
+                    CheckBox {
+                        checked: nodeRow.selected
+                        enabled: !simulationPage.running
+                        onToggled: {
+                            AppController.setResidualBusNodeEnabled(nodeRow.channel, nodeRow.name, checked)
+                            nodeModel.setProperty(nodeRow.index, "selected", checked)
+                        }
+                    }
+                    Label {
+                        text: "CH" + nodeRow.channel
+                        color: simulationPage.accent
+                        font.pixelSize: 11
+                        Layout.preferredWidth: 36
+                    }
+                    Label {
+                        text: nodeRow.name
+                        color: simulationPage.textMain
+                        font.pixelSize: 13
+                        elide: Text.ElideRight
+                        Layout.fillWidth: true
+                    }
+                    Label {
+                        text: nodeRow.cyclicCount + " / " + nodeRow.messageCount + " cyclic"
+                        color: simulationPage.textMuted
+                        font.pixelSize: 11
+                        Layout.rightMargin: 8
+                    }
+                }
+
+                Label {
+                    anchors.centerIn: parent
+                    visible: nodeModel.count === 0
+                    text: "No DBC nodes — assign a DBC to an enabled channel in CAN Config."
+                    color: simulationPage.textMuted
+                    font.pixelSize: 13
+                }
+            }
+        }
+
+        // ── Node scripts ──────────────────────────────────────────────────
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 220
+            radius: 8
+            color: simulationPage.panelBg
+            border.color: simulationPage.border
+            border.width: 1
+
+            ColumnLayout {
+                anchors.fill: parent
+                anchors.margins: 8
+                spacing: 6
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 8
+
+                    Label {
+                        text: "NODE SCRIPTS"
+                        color: simulationPage.textMuted
+                        font.pixelSize: 10
+                        font.letterSpacing: 1.0
+                    }
+                    Label {
+                        text: AppController.scriptsRunning
+                              ? AppController.scriptPaths().length + " loaded"
+                              : "not running"
+                        color: AppController.scriptsRunning ? simulationPage.accent
+                                                            : simulationPage.textMuted
+                        font.pixelSize: 11
+                    }
+                    Item { Layout.fillWidth: true }
+                    Button {
+                        text: "Load…"
+                        enabled: AppController.connected
+                        onClicked: scriptDialog.open()
+                    }
+                    Button {
+                        text: "Reload"
+                        enabled: AppController.connected && AppController.scriptPaths().length > 0
+                        onClicked: AppController.loadScripts(AppController.scriptPaths())
+                    }
+                    Button {
+                        text: "Unload"
+                        enabled: AppController.scriptsRunning
+                        onClicked: AppController.unloadScripts()
+                    }
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    spacing: 8
+
+                    // Per-handler profile
+                    ListView {
+                        id: handlerList
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        clip: true
+                        model: simulationPage.handlerStats
+                        ScrollBar.vertical: ScrollBar {}
+
+                        delegate: RowLayout {
+                            required property var modelData
+                            width: handlerList.width
+                            spacing: 8
+                            Label {
+                                text: modelData.node
+                                color: simulationPage.accent
+                                font.pixelSize: 11
+                                Layout.preferredWidth: 90
+                                elide: Text.ElideRight
+                            }
+                            Label {
+                                text: modelData.handler
+                                color: simulationPage.textMain
+                                font.pixelSize: 11
+                                elide: Text.ElideRight
+                                Layout.fillWidth: true
+                            }
+                            Label {
+                                text: modelData.calls + " calls  "
+                                      + modelData.avgUs.toFixed(1) + " / "
+                                      + modelData.maxUs.toFixed(1) + " µs"
+                                      + (modelData.errors > 0 ? "  ⚠ " + modelData.errors : "")
+                                color: modelData.errors > 0 ? "#e06c75" : simulationPage.textMuted
+                                font.pixelSize: 11
+                                font.family: simulationPage.monoFont
+                            }
+                        }
+                    }
+
+                    // can.log() output
+                    ScrollView {
+                        Layout.preferredWidth: parent.width * 0.4
+                        Layout.fillHeight: true
+                        TextArea {
+                            id: scriptLog
+                            readOnly: true
+                            wrapMode: TextEdit.NoWrap
+                            color: simulationPage.textMain
+                            font.pixelSize: 11
+                            font.family: simulationPage.monoFont
+                            placeholderText: "can.log() output"
+                            background: Rectangle {
+                                color: simulationPage.pageBg
+                                radius: 4
+                            }
+                        }
+                    }
+                }
             }
+        }
 
-            Label {
-                text: "Upcoming: ASC/BLF file import, transport controls, speed factors, and timing schedule view."
-                color: simulationPage.textMuted
-                wrapMode: Text.WordWrap
-                font.pixelSize: 13
-                Layout.fillWidth: true
+        // ── Statistics ────────────────────────────────────────────────────
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 24
+
+            Repeater {
+                model: [
+                    { label: "Messages",    value: simulationPage.stats.scheduled ?? 0 },
+                    { label: "Frames sent", value: simulationPage.stats.framesSent ?? 0 },
+                    { label: "Avg late",    value: (simulationPage.stats.avgLatenessUs ?? 0).toFixed(1) + " µs" },
+                    { label: "Max late",    value: (simulationPage.stats.maxLatenessUs ?? 0).toFixed(1) + " µs" },
+                    { label: "TX errors",   value: simulationPage.stats.txErrors ?? 0 }
+                ]
+                delegate: ColumnLayout {
+                    required property var modelData
+                    spacing: 2
+                    Label {
+                        text: modelData.label.toUpperCase()
+                        color: simulationPage.textMuted
+                        font.pixelSize: 10
+                        font.letterSpacing: 1.0
+                    }
+                    Label {
+                        text: modelData.value
+                        color: simulationPage.textMain
+                        font.pixelSize: 15
+                        font.bold: true
+                    }
+                }
             }
 
-            Item { Layout.fillHeight: true }
+            Item { Layout.fillWidth: true }
+        }
+
+        // ── Virtual bus ───────────────────────────────────────────────────
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 24
+            visible: simulationPage.busStats.available === true
 
-            Label {
-                text: "STATUS: REQUIREMENTS DEFINED"
-                color: simulationPage.accent
-                font.pixelSize: 11
-                font.letterSpacing: 1.0
+            ColumnLayout {
+                spacing: 2
+                Label {
+                    text: "BUS LOAD"
+                    color: simulationPage.textMuted
+                    font.pixelSize: 10
+                    font.letterSpacing: 1.0
+                }
+                Label {
+                    text: (simulationPage.busStats.busLoad ?? 0).toFixed(1) + " %"
+                    color: simulationPage.textMain
+                    font.pixelSize: 15
+                    font.bold: true
+                }
             }
+
+            // One column per bus node: frames won / arbitration losses
+            Repeater {
+                model: simulationPage.busStats.nodes ?? []
+                delegate: ColumnLayout {
+                    required property var modelData
+                    spacing: 2
+                    Label {
+                        text: modelData.name.toUpperCase()
+                        color: simulationPage.textMuted
+                        font.pixelSize: 10
+                        font.letterSpacing: 1.0
+                    }
+                    Label {
+                        text: modelData.txFrames + " tx · " + modelData.arbitrationLosses + " lost"
+                        color: simulationPage.textMain
+                        font.pixelSize: 13
+                        font.family: simulationPage.monoFont
+                    }
+                }
+            }
+
+            Item { Layout.fillWidth: true }
         }
     }
 }
@@ -34,8 +34,10 @@
  *  • Each cell delegate is a lightweight Item — no QObject per cell.
  *    All display strings were pre-formatted in C++ (AppController::buildEntry).
  *
- *  • The `model.isFrame` custom role lets the delegate branch between
- *    frame and signal rendering without any JS state.
+ *  • Each cell reads one `model.rowData` snapshot (TraceRow) — text and
+ *    flags for the whole row — instead of one role per property.
+ *    The `depth` property lets the delegate branch between frame and
+ *    signal rendering without any JS state.
  *
  *  • FileDialog for Save and DBC Load — avoids hard-coded paths.
  */
@@ -139,7 +141,7 @@ Page {
             return false
 
         const path = urlValue.toString().toLowerCase()
-        return path.endsWith(".asc") || path.endsWith(".blf")
+        return path.endsWith(".asc") || path.endsWith(".blf") || path.endsWith(".alj")
     }
 
     function hasSupportedTraceLog(urls) {
@@ -167,6 +169,13 @@ Page {
         }
     }
 
+    // Scroll to one frame — called via appWindow.jumpToFrame() from reports.
+    function jumpToFrame(seconds, channel, id) {
+        const idx = AppController.traceIndexOfFrame(seconds, channel, id)
+        if (idx.valid)
+            traceView.positionViewAtRow(traceView.rowAtIndex(idx), TableView.AlignVCenter)
+    }
+
     // ─────────────────────────────────────────────────────────────────────────
     //  Page background
     // ─────────────────────────────────────────────────────────────────────────
@@ -297,7 +306,7 @@ Page {
                     }
 
                     Label {
-                        text: "Drop .asc/.blf to analyze"
+                        text: "Drop .asc/.blf/.alj to analyze"
                         color: tracePage.clrTextMuted
                         font.pixelSize: 10
                         Layout.leftMargin: 6
@@ -589,10 +598,161 @@ Page {
         anchors.fill: parent
         color: tracePage.clrPage
 
+        // ─────────────────────────────────────────────────────────────────────
+        //  MINIMAP
+        //
+        //  One column per 2 px from AppController.traceOverview(): frame
+        //  density per channel, bus load line, error ticks and the min/max
+        //  band of the overview signal.  Click jumps the view to that time,
+        //  wheel zooms around the cursor, double-click shows the whole trace.
+        // ─────────────────────────────────────────────────────────────────────
+        Canvas {
+            id: minimap
+            anchors.top:   parent.top
+            anchors.left:  parent.left
+            anchors.right: parent.right
+            height: 40
+
+            property var    ov:      null
+            property double viewFrom: -1   // seconds, -1 = whole trace
+            property double viewTo:   -1
+
+            function refresh() {
+                ov = AppController.traceOverview(Math.max(1, Math.floor(width / 2)),
+                                                 viewFrom, viewTo)
+                requestPaint()
+            }
+            function timeAt(x) {
+                if (!ov || width <= 0) return -1
+                return ov.fromSec + (ov.toSec - ov.fromSec) * Math.max(0, Math.min(1, x / width))
+            }
+
+            onWidthChanged: refresh()
+            Component.onCompleted: refresh()
+
+            Timer {
+                interval: 500
+                repeat: true
+                running: tracePage.visible
+                property int lastCount: -1
+                onTriggered: {
+                    if (AppController.frameCount !== lastCount) {
+                        lastCount = AppController.frameCount
+                        minimap.refresh()
+                    }
+                }
+            }
+
+            onPaint: {
+                var ctx = getContext("2d")
+                ctx.fillStyle = tracePage.clrPanel
+                ctx.fillRect(0, 0, width, height)
+                if (!ov || ov.columns === 0) return
+
+                var n  = ov.columns
+                var cw = width / n
+                var chColors = [tracePage.clrCH1, tracePage.clrCH2,
+                                tracePage.clrDecoded, tracePage.clrFD]
+
+                // Stacked frame density per channel
+                var maxF = Math.max(1, ov.maxFrames)
+                for (var i = 0; i < n; ++i) {
+                    var y = height
+                    for (var ch = 0; ch < ov.frames.length; ++ch) {
+                        var f = ov.frames[ch][i]
+                        if (f <= 0) continue
+                        var h = (height - 4) * f / maxF
+                        ctx.fillStyle = chColors[ch % chColors.length]
+                        ctx.globalAlpha = 0.55
+                        ctx.fillRect(i * cw, y - h, Math.max(1, cw), h)
+                        y -= h
+                    }
+                }
+                ctx.globalAlpha = 1.0
+
+                // Signal min/max band (scaled to its own range)
+                if (ov.hasSignal) {
+                    var lo = Infinity, hi = -Infinity
+                    for (i = 0; i < n; ++i) {
+                        if (isNaN(ov.sigMin[i])) continue
+                        lo = Math.min(lo, ov.sigMin[i]); hi = Math.max(hi, ov.sigMax[i])
+                    }
+                    var span = (hi > lo) ? hi - lo : 1
+                    ctx.fillStyle = tracePage.clrSignalText
+                    for (i = 0; i < n; ++i) {
+                        if (isNaN(ov.sigMin[i])) continue
+                        var yTop = 2 + (height - 4) * (1 - (ov.sigMax[i] - lo) / span)
+                        var yBot = 2 + (height - 4) * (1 - (ov.sigMin[i] - lo) / span)
+                        ctx.fillRect(i * cw, yTop, Math.max(1, cw), Math.max(1, yBot - yTop))
+                    }
+                }
+
+                // Bus load line (busiest channel)
+                ctx.strokeStyle = tracePage.clrTextMain
+                ctx.lineWidth = 1
+                ctx.beginPath()
+                for (i = 0; i < n; ++i) {
+                    var ly = height - 1 - (height - 2) * ov.load[i]
+                    if (i === 0) ctx.moveTo(0, ly); else ctx.lineTo((i + 0.5) * cw, ly)
+                }
+                ctx.stroke()
+
+                // Error ticks along the top edge
+                ctx.fillStyle = tracePage.clrError
+                for (i = 0; i < n; ++i)
+                    if (ov.errors[i] > 0) ctx.fillRect(i * cw, 0, Math.max(1, cw), 4)
+            }
+
+            Label {
+                visible: minimap.ov && minimap.ov.hasSignal
+                anchors.right: parent.right
+                anchors.top:   parent.top
+                anchors.margins: 3
+                text: minimap.ov ? minimap.ov.signal : ""
+                color: tracePage.clrTextMuted
+                font.pixelSize: 9
+            }
+
+            Rectangle {
+                anchors.bottom: parent.bottom
+                width: parent.width; height: 1
+                color: tracePage.clrBorder
+            }
+
+            MouseArea {
+                anchors.fill: parent
+                cursorShape: Qt.PointingHandCursor
+                onClicked: function(mouse) {
+                    const t = minimap.timeAt(mouse.x)
+                    if (t < 0) return
+                    const idx = AppController.traceIndexAtTime(t)
+                    if (idx.valid)
+                        traceView.positionViewAtRow(traceView.rowAtIndex(idx),
+                                                    TableView.AlignVCenter)
+                }
+                onDoubleClicked: {
+                    minimap.viewFrom = -1
+                    minimap.viewTo   = -1
+                    minimap.refresh()
+                }
+                onWheel: function(wheel) {
+                    if (!minimap.ov) return
+                    const t     = minimap.timeAt(wheel.x)
+                    const scale = wheel.angleDelta.y > 0 ? 0.8 : 1.25
+                    const from  = Math.max(minimap.ov.firstSec, t - (t - minimap.ov.fromSec) * scale)
+                    const to    = Math.min(minimap.ov.endSec,   t + (minimap.ov.toSec - t) * scale)
+                    if (to - from < 0.5) return
+                    minimap.viewFrom = from
+                    minimap.viewTo   = to
+                    minimap.refresh()
+                }
+            }
+        }
+
         // Column headers (HorizontalHeaderView synced to TreeView)
         HorizontalHeaderView {
             id: headerView
-            anchors.top:   parent.top
+            anchors.top:   minimap.bottom
             anchors.left:  parent.left
             anchors.right: parent.right
             height: tracePage.headerH
@@ -690,6 +850,9 @@ Page {
 
             model: AppController.traceProxy
 
+            // Counted for AppController.traceViewStats() (data() calls per step).
+            onContentYChanged: AppController.traceModel.noteScrollStep()
+
             // ── Column widths ─────────────────────────────────────────────────
             columnWidthProvider: function(col) {
                 var w = tracePage.colWidths
@@ -729,21 +892,21 @@ Page {
                 required property int  row
                 required property int  column
 
-                // ── Model data (via implicit model context) ──────────────────
-                // model.display  = Qt::DisplayRole text for this (row, col)
-                // model.isFrame  = custom IsFrameRole (false for signal rows)
-                // model.channel  = custom ChannelRole (1 or 2)
-                // model.isError  = custom IsErrorRole
-                // model.isFD     = custom IsFDRole
-                // model.isDecoded= custom IsDecodedRole
+                // ── Model data (one RowRole call per cell) ───────────────────
+                // model.rowData = TraceRow snapshot of the whole row: every
+                // column's text plus isFrame / isError / isFD / isDecoded /
+                // isTx / channel.  Reading the roles one by one would cost
+                // a data() call and a QVariant each; the snapshot is built
+                // once per row and cached by TraceModel.
+                readonly property var rowData: model.rowData
 
                 // ── Derived state ────────────────────────────────────────────
                 readonly property bool isSignalRow: depth > 0
-                readonly property int  channelNum:  model.channel  ?? 1
-                readonly property bool isError:     model.isError  ?? false
-                readonly property bool isFD:        model.isFD     ?? false
-                readonly property bool isDecoded:   model.isDecoded ?? false
-                readonly property string cellText:  model.display  ?? ""
+                readonly property int  channelNum:  rowData ? (rowData.channel || 1) : 1
+                readonly property bool isError:     rowData ? rowData.isError   : false
+                readonly property bool isFD:        rowData ? rowData.isFD      : false
+                readonly property bool isDecoded:   rowData ? rowData.isDecoded : false
+                readonly property string cellText:  rowData ? rowData.cell(column) : ""
 
                 // ── Row background + cell borders (combined into 1 Rectangle) ──
                 // Merges the old 3-Rectangle pattern (bg + bottom sep + right sep)
@@ -879,7 +1042,7 @@ Page {
                         if (isError) return tracePage.clrError
 
                         // TX echoes: muted
-                        if (model.display === "Tx" && column === 5)
+                        if (cellDelegate.cellText === "Tx" && column === 5)
                             return tracePage.clrFD
 
                         switch (column) {
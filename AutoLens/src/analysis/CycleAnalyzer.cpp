@@ -0,0 +1,116 @@
+/**
+ * @file CycleAnalyzer.cpp
+ * @brief Partitioning and the per-partition cycle/jitter pass.
+ */
+
+#include "analysis/CycleAnalyzer.h"
+
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace CANManager;
+using namespace DBCManager;
+
+void CycleAnalyzer::clear()
+{
+    m_partitions.clear();
+    m_index.clear();
+}
+
+void CycleAnalyzer::add(const CANMessage& msg)
+{
+    if (msg.isError)
+        return;
+
+    const quint64 key = quint64(msg.id) | (quint64(msg.channel) << 32)
+                      | (msg.isExtended ? (1ull << 40) : 0);
+    auto it = m_index.constFind(key);
+    if (it == m_index.constEnd()) {
+        Partition p;
+        p.channel  = msg.channel;
+        p.id       = msg.id;
+        p.extended = msg.isExtended;
+        m_partitions.append(std::move(p));
+        it = m_index.insert(key, m_partitions.size() - 1);
+    }
+    m_partitions[it.value()].timestamps.append(msg.timestamp);
+}
+
+QVector<CycleAnalyzer::Result> CycleAnalyzer::run(const DBCDatabase* db, double gapFactor) const
+{
+    gapFactor = std::max(1.0, gapFactor);
+    return QtConcurrent::blockingMapped<QVector<Result>>(
+        m_partitions, [db, gapFactor](const Partition& p) { return analyse(p, db, gapFactor); });
+}
+
+CycleAnalyzer::Result CycleAnalyzer::analyse(const Partition& p, const DBCDatabase* db,
+                                             double gapFactor)
+{
+    Result r;
+    r.channel  = p.channel;
+    r.id       = p.id;
+    r.extended = p.extended;
+    r.frames   = quint64(p.timestamps.size());
+    r.ratioHistogram.fill(0, RATIO_BINS);
+
+    const DBCMessage* msg = db ? db->messageById(p.id) : nullptr;
+    if (msg) {
+        r.name = msg->name;
+        if (msg->cycleTimeMs > 0) {
+            r.nominalMs      = msg->cycleTimeMs;
+            r.nominalFromDbc = true;
+        }
+    }
+
+    // Imported logs from several sources are not always in order.
+    QVector<quint64> ts = p.timestamps;
+    if (!std::is_sorted(ts.begin(), ts.end()))
+        std::sort(ts.begin(), ts.end());
+    if (ts.size() < 2)
+        return r;
+
+    if (!r.nominalFromDbc) {
+        QVector<quint64> intervals;
+        intervals.reserve(ts.size() - 1);
+        for (int i = 1; i < ts.size(); ++i)
+            intervals.append(ts[i] - ts[i - 1]);
+        auto mid = intervals.begin() + intervals.size() / 2;
+        std::nth_element(intervals.begin(), mid, intervals.end());
+        r.nominalMs = double(*mid) / 1e6;
+    }
+
+    const double nominalNs = r.nominalMs * 1e6;
+    const double gapNs     = gapFactor * nominalNs;
+
+    // Welford: one pass, numerically stable for millions of intervals.
+    double  mean = 0.0, m2 = 0.0;
+    quint64 minNs = ~quint64(0), maxNs = 0;
+    for (int i = 1; i < ts.size(); ++i) {
+        const quint64 dt = ts[i] - ts[i - 1];
+        const double  x  = double(dt);
+        const double  delta = x - mean;
+        mean += delta / double(i);
+        m2   += delta * (x - mean);
+        minNs = std::min(minNs, dt);
+        maxNs = std::max(maxNs, dt);
+
+        if (nominalNs > 0) {
+            const int bin = std::min(RATIO_BINS - 1, int(x / nominalNs * 10.0));
+            ++r.ratioHistogram[bin];
+            if (x > gapNs) {
+                ++r.gapCount;
+                if (r.gaps.size() < MAX_GAPS_PER_ID)
+                    r.gaps.append({ ts[i], dt });
+            }
+        }
+    }
+
+    const int n = ts.size() - 1;
+    r.meanMs   = mean / 1e6;
+    r.jitterMs = (n > 1 ? std::sqrt(m2 / double(n - 1)) : 0.0) / 1e6;
+    r.minMs    = double(minNs) / 1e6;
+    r.maxMs    = double(maxNs) / 1e6;
+    return r;
+}
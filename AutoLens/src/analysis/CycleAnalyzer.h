@@ -0,0 +1,102 @@
+#pragma once
+/**
+ * @file CycleAnalyzer.h
+ * @brief Offline cycle-gap and jitter report per (channel, ID).
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  After a drive the question is "which messages went missing, and how
+ *  steady was everything else?": every inter-arrival time above N × the
+ *  nominal cycle, plus the spread of the intervals per ID.  That used to
+ *  be a script over a CSV export.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  HOW
+ * ═══════════════════════════════════════════════════════════════════════════
+ *    add()  one pass over the frames (trace store or TraceImporter output)
+ *           → per-(channel, id, ext) partition of timestamps, 8 bytes/frame
+ *    run()  partitions are independent: QtConcurrent::blockingMapped
+ *           spreads them over the global thread pool, each worker streams
+ *           its partition once (Welford mean/variance, ratio histogram,
+ *           gap list) — no shared state, no locks.
+ *
+ *  Nominal cycle: the DBC GenMsgCycleTime when the message has one,
+ *  otherwise the median interval of the partition.  Event-driven messages
+ *  therefore still get a jitter figure; their "gaps" are only meaningful
+ *  when they really are periodic.
+ *
+ *  The jitter distribution is a histogram of interval / nominal in
+ *  RATIO_BINS steps of 0.1 (the last bin collects ≥ 2.0).
+ *
+ *  run() blocks; AppController calls it from a one-shot worker thread.
+ */
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <cstdint>
+
+#include "hardware/CANInterface.h"
+#include "dbc/DBCParser.h"
+
+class CycleAnalyzer
+{
+public:
+    static constexpr int RATIO_BINS      = 21;     ///< [0, 0.1) … [1.9, 2.0), ≥ 2.0
+    static constexpr int MAX_GAPS_PER_ID = 1000;   ///< listed; all are counted
+
+    /** One late frame: it arrived @c gapNs after the previous one. */
+    struct Gap
+    {
+        quint64 timestampNs = 0;
+        quint64 gapNs       = 0;
+    };
+
+    struct Result
+    {
+        uint8_t  channel  = 0;
+        uint32_t id       = 0;
+        bool     extended = false;
+        QString  name;                   ///< DBC message name, if known
+        quint64  frames   = 0;
+        double   nominalMs = 0.0;
+        bool     nominalFromDbc = false;
+        double   meanMs   = 0.0;
+        double   jitterMs = 0.0;         ///< standard deviation of the interval
+        double   minMs    = 0.0;
+        double   maxMs    = 0.0;
+        quint64  gapCount = 0;
+        QVector<Gap>     gaps;           ///< first MAX_GAPS_PER_ID, in time order
+        QVector<quint32> ratioHistogram; ///< RATIO_BINS counts
+    };
+
+    /** Drop all partitions. */
+    void clear();
+
+    /** Partition one frame (error frames are ignored). */
+    void add(const CANManager::CANMessage& msg);
+
+    int  partitionCount() const { return m_partitions.size(); }
+
+    /**
+     * @brief Analyse every partition in parallel.
+     * @param db         Nominal cycles and names (may be null).
+     * @param gapFactor  Interval > gapFactor × nominal counts as a gap.
+     */
+    QVector<Result> run(const DBCManager::DBCDatabase* db, double gapFactor) const;
+
+private:
+    struct Partition
+    {
+        uint8_t  channel  = 0;
+        uint32_t id       = 0;
+        bool     extended = false;
+        QVector<quint64> timestamps;
+    };
+
+    static Result analyse(const Partition& p, const DBCManager::DBCDatabase* db, double gapFactor);
+
+    QVector<Partition>   m_partitions;
+    QHash<quint64, int>  m_index;   ///< (channel, id, ext) → m_partitions slot
+};
@@ -0,0 +1,153 @@
+/**
+ * @file CycleReportModel.cpp
+ * @brief Formatting and sorting of the cycle/jitter report.
+ */
+
+#include "analysis/CycleReportModel.h"
+
+#include <algorithm>
+
+CycleReportModel::CycleReportModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void CycleReportModel::setResults(QVector<CycleAnalyzer::Result> results, double gapFactor)
+{
+    beginResetModel();
+    m_rows      = std::move(results);
+    m_gapFactor = gapFactor;
+    endResetModel();
+    sortByColumn(ColGaps, false);
+    emit countChanged();
+}
+
+int CycleReportModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int CycleReportModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColCount;
+}
+
+QVariant CycleReportModel::sortValue(const CycleAnalyzer::Result& r, int column) const
+{
+    switch (column) {
+    case ColChn:     return r.channel;
+    case ColID:      return (quint64(r.extended) << 32) | r.id;
+    case ColName:    return r.name;
+    case ColFrames:  return r.frames;
+    case ColNominal: return r.nominalMs;
+    case ColMean:    return r.meanMs;
+    case ColJitter:  return r.jitterMs;
+    case ColMax:     return r.maxMs;
+    case ColGaps:    return r.gapCount;
+    default:         return {};
+    }
+}
+
+QVariant CycleReportModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size())
+        return {};
+    const CycleAnalyzer::Result& r = m_rows[index.row()];
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case ColChn:     return QString::number(r.channel);
+        case ColID:      return QString::number(r.id, 16).toUpper().rightJustified(r.extended ? 8 : 3, QChar('0'))
+                                + (r.extended ? QStringLiteral("x") : QStringLiteral("h"));
+        case ColName:    return r.name;
+        case ColFrames:  return QString::number(r.frames);
+        case ColNominal: return r.nominalMs > 0 ? QString::number(r.nominalMs, 'f', 1) : QString();
+        case ColMean:    return QString::number(r.meanMs,   'f', 3);
+        case ColJitter:  return QString::number(r.jitterMs, 'f', 3);
+        case ColMax:     return QString::number(r.maxMs,    'f', 3);
+        case ColGaps:    return QString::number(r.gapCount);
+        default:         return {};
+        }
+    case SortRole:           return sortValue(r, index.column());
+    case HasGapsRole:        return r.gapCount > 0;
+    case NominalFromDbcRole: return r.nominalFromDbc;
+    default:                 return {};
+    }
+}
+
+QVariant CycleReportModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Vertical || role != Qt::DisplayRole)
+        return {};
+
+    switch (section) {
+    case ColChn:     return QStringLiteral("Chn");
+    case ColID:      return QStringLiteral("ID");
+    case ColName:    return QStringLiteral("Name");
+    case ColFrames:  return QStringLiteral("Frames");
+    case ColNominal: return QStringLiteral("Cycle (ms)");
+    case ColMean:    return QStringLiteral("Mean (ms)");
+    case ColJitter:  return QStringLiteral("Jitter σ (ms)");
+    case ColMax:     return QStringLiteral("Max (ms)");
+    case ColGaps:    return QStringLiteral("Gaps > %1×").arg(m_gapFactor);
+    default:         return {};
+    }
+}
+
+QHash<int, QByteArray> CycleReportModel::roleNames() const
+{
+    return {
+        { Qt::DisplayRole,    "display"        },
+        { SortRole,           "sortValue"      },
+        { HasGapsRole,        "hasGaps"        },
+        { NominalFromDbcRole, "nominalFromDbc" },
+    };
+}
+
+void CycleReportModel::sortByColumn(int column, bool ascending)
+{
+    if (column < 0 || column >= ColCount)
+        return;
+
+    emit layoutAboutToBeChanged();
+    std::stable_sort(m_rows.begin(), m_rows.end(),
+                     [this, column, ascending](const CycleAnalyzer::Result& a,
+                                               const CycleAnalyzer::Result& b) {
+                         const QVariant va = sortValue(a, column);
+                         const QVariant vb = sortValue(b, column);
+                         const auto order  = QVariant::compare(va, vb);
+                         return ascending ? order == QPartialOrdering::Less
+                                          : order == QPartialOrdering::Greater;
+                     });
+    emit layoutChanged();
+}
+
+QVariantList CycleReportModel::gaps(int row) const
+{
+    QVariantList list;
+    if (row < 0 || row >= m_rows.size())
+        return list;
+
+    const CycleAnalyzer::Result& r = m_rows[row];
+    list.reserve(r.gaps.size());
+    for (const CycleAnalyzer::Gap& g : r.gaps) {
+        list.append(QVariantMap{
+            { "timeSec", double(g.timestampNs) / 1e9 },
+            { "gapMs",   double(g.gapNs) / 1e6       },
+            { "channel", r.channel                   },
+            { "id",      r.id                        },
+        });
+    }
+    return list;
+}
+
+QVariantList CycleReportModel::jitterHistogram(int row) const
+{
+    QVariantList list;
+    if (row < 0 || row >= m_rows.size())
+        return list;
+    for (quint32 n : m_rows[row].ratioHistogram)
+        list.append(n);
+    return list;
+}
@@ -0,0 +1,73 @@
+#pragma once
+/**
+ * @file CycleReportModel.h
+ * @brief Table model over CycleAnalyzer results (one row per channel/ID).
+ *
+ * Sorted in place by sortByColumn() — the report is a few hundred rows at
+ * most, so a proxy model would only add indirection.  gaps() hands QML
+ * the late frames of one row so it can jump to them in the trace.
+ */
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+#include "analysis/CycleAnalyzer.h"
+
+class CycleReportModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int    count     READ rowCount   NOTIFY countChanged)
+    Q_PROPERTY(double gapFactor READ gapFactor  NOTIFY countChanged)
+
+public:
+    enum Column {
+        ColChn = 0,
+        ColID,
+        ColName,
+        ColFrames,
+        ColNominal,
+        ColMean,
+        ColJitter,
+        ColMax,
+        ColGaps,
+        ColCount
+    };
+
+    enum Roles {
+        SortRole = Qt::UserRole + 1,   ///< numeric value of the cell
+        HasGapsRole,                   ///< bool: row has at least one gap
+        NominalFromDbcRole             ///< bool: nominal cycle from GenMsgCycleTime
+    };
+
+    explicit CycleReportModel(QObject* parent = nullptr);
+
+    void setResults(QVector<CycleAnalyzer::Result> results, double gapFactor);
+    void clear() { setResults({}, m_gapFactor); }
+    double gapFactor() const { return m_gapFactor; }
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /** Re-order the rows; the default column order is most gaps first. */
+    Q_INVOKABLE void sortByColumn(int column, bool ascending);
+
+    /** Late frames of @p row: [{ "timeSec", "gapMs", "channel", "id" }, …] */
+    Q_INVOKABLE QVariantList gaps(int row) const;
+
+    /** Interval / nominal histogram of @p row (CycleAnalyzer::RATIO_BINS counts). */
+    Q_INVOKABLE QVariantList jitterHistogram(int row) const;
+
+signals:
+    void countChanged();
+
+private:
+    QVariant sortValue(const CycleAnalyzer::Result& r, int column) const;
+
+    QVector<CycleAnalyzer::Result> m_rows;
+    double m_gapFactor = 2.0;
+};
@@ -0,0 +1,402 @@
+/**
+ * @file LatencyAnalyzer.cpp
+ * @brief Pair parsing and the streaming request/response matcher.
+ */
+
+#include "analysis/LatencyAnalyzer.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace CANManager;
+using namespace DBCManager;
+
+namespace {
+
+int binOf(quint64 latencyNs)
+{
+    const double us = double(latencyNs) / 1000.0;
+    if (us < 1.0)
+        return 0;
+    const int bin = int(std::log2(us) * LatencyAnalyzer::BINS_PER_OCTAVE);
+    return std::min(bin, LatencyAnalyzer::HIST_BINS - 1);
+}
+
+/** "02 01 0D" / "?? 41" → bytes + mask.  Returns false on a bad token. */
+bool parsePattern(const QString& text, QVector<uint8_t>& bytes, QVector<uint8_t>& mask)
+{
+    const QStringList tokens = text.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    for (const QString& t : tokens) {
+        if (t == QStringLiteral("??") || t == QStringLiteral("xx") || t == QStringLiteral("XX")) {
+            bytes.append(0);
+            mask.append(0x00);
+            continue;
+        }
+        bool ok = false;
+        const uint v = t.toUInt(&ok, 16);
+        if (!ok || v > 0xFF)
+            return false;
+        bytes.append(uint8_t(v));
+        mask.append(0xFF);
+    }
+    return true;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Configuration
+// ─────────────────────────────────────────────────────────────────────────────
+
+double LatencyAnalyzer::binLowerUs(int bin)
+{
+    return bin <= 0 ? 0.0 : std::exp2(double(bin) / BINS_PER_OCTAVE);
+}
+
+QString LatencyAnalyzer::setPairs(const QString& json, const DBCDatabase& db)
+{
+    QVector<Pair> parsed;
+    if (!json.trimmed().isEmpty()) {
+        const QString error = parsePairs(json, db, parsed);
+        if (!error.isEmpty())
+            return error;
+    }
+
+    m_pairs = std::move(parsed);
+    m_json  = json;
+    rebuildHooks();
+    m_lastNs = 0;
+    qDebug() << "[Latency]" << m_pairs.size() << "pair(s) configured";
+    return {};
+}
+
+void LatencyAnalyzer::rebuildHooks()
+{
+    m_hooks.clear();
+    for (int i = 0; i < m_pairs.size(); ++i) {
+        const Pair& p = m_pairs[i];
+        m_hooks[hookKey(p.request.channel,  p.request.id,  p.request.extended)].append({ i, false });
+        m_hooks[hookKey(p.response.channel, p.response.id, p.response.extended)].append({ i, true });
+    }
+}
+
+QString LatencyAnalyzer::rebindDatabase(const DBCDatabase& db)
+{
+    if (m_json.trimmed().isEmpty())
+        return {};
+
+    QVector<Pair> parsed;
+    const QString error = parsePairs(m_json, db, parsed);
+    if (!error.isEmpty())
+        return error;
+
+    auto unchanged = [&](int i) {
+        return i < m_pairs.size()
+            && parsed[i].request.sameResolution(m_pairs[i].request)
+            && parsed[i].response.sameResolution(m_pairs[i].response);
+    };
+    bool anyChanged = parsed.size() != m_pairs.size();
+    for (int i = 0; i < parsed.size() && !anyChanged; ++i)
+        anyChanged = !unchanged(i);
+    if (!anyChanged)
+        return {};   // the common case: the new DBC does not touch the pairs
+
+    // Carry the statistics of every pair that still means the same thing.
+    for (int i = 0; i < parsed.size(); ++i) {
+        if (!unchanged(i))
+            continue;
+        Pair& now = parsed[i];
+        Pair& was = m_pairs[i];
+        now.pending   = std::move(was.pending);
+        now.requests  = was.requests;
+        now.responses = was.responses;
+        now.timeouts  = was.timeouts;
+        now.unmatched = was.unmatched;
+        now.sumNs     = was.sumNs;
+        now.minNs     = was.minNs;
+        now.maxNs     = was.maxNs;
+        std::copy(std::begin(was.histogram), std::end(was.histogram), std::begin(now.histogram));
+    }
+
+    m_pairs = std::move(parsed);
+    rebuildHooks();
+    qDebug() << "[Latency] Pairs re-resolved against the new DBC";
+    return {};
+}
+
+QString LatencyAnalyzer::parsePairs(const QString& json, const DBCDatabase& db,
+                                    QVector<Pair>& out) const
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+        return QString("JSON error at offset %1: %2").arg(parseError.offset).arg(parseError.errorString());
+
+    const QJsonArray list = doc.isArray() ? doc.array()
+                                          : doc.object().value(QStringLiteral("pairs")).toArray();
+
+    auto parseEndpoint = [&db](const QJsonObject& o, Endpoint& e, QString& error) -> bool {
+        e.channel = o.value(QStringLiteral("channel")).toInt(0);
+        if (e.channel < 0 || e.channel > 15) {
+            error = QStringLiteral("channel must be 0..15");
+            return false;
+        }
+
+        const QJsonValue idValue = o.value(QStringLiteral("id"));
+        const DBCMessage* msg = nullptr;
+        bool ok = false;
+        if (idValue.isDouble()) {
+            e.id = uint32_t(idValue.toDouble());
+            ok = true;
+        } else {
+            const QString text = idValue.toString().trimmed();
+            e.id = text.toUInt(&ok, 0);
+            if (!ok && (msg = db.messageByName(text))) {
+                e.id = msg->id;
+                e.extended = msg->isExtended;
+                ok = true;
+            }
+        }
+        if (!ok) {
+            error = QString("unknown message \"%1\"").arg(idValue.toVariant().toString());
+            return false;
+        }
+        if (!msg) {
+            e.extended = e.id > 0x7FF;
+            msg = db.messageById(e.id);
+        }
+        if (o.contains(QStringLiteral("extended")))
+            e.extended = o.value(QStringLiteral("extended")).toBool();
+
+        if (o.contains(QStringLiteral("data"))
+            && !parsePattern(o.value(QStringLiteral("data")).toString(), e.pattern, e.patternMask)) {
+            error = QStringLiteral("bad data pattern (hex bytes, ?? = any)");
+            return false;
+        }
+
+        const QString sigName = o.value(QStringLiteral("signal")).toString();
+        if (!sigName.isEmpty()) {
+            const DBCSignal* sig = msg ? msg->signal(sigName) : nullptr;
+            if (!sig) {
+                error = QString("signal \"%1\" not found in the DBC").arg(sigName);
+                return false;
+            }
+            e.codec  = SignalCodec(*sig);
+            e.signal = *sig;
+            if (o.contains(QStringLiteral("equals"))) {
+                // Physical values carry the factor's rounding — compare loosely.
+                const double v   = o.value(QStringLiteral("equals")).toDouble();
+                const double eps = std::max(1e-9, std::abs(sig->factor) * 0.5);
+                e.lo = v - eps;
+                e.hi = v + eps;
+            } else {
+                e.lo = o.value(QStringLiteral("min")).toDouble(-HUGE_VAL);
+                e.hi = o.value(QStringLiteral("max")).toDouble(HUGE_VAL);
+            }
+        }
+        return true;
+    };
+
+    for (int i = 0; i < list.size(); ++i) {
+        const QJsonObject o = list[i].toObject();
+        const QString where = QString("Pair %1").arg(i + 1);
+        QString error;
+        Pair p;
+
+        if (!o.contains(QStringLiteral("request")) || !o.contains(QStringLiteral("response")))
+            return where + ": needs \"request\" and \"response\"";
+        if (!parseEndpoint(o.value(QStringLiteral("request")).toObject(), p.request, error))
+            return where + " request: " + error;
+        if (!parseEndpoint(o.value(QStringLiteral("response")).toObject(), p.response, error))
+            return where + " response: " + error;
+
+        const double timeoutMs = o.value(QStringLiteral("timeoutMs")).toDouble(1000.0);
+        if (timeoutMs <= 0)
+            return where + ": timeoutMs must be > 0";
+        p.timeoutNs = quint64(timeoutMs * 1e6);
+
+        p.name = o.value(QStringLiteral("name")).toString();
+        if (p.name.isEmpty()) {
+            p.name = QString("0x%1 → 0x%2")
+                         .arg(QString::number(p.request.id, 16).toUpper())
+                         .arg(QString::number(p.response.id, 16).toUpper());
+        }
+        out.append(std::move(p));
+    }
+    return {};
+}
+
+void LatencyAnalyzer::reset()
+{
+    for (Pair& p : m_pairs) {
+        p.pending.clear();
+        p.requests = p.responses = p.timeouts = p.unmatched = 0;
+        p.sumNs = p.minNs = p.maxNs = 0;
+        std::fill(std::begin(p.histogram), std::end(p.histogram), 0);
+    }
+    m_lastNs = 0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Matching
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool LatencyAnalyzer::Endpoint::sameResolution(const Endpoint& other) const
+{
+    if (channel != other.channel || id != other.id || extended != other.extended
+        || pattern != other.pattern || patternMask != other.patternMask
+        || codec.isValid() != other.codec.isValid())
+        return false;
+    if (!codec.isValid())
+        return true;
+    return lo == other.lo && hi == other.hi
+        && signal.startBit  == other.signal.startBit
+        && signal.bitLength == other.signal.bitLength
+        && signal.byteOrder == other.signal.byteOrder
+        && signal.valueType == other.signal.valueType
+        && signal.factor    == other.signal.factor
+        && signal.offset    == other.signal.offset;
+}
+
+bool LatencyAnalyzer::Endpoint::matches(const CANMessage& msg) const
+{
+    const int len = msg.dataLength();
+    if (!pattern.isEmpty()) {
+        if (len < pattern.size())
+            return false;
+        for (int i = 0; i < pattern.size(); ++i) {
+            if ((msg.data[i] & patternMask[i]) != pattern[i])
+                return false;
+        }
+    }
+    if (codec.isValid()) {
+        const double v = codec.decode(msg.data, len);
+        if (v < lo || v > hi)
+            return false;
+    }
+    return true;
+}
+
+void LatencyAnalyzer::Pair::expire(quint64 nowNs)
+{
+    while (!pending.empty() && pending.front() + timeoutNs < nowNs) {
+        pending.pop_front();
+        ++timeouts;
+    }
+}
+
+void LatencyAnalyzer::Pair::record(quint64 latencyNs)
+{
+    minNs = responses == 0 ? latencyNs : std::min(minNs, latencyNs);
+    maxNs = std::max(maxNs, latencyNs);
+    sumNs += latencyNs;
+    ++responses;
+    ++histogram[binOf(latencyNs)];
+}
+
+void LatencyAnalyzer::process(const CANMessage& msg)
+{
+    if (m_hooks.isEmpty() || msg.isError || msg.isRemote)
+        return;
+    m_lastNs = std::max(m_lastNs, quint64(msg.timestamp));
+
+    // Endpoints on this channel and on "any channel".
+    const QVector<Hook>* lists[2] = { nullptr, nullptr };
+    auto it = m_hooks.constFind(hookKey(msg.channel, msg.id, msg.isExtended));
+    if (it != m_hooks.constEnd())
+        lists[0] = &it.value();
+    it = m_hooks.constFind(hookKey(0, msg.id, msg.isExtended));
+    if (it != m_hooks.constEnd())
+        lists[1] = &it.value();
+
+    // Responses before requests: a frame that is both (same ID) closes the
+    // previous exchange before opening the next.
+    for (const bool responsePass : { true, false }) {
+        for (const QVector<Hook>* hooks : lists) {
+            if (!hooks) continue;
+            for (const Hook& h : *hooks) {
+                if (h.response != responsePass) continue;
+                Pair& p = m_pairs[h.pair];
+                const Endpoint& e = h.response ? p.response : p.request;
+                if (!e.matches(msg)) continue;
+
+                p.expire(msg.timestamp);
+                if (h.response) {
+                    if (p.pending.empty()) {
+                        ++p.unmatched;
+                    } else {
+                        p.record(msg.timestamp - p.pending.front());
+                        p.pending.pop_front();
+                    }
+                } else {
+                    ++p.requests;
+                    if (int(p.pending.size()) >= MAX_PENDING) {
+                        p.pending.pop_front();
+                        ++p.timeouts;
+                    }
+                    p.pending.push_back(msg.timestamp);
+                }
+            }
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Statistics
+// ─────────────────────────────────────────────────────────────────────────────
+
+QVector<LatencyAnalyzer::PairStats> LatencyAnalyzer::stats() const
+{
+    QVector<PairStats> out;
+    out.reserve(m_pairs.size());
+
+    for (const Pair& p : m_pairs) {
+        PairStats s;
+        s.name      = p.name;
+        s.timeoutMs = double(p.timeoutNs) / 1e6;
+        s.requests  = p.requests;
+        s.responses = p.responses;
+        s.unmatched = p.unmatched;
+
+        // Requests still pending but already past their deadline are
+        // timeouts too — no later frame of this pair has expired them yet.
+        s.timeouts = p.timeouts;
+        for (quint64 t : p.pending)
+            if (t + p.timeoutNs < m_lastNs) ++s.timeouts;
+
+        s.histogram.resize(HIST_BINS);
+        std::copy(std::begin(p.histogram), std::end(p.histogram), s.histogram.begin());
+
+        if (p.responses > 0) {
+            s.minUs  = double(p.minNs) / 1000.0;
+            s.maxUs  = double(p.maxNs) / 1000.0;
+            s.meanUs = double(p.sumNs) / double(p.responses) / 1000.0;
+
+            // Percentiles at the geometric centre of the bin, clamped to the
+            // exact min/max so a one-sample pair reports its real value.
+            auto percentile = [&](double q) {
+                const quint64 rank = quint64(std::ceil(q * double(p.responses)));
+                quint64 seen = 0;
+                for (int b = 0; b < HIST_BINS; ++b) {
+                    seen += p.histogram[b];
+                    if (seen >= rank) {
+                        const double centre = b == 0 ? 0.5 : binLowerUs(b) * std::exp2(0.5 / BINS_PER_OCTAVE);
+                        return std::clamp(centre, s.minUs, s.maxUs);
+                    }
+                }
+                return s.maxUs;
+            };
+            s.p50Us = percentile(0.50);
+            s.p95Us = percentile(0.95);
+            s.p99Us = percentile(0.99);
+        }
+        out.append(std::move(s));
+    }
+    return out;
+}
@@ -0,0 +1,152 @@
+#pragma once
+/**
+ * @file LatencyAnalyzer.h
+ * @brief Request → response latency between configured message pairs.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  ECU reaction times (0x7DF diagnostic request → 0x7E8 answer, a command
+ *  message → its status echo) used to be measured by hand in exported CSV
+ *  files.  LatencyAnalyzer matches the pairs in one streaming pass over the
+ *  frames — live, from an imported log, or replayed from the trace — and
+ *  keeps a latency histogram plus timeout count per pair.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  PAIRS (JSON, persisted as "Latency/pairs")
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    { "pairs": [
+ *      { "name": "OBD vehicle speed",
+ *        "request":  { "channel": 1, "id": "0x7DF", "data": "02 01 0D" },
+ *        "response": { "channel": 1, "id": "0x7E8", "data": "?? 41 0D" },
+ *        "timeoutMs": 50 },
+ *      { "request":  { "id": "BodyCmd",    "signal": "DoorLockReq", "equals": 1 },
+ *        "response": { "id": "BodyStatus", "signal": "DoorLocked",  "min": 0.5 },
+ *        "timeoutMs": 200 }
+ *    ] }
+ *
+ *  id        number, "0x…" or a DBC message name; channel 0/omitted = any.
+ *  data      hex byte prefix the payload must start with, "??" = any byte.
+ *  signal    DBC signal of that message, with "equals" or "min"/"max".
+ *
+ *  Every matching request opens a pending slot; a matching response closes
+ *  the oldest one still inside timeoutMs (so pipelined requests are paired
+ *  in order).  Slots older than timeoutMs count as timeouts, responses
+ *  with nothing pending as unmatched.  Frames must arrive in timestamp
+ *  order.
+ *
+ *  Not thread-safe: AppController feeds and queries it on the UI thread.
+ */
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <cstdint>
+#include <deque>
+
+#include "hardware/CANInterface.h"
+#include "dbc/DBCParser.h"
+#include "dbc/SignalCodec.h"
+
+class LatencyAnalyzer
+{
+public:
+    static constexpr int BINS_PER_OCTAVE = 4;
+    static constexpr int HIST_BINS       = 24 * BINS_PER_OCTAVE;   ///< 1 µs … ~16.7 s
+    static constexpr int MAX_PENDING     = 256;                    ///< per pair; overflow = timeout
+
+    struct PairStats
+    {
+        QString name;
+        double  timeoutMs = 0.0;
+        quint64 requests  = 0;
+        quint64 responses = 0;   ///< matched
+        quint64 timeouts  = 0;
+        quint64 unmatched = 0;   ///< responses with no request pending
+        double  minUs = 0.0, maxUs = 0.0, meanUs = 0.0;
+        double  p50Us = 0.0, p95Us = 0.0, p99Us = 0.0;
+        QVector<quint64> histogram;   ///< HIST_BINS counts, see binLowerUs()
+    };
+
+    /** Lower edge of histogram bin @p bin in microseconds. */
+    static double binLowerUs(int bin);
+
+    /**
+     * @brief Parse @p json, resolving message/signal names in @p db.
+     * @return Empty string on success, otherwise the first error (the
+     *         previous pairs and their statistics stay active).
+     */
+    QString setPairs(const QString& json, const DBCManager::DBCDatabase& db);
+    QString pairs() const { return m_json; }
+
+    /**
+     * @brief Re-resolve the current pairs against a new @p db (DBC load or
+     *        merge).  Pairs that resolve to the same endpoints keep their
+     *        statistics and pending requests; only changed pairs start over.
+     * @return Empty string on success, otherwise the first error (nothing
+     *         changes then).
+     */
+    QString rebindDatabase(const DBCManager::DBCDatabase& db);
+    int     pairCount() const { return m_pairs.size(); }
+
+    /** Zero all statistics and pending requests; the pairs stay. */
+    void reset();
+
+    /** Feed one frame (timestamp order). */
+    void process(const CANManager::CANMessage& msg);
+
+    QVector<PairStats> stats() const;
+
+private:
+    struct Endpoint
+    {
+        int      channel  = 0;          ///< 0 = any
+        uint32_t id       = 0;
+        bool     extended = false;
+        QVector<uint8_t> pattern;       ///< payload prefix ...
+        QVector<uint8_t> patternMask;   ///< ... 0x00 where "??"
+        DBCManager::SignalCodec codec;  ///< valid → signal condition
+        DBCManager::DBCSignal   signal; ///< what codec was built from (rebindDatabase())
+        double   lo = 0.0, hi = 0.0;
+
+        bool matches(const CANManager::CANMessage& msg) const;
+        bool sameResolution(const Endpoint& other) const;
+    };
+
+    struct Pair
+    {
+        QString  name;
+        Endpoint request;
+        Endpoint response;
+        quint64  timeoutNs = 0;
+
+        std::deque<quint64> pending;    ///< request timestamps, oldest first
+        quint64 requests = 0, responses = 0, timeouts = 0, unmatched = 0;
+        quint64 sumNs = 0, minNs = 0, maxNs = 0;
+        quint64 histogram[HIST_BINS] = {};
+
+        void expire(quint64 nowNs);
+        void record(quint64 latencyNs);
+    };
+
+    struct Hook
+    {
+        int  pair;
+        bool response;
+    };
+
+    static quint64 hookKey(int channel, uint32_t id, bool extended)
+    {
+        return quint64(id) | (quint64(channel) << 32) | (extended ? (1ull << 40) : 0);
+    }
+
+    QString parsePairs(const QString& json, const DBCManager::DBCDatabase& db,
+                       QVector<Pair>& out) const;
+    void    rebuildHooks();
+
+    QVector<Pair>               m_pairs;
+    QHash<quint64, QVector<Hook>> m_hooks;   ///< (channel, id, ext) → endpoints
+    QString                     m_json;
+    quint64                     m_lastNs = 0;
+};
@@ -0,0 +1,234 @@
+/**
+ * @file TraceDiff.cpp
+ * @brief Partitioning, streaming alignment and per-signal comparison.
+ */
+
+#include "analysis/TraceDiff.h"
+
+#include <QHash>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "dbc/SignalCodec.h"
+
+using namespace CANManager;
+using namespace DBCManager;
+
+namespace {
+
+inline quint64 keyOf(const CANMessage& m)
+{
+    return quint64(m.id) | (quint64(m.channel) << 32) | (m.isExtended ? (1ull << 40) : 0);
+}
+
+/** One key's frames in both captures (indices into the capture vectors). */
+struct Job
+{
+    quint64      key = 0;
+    QVector<int> base;
+    QVector<int> cand;
+};
+
+struct CompiledSignal
+{
+    SignalCodec codec;
+    int         muxValue  = -1;     ///< ≥ 0: only when the selector has this value
+    double      tolerance = 0.0;    ///< half a raw step — below that is rounding
+};
+
+double meanCycleMs(const QVector<CANMessage>& frames, const QVector<int>& idx)
+{
+    if (idx.size() < 2)
+        return 0.0;
+    return double(frames[idx.last()].timestamp - frames[idx.first()].timestamp)
+           / double(idx.size() - 1) / 1e6;
+}
+
+} // namespace
+
+bool TraceDiff::MessageDiff::differs(double cycleTolerance) const
+{
+    if (status != Status::Common || onlyBase || onlyCand || payloadDiffs)
+        return true;
+    if (baseCycleMs > 0 && std::abs(candCycleMs - baseCycleMs) > cycleTolerance * baseCycleMs)
+        return true;
+    for (const SignalDiff& s : signalDiffs)
+        if (s.differing) return true;
+    return false;
+}
+
+QVector<TraceDiff::MessageDiff> TraceDiff::compare(const QVector<CANMessage>& baseline,
+                                                   const QVector<CANMessage>& candidate,
+                                                   const DBCDatabase* db, Align align)
+{
+    // ── Partition both captures by key ──────────────────────────────────────
+    QHash<quint64, int> slot;
+    QVector<Job> jobs;
+    auto partition = [&](const QVector<CANMessage>& frames, bool isBase) {
+        for (int i = 0; i < frames.size(); ++i) {
+            if (frames[i].isError) continue;
+            const quint64 key = keyOf(frames[i]);
+            auto it = slot.constFind(key);
+            if (it == slot.constEnd()) {
+                jobs.append(Job{ key, {}, {} });
+                it = slot.insert(key, jobs.size() - 1);
+            }
+            (isBase ? jobs[it.value()].base : jobs[it.value()].cand).append(i);
+        }
+    };
+    partition(baseline, true);
+    partition(candidate, false);
+
+    const quint64 baseStart = baseline.isEmpty()  ? 0 : baseline.first().timestamp;
+    const quint64 candStart = candidate.isEmpty() ? 0 : candidate.first().timestamp;
+
+    // ── Compare every key on the thread pool ────────────────────────────────
+    auto compareOne = [&](const Job& job) -> MessageDiff {
+        MessageDiff d;
+        const CANMessage& sample = job.base.isEmpty() ? candidate[job.cand.first()]
+                                                      : baseline[job.base.first()];
+        d.channel    = sample.channel;
+        d.id         = sample.id;
+        d.extended   = sample.isExtended;
+        d.baseFrames = quint64(job.base.size());
+        d.candFrames = quint64(job.cand.size());
+        d.baseCycleMs = meanCycleMs(baseline,  job.base);
+        d.candCycleMs = meanCycleMs(candidate, job.cand);
+        d.status = job.base.isEmpty() ? Status::OnlyInCandidate
+                 : job.cand.isEmpty() ? Status::OnlyInBaseline
+                                      : Status::Common;
+
+        // Signals of this message, precompiled once per key.
+        QVector<CompiledSignal> sigs;
+        SignalCodec muxSelector;
+        if (const DBCMessage* msg = db ? db->messageById(d.id) : nullptr) {
+            d.name = msg->name;
+            for (const DBCSignal& s : msg->signalList) {
+                if (s.muxIndicator == QStringLiteral("M"))
+                    muxSelector = SignalCodec(s);
+                sigs.append({ SignalCodec(s), s.muxIndicator.startsWith(QLatin1Char('m')) ? s.muxValue : -1,
+                              std::abs(s.factor) * 0.5 });
+                d.signalDiffs.append({ s.name, s.unit, 0, 0, 0.0 });
+            }
+        }
+
+        auto addHit = [&d](Hit&& h) {
+            ++d.hitCount;
+            if (d.hits.size() < MAX_HITS)
+                d.hits.append(std::move(h));
+        };
+
+        auto comparePair = [&](const CANMessage& a, const CANMessage& b) {
+            ++d.aligned;
+            const int lenA = a.dataLength(), lenB = b.dataLength();
+
+            if (sigs.isEmpty()) {
+                if (lenA != lenB || std::memcmp(a.data, b.data, size_t(lenA)) != 0) {
+                    ++d.payloadDiffs;
+                    Hit h;
+                    h.kind   = Hit::Payload;
+                    h.baseNs = qint64(a.timestamp - baseStart);
+                    h.candNs = qint64(b.timestamp - candStart);
+                    h.base   = a;
+                    h.cand   = b;
+                    addHit(std::move(h));
+                }
+                return;
+            }
+
+            if (lenA != lenB || std::memcmp(a.data, b.data, size_t(lenA)) != 0)
+                ++d.payloadDiffs;
+
+            const double selA = muxSelector.isValid() ? muxSelector.decode(a.data, lenA) : 0.0;
+            const double selB = muxSelector.isValid() ? muxSelector.decode(b.data, lenB) : 0.0;
+            for (int s = 0; s < sigs.size(); ++s) {
+                const CompiledSignal& cs = sigs[s];
+                if (cs.muxValue >= 0 && (selA != cs.muxValue || selB != cs.muxValue))
+                    continue;
+                const double va = cs.codec.decode(a.data, lenA);
+                const double vb = cs.codec.decode(b.data, lenB);
+                SignalDiff& sd = d.signalDiffs[s];
+                ++sd.compared;
+                const double diff = std::abs(va - vb);
+                if (diff <= cs.tolerance)
+                    continue;
+                ++sd.differing;
+                sd.maxAbsDiff = std::max(sd.maxAbsDiff, diff);
+
+                Hit h;
+                h.kind      = Hit::Signal;
+                h.signal    = s;
+                h.baseNs    = qint64(a.timestamp - baseStart);
+                h.candNs    = qint64(b.timestamp - candStart);
+                h.baseValue = va;
+                h.candValue = vb;
+                h.base      = a;
+                h.cand      = b;
+                addHit(std::move(h));
+            }
+        };
+
+        auto onlyBase = [&](const CANMessage& a) {
+            ++d.onlyBase;
+            Hit h;
+            h.kind   = Hit::OnlyInBaseline;
+            h.baseNs = qint64(a.timestamp - baseStart);
+            h.base   = a;
+            addHit(std::move(h));
+        };
+        auto onlyCand = [&](const CANMessage& b) {
+            ++d.onlyCand;
+            Hit h;
+            h.kind   = Hit::OnlyInCandidate;
+            h.candNs = qint64(b.timestamp - candStart);
+            h.cand   = b;
+            addHit(std::move(h));
+        };
+
+        if (d.status != Status::Common)
+            return d;   // counts and cycle are the whole story
+
+        // ── Streaming merge of the two frame lists ──────────────────────────
+        int i = 0, j = 0;
+        const int nA = job.base.size(), nB = job.cand.size();
+        if (align == Align::BySequence) {
+            for (; i < nA && j < nB; ++i, ++j)
+                comparePair(baseline[job.base[i]], candidate[job.cand[j]]);
+        } else {
+            // Half the nominal cycle, at least 1 ms for event-driven traffic.
+            const double cycleNs = std::max(d.baseCycleMs, d.candCycleMs) * 1e6;
+            const qint64 tolNs   = std::max<qint64>(1000000, qint64(cycleNs / 2));
+            while (i < nA && j < nB) {
+                const CANMessage& a = baseline[job.base[i]];
+                const CANMessage& b = candidate[job.cand[j]];
+                const qint64 ra = qint64(a.timestamp - baseStart);
+                const qint64 rb = qint64(b.timestamp - candStart);
+                if (std::abs(ra - rb) <= tolNs) {
+                    comparePair(a, b);
+                    ++i; ++j;
+                } else if (ra < rb) {
+                    onlyBase(a);
+                    ++i;
+                } else {
+                    onlyCand(b);
+                    ++j;
+                }
+            }
+        }
+        for (; i < nA; ++i) onlyBase(baseline[job.base[i]]);
+        for (; j < nB; ++j) onlyCand(candidate[job.cand[j]]);
+        return d;
+    };
+
+    QVector<MessageDiff> out = QtConcurrent::blockingMapped<QVector<MessageDiff>>(jobs, compareOne);
+
+    std::sort(out.begin(), out.end(), [](const MessageDiff& a, const MessageDiff& b) {
+        return a.channel != b.channel ? a.channel < b.channel
+             : a.extended != b.extended ? !a.extended
+             : a.id < b.id;
+    });
+    return out;
+}
@@ -0,0 +1,104 @@
+#pragma once
+/**
+ * @file TraceDiff.h
+ * @brief Compare a baseline capture with a candidate, per message and signal.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  ECU regression tests record the same drive cycle against the old and the
+ *  new software.  The questions are always the same: which IDs disappeared
+ *  or appeared, whose cycle time moved, and where do signal values start to
+ *  diverge.  Eyeballing two ASC files does not scale past a handful of IDs.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  HOW
+ * ═══════════════════════════════════════════════════════════════════════════
+ *    1. Both logs are read with TraceImporter and partitioned by
+ *       (channel, id, ext) — frame indices only, the frames stay put.
+ *    2. Each key is independent, so QtConcurrent::blockingMapped compares
+ *       them in parallel.  Per key, the two frame lists are aligned by a
+ *       streaming two-pointer merge:
+ *         ByTime      times relative to each capture's first frame; frames
+ *                     within half a nominal cycle are a pair, the earlier
+ *                     of two non-matching frames is "only in A/B"
+ *         BySequence  n-th frame against n-th frame
+ *    3. Every aligned pair is decoded with precompiled SignalCodecs (mux
+ *       branches respected) and compared; without a DBC the raw payload is.
+ *
+ *  Differences are counted exhaustively but listed (hits) only up to
+ *  MAX_HITS per message — enough to drive the side-by-side view.
+ *
+ *  compare() blocks; AppController runs it on a one-shot worker thread.
+ */
+
+#include <QString>
+#include <QVector>
+#include <cstdint>
+
+#include "hardware/CANInterface.h"
+#include "dbc/DBCParser.h"
+
+class TraceDiff
+{
+public:
+    static constexpr int MAX_HITS = 1000;   ///< listed per message; all are counted
+
+    enum class Align { ByTime, BySequence };
+
+    enum class Status { Common, OnlyInBaseline, OnlyInCandidate };
+
+    /** One listed difference.  Times are relative to each capture's start. */
+    struct Hit
+    {
+        enum Kind : uint8_t { Signal, Payload, OnlyInBaseline, OnlyInCandidate };
+
+        Kind    kind     = Signal;
+        int     signal   = -1;      ///< index into MessageDiff::signalDiffs (Kind::Signal)
+        qint64  baseNs   = -1;      ///< -1 = no baseline frame
+        qint64  candNs   = -1;      ///< -1 = no candidate frame
+        double  baseValue = 0.0;
+        double  candValue = 0.0;
+        CANManager::CANMessage base;   ///< raw frames for the side-by-side view
+        CANManager::CANMessage cand;
+    };
+
+    struct SignalDiff
+    {
+        QString name;
+        QString unit;
+        quint64 compared   = 0;
+        quint64 differing  = 0;
+        double  maxAbsDiff = 0.0;
+    };
+
+    struct MessageDiff
+    {
+        uint8_t  channel  = 0;
+        uint32_t id       = 0;
+        bool     extended = false;
+        QString  name;
+        Status   status   = Status::Common;
+
+        quint64  baseFrames = 0, candFrames = 0;
+        double   baseCycleMs = 0.0, candCycleMs = 0.0;   ///< mean interval
+        quint64  aligned    = 0;
+        quint64  onlyBase   = 0, onlyCand = 0;           ///< frames without a partner
+        quint64  payloadDiffs = 0;                       ///< aligned pairs with different bytes
+
+        QVector<SignalDiff> signalDiffs;
+        quint64      hitCount = 0;
+        QVector<Hit> hits;                               ///< first MAX_HITS, in time order
+
+        /** Anything worth a look: missing/new ID, moved cycle, value divergence. */
+        bool differs(double cycleTolerance) const;
+    };
+
+    /**
+     * @brief Compare @p baseline against @p candidate.
+     * @param db  Signal definitions (may be null: payload comparison only).
+     */
+    static QVector<MessageDiff> compare(const QVector<CANManager::CANMessage>& baseline,
+                                        const QVector<CANManager::CANMessage>& candidate,
+                                        const DBCManager::DBCDatabase* db, Align align);
+};
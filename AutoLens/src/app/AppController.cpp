@@ -12,8 +12,9 @@
  *
  *  2. 50 ms batch flushing keeps the UI smooth at high frame rates:
  *     Frames arrive via onFrameReceived() → m_pending vector.
- *     Every 50 ms, flushPendingFrames() moves the whole batch to TraceModel
- *     in a single beginInsertRows/endInsertRows call.
+ *     Every 50 ms, flushPendingFrames() submits the batch to the persistent
+ *     DecodePipeline workers; onDecodedBatches() inserts the finished,
+ *     in-order entries into TraceModel in a single beginInsertRows call.
  *
  *  3. Per-channel DBC: each of the 4 channel slots can have its own DBC
  *     file. All enabled channels' DBCs are merged into m_dbcDb at
@@ -28,20 +29,41 @@
 #include "app/Logger.h"
 #include "hardware/VectorCANDriver.h"
 #include "hardware/DemoCANDriver.h"
+#include "hardware/VirtualCANDriver.h"
+#include "hardware/UdpCANDriver.h"
+#include "hardware/SlcanDriver.h"
+#include "trace/TraceEntryBuilder.h"
 #include "trace/TraceExporter.h"
 #include "trace/TraceImporter.h"
+#include "trace/ClockSync.h"
+#include "hardware/CANBitTiming.h"
+#include "metrics/MetricsRegistry.h"
 
 #include <QDebug>
 #include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
 #include <QTextStream>
 #include <QThreadPool>
 #include <QVariantMap>
-#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
 #include <atomic>
+#include <limits>
 #include <memory>
 
+#ifdef Q_OS_WIN
+#  ifndef PSAPI_VERSION
+#    define PSAPI_VERSION 2   // K32GetProcessMemoryInfo: kernel32, no psapi.lib
+#  endif
+#  include <windows.h>
+#  include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#  include <unistd.h>
+#endif
+
 using namespace CANManager;
 using namespace DBCManager;
 
@@ -92,38 +114,11 @@ AppController::AppController(QObject* parent)
     m_traceProxy.setSourceModel(&m_traceModel);
 
     // -----------------------------------------------------------------------
-    //  Select driver
-    //  Try Vector XL first. If the DLL is not found (dev machine without HW),
-    //  fall back to the Demo driver so the UI always works.
-    // -----------------------------------------------------------------------
-    auto* vectorDrv = new VectorCANDriver(this);
-    qDebug() << "[AppController] Checking Vector XL driver availability...";
-    if (vectorDrv->isAvailable()) {
-        m_driver = vectorDrv;
-        qDebug() << "[AppController] Using Vector XL driver (DLL found)";
-    } else {
-        qDebug() << "[AppController] Vector XL DLL not found — using Demo driver";
-        vectorDrv->deleteLater();
-        m_driver = new DemoCANDriver(this);
-    }
-
-    // -----------------------------------------------------------------------
-    //  Connect driver signals → our slots
-    //
-    //  Qt::AutoConnection becomes QueuedConnection for VectorCANDriver
-    //  (cross-thread) and DirectConnection for DemoCANDriver (same thread).
-    //  Either way, onFrameReceived() always executes on the UI thread.
-    //
-    //  WHY onDriverError instead of directly re-emitting errorOccurred:
-    //  onDriverError intercepts fatal hardware-removal errors (HW_NOT_PRESENT)
-    //  and auto-disconnects before forwarding to QML.  Without this, the
-    //  receive thread would flood the error toast with errors every 100 ms.
+    //  Select driver ("Driver/backend", restored by loadSettings above)
+    //  "auto" tries Vector XL first.  If the DLL is not found (dev machine
+    //  without HW), it falls back to the Demo driver so the UI always works.
     // -----------------------------------------------------------------------
-    connect(m_driver, &ICANDriver::messageReceived,
-            this,     &AppController::onFrameReceived);
-
-    connect(m_driver, &ICANDriver::errorOccurred,
-            this,     &AppController::onDriverError);
+    installDriver(createDriver());
 
     // -----------------------------------------------------------------------
     //  Batch-flush timer (50 ms = 20 Hz UI refresh)
@@ -136,10 +131,111 @@ AppController::AppController(QObject* parent)
     m_flushTimer.setTimerType(Qt::CoarseTimer);  // save CPU, ±5% jitter OK
     connect(&m_flushTimer, &QTimer::timeout, this, &AppController::flushPendingFrames);
 
+    // -----------------------------------------------------------------------
+    //  Decode pipeline — persistent workers that turn CANMessages into
+    //  TraceEntries off the UI thread.  Finished batches come back through
+    //  a queued batchesReady() so the UI thread never waits on decoding.
+    // -----------------------------------------------------------------------
+    connect(&m_decodePipeline, &DecodePipeline::batchesReady,
+            this,              &AppController::onDecodedBatches);
+    m_decodePipeline.start();
+
+    // -----------------------------------------------------------------------
+    //  Residual bus simulation — frames leave through the active driver.
+    //
+    //  WHY count errors instead of emitting per frame: the sink runs on the
+    //  simulator thread at up to thousands of frames/s.  A listen-only port
+    //  would otherwise flood the UI with one toast per frame; only the first
+    //  failure is forwarded, the rest show up in residualBusStats().
+    // -----------------------------------------------------------------------
+    m_residualBus.setFrameSink([this](const QVector<CANMessage>& frames) {
+        // One batch per wheel tick: the UDP driver packs it into one datagram
+        const CANResult r = transmitAsNode(m_residualNode, frames.constData(), frames.size());
+        if (!r.success && m_residualTxErrors.fetch_add(1) == 0) {
+            const QString err = r.errorMessage;
+            QMetaObject::invokeMethod(this, [this, err]() {
+                emit errorOccurred("Residual bus TX failed: " + err);
+            }, Qt::QueuedConnection);
+        }
+    });
+    connect(&m_residualBus, &ResidualBusSimulator::runningChanged,
+            this,           &AppController::residualBusRunningChanged);
+
+    // -----------------------------------------------------------------------
+    //  Node scripts — run on their own QJSEngine thread.  can.output() goes
+    //  straight to the driver; can.setSignal() feeds the residual bus.
+    // -----------------------------------------------------------------------
+    m_scriptHost.setTransmit([this](const CANMessage& msg) {
+        return transmitAsNode(m_scriptNode, &msg, 1).success;
+    });
+    m_scriptHost.setSetSignal([this](int ch, const QString& message,
+                                     const QString& signalName, double value) {
+        return m_residualBus.setSignalValue(ch, message, signalName, value);
+    });
+    connect(&m_scriptHost, &ScriptHost::runningChanged,
+            this,          &AppController::scriptsRunningChanged);
+    connect(&m_scriptHost, &ScriptHost::scriptLog,
+            this,          &AppController::scriptOutput);
+    connect(&m_scriptHost, &ScriptHost::scriptError, this, [this](const QString& message) {
+        emit errorOccurred("Script: " + message);
+    });
+
+    // -----------------------------------------------------------------------
+    //  Gateway — forwards on the driver thread (see installDriver()), so
+    //  like the residual bus sink only the first TX failure is surfaced.
+    // -----------------------------------------------------------------------
+    m_gateway.setTransmit([this](const CANMessage* frames, int count) {
+        int sent = 0;
+        const CANResult r = transmitAsNode(m_gatewayNode, frames, count, &sent);
+        if (!r.success && m_gatewayTxErrors.fetch_add(1) == 0) {
+            const QString err = r.errorMessage;
+            QMetaObject::invokeMethod(this, [this, err]() {
+                emit errorOccurred("Gateway TX failed: " + err);
+            }, Qt::QueuedConnection);
+        }
+        return sent;
+    });
+    connect(&m_gateway, &GatewayEngine::enabledChanged,
+            this,       &AppController::gatewayEnabledChanged);
+
     // Frame-rate counter — updated once per second
     m_rateTimer.setInterval(1000);
     connect(&m_rateTimer, &QTimer::timeout, this, &AppController::updateFrameRate);
 
+    // Flight recorder — trigger frames dump after a post-trigger delay so
+    // the file also shows what happened right after the event.
+    connect(&m_flightRecorder, &FlightRecorder::triggered, this, [this](const QString& reason) {
+        QSettings settings;
+        const int postMs = settings.value("Recorder/postTriggerMs", 5000).toInt();
+        qDebug() << "[AppController] Flight recorder trigger:" << reason;
+        setStatus("Flight recorder triggered by " + reason);
+        QTimer::singleShot(qMax(0, postMs), this, [this]() { dumpFlightRecorder(); });
+    });
+    connect(&m_flightRecorder, &FlightRecorder::dumpFinished, this,
+            [this](const QString& path, const QString& error, int frames) {
+        if (!error.isEmpty()) {
+            emit errorOccurred("Flight recorder dump failed: " + error);
+            setStatus("Flight recorder dump failed");
+            return;
+        }
+        setStatus(QString("Flight recorder: %1 frames written to %2")
+                      .arg(frames).arg(QFileInfo(path).fileName()));
+    });
+
+    // Journal — a failed write (disk full, drive removed) ends journaling;
+    // everything up to the last intact block stays readable.
+    connect(&m_journal, &TraceJournal::writeFailed, this, [this](const QString& error) {
+        m_journal.stop();
+        emit errorOccurred("Journal write failed: " + error);
+        setStatus("Journaling stopped");
+        emit journalingChanged();
+    });
+
+    // Metrics — registered once; sampled every second while exporting
+    registerMetrics();
+    m_metricsTimer.setInterval(1000);
+    connect(&m_metricsTimer, &QTimer::timeout, this, &AppController::sampleMetrics);
+
     // -----------------------------------------------------------------------
     //  Port health monitoring timer (2-second interval)
     //
@@ -174,6 +270,18 @@ AppController::AppController(QObject* parent)
 AppController::~AppController()
 {
     disconnectChannels();
+    m_journal.stop();   // final checkpoint: the file reads as closed cleanly
+    m_scriptHost.unload();
+    m_residualBus.stop();
+    m_decodePipeline.stop();
+
+    // Analysis workers capture `this`; let them finish before it goes away.
+    // Their queued result events die with this object.
+    for (const QPointer<QThread>& worker : std::as_const(m_workers)) {
+        if (!worker) continue;
+        worker->wait();
+        delete worker.data();
+    }
 }
 
 // ============================================================================
@@ -185,6 +293,251 @@ QString AppController::driverName() const
     return m_driver ? m_driver->driverName() : QStringLiteral("None");
 }
 
+// ============================================================================
+//  Driver Selection
+// ============================================================================
+
+ICANDriver* AppController::createDriver()
+{
+    if (m_driverBackend == QLatin1String("virtual")) {
+        qDebug() << "[AppController] Using virtual CAN bus driver";
+        return new VirtualCANDriver(this);
+    }
+    if (m_driverBackend == QLatin1String("demo")) {
+        qDebug() << "[AppController] Using Demo driver (selected)";
+        return new DemoCANDriver(this);
+    }
+    if (m_driverBackend == QLatin1String("udp")) {
+        qDebug() << "[AppController] Using CAN over UDP driver:"
+                 << m_udpLocalPort << "→" << m_udpPeer;
+        auto* udp = new UdpCANDriver(this);
+        const int colon = m_udpPeer.lastIndexOf(':');
+        udp->setEndpoint(m_udpLocalPort, m_udpPeer.left(colon),
+                         static_cast<quint16>(m_udpPeer.mid(colon + 1).toUInt()));
+        return udp;
+    }
+    if (m_driverBackend == QLatin1String("slcan")) {
+        // Serial ports are enumerated by the driver; "Driver/slcanPorts"
+        // adds names it cannot find itself (e.g. a pty used for testing).
+        qDebug() << "[AppController] Using SLCAN serial driver";
+        QSettings settings;
+        auto* slcan = new SlcanDriver(this);
+        slcan->setExtraPorts(settings.value("Driver/slcanPorts").toStringList());
+        slcan->setBaudRate(settings.value("Driver/slcanBaud", SlcanDriver::DEFAULT_BAUD).toInt());
+        return slcan;
+    }
+
+    auto* vectorDrv = new VectorCANDriver(this);
+    qDebug() << "[AppController] Checking Vector XL driver availability...";
+    if (vectorDrv->isAvailable()) {
+        qDebug() << "[AppController] Using Vector XL driver (DLL found)";
+        return vectorDrv;
+    }
+    qDebug() << "[AppController] Vector XL DLL not found — using Demo driver";
+    vectorDrv->deleteLater();
+    return new DemoCANDriver(this);
+}
+
+void AppController::installDriver(ICANDriver* driver)
+{
+    m_driver     = driver;
+    m_virtualBus = qobject_cast<VirtualCANDriver*>(driver);
+    m_driver->setCaptureFilter(&m_captureFilter);
+
+    // The simulator, the scripts and the gateway get their own bus nodes;
+    // addNode() is idempotent, so the ids stay stable across reconnects.
+    // Gateway output is echoed as TX so it is never routed a second time.
+    if (m_virtualBus) {
+        m_residualNode = m_virtualBus->addNode(QStringLiteral("ResidualBus"));
+        m_scriptNode   = m_virtualBus->addNode(QStringLiteral("Scripts"));
+        m_gatewayNode  = m_virtualBus->addNode(QStringLiteral("Gateway"), true);
+    }
+    m_txDriver.store(driver, std::memory_order_release);
+
+    // -----------------------------------------------------------------------
+    //  Gateway first, and DirectConnection: it runs on the thread that
+    //  emitted the frame, before the frame is queued for the UI.
+    // -----------------------------------------------------------------------
+    connect(m_driver, &ICANDriver::messageReceived, &m_gateway,
+            [this](const CANMessage& msg) { m_gateway.process(msg); },
+            Qt::DirectConnection);
+
+    // Shared-memory ring right behind it — external readers see the frame
+    // before the UI thread does.  publish() returns at once when sharing is off.
+    connect(m_driver, &ICANDriver::messageReceived, &m_frameRing,
+            [this](const CANMessage& msg) { m_frameRing.publish(msg); },
+            Qt::DirectConnection);
+
+    // Flight recorder — packs every frame into its staging segment; a
+    // few hundred ns, compression happens on its own thread.
+    connect(m_driver, &ICANDriver::messageReceived, &m_flightRecorder,
+            [this](const CANMessage& msg) { m_flightRecorder.record(msg); },
+            Qt::DirectConnection);
+
+    // Journal — same packing into its staging block; the disk writes
+    // happen on its writer thread.
+    connect(m_driver, &ICANDriver::messageReceived, &m_journal,
+            [this](const CANMessage& msg) { m_journal.record(msg); },
+            Qt::DirectConnection);
+
+    // Per-channel frame, error and bus-time counters — relaxed atomics on
+    // the driver thread, so the numbers do not depend on the UI keeping up.
+    connect(m_driver, &ICANDriver::messageReceived, &m_metricsExporter,
+            [this](const CANMessage& msg) {
+                if (!m_metricsActive.load(std::memory_order_relaxed))
+                    return;
+                const int idx = msg.channel - 1;
+                if (idx < 0 || idx >= MAX_CHANNELS)
+                    return;
+                ChannelMetrics& cm = m_channelMetrics[idx];
+                if (msg.isError) {
+                    cm.errorFrames->add();
+                    return;
+                }
+                cm.frames->add();
+                cm.busyNs->add(CANBitTiming::frameDurationNs(
+                    msg, m_metricBitrate.load(std::memory_order_relaxed),
+                    m_metricDataBitrate.load(std::memory_order_relaxed),
+                    m_metricFdEnabled.load(std::memory_order_relaxed)));
+            },
+            Qt::DirectConnection);
+
+    // -----------------------------------------------------------------------
+    //  Connect driver signals → our slots
+    //
+    //  Qt::AutoConnection becomes QueuedConnection for VectorCANDriver, the
+    //  virtual bus and DemoCANDriver's DBC traffic (all emitted from worker
+    //  threads) and DirectConnection for the built-in demo frames (same
+    //  thread).  Either way, onFrameReceived() always executes on the UI
+    //  thread.
+    //
+    //  WHY onDriverError instead of directly re-emitting errorOccurred:
+    //  onDriverError intercepts fatal hardware-removal errors (HW_NOT_PRESENT)
+    //  and auto-disconnects before forwarding to QML.  Without this, the
+    //  receive thread would flood the error toast with errors every 100 ms.
+    // -----------------------------------------------------------------------
+    connect(m_driver, &ICANDriver::messageReceived,
+            this,     &AppController::onFrameReceived);
+
+    connect(m_driver, &ICANDriver::errorOccurred,
+            this,     &AppController::onDriverError);
+}
+
+void AppController::detachDriver(ICANDriver* driver)
+{
+    // Worker threads stop picking the driver up first; a call already in
+    // flight finishes before shutdown() joins the driver's threads.
+    m_txDriver.store(nullptr, std::memory_order_release);
+
+    disconnect(driver, nullptr, this, nullptr);
+    disconnect(driver, nullptr, &m_gateway, nullptr);
+    disconnect(driver, nullptr, &m_frameRing, nullptr);
+    disconnect(driver, nullptr, &m_flightRecorder, nullptr);
+    disconnect(driver, nullptr, &m_journal, nullptr);
+    disconnect(driver, nullptr, &m_metricsExporter, nullptr);
+}
+
+CANResult AppController::transmitAsNode(int node, const CANMessage* frames, int count, int* sent)
+{
+    ICANDriver* driver = m_txDriver.load(std::memory_order_acquire);
+    if (!driver)
+        return CANResult::Failure("No active driver");
+    if (auto* bus = qobject_cast<VirtualCANDriver*>(driver))
+        return bus->transmitBatchFrom(node, frames, count, sent);
+    return driver->transmitBatch(frames, count, sent);
+}
+
+void AppController::startWorker(QThread* thread, const QString& name)
+{
+    m_workers.removeAll(nullptr);   // finished ones have deleted themselves
+    m_workers.append(thread);
+    thread->setObjectName(name);
+    connect(thread, &QThread::finished, thread, &QThread::deleteLater);
+    thread->start();
+}
+
+bool AppController::setDriverBackend(const QString& backend)
+{
+    const QString key = backend.toLower();
+    if (key != QLatin1String("auto") && key != QLatin1String("demo")
+        && key != QLatin1String("virtual") && key != QLatin1String("udp")
+        && key != QLatin1String("slcan")) {
+        emit errorOccurred("Unknown driver backend: " + backend);
+        return false;
+    }
+    if (key == m_driverBackend)
+        return true;
+
+    if (m_connected) {
+        emit errorOccurred("Disconnect before switching the driver backend");
+        return false;
+    }
+    // A background init / health check still uses the current driver.
+    if ((m_initThread && m_initThread->isRunning()) || m_portChecking) {
+        emit errorOccurred("Driver detection in progress — try again in a moment");
+        return false;
+    }
+
+    m_driverBackend = key;
+    QSettings settings;
+    settings.setValue("Driver/backend", m_driverBackend);
+
+    ICANDriver* old = m_driver;
+    detachDriver(old);
+    old->shutdown();
+    old->deleteLater();
+
+    installDriver(createDriver());
+
+    m_channelInfos.clear();
+    m_channelList.clear();
+    emit channelListChanged();
+    emit driverNameChanged();
+
+    refreshChannels();
+    return true;
+}
+
+bool AppController::setUdpEndpoint(int localPort, const QString& peer)
+{
+    const QString p = peer.trimmed();
+    const int colon = p.lastIndexOf(':');
+    bool portOk = false;
+    const uint peerPort = colon > 0 ? p.mid(colon + 1).toUInt(&portOk) : 0;
+    if (localPort <= 0 || localPort > 65535 || !portOk || peerPort == 0 || peerPort > 65535) {
+        emit errorOccurred("UDP endpoint must be a local port and host:port, e.g. 127.0.0.1:20000");
+        return false;
+    }
+    if (m_connected) {
+        emit errorOccurred("Disconnect before changing the UDP endpoint");
+        return false;
+    }
+
+    m_udpLocalPort = static_cast<quint16>(localPort);
+    m_udpPeer      = p;
+    QSettings settings;
+    settings.setValue("Driver/udpLocalPort", localPort);
+    settings.setValue("Driver/udpPeer",      m_udpPeer);
+
+    // Takes effect on the next connect; refresh the one-entry channel list
+    if (auto* udp = qobject_cast<UdpCANDriver*>(m_driver)) {
+        udp->setEndpoint(m_udpLocalPort, p.left(colon), static_cast<quint16>(peerPort));
+        refreshChannels();
+    }
+    return true;
+}
+
+QVariantMap AppController::udpEndpoint() const
+{
+    return { { "localPort", m_udpLocalPort }, { "peer", m_udpPeer } };
+}
+
+bool AppController::hasFixedChannels() const
+{
+    return qobject_cast<DemoCANDriver*>(m_driver) || m_virtualBus
+        || qobject_cast<UdpCANDriver*>(m_driver);
+}
+
 // ============================================================================
 //  Hardware Detection (background thread with watchdog)
 // ============================================================================
@@ -279,18 +632,13 @@ void AppController::refreshChannels()
         cancelled->store(true);
 
         // Abandon stuck driver (no terminate/delete — see comment above)
-        disconnect(m_driver, nullptr, this, nullptr);
+        detachDriver(m_driver);
         m_driver->setParent(nullptr);   // detach from AppController
         m_initThread = nullptr;
 
-        // Create Demo driver and re-wire signals
-        // WHY onDriverError (not direct errorOccurred): consistent with the
-        // initial driver connection so hardware-removal logic is always active.
-        m_driver = new DemoCANDriver(this);
-        connect(m_driver, &ICANDriver::messageReceived,
-                this,     &AppController::onFrameReceived);
-        connect(m_driver, &ICANDriver::errorOccurred,
-                this,     &AppController::onDriverError);
+        // Create Demo driver and re-wire signals (same path as the initial
+        // driver, so hardware-removal logic is always active).
+        installDriver(new DemoCANDriver(this));
 
         m_driver->initialize();
         applyDriverInitResult(true, m_driver->detectChannels());
@@ -455,8 +803,8 @@ void AppController::checkPortHealth()
     // a Vector device, the port dropdown should reflect reality.  With a 2-second
     // refresh the list is always fresh without requiring a manual "Refresh" click.
     if (!m_connected) {
-        // Demo driver always has the same virtual channels — no need to re-scan
-        if (qobject_cast<DemoCANDriver*>(m_driver)) return;
+        // Demo, virtual bus and UDP always have the same channels — no need to re-scan
+        if (hasFixedChannels()) return;
 
         // Skip if init or a manual refreshChannels() is already in progress
         if (m_initThread && m_initThread->isRunning()) return;
@@ -554,11 +902,12 @@ void AppController::onDriverError(const QString& message)
     //  sets m_asyncRunning = false and waits for the receive thread to exit.
     //  The thread then stops its loop → no more errors.
     // -----------------------------------------------------------------------
-    if (m_connected && !qobject_cast<DemoCANDriver*>(m_driver)) {
+    if (m_connected && !hasFixedChannels()) {
         const bool isFatalHwError =
             message.contains("HW_NOT_PRESENT") ||
             message.contains("HW_NOT_READY")   ||
-            message.contains("CANNOT_OPEN_DRIVER");
+            message.contains("CANNOT_OPEN_DRIVER") ||
+            message.startsWith("Serial port lost");   // SLCAN adapter unplugged
 
         if (isFatalHwError) {
             qWarning() << "[AppController] Fatal HW error — auto-disconnecting:" << message;
@@ -611,6 +960,12 @@ void AppController::connectChannels()
         }
     }
 
+    // Bus-busy time in the metrics uses the rates the channel is opened with
+    m_metricBitrate.store(busConfig.bitrate);
+    m_metricDataBitrate.store(busConfig.fdDataBitrate);
+    m_metricFdEnabled.store(busConfig.fdEnabled);
+    m_traceOverview.setBitTiming(busConfig.bitrate, busConfig.fdDataBitrate, busConfig.fdEnabled);
+
     // If no channel is configured yet, announce this so user knows to use CAN Config
     if (!anyEnabled) {
         setStatus(QString("Using defaults: %1 | 500 kbit/s | listen-only")
@@ -621,10 +976,10 @@ void AppController::connectChannels()
     //  Refresh channel list if needed (e.g. first time or HW was plugged in)
     // -----------------------------------------------------------------------
     if (m_channelInfos.isEmpty()) {
-        // Synchronous init only for Demo driver (instant); Vector was async
-        if (auto* demo = qobject_cast<DemoCANDriver*>(m_driver)) {
-            demo->initialize();
-            m_channelInfos = demo->detectChannels();
+        // Synchronous init only for Demo / virtual bus / UDP (instant); Vector was async
+        if (hasFixedChannels()) {
+            m_driver->initialize();
+            m_channelInfos = m_driver->detectChannels();
             m_channelList.clear();
             for (const auto& ch : m_channelInfos)
                 m_channelList.append(ch.displayString());
@@ -662,6 +1017,8 @@ void AppController::connectChannels()
     m_connected = true;
     emit connectedChanged();
 
+    m_captureHardware = m_driver->applyAcceptanceFilter();
+
     // Start async receive for Vector HW (Demo driver uses its own timer)
     if (auto* vdrv = qobject_cast<CANManager::VectorCANDriver*>(m_driver))
         vdrv->startAsyncReceive();
@@ -682,6 +1039,11 @@ void AppController::disconnectChannels()
     // Stop measuring first (cleans up timers, sets m_measuring=false)
     if (m_measuring) stopMeasurement();
 
+    // Scripts and the simulator transmit through m_driver — stop them
+    // before the port closes.
+    m_scriptHost.unload();
+    m_residualBus.stop();
+
     // Stop Vector async receive thread
     if (auto* vdrv = qobject_cast<CANManager::VectorCANDriver*>(m_driver))
         vdrv->stopAsyncReceive();
@@ -892,7 +1254,7 @@ void AppController::rebuildMergedDbc()
     //
     //  WHY merge: the trace receives frames from all channels mixed together.
     //  A single lookup database is faster than per-channel branching in the
-    //  hot path (buildEntry() called for every received frame).
+    //  hot path (TraceEntryBuilder::build() called for every received frame).
     //
     //  WHY also check dbcFilePath: if a channel is enabled but no DBC was
     //  pre-loaded yet (e.g. first-time connect), try loading from the stored
@@ -940,6 +1302,16 @@ void AppController::rebuildMergedDbc()
         emit dbcInfoChanged();
         qDebug() << "[AppController] Merged DBC:" << m_dbcInfo;
     }
+
+    // Decode workers read an immutable snapshot, never m_dbcDb itself
+    m_decodePipeline.setDatabase(m_dbcDb);
+    m_signalStream.setDatabase(m_dbcDb);
+    m_traceModel.setDatabase(m_dbcDb);
+    applyOverviewSignal();
+    configureLatency();
+
+    // Gateway routes may name DBC messages/signals — re-resolve them
+    configureGateway();
 }
 
 // ============================================================================
@@ -968,6 +1340,10 @@ void AppController::loadDbc(const QString& filePath)
 
     if (auto* demoDrv = qobject_cast<DemoCANDriver*>(m_driver))
         demoDrv->setSimulationDatabase(m_dbcDb);
+    m_decodePipeline.setDatabase(m_dbcDb);
+    m_traceModel.setDatabase(m_dbcDb);
+    applyOverviewSignal();
+    configureLatency();
 
     m_dbcInfo = QString("%1  |  %2 msg  |  %3 sig")
                     .arg(fi.fileName())
@@ -986,7 +1362,10 @@ void AppController::loadDbc(const QString& filePath)
 
 void AppController::clearTrace()
 {
+    m_decodePipeline.reset();   // frames still decoding must not reappear
     m_traceModel.clear();
+    m_traceOverview.clear();
+    m_latency.reset();
     emit frameCountChanged();
     setStatus("Trace cleared");
 }
@@ -1029,21 +1408,116 @@ bool AppController::importTraceLog(const QString& filePath, bool append)
         emit frameRateChanged();
     }
 
-    if (!append)
+    // ── Appending a second source: bring it onto the trace's clock ──────────
+    //
+    //  Frames seen by both loggers pin the offset and drift (ClockSync).
+    //  When they line up, the two sources are merged by corrected time
+    //  instead of concatenated.  Without enough shared frames the file is
+    //  appended unchanged, as before.
+    QString syncInfo;
+    bool    merge    = false;
+    quint64 rebaseNs = 0;   // added to every frame of a merge (see below)
+    if (append && m_traceModel.frameCount() > 0) {
+        ClockSync sync;
+        m_traceModel.forEachMessage([&sync](const CANMessage& frame) {
+            sync.addReference(frame);
+        });
+        for (const CANMessage& frame : std::as_const(importedFrames))
+            sync.observe(frame);
+
+        const ClockSync::Estimate est = sync.estimate();
+        const bool canMerge = m_traceModel.displayMode() == TraceModel::DisplayMode::Append;
+
+        // A logger started before the reference maps its first frames below
+        // zero.  Merging rebuilds the whole trace, so shift both sources up
+        // by that much; otherwise the existing rows stay as they are and
+        // the file can only be appended unsynced.
+        qint64 earliest = 0;
+        if (est.valid) {
+            for (const CANMessage& frame : std::as_const(importedFrames))
+                earliest = std::min(earliest, sync.map(frame.timestamp));
+        }
+
+        if (est.valid && (canMerge || earliest == 0)) {
+            rebaseNs = quint64(-earliest);
+            for (CANMessage& frame : importedFrames)
+                frame.timestamp = quint64(sync.map(frame.timestamp) - earliest);
+            merge = canMerge;
+            syncInfo = QString(", synced: offset %1 ms, drift %2 ppm, ±%3 µs over %4 frames")
+                           .arg(est.offsetNs / 1e6, 0, 'f', 3)
+                           .arg(est.driftPpm, 0, 'f', 2)
+                           .arg(est.residualUs, 0, 'f', 1)
+                           .arg(est.pairs);
+            if (rebaseNs > 0)
+                syncInfo += QString(", timeline shifted by %1 ms").arg(rebaseNs / 1e6, 0, 'f', 3);
+            qDebug() << "[AppController] Clock sync for" << fi.fileName() << syncInfo;
+        } else if (est.valid) {
+            syncInfo = QStringLiteral(", not synced (file starts before the trace; "
+                                      "merging needs Append mode)");
+        } else {
+            syncInfo = QStringLiteral(", not synced (no shared frames)");
+        }
+    }
+
+    // A merge rebuilds the trace from both sources, so the current rows are
+    // pulled out as raw frames (no TraceEntry) before the model is cleared.
+    QVector<CANMessage> existing;
+    if (merge) {
+        existing.reserve(m_traceModel.frameCount());
+        m_traceModel.forEachMessage([&existing, rebaseNs](const CANMessage& frame) {
+            existing.append(frame);
+            existing.last().timestamp += rebaseNs;
+        });
+        std::stable_sort(importedFrames.begin(), importedFrames.end(),
+                         [](const CANMessage& a, const CANMessage& b) { return a.timestamp < b.timestamp; });
+    }
+
+    if (!append || merge) {
+        m_decodePipeline.reset();
         m_traceModel.clear();
+        m_traceOverview.clear();
+        m_latency.reset();
+    }
+
+    // One segment's worth of entries at a time: the model seals between
+    // calls, so a multi-million-frame file never exists as TraceEntry
+    // objects all at once — only the hot tail and this chunk do.
+    QVector<TraceEntry> chunk;
+    chunk.reserve(TraceModel::SEGMENT_FRAMES);
+    qsizetype fed = 0;
+    auto feed = [&](const CANMessage& frame) {
+        chunk.append(TraceEntryBuilder::build(frame, &m_dbcDb));
+        m_traceOverview.add(frame);
+        m_latency.process(frame);
+        ++fed;
+        if (chunk.size() == TraceModel::SEGMENT_FRAMES) {
+            m_traceModel.addEntries(chunk);
+            chunk.clear();
+        }
+    };
 
-    QVector<TraceEntry> entries;
-    entries.reserve(importedFrames.size());
-    for (const auto& frame : importedFrames)
-        entries.append(buildEntry(frame));
+    // Merge: walk both sorted sources (std::merge order — the existing
+    // frame first on equal times) straight into the chunks, with no third
+    // full-size copy.
+    auto next = importedFrames.cbegin();
+    for (const CANMessage& frame : std::as_const(existing)) {
+        for (; next != importedFrames.cend() && next->timestamp < frame.timestamp; ++next)
+            feed(*next);
+        feed(frame);
+    }
+    existing = {};
+    for (; next != importedFrames.cend(); ++next)
+        feed(*next);
 
-    m_traceModel.addEntries(entries);
+    if (!chunk.isEmpty())
+        m_traceModel.addEntries(chunk);
     emit frameCountChanged();
 
-    setStatus(QString("Offline trace %1: %2 (%3 frames)")
-                  .arg(append ? "appended" : "loaded")
+    setStatus(QString("Offline trace %1: %2 (%3 frames%4)")
+                  .arg(merge ? "merged" : append ? "appended" : "loaded")
                   .arg(fi.fileName())
-                  .arg(importedFrames.size()));
+                  .arg(fed)
+                  .arg(syncInfo));
 
     return true;
 }
@@ -1062,24 +1536,26 @@ void AppController::saveTrace(const QString& filePath)
     //
     const QString ext = fi.suffix().toLower();
     QString err;
+    QElapsedTimer writeTime;
+    writeTime.start();
 
     if (ext == "asc")
     {
         // ── Vector ASC (ASCII Log) ─────────────────────────────────────────
         // Human-readable text format.  Opens in CANalyzer or any text editor.
-        err = TraceExporter::saveAsAsc(path, m_traceModel.frames());
+        err = TraceExporter::saveAsAsc(path, m_traceModel);
     }
     else if (ext == "blf")
     {
         // ── Vector BLF (Binary Log File) ──────────────────────────────────
         // Compact binary format.  Preferred for large traces and automated
         // test toolchains.  Opens in CANalyzer / CANoe / python-can.
-        err = TraceExporter::saveAsBLF(path, m_traceModel.frames());
+        err = TraceExporter::saveAsBLF(path, m_traceModel);
     }
     else
     {
         // ── CSV (default, and fallback for unknown extensions) ─────────────
-        err = TraceExporter::saveAsCsv(path, m_traceModel.frames());
+        err = TraceExporter::saveAsCsv(path, m_traceModel);
     }
 
     // ── Report result ──────────────────────────────────────────────────────────
@@ -1087,6 +1563,8 @@ void AppController::saveTrace(const QString& filePath)
         setStatus("Save failed: " + err);
         emit errorOccurred(err);
     } else {
+        countLogBytes(ext == "asc" || ext == "blf" ? ext : QStringLiteral("csv"),
+                      path, writeTime.nsecsElapsed());
         setStatus(QString("Trace saved: %1  (%2 frames)  [%3]")
                       .arg(fi.fileName())
                       .arg(m_traceModel.frameCount())
@@ -1118,208 +1596,1254 @@ void AppController::sendFrame(quint32 id, const QString& hexData, bool extended)
 }
 
 // ============================================================================
-//  Frame Reception
+//  Residual Bus Simulation
 // ============================================================================
 
-void AppController::onFrameReceived(const CANMessage& msg)
+void AppController::configureResidualBus()
 {
-    // -----------------------------------------------------------------------
-    //  Discard frames when not measuring.
-    //
-    //  WHY check here rather than in flushPendingFrames(): we don't want
-    //  m_pending to grow unboundedly when connected-but-not-measuring.
-    //  Dropping here keeps memory usage O(batch size) not O(time connected).
-    // -----------------------------------------------------------------------
-    if (!m_measuring || m_paused) return;
+    // Simulator channels follow the CAN Config slots (1-based), so a node
+    // list stays stable even when other channels are toggled.
+    for (int i = 0; i < MAX_CHANNELS; ++i) {
+        m_residualBus.setChannelDatabase(
+            i + 1, m_channelConfigs[i].enabled ? m_channelDbs[i] : DBCDatabase());
+    }
+}
 
-    if (msg.isTxConfirm) return;   // skip TX echoes (optional — could expose as setting)
+QVariantList AppController::residualBusNodes()
+{
+    if (!m_residualBus.isRunning())
+        configureResidualBus();
 
-    m_pending.append(msg);
-    ++m_framesSinceLastSec;
+    QVariantList list;
+    const auto nodes = m_residualBus.nodes();
+    list.reserve(nodes.size());
+    for (const auto& n : nodes) {
+        list.append(QVariantMap{
+            { "channel",      n.channel      },
+            { "name",         n.name         },
+            { "messageCount", n.messageCount },
+            { "cyclicCount",  n.cyclicCount  },
+            { "selected",     n.enabled      }
+        });
+    }
+    return list;
 }
 
-// ============================================================================
-//  50 ms flush timer — batch insert into TraceModel
-// ============================================================================
-
-void AppController::flushPendingFrames()
+void AppController::setResidualBusNodeEnabled(int channel, const QString& node, bool enabled)
 {
-    if (m_pending.isEmpty()) return;
+    if (m_residualBus.isRunning()) {
+        emit errorOccurred("Stop the simulation before changing nodes");
+        return;
+    }
 
-    // While paused, m_pending accumulates but we don't flush until resume.
-    // pauseMeasurement() calls flushPendingFrames() manually on resume.
-    if (m_paused) return;
+    m_residualBus.setNodeEnabled(channel, node, enabled);
 
-    QVector<CANMessage> batch = std::move(m_pending);
-    m_pending.clear();
+    QSettings settings;
+    settings.setValue("Simulation/nodes", m_residualBus.enabledNodeKeys());
+}
 
-#ifndef QT_NO_DEBUG
-    qDebug() << "[Flush] batch=" << batch.size()
-             << "measuring=" << m_measuring
-             << "mode=" << (m_inPlaceDisplayMode ? "InPlace" : "Append")
-             << "frames_before=" << m_traceModel.frameCount();
-#endif
+bool AppController::startResidualBus()
+{
+    if (m_residualBus.isRunning())
+        return true;
 
-    // ── Build entries off the UI thread ───────────────────────────────────
-    //  buildEntry() does string formatting (QString::number, arg, toUpper)
-    //  plus DBC signal decoding.  At high bus loads (1000+ fps) this is the
-    //  most CPU-intensive work in the flush path.  Moving it to a thread-pool
-    //  worker keeps the UI thread responsive for rendering.
-    //
-    //  WHY blockingMapped (not async): we need the entries _now_ to insert
-    //  into TraceModel.  blockingMapped runs the work on the global thread
-    //  pool and returns when all items are built — typically <1 ms for a
-    //  50 ms batch of ~50-500 frames.
-    const auto* self = this;  // capture const this for buildEntry()
-    QVector<TraceEntry> entries = QtConcurrent::blockingMapped<QVector<TraceEntry>>(
-        batch,
-        [self](const CANMessage& msg) -> TraceEntry {
-            return self->buildEntry(msg);
-        }
-    );
+    if (!m_connected) {
+        emit errorOccurred("Not connected — cannot start simulation");
+        return false;
+    }
 
-    m_traceModel.addEntries(entries);
-    emit frameCountChanged();
+    configureResidualBus();
+    m_residualTxErrors.store(0);
 
-#ifndef QT_NO_DEBUG
-    qDebug() << "[Flush] frames_after=" << m_traceModel.frameCount();
-#endif
+    if (!m_residualBus.start()) {
+        emit errorOccurred("No cyclic messages to simulate — select nodes with GenMsgCycleTime");
+        return false;
+    }
+
+    setStatus(QString("Residual bus simulation: %1 messages")
+                  .arg(m_residualBus.scheduledMessageCount()));
+    return true;
 }
 
-// ============================================================================
-//  Build one TraceEntry from a raw CANMessage
-// ============================================================================
+void AppController::stopResidualBus()
+{
+    if (!m_residualBus.isRunning())
+        return;
 
-TraceEntry AppController::buildEntry(const CANMessage& msg) const
-{
-    // ── Interned strings for repeated values ─────────────────────────────
-    //  These are created once and reused across all frames.  QString uses
-    //  copy-on-write so assigning a static QString to a TraceEntry field
-    //  only increments a ref-count — zero allocation.
-    static const QString s_can       = QStringLiteral("CAN");
-    static const QString s_canFD     = QStringLiteral("CAN FD");
-    static const QString s_canFdBrs  = QStringLiteral("CAN FD BRS");
-    static const QString s_error     = QStringLiteral("Error Frame");
-    static const QString s_remote    = QStringLiteral("Remote Frame");
-    static const QString s_rx        = QStringLiteral("Rx");
-    static const QString s_tx        = QStringLiteral("Tx");
-    // Channel number strings (1–4 cover all practical hardware)
-    static const QString s_ch1       = QStringLiteral("1");
-    static const QString s_ch2       = QStringLiteral("2");
-    static const QString s_ch3       = QStringLiteral("3");
-    static const QString s_ch4       = QStringLiteral("4");
-    // Common DLC strings (0–8 for classic CAN, plus common FD lengths)
-    static const QString s_dlc[9]    = {
-        QStringLiteral("0"), QStringLiteral("1"), QStringLiteral("2"),
-        QStringLiteral("3"), QStringLiteral("4"), QStringLiteral("5"),
-        QStringLiteral("6"), QStringLiteral("7"), QStringLiteral("8")
-    };
+    m_residualBus.stop();
+    setStatus("Residual bus simulation stopped");
+}
 
-    TraceEntry e;
-    e.msg = msg;
+QVariantMap AppController::residualBusStats() const
+{
+    const auto st = m_residualBus.stats();
+    return {
+        { "framesSent",     static_cast<double>(st.framesSent)     },
+        { "scheduled",      st.scheduled                           },
+        { "avgLatenessUs",  st.avgLatenessUs                       },
+        { "maxLatenessUs",  st.maxLatenessUs                       },
+        { "droppedUpdates", static_cast<double>(st.droppedUpdates) },
+        { "txErrors",       static_cast<double>(m_residualTxErrors.load()) }
+    };
+}
 
-    // Col 0: Relative timestamp (hardware ns → display ms with 6 decimal places)
-    const double relMs = static_cast<double>(msg.timestamp) / 1.0e6;
-    e.timeStr = QString::number(relMs, 'f', 6);
+bool AppController::setSimSignal(int channel, const QString& message,
+                                 const QString& signalName, double value)
+{
+    return m_residualBus.setSignalValue(channel, message, signalName, value);
+}
 
-    // Col 2: CAN ID — CANoe format "0C4h" (std) / "18DB33F1h" (ext)
-    if (msg.isExtended)
-        e.idStr = QString("%1h").arg(msg.id, 8, 16, QChar('0')).toUpper();
-    else
-        e.idStr = QString("%1h").arg(msg.id, 3, 16, QChar('0')).toUpper();
-
-    // Col 3: Channel number (interned for channels 1–4)
-    switch (msg.channel) {
-    case 1:  e.chnStr = s_ch1; break;
-    case 2:  e.chnStr = s_ch2; break;
-    case 3:  e.chnStr = s_ch3; break;
-    case 4:  e.chnStr = s_ch4; break;
-    default: e.chnStr = QString::number(msg.channel); break;
-    }
-
-    // Col 4: Event type (interned — priority: Error > Remote > FD variants > CAN)
-    if (msg.isError)
-        e.eventTypeStr = s_error;
-    else if (msg.isRemote)
-        e.eventTypeStr = s_remote;
-    else if (msg.isFD)
-        e.eventTypeStr = msg.isBRS ? s_canFdBrs : s_canFD;
-    else
-        e.eventTypeStr = s_can;
+QVariantMap AppController::virtualBusStats() const
+{
+    if (!m_virtualBus)
+        return { { "available", false } };
+
+    const auto st = m_virtualBus->stats();
+    QVariantList nodes;
+    for (const auto& n : st.nodes) {
+        nodes.append(QVariantMap{
+            { "name",              n.name                                    },
+            { "txFrames",          static_cast<double>(n.txFrames)           },
+            { "arbitrationLosses", static_cast<double>(n.arbitrationLosses)  },
+            { "queueFull",         static_cast<double>(n.queueFull)          },
+            { "maxQueueDelayUs",   n.maxQueueDelayUs                         },
+            { "queued",            n.queued                                  }
+        });
+    }
+    return {
+        { "available", true                             },
+        { "frames",    static_cast<double>(st.frames)   },
+        { "busLoad",   st.busLoadPercent                },
+        { "totalLoad", st.totalLoadPercent              },
+        { "nodes",     nodes                            }
+    };
+}
 
-    // Col 5: Direction (interned)
-    e.dirStr = msg.isTxConfirm ? s_tx : s_rx;
+// ============================================================================
+//  Gateway
+// ============================================================================
 
-    // Col 6: DLC (interned for 0–8, dynamic for FD extended lengths)
-    {
-        const int dlcVal = (msg.isFD && msg.dlc > 8)
-                               ? msg.dataLength()
-                               : static_cast<int>(msg.dlc);
-        if (dlcVal >= 0 && dlcVal <= 8)
-            e.dlcStr = s_dlc[dlcVal];
-        else
-            e.dlcStr = QString::number(dlcVal);
+void AppController::configureGateway()
+{
+    for (int i = 0; i < MAX_CHANNELS; ++i) {
+        m_gateway.setChannelDatabase(
+            i + 1, m_channelConfigs[i].enabled ? m_channelDbs[i] : DBCDatabase());
     }
+    if (m_gatewayRoutes.isEmpty())
+        return;
 
-    // Col 7: Data bytes (hex dump, space-separated, uppercase)
-    {
-        const int len = msg.dataLength();
-        QString dataStr;
-        dataStr.reserve(len * 3);
-        for (int i = 0; i < len; ++i) {
-            if (i > 0) dataStr += ' ';
-            dataStr += QString("%1").arg(msg.data[i], 2, 16, QChar('0')).toUpper();
-        }
-        e.dataStr = dataStr;
+    const QString error = m_gateway.setRoutes(m_gatewayRoutes);
+    if (!error.isEmpty()) {
+        qWarning() << "[AppController] Gateway routes not compiled:" << error;
+        emit errorOccurred("Gateway: " + error);
     }
+}
 
-    // DBC decode → Col 1 name + signal child rows
-    if (!m_dbcDb.isEmpty()) {
-        const DBCMessage* dbcMsg = m_dbcDb.messageById(msg.id);
-        if (dbcMsg) {
-            e.nameStr = dbcMsg->name;
-
-            const int dataLen = msg.dataLength();
-            e.decodedSignals.reserve(dbcMsg->signalList.size());
-
-            // Evaluate mux selector first (muxIndicator == "M")
-            bool    hasMuxSelector = false;
-            int64_t activeMuxRaw   = -1;
-            for (const auto& sig : dbcMsg->signalList) {
-                if (sig.muxIndicator == QStringLiteral("M")) {
-                    hasMuxSelector = true;
-                    activeMuxRaw   = sig.rawValue(msg.data, dataLen);
-                    break;
-                }
-            }
+QString AppController::setGatewayRoutes(const QString& json)
+{
+    configureGateway();   // current DBCs, without re-applying the old routes' errors
+    const QString error = m_gateway.setRoutes(json);
+    if (!error.isEmpty())
+        return error;
 
-            for (const auto& sig : dbcMsg->signalList) {
-                const bool isMuxSel = (sig.muxIndicator == QStringLiteral("M"));
-                const bool isMuxed  = !sig.muxIndicator.isEmpty() && !isMuxSel;
+    m_gatewayRoutes = json;
+    m_gatewayTxErrors.store(0);
+    QSettings settings;
+    settings.setValue("Gateway/routes", m_gatewayRoutes);
+    setStatus(QString("Gateway: %1 route(s) active").arg(m_gateway.routeCount()));
+    return {};
+}
 
-                // Skip muxed signals not belonging to the active mux branch
-                if (isMuxed && hasMuxSelector && sig.muxValue >= 0
-                    && sig.muxValue != activeMuxRaw)
-                    continue;
+QString AppController::loadGatewayRoutes(const QString& filePath)
+{
+    QFile file(stripFileUrl(filePath));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return QString("Cannot open %1: %2").arg(file.fileName(), file.errorString());
+    return setGatewayRoutes(QString::fromUtf8(file.readAll()));
+}
 
-                const int64_t rawValue     = sig.rawValue(msg.data, dataLen);
-                const double  physicalVal  = sig.decode(msg.data, dataLen);
+void AppController::setGatewayEnabled(bool enabled)
+{
+    if (enabled == m_gateway.isEnabled())
+        return;
+    m_gatewayTxErrors.store(0);
+    m_gateway.setEnabled(enabled);   // emits gatewayEnabledChanged via the relay
 
-                QString valueText = QString::number(physicalVal, 'g', 8);
-                if (!sig.unit.isEmpty()) valueText += " " + sig.unit;
-                if (sig.valueDescriptions.contains(rawValue))
-                    valueText += QString(" (%1)").arg(sig.valueDescriptions.value(rawValue));
+    QSettings settings;
+    settings.setValue("Gateway/enabled", enabled);
+}
 
-                SignalRow sr;
-                sr.name     = sig.name;
-                sr.valueStr = valueText;
-                sr.rawStr   = QString("0x%1").arg(rawValue, 0, 16, QChar('0')).toUpper();
-                e.decodedSignals.append(sr);
-            }
-        }
+// ============================================================================
+//  Latency Analysis
+// ============================================================================
+
+void AppController::configureLatency()
+{
+    QSettings settings;
+    const QString json = settings.value("Latency/pairs").toString();
+    if (json.isEmpty())
+        return;
+
+    // First call configures; after that a DBC load/merge only re-resolves
+    // names, so statistics of a running capture survive.
+    const QString error = m_latency.pairs() == json
+        ? m_latency.rebindDatabase(m_dbcDb)
+        : m_latency.setPairs(json, m_dbcDb);
+    if (!error.isEmpty()) {
+        qWarning() << "[AppController] Latency pairs not resolved:" << error;
+        emit errorOccurred("Latency: " + error);
+    }
+}
+
+QString AppController::setLatencyPairs(const QString& json)
+{
+    const QString error = m_latency.setPairs(json, m_dbcDb);
+    if (!error.isEmpty())
+        return error;
+
+    QSettings settings;
+    settings.setValue("Latency/pairs", json);
+    setStatus(QString("Latency: %1 pair(s) active").arg(m_latency.pairCount()));
+    return {};
+}
+
+void AppController::analyzeTraceLatency()
+{
+    m_latency.reset();
+    m_traceModel.forEachMessage([this](const CANMessage& frame) {
+        m_latency.process(frame);
+    });
+    setStatus(QString("Latency: %1 frames analysed").arg(m_traceModel.frameCount()));
+}
+
+QVariantList AppController::latencyStats() const
+{
+    QVariantList list;
+    for (const auto& st : m_latency.stats()) {
+        QVariantList bins;
+        for (int b = 0; b < st.histogram.size(); ++b) {
+            if (st.histogram[b] == 0) continue;
+            bins.append(QVariantMap{
+                { "fromUs", LatencyAnalyzer::binLowerUs(b)        },
+                { "count",  static_cast<double>(st.histogram[b]) }
+            });
+        }
+        list.append(QVariantMap{
+            { "pair",      st.name                            },
+            { "timeoutMs", st.timeoutMs                       },
+            { "requests",  static_cast<double>(st.requests)   },
+            { "responses", static_cast<double>(st.responses)  },
+            { "timeouts",  static_cast<double>(st.timeouts)   },
+            { "unmatched", static_cast<double>(st.unmatched)  },
+            { "minUs",     st.minUs                           },
+            { "maxUs",     st.maxUs                           },
+            { "meanUs",    st.meanUs                          },
+            { "p50Us",     st.p50Us                           },
+            { "p95Us",     st.p95Us                           },
+            { "p99Us",     st.p99Us                           },
+            { "histogram", bins                               }
+        });
+    }
+    return list;
+}
+
+// ============================================================================
+//  Cycle Gap / Jitter Report
+// ============================================================================
+
+bool AppController::analyzeCycles(double gapFactor, const QString& filePath)
+{
+    if (m_cycleRunning)
+        return false;
+
+    // Partition on the UI thread only when reading the trace store (8 bytes
+    // per frame); a file is imported and partitioned on the worker.
+    auto analyzer = std::make_shared<CycleAnalyzer>();
+    const QString path = stripFileUrl(filePath);
+    if (path.isEmpty()) {
+        m_traceModel.forEachMessage([&analyzer](const CANMessage& frame) {
+            analyzer->add(frame);
+        });
+    }
+
+    m_cycleRunning = true;
+    emit cycleAnalysisRunningChanged();
+    setStatus(QString("Cycle analysis: %1…").arg(path.isEmpty() ? QStringLiteral("trace")
+                                                                 : QFileInfo(path).fileName()));
+
+    auto* thread = QThread::create([this, analyzer, path, gapFactor, db = m_dbcDb]() {
+        QString error;
+        if (!path.isEmpty()) {
+            QVector<CANMessage> frames;
+            error = TraceImporter::load(path, frames);
+            for (const CANMessage& frame : std::as_const(frames))
+                analyzer->add(frame);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QVector<CycleAnalyzer::Result> results;
+        if (error.isEmpty())
+            results = analyzer->run(&db, gapFactor);
+        const qint64 ms = timer.elapsed();
+
+        QMetaObject::invokeMethod(this, [this, results, error, gapFactor, ms]() {
+            m_cycleRunning = false;
+            emit cycleAnalysisRunningChanged();
+            if (!error.isEmpty()) {
+                setStatus("Cycle analysis failed: " + error);
+                emit errorOccurred(error);
+                return;
+            }
+
+            quint64 gapCount = 0;
+            for (const auto& r : results)
+                gapCount += r.gapCount;
+            m_cycleReport.setResults(results, gapFactor);
+            setStatus(QString("Cycle analysis: %1 IDs, %2 gaps (%3 ms)")
+                          .arg(results.size()).arg(gapCount).arg(ms));
+        }, Qt::QueuedConnection);
+    });
+
+    startWorker(thread, QStringLiteral("AutoLens_CycleAnalysis"));
+    return true;
+}
+
+QModelIndex AppController::traceIndexOfFrame(double seconds, int channel, uint id) const
+{
+    const quint64 ns  = quint64(qMax(0.0, seconds) * 1e9 + 0.5);
+    const int     row = m_traceModel.rowAtTime(ns);
+    if (row < 0)
+        return {};
+
+    // Several frames can share the timestamp — find the one asked for.
+    constexpr int kMaxScan = 64;
+    const int end = qMin(m_traceModel.frameCount(), row + kMaxScan);
+    for (int r = row; r < end; ++r) {
+        const CANMessage msg = m_traceModel.messageAt(r);
+        if (msg.timestamp > ns)
+            break;
+        if (msg.channel == channel && msg.id == id) {
+            const QModelIndex idx = m_traceProxy.mapFromSource(m_traceModel.index(r, 0));
+            if (idx.isValid())
+                return idx;
+            break;   // filtered out — fall back to the nearest visible row
+        }
+    }
+    return traceIndexAtTime(seconds);
+}
+
+// ============================================================================
+//  Trace Compare
+// ============================================================================
+
+bool AppController::compareTraces(const QString& baselinePath, const QString& candidatePath,
+                                  bool bySequence)
+{
+    if (m_compareRunning)
+        return false;
+
+    const QString basePath = stripFileUrl(baselinePath);
+    const QString candPath = stripFileUrl(candidatePath);
+    m_compareRunning = true;
+    emit compareRunningChanged();
+    setStatus(QString("Comparing %1 ↔ %2…")
+                  .arg(QFileInfo(basePath).fileName(), QFileInfo(candPath).fileName()));
+
+    const auto align = bySequence ? TraceDiff::Align::BySequence : TraceDiff::Align::ByTime;
+    auto* thread = QThread::create([this, basePath, candPath, align, db = m_dbcDb]() {
+        QVector<CANMessage> baseline, candidate;
+        QString error = TraceImporter::load(basePath, baseline);
+        if (error.isEmpty())
+            error = TraceImporter::load(candPath, candidate);
+
+        QElapsedTimer timer;
+        timer.start();
+        QVector<TraceDiff::MessageDiff> result;
+        if (error.isEmpty())
+            result = TraceDiff::compare(baseline, candidate, db.isEmpty() ? nullptr : &db, align);
+        const qint64 ms = timer.elapsed();
+
+        QMetaObject::invokeMethod(this, [this, result, error, ms]() {
+            m_compareRunning = false;
+            if (!error.isEmpty()) {
+                emit compareRunningChanged();
+                setStatus("Compare failed: " + error);
+                emit errorOccurred(error);
+                return;
+            }
+            m_compare = result;
+            emit compareRunningChanged();
+
+            int differing = 0;
+            for (const auto& d : std::as_const(m_compare))
+                if (d.differs(0.1)) ++differing;
+            setStatus(QString("Compare: %1 of %2 messages differ (%3 ms)")
+                          .arg(differing).arg(m_compare.size()).arg(ms));
+        }, Qt::QueuedConnection);
+    });
+
+    startWorker(thread, QStringLiteral("AutoLens_TraceCompare"));
+    return true;
+}
+
+QVariantList AppController::compareMessages(bool differingOnly, double cycleTolerance) const
+{
+    QVariantList list;
+    for (int i = 0; i < m_compare.size(); ++i) {
+        const TraceDiff::MessageDiff& d = m_compare[i];
+        const bool differs = d.differs(cycleTolerance);
+        if (differingOnly && !differs)
+            continue;
+
+        QVariantList sigs;
+        for (const auto& s : d.signalDiffs) {
+            sigs.append(QVariantMap{
+                { "name",       s.name                           },
+                { "unit",       s.unit                           },
+                { "compared",   static_cast<double>(s.compared)  },
+                { "differing",  static_cast<double>(s.differing) },
+                { "maxAbsDiff", s.maxAbsDiff                     }
+            });
+        }
+
+        const char* status = d.status == TraceDiff::Status::OnlyInBaseline  ? "baseline"
+                           : d.status == TraceDiff::Status::OnlyInCandidate ? "candidate"
+                                                                            : "common";
+        list.append(QVariantMap{
+            { "index",        i                                    },
+            { "channel",      d.channel                            },
+            { "id",           d.id                                 },
+            { "extended",     d.extended                           },
+            { "name",         d.name                               },
+            { "status",       QString::fromLatin1(status)          },
+            { "baseFrames",   static_cast<double>(d.baseFrames)    },
+            { "candFrames",   static_cast<double>(d.candFrames)    },
+            { "baseCycleMs",  d.baseCycleMs                        },
+            { "candCycleMs",  d.candCycleMs                        },
+            { "aligned",      static_cast<double>(d.aligned)       },
+            { "onlyBase",     static_cast<double>(d.onlyBase)      },
+            { "onlyCand",     static_cast<double>(d.onlyCand)      },
+            { "payloadDiffs", static_cast<double>(d.payloadDiffs)  },
+            { "hitCount",     static_cast<double>(d.hitCount)      },
+            { "differs",      differs                              },
+            { "signals",      sigs                                 }
+        });
+    }
+    return list;
+}
+
+QVariantList AppController::compareHits(int index) const
+{
+    QVariantList list;
+    if (index < 0 || index >= m_compare.size())
+        return list;
+
+    auto hex = [](const CANMessage& m) {
+        const QByteArray bytes(reinterpret_cast<const char*>(m.data), m.dataLength());
+        return QString::fromLatin1(bytes.toHex(' ').toUpper());
+    };
+
+    const TraceDiff::MessageDiff& d = m_compare[index];
+    list.reserve(d.hits.size());
+    for (const TraceDiff::Hit& h : d.hits) {
+        const char* kind = h.kind == TraceDiff::Hit::Signal         ? "signal"
+                         : h.kind == TraceDiff::Hit::Payload        ? "payload"
+                         : h.kind == TraceDiff::Hit::OnlyInBaseline ? "baseline"
+                                                                    : "candidate";
+        list.append(QVariantMap{
+            { "kind",      QString::fromLatin1(kind)                                     },
+            { "signal",    h.signal >= 0 ? d.signalDiffs[h.signal].name : QString()      },
+            { "baseSec",   h.baseNs >= 0 ? h.baseNs / 1e9 : -1.0                         },
+            { "candSec",   h.candNs >= 0 ? h.candNs / 1e9 : -1.0                         },
+            { "baseValue", h.baseValue                                                   },
+            { "candValue", h.candValue                                                   },
+            { "baseData",  h.baseNs >= 0 ? hex(h.base) : QString()                       },
+            { "candData",  h.candNs >= 0 ? hex(h.cand) : QString()                       }
+        });
+    }
+    return list;
+}
+
+void AppController::setFrameSharing(bool enabled)
+{
+    if (enabled == m_frameRing.isOpen())
+        return;
+
+    QSettings settings;
+    if (enabled) {
+        const QString error = m_frameRing.open(
+            settings.value("Share/name", SharedFrameRing::defaultName()).toString(),
+            settings.value("Share/slots", SharedFrameRing::DEFAULT_SLOTS).toInt());
+        if (!error.isEmpty()) {
+            qWarning() << "[AppController] Frame sharing failed:" << error;
+            emit errorOccurred("Frame sharing failed: " + error);
+            emit frameSharingChanged();   // let the QML switch snap back
+            return;
+        }
+        setStatus("Sharing frames via " + m_frameRing.name());
+    } else {
+        m_frameRing.close();
+    }
+    settings.setValue("Share/enabled", enabled);
+    emit frameSharingChanged();
+}
+
+QVariantMap AppController::frameSharingInfo() const
+{
+    return {
+        { "name",      m_frameRing.isOpen() ? m_frameRing.name()
+                                            : SharedFrameRing::defaultName() },
+        { "published", static_cast<double>(m_frameRing.published()) },
+    };
+}
+
+void AppController::setSignalStreaming(bool enabled)
+{
+    if (enabled == m_signalStream.isRunning())
+        return;
+
+    QSettings settings;
+    if (enabled) {
+        const QString error = m_signalStream.start(static_cast<quint16>(
+            settings.value("Stream/port", SignalStreamServer::DEFAULT_PORT).toUInt()));
+        if (!error.isEmpty()) {
+            qWarning() << "[AppController] Signal streaming failed:" << error;
+            emit errorOccurred("Signal streaming failed: " + error);
+            emit signalStreamingChanged();   // let the QML switch snap back
+            return;
+        }
+        setStatus(QString("Streaming signals on 127.0.0.1:%1").arg(m_signalStream.port()));
+    } else {
+        m_signalStream.stop();
+    }
+    settings.setValue("Stream/enabled", enabled);
+    emit signalStreamingChanged();
+}
+
+QVariantMap AppController::signalStreamInfo() const
+{
+    QVariantList clients;
+    for (const auto& c : m_signalStream.clientStats()) {
+        clients.append(QVariantMap{
+            { "peer",      c.peer                            },
+            { "webSocket", c.webSocket                       },
+            { "signals",   c.signalCount                     },
+            { "rateHz",    c.rateHz                          },
+            { "updates",   static_cast<double>(c.updates)    },
+            { "skipped",   static_cast<double>(c.skipped)    },
+        });
+    }
+    return {
+        { "port",    m_signalStream.port() },
+        { "clients", clients               },
+    };
+}
+
+void AppController::setMetricsEnabled(bool enabled)
+{
+    if (enabled == m_metricsExporter.isRunning())
+        return;
+
+    QSettings settings;
+    if (enabled) {
+        const QString error = m_metricsExporter.start(
+            static_cast<quint16>(settings.value("Metrics/port", MetricsExporter::DEFAULT_PORT).toUInt()),
+            settings.value("Metrics/file").toString(),
+            settings.value("Metrics/fileIntervalMs", MetricsExporter::DEFAULT_FILE_INTERVAL_MS).toInt());
+        if (!error.isEmpty()) {
+            qWarning() << "[AppController] Metrics export failed:" << error;
+            emit errorOccurred("Metrics export failed: " + error);
+            emit metricsEnabledChanged();   // let the QML switch snap back
+            return;
+        }
+        for (ChannelMetrics& cm : m_channelMetrics) {
+            cm.lastFrames = cm.frames->value();
+            cm.lastBusyNs = cm.busyNs->value();
+        }
+        m_metricsClock.start();
+        m_metricsActive.store(true);
+        m_metricsTimer.start();
+        sampleMetrics();
+        setStatus(m_metricsExporter.port()
+                      ? QString("Metrics on http://127.0.0.1:%1/metrics").arg(m_metricsExporter.port())
+                      : "Metrics written to " + m_metricsExporter.filePath());
+    } else {
+        m_metricsTimer.stop();
+        m_metricsActive.store(false);
+        m_metricsExporter.stop();
+    }
+    settings.setValue("Metrics/enabled", enabled);
+    emit metricsEnabledChanged();
+}
+
+QVariantMap AppController::metricsInfo() const
+{
+    QSettings settings;
+    return {
+        { "port", m_metricsExporter.isRunning()
+                      ? m_metricsExporter.port()
+                      : settings.value("Metrics/port", MetricsExporter::DEFAULT_PORT).toUInt() },
+        { "file", settings.value("Metrics/file").toString() },
+    };
+}
+
+void AppController::setFlightRecorder(bool enabled)
+{
+    if (enabled == m_flightRecorder.isRunning())
+        return;
+
+    QSettings settings;
+    if (enabled) {
+        QSet<uint32_t> ids;
+        for (const QString& hex : settings.value("Recorder/triggerIds").toStringList()) {
+            bool ok = false;
+            const uint32_t id = hex.trimmed().toUInt(&ok, 16);
+            if (ok)
+                ids.insert(id);
+        }
+        m_flightRecorder.setTrigger(ids, settings.value("Recorder/triggerOnError", false).toBool());
+        m_flightRecorder.start(
+            settings.value("Recorder/windowMin", FlightRecorder::DEFAULT_WINDOW_MIN).toInt(),
+            settings.value("Recorder/budgetMB", FlightRecorder::DEFAULT_BUDGET_MB).toLongLong());
+        setStatus(QString("Flight recorder: keeping the last %1 min")
+                      .arg(m_flightRecorder.windowMinutes()));
+    } else {
+        m_flightRecorder.stop();
+    }
+    settings.setValue("Recorder/enabled", enabled);
+    emit flightRecorderChanged();
+}
+
+bool AppController::dumpFlightRecorder(const QString& filePath)
+{
+    if (!m_flightRecorder.isRunning()) {
+        emit errorOccurred("Flight recorder is off");
+        return false;
+    }
+    if (m_flightRecorder.isDumping()) {
+        emit errorOccurred("Flight recorder dump already in progress");
+        return false;
+    }
+
+    QString path = stripFileUrl(filePath);
+    if (path.isEmpty()) {
+        const QString dir = flightRecorderStats().value("dir").toString();
+        if (!QDir().mkpath(dir)) {
+            emit errorOccurred("Cannot create " + dir);
+            return false;
+        }
+        path = QDir(dir).filePath(QDateTime::currentDateTime()
+                                      .toString("'flight_'yyyyMMdd_HHmmss'.blf'"));
+    }
+
+    if (!m_flightRecorder.dump(path)) {
+        emit errorOccurred("Flight recorder holds no frames yet");
+        return false;
+    }
+    setStatus("Flight recorder: writing " + QFileInfo(path).fileName() + "...");
+    return true;
+}
+
+QVariantMap AppController::flightRecorderStats() const
+{
+    QSettings settings;
+    const auto st = m_flightRecorder.stats();
+    return {
+        { "frames",          static_cast<double>(st.frames)    },
+        { "segments",        st.segments                       },
+        { "compressedBytes", static_cast<double>(st.compressedBytes) },
+        { "rawBytes",        static_cast<double>(st.rawBytes)  },
+        { "spanSec",         st.newestNs > st.oldestNs ? (st.newestNs - st.oldestNs) / 1e9 : 0.0 },
+        { "windowMin",       m_flightRecorder.windowMinutes()  },
+        { "dir",             settings.value("Recorder/dir",
+                                 QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)
+                                     + "/AutoLens/FlightRecorder").toString() },
+    };
+}
+
+// ============================================================================
+//  Crash-safe journal
+// ============================================================================
+
+void AppController::setJournaling(bool enabled)
+{
+    if (enabled == m_journal.isRunning())
+        return;
+
+    QSettings settings;
+    if (enabled) {
+        const QString dir = journalStats().value("dir").toString();
+        if (!QDir().mkpath(dir)) {
+            emit errorOccurred("Cannot create " + dir);
+            return;
+        }
+        const QString path = QDir(dir).filePath(QDateTime::currentDateTime()
+                                                    .toString("'journal_'yyyyMMdd_HHmmss'.alj'"));
+        const QString err = m_journal.start(path);
+        if (!err.isEmpty()) {
+            emit errorOccurred("Journal: " + err);
+            return;
+        }
+        setStatus("Journaling to " + QFileInfo(path).fileName());
+    } else {
+        m_journal.stop();
+        setStatus("Journal closed");
+    }
+    settings.setValue("Journal/enabled", enabled);
+    emit journalingChanged();
+}
+
+QVariantMap AppController::journalStats() const
+{
+    QSettings settings;
+    const auto st = m_journal.stats();
+    return {
+        { "path",        st.path                               },
+        { "frames",      static_cast<double>(st.frames)        },
+        { "blocks",      static_cast<double>(st.blocks)        },
+        { "checkpoints", static_cast<double>(st.checkpoints)   },
+        { "bytes",       static_cast<double>(st.bytes)         },
+        { "error",       st.error                              },
+        { "dir",         settings.value("Journal/dir",
+                             QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)
+                                 + "/AutoLens/Journal").toString() },
+    };
+}
+
+QVariantMap AppController::scanJournal(const QString& filePath)
+{
+    const QString path = stripFileUrl(filePath);
+    QElapsedTimer timer;
+    timer.start();
+    TraceJournal::Index index;
+    const QString err = TraceJournal::scan(path, index);
+    if (!err.isEmpty())
+        return { { "error", err } };
+
+    return {
+        { "frames",      static_cast<double>(index.frames)     },
+        { "blocks",      index.blocks.size()                   },
+        { "checkpoints", index.checkpoints                     },
+        { "tailBlocks",  index.tailBlocks                      },
+        { "fileBytes",   static_cast<double>(index.fileBytes)  },
+        { "validBytes",  static_cast<double>(index.validBytes) },
+        { "clean",       index.clean                           },
+        { "startTime",   QDateTime::fromMSecsSinceEpoch(index.startEpochMs) },
+        { "firstSec",    index.blocks.isEmpty() ? 0.0 : index.blocks.first().firstNs / 1e9 },
+        { "lastSec",     index.blocks.isEmpty() ? 0.0 : index.blocks.last().lastNs / 1e9   },
+        { "scanMs",      static_cast<double>(timer.elapsed())  },
+    };
+}
+
+// ============================================================================
+//  Trace overview (minimap)
+// ============================================================================
+
+QVariantMap AppController::traceOverview(int columns, double fromSec, double toSec)
+{
+    const qint64 firstNs = m_traceOverview.firstNs();
+    const qint64 endNs   = m_traceOverview.endNs();
+    const qint64 fromNs  = fromSec < 0 ? firstNs : qint64(fromSec * 1e9);
+    const qint64 toNs    = toSec   < 0 ? endNs   : qint64(toSec * 1e9);
+    columns = qBound(1, columns, 8192);
+
+    const auto cols = m_traceOverview.query(fromNs, toNs, columns);
+
+    QVariantList frames[TraceOverview::CHANNELS];
+    QVariantList errors, load, sigMin, sigMax;
+    quint32 maxFrames = 0;
+    constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+    for (const TraceOverview::Column& c : cols) {
+        quint32 total = 0;
+        double  busiest = 0;
+        for (int ch = 0; ch < TraceOverview::CHANNELS; ++ch) {
+            frames[ch].append(c.sum.frames[ch]);
+            total  += c.sum.frames[ch];
+            if (c.coveredNs > 0)
+                busiest = qMax(busiest, double(c.sum.busyNs[ch]) / double(c.coveredNs));
+        }
+        maxFrames = qMax(maxFrames, total);
+        errors.append(c.sum.errors);
+        load.append(qMin(1.0, busiest));
+        sigMin.append(c.sum.hasSignal ? double(c.sum.signalMin) : kNaN);
+        sigMax.append(c.sum.hasSignal ? double(c.sum.signalMax) : kNaN);
     }
 
-    return e;
+    QVariantList framesPerChannel;
+    for (const QVariantList& f : frames)
+        framesPerChannel.append(QVariant(f));
+
+    QSettings settings;
+    return {
+        { "firstSec",  firstNs / 1e9 },
+        { "endSec",    endNs / 1e9 },
+        { "fromSec",   fromNs / 1e9 },
+        { "toSec",     toNs / 1e9 },
+        { "columns",   cols.size() },
+        { "frames",    framesPerChannel },
+        { "errors",    errors },
+        { "load",      load },
+        { "maxFrames", maxFrames },
+        { "hasSignal", m_traceOverview.hasSignal() },
+        { "signal",    m_traceOverview.hasSignal()
+                           ? settings.value("Overview/message").toString() + "."
+                                 + settings.value("Overview/signal").toString()
+                           : QString() },
+        { "sigMin",    sigMin },
+        { "sigMax",    sigMax },
+    };
+}
+
+bool AppController::setOverviewSignal(const QString& messageName, const QString& signalName)
+{
+    QSettings settings;
+    settings.setValue("Overview/message", messageName.trimmed());
+    settings.setValue("Overview/signal",  signalName.trimmed());
+    applyOverviewSignal();
+
+    if (!messageName.trimmed().isEmpty() && !m_traceOverview.hasSignal()) {
+        const QString err = QString("Overview: signal %1.%2 is not in the loaded DBC")
+                                .arg(messageName, signalName);
+        setStatus(err);
+        emit errorOccurred(err);
+        return false;
+    }
+    return true;
+}
+
+void AppController::applyOverviewSignal()
+{
+    QSettings settings;
+    const QString msgName = settings.value("Overview/message").toString();
+    const QString sigName = settings.value("Overview/signal").toString();
+
+    const DBCMessage* msg = msgName.isEmpty() ? nullptr : m_dbcDb.messageByName(msgName);
+    const DBCSignal*  sig = nullptr;
+    const DBCSignal*  mux = nullptr;
+    if (msg) {
+        for (const DBCSignal& s : msg->signalList) {
+            if (s.name == sigName)
+                sig = &s;
+            if (s.muxIndicator == QStringLiteral("M"))
+                mux = &s;
+        }
+    }
+
+    if (!sig) {
+        m_traceOverview.clearSignal();
+        return;
+    }
+
+    // Fill the min/max for frames already in the trace, not just new ones.
+    m_traceOverview.setSignal(msg->id, *sig, mux);
+    m_traceModel.forEachMessage([this](const CANMessage& frame) {
+        m_traceOverview.addSignal(frame);
+    });
+}
+
+QModelIndex AppController::traceIndexAtTime(double seconds) const
+{
+    const int row = m_traceModel.rowAtTime(quint64(qMax(0.0, seconds) * 1e9));
+    if (row < 0)
+        return {};
+
+    // The row may be hidden by the filter — take the next one that is not.
+    constexpr int kMaxScan = 4096;
+    const int end = qMin(m_traceModel.frameCount(), row + kMaxScan);
+    for (int r = row; r < end; ++r) {
+        const QModelIndex idx = m_traceProxy.mapFromSource(m_traceModel.index(r, 0));
+        if (idx.isValid())
+            return idx;
+    }
+    return {};
+}
+
+QVariantMap AppController::traceViewStats() const
+{
+    const TraceModel::ViewStats st = m_traceModel.viewStats();
+    const double steps = static_cast<double>(qMax<quint64>(1, st.scrollSteps));
+    return {
+        { "dataCalls",        static_cast<double>(st.dataCalls)      },
+        { "rowCalls",         static_cast<double>(st.rowCalls)       },
+        { "snapshotBuilds",   static_cast<double>(st.snapshotBuilds) },
+        { "scrollSteps",      static_cast<double>(st.scrollSteps)    },
+        { "dataCallsPerStep", st.dataCalls / steps                   },
+        { "buildsPerStep",    st.snapshotBuilds / steps              },
+    };
+}
+
+void AppController::resetTraceViewStats()
+{
+    m_traceModel.resetViewStats();
+}
+
+void AppController::registerMetrics()
+{
+    auto& metrics = MetricsRegistry::instance();
+
+    for (int i = 0; i < MAX_CHANNELS; ++i) {
+        const QString label = QString("channel=\"%1\"").arg(i + 1);
+        ChannelMetrics& cm = m_channelMetrics[i];
+        cm.frames      = metrics.counter("autolens_rx_frames", "Frames received", label);
+        cm.errorFrames = metrics.counter("autolens_rx_error_frames", "Error frames received", label);
+        cm.busyNs      = metrics.counter("autolens_bus_busy_seconds",
+                                         "On-wire time of received frames", label, 1e-9);
+        cm.captureDrops = metrics.counter("autolens_capture_filtered_frames",
+                                          "Frames dropped by the capture pre-filter", label);
+        cm.frameRate   = metrics.gauge("autolens_rx_frame_rate",
+                                       "Frames per second over the last sample interval", label);
+        cm.busLoad     = metrics.gauge("autolens_bus_load_ratio",
+                                       "Bus load over the last sample interval (0..1)", label);
+    }
+
+    m_metricPending      = metrics.gauge("autolens_capture_pending_frames",
+                                         "Frames waiting for the next decode submit");
+    m_metricDecodeJobs   = metrics.gauge("autolens_decode_jobs_in_flight",
+                                         "Decode jobs submitted but not yet collected");
+    m_metricTraceFrames  = metrics.gauge("autolens_trace_frames", "Frames held by the trace");
+    m_metricTraceEncoded = metrics.gauge("autolens_trace_encoded_bytes",
+                                         "Bytes held by sealed (encoded) trace segments");
+    m_metricMemoHitRatio = metrics.gauge("autolens_decode_memo_hit_ratio",
+                                         "Share of signal decodes served by the decode memo");
+    m_metricMemoHits     = metrics.counter("autolens_decode_memo_lookups",
+                                           "Signal decodes served from / missing in the decode memo",
+                                           "result=\"hit\"");
+    m_metricMemoMisses   = metrics.counter("autolens_decode_memo_lookups",
+                                           "Signal decodes served from / missing in the decode memo",
+                                           "result=\"miss\"");
+    m_metricRss          = metrics.gauge("autolens_process_resident_memory_bytes",
+                                         "Resident set size of the process");
+    m_metricScriptDrops  = metrics.counter("autolens_dropped", "Items dropped for a full queue",
+                                           "queue=\"scripts\"");
+    m_metricResidualDrops = metrics.counter("autolens_dropped", "Items dropped for a full queue",
+                                            "queue=\"residual_updates\"");
+}
+
+void AppController::sampleMetrics()
+{
+    // Rates are computed from the counter deltas over the real interval,
+    // not the nominal 1 s — a busy UI thread makes the timer late.
+    const double seconds = qMax<qint64>(1, m_metricsClock.restart()) / 1000.0;
+    for (ChannelMetrics& cm : m_channelMetrics) {
+        const quint64 frames = cm.frames->value();
+        const quint64 busyNs = cm.busyNs->value();
+        cm.frameRate->set(double(frames - cm.lastFrames) / seconds);
+        cm.busLoad->set(qMin(1.0, double(busyNs - cm.lastBusyNs) * 1e-9 / seconds));
+        cm.lastFrames = frames;
+        cm.lastBusyNs = busyNs;
+    }
+    for (const auto& st : m_captureFilter.stats())
+        if (st.channel >= 1 && st.channel <= MAX_CHANNELS)
+            m_channelMetrics[st.channel - 1].captureDrops->set(st.filtered);
+
+    m_metricPending->set(m_pending.size());
+    m_metricDecodeJobs->set(m_decodePipeline.jobsInFlight());
+    m_metricTraceFrames->set(m_traceModel.frameCount());
+    m_metricTraceEncoded->set(double(m_traceModel.encodedBytes()));
+    {
+        // Ratio over the last interval, so a change of traffic shows up.
+        const quint64 hits   = m_metricMemoHits->value();
+        const quint64 misses = m_metricMemoMisses->value();
+        const quint64 lookups = (hits - m_lastMemoHits) + (misses - m_lastMemoMisses);
+        if (lookups > 0)
+            m_metricMemoHitRatio->set(double(hits - m_lastMemoHits) / double(lookups));
+        m_lastMemoHits   = hits;
+        m_lastMemoMisses = misses;
+    }
+    m_metricScriptDrops->set(m_scriptHost.droppedFrames());
+    m_metricResidualDrops->set(m_residualBus.stats().droppedUpdates);
+
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS pmc{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        m_metricRss->set(double(pmc.WorkingSetSize));
+#elif defined(Q_OS_LINUX)
+    // statm: size resident shared … in pages
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1)
+            m_metricRss->set(fields[1].toDouble() * double(sysconf(_SC_PAGESIZE)));
+    }
+#endif
+}
+
+void AppController::countLogBytes(const QString& format, const QString& path, qint64 elapsedNs)
+{
+    // Exporters write whole files, so size and wall time per save give the
+    // writer throughput; registration is idempotent, so this is the lookup.
+    auto& metrics = MetricsRegistry::instance();
+    const QString label = QString("format=\"%1\"").arg(format);
+    metrics.counter("autolens_log_bytes_written", "Bytes written by trace log writers",
+                    label)->add(quint64(qMax<qint64>(0, QFileInfo(path).size())));
+    metrics.counter("autolens_log_write_seconds", "Time spent writing trace logs",
+                    label, 1e-9)->add(quint64(elapsedNs));
+}
+
+QVariantList AppController::gatewayStats() const
+{
+    QVariantList list;
+    for (const auto& st : m_gateway.stats()) {
+        list.append(QVariantMap{
+            { "route",     st.name                              },
+            { "matched",   static_cast<double>(st.matched)      },
+            { "forwarded", static_cast<double>(st.forwarded)    },
+            { "filtered",  static_cast<double>(st.filtered)     },
+            { "txErrors",  static_cast<double>(st.txErrors)     },
+            { "avgUs",     st.avgUs                             },
+            { "maxUs",     st.maxUs                             }
+        });
+    }
+    return list;
+}
+
+// ============================================================================
+//  Capture Filter
+// ============================================================================
+
+QString AppController::setCaptureFilter(const QString& json)
+{
+    const QString error = m_captureFilter.setConfig(json);
+    if (!error.isEmpty())
+        return error;
+
+    if (m_connected)
+        m_captureHardware = m_driver->applyAcceptanceFilter();
+    QSettings settings;
+    settings.setValue("Capture/filter", json);
+    setStatus(m_captureFilter.isActive()
+                  ? QString("Capture filter active%1").arg(m_captureHardware ? " (hardware + software)" : "")
+                  : QStringLiteral("Capture filter cleared"));
+    return {};
+}
+
+QVariantMap AppController::captureFilterStats() const
+{
+    QVariantList channels;
+    for (const auto& st : m_captureFilter.stats()) {
+        channels.append(QVariantMap{
+            { "channel",  st.channel                          },
+            { "passed",   static_cast<double>(st.passed)      },
+            { "filtered", static_cast<double>(st.filtered)    }
+        });
+    }
+    return QVariantMap{
+        { "active",   m_captureFilter.isActive()                 },
+        { "hardware", m_connected && m_captureHardware           },
+        { "channels", channels                                   }
+    };
+}
+
+// ============================================================================
+//  Thread Placement
+// ============================================================================
+
+QString AppController::setThreadPlacement(const QString& json)
+{
+    const QString error = ThreadPlacement::instance().setConfig(json);
+    if (!error.isEmpty())
+        return error;
+
+    QSettings settings;
+    settings.setValue("Threads/placement", json);
+
+    int failed = 0;
+    for (const auto& t : ThreadPlacement::instance().threads())
+        if (!t.result.isEmpty()) ++failed;
+    setStatus(failed ? QString("Thread placement: %1 thread(s) not fully placed").arg(failed)
+                     : QStringLiteral("Thread placement applied"));
+    return {};
+}
+
+QString AppController::threadPlacement() const
+{
+    return ThreadPlacement::instance().config();
+}
+
+QVariantList AppController::placedThreads() const
+{
+    QVariantList list;
+    for (const auto& t : ThreadPlacement::instance().threads()) {
+        list.append(QVariantMap{
+            { "name",   t.name                              },
+            { "role",   ThreadPlacement::roleName(t.role)   },
+            { "result", t.result                            }
+        });
+    }
+    return list;
+}
+
+void AppController::measureThreadLatency(int durationMs)
+{
+    // The probe sleeps for the whole duration — never on the UI thread.
+    auto* thread = QThread::create([this, durationMs]() {
+        const auto stats = ThreadPlacement::instance().measureWakeLatency(durationMs);
+        QVariantList results;
+        for (const auto& ws : stats) {
+            results.append(QVariantMap{
+                { "role",    ThreadPlacement::roleName(ws.role)  },
+                { "samples", static_cast<double>(ws.samples)     },
+                { "minUs",   ws.minUs                            },
+                { "avgUs",   ws.avgUs                            },
+                { "p99Us",   ws.p99Us                            },
+                { "maxUs",   ws.maxUs                            },
+                { "result",  ws.result                           }
+            });
+        }
+        QMetaObject::invokeMethod(this, [this, results]() {
+            emit threadLatencyMeasured(results);
+        }, Qt::QueuedConnection);
+    });
+    startWorker(thread, QStringLiteral("AutoLens_LatencyProbe"));
+}
+
+// ============================================================================
+//  Node Scripts
+// ============================================================================
+
+bool AppController::loadScripts(const QStringList& paths)
+{
+    if (!m_connected) {
+        emit errorOccurred("Not connected — cannot load scripts");
+        return false;
+    }
+
+    QStringList files;
+    for (const QString& p : paths)
+        files.append(stripFileUrl(p));
+    if (files.isEmpty())
+        return false;
+
+    // Scripts resolve message names against the per-channel DBCs.
+    for (int i = 0; i < MAX_CHANNELS; ++i) {
+        m_scriptHost.setChannelDatabase(
+            i + 1, m_channelConfigs[i].enabled ? m_channelDbs[i] : DBCDatabase());
+    }
+
+    m_scriptPaths = files;
+    QSettings settings;
+    settings.setValue("Simulation/scripts", m_scriptPaths);
+
+    setStatus(QString("Loading %1 node script(s)").arg(files.size()));
+    return m_scriptHost.load(files);
+}
+
+void AppController::unloadScripts()
+{
+    if (!m_scriptHost.isRunning())
+        return;
+    m_scriptHost.unload();
+    setStatus("Node scripts unloaded");
+}
+
+QStringList AppController::scriptPaths() const
+{
+    return m_scriptPaths;
+}
+
+QVariantList AppController::scriptHandlerStats() const
+{
+    QVariantList list;
+    const auto stats = m_scriptHost.handlerStats();
+    list.reserve(stats.size());
+    for (const auto& s : stats) {
+        list.append(QVariantMap{
+            { "node",    s.node                          },
+            { "handler", s.description                   },
+            { "calls",   static_cast<double>(s.calls)    },
+            { "errors",  static_cast<double>(s.errors)   },
+            { "avgUs",   s.avgUs                         },
+            { "maxUs",   s.maxUs                         }
+        });
+    }
+    return list;
+}
+
+// ============================================================================
+//  Frame Reception
+// ============================================================================
+
+void AppController::onFrameReceived(const CANMessage& msg)
+{
+    // Node scripts react to traffic whether or not the trace is recording.
+    // dispatch() is a bitmap test for frames no script subscribed to.
+    if (!msg.isTxConfirm)
+        m_scriptHost.dispatch(msg);
+
+    // -----------------------------------------------------------------------
+    //  Discard frames when not measuring.
+    //
+    //  WHY check here rather than in flushPendingFrames(): we don't want
+    //  m_pending to grow unboundedly when connected-but-not-measuring.
+    //  Dropping here keeps memory usage O(batch size) not O(time connected).
+    // -----------------------------------------------------------------------
+    if (!m_measuring || m_paused) return;
+
+    if (msg.isTxConfirm) return;   // skip TX echoes (optional — could expose as setting)
+
+    m_pending.append(msg);
+    ++m_framesSinceLastSec;
+}
+
+// ============================================================================
+//  50 ms flush timer — batch insert into TraceModel
+// ============================================================================
+
+void AppController::flushPendingFrames()
+{
+    if (m_pending.isEmpty()) return;
+
+    // While paused, m_pending accumulates but we don't flush until resume.
+    // pauseMeasurement() calls flushPendingFrames() manually on resume.
+    if (m_paused) return;
+
+#ifndef QT_NO_DEBUG
+    qDebug() << "[Flush] batch=" << m_pending.size()
+             << "measuring=" << m_measuring
+             << "mode=" << (m_inPlaceDisplayMode ? "InPlace" : "Append")
+             << "frames_before=" << m_traceModel.frameCount()
+             << "jobs_in_flight=" << m_decodePipeline.jobsInFlight();
+#endif
+
+    // ── Hand the batch to the decode workers ──────────────────────────────
+    //  TraceEntryBuilder::build() does string formatting (QString::number,
+    //  arg, toUpper) plus DBC signal decoding.  At high bus loads (1000+ fps) this is the
+    //  most CPU-intensive work in the flush path.
+    //
+    //  WHY submit (not blockingMapped): the UI thread only enqueues here and
+    //  returns immediately.  Decoded entries come back in capture order via
+    //  DecodePipeline::batchesReady → onDecodedBatches().  If the job ring is
+    //  full, submit() leaves the remainder in m_pending for the next tick.
+    m_decodePipeline.submit(m_pending);
+}
+
+// ============================================================================
+//  Decoded batches → TraceModel
+// ============================================================================
+
+void AppController::onDecodedBatches()
+{
+    m_decodedBatch.clear();   // Qt 6 keeps capacity — no per-batch allocation
+    if (m_decodePipeline.takeCompleted(m_decodedBatch) == 0)
+        return;
+
+    // Dashboards get the values decoded for the trace — no second decode
+    m_signalStream.ingest(m_decodedBatch);
+
+    for (const TraceEntry& e : std::as_const(m_decodedBatch)) {
+        m_traceOverview.add(e.msg);
+        m_latency.process(e.msg);
+    }
+
+    m_traceModel.addEntries(m_decodedBatch);
+    m_decodedBatch.clear();
+    emit frameCountChanged();
+
+#ifndef QT_NO_DEBUG
+    qDebug() << "[Flush] frames_after=" << m_traceModel.frameCount();
+#endif
 }
 
 // ============================================================================
@@ -1409,6 +2933,45 @@ void AppController::loadSettings()
 
     // Trace display mode (false=append, true=in-place)
     m_inPlaceDisplayMode = settings.value("Trace/inPlaceDisplayMode", false).toBool();
+
+    // Residual bus node selection ("ch:node" keys) and node scripts
+    m_residualBus.setEnabledNodeKeys(settings.value("Simulation/nodes").toStringList());
+    m_scriptPaths = settings.value("Simulation/scripts").toStringList();
+
+    m_driverBackend = settings.value("Driver/backend", QStringLiteral("auto")).toString();
+    m_udpLocalPort  = static_cast<quint16>(
+        settings.value("Driver/udpLocalPort", UdpCANDriver::DEFAULT_PORT).toUInt());
+    m_udpPeer       = settings.value("Driver/udpPeer", QStringLiteral("127.0.0.1:20000")).toString();
+
+    // Gateway routes compile once the channel DBCs are parsed (configureGateway)
+    m_gatewayRoutes = settings.value("Gateway/routes").toString();
+    m_gateway.setEnabled(settings.value("Gateway/enabled", false).toBool());
+
+    // Threads started later pick their placement up in their Scope
+    const QString placementError =
+        ThreadPlacement::instance().setConfig(settings.value("Threads/placement").toString());
+    if (!placementError.isEmpty())
+        qWarning() << "[AppController] Thread placement not loaded:" << placementError;
+
+    const QString captureError = m_captureFilter.setConfig(settings.value("Capture/filter").toString());
+    if (!captureError.isEmpty())
+        qWarning() << "[AppController] Capture filter not loaded:" << captureError;
+
+    // Latency pairs naming DBC messages are re-resolved in configureLatency()
+    const QString latencyError = m_latency.setPairs(settings.value("Latency/pairs").toString(), m_dbcDb);
+    if (!latencyError.isEmpty())
+        qWarning() << "[AppController] Latency pairs not loaded yet:" << latencyError;
+
+    if (settings.value("Share/enabled", false).toBool())
+        setFrameSharing(true);
+    if (settings.value("Stream/enabled", false).toBool())
+        setSignalStreaming(true);
+    if (settings.value("Metrics/enabled", false).toBool())
+        setMetricsEnabled(true);
+    if (settings.value("Recorder/enabled", false).toBool())
+        setFlightRecorder(true);
+    if (settings.value("Journal/enabled", false).toBool())
+        setJournaling(true);
     qDebug() << "[AppController] Settings loaded from persistent store";
 }
 
@@ -29,6 +29,19 @@
  *     AppController.clearTrace()                 — empty the trace table
  *     AppController.importTraceLog(path, append) — offline ASC/BLF analysis
  *     AppController.sendFrame(id, data, ext)     — transmit one frame
+ *     AppController.startResidualBus()           — simulate the selected DBC nodes
+ *     AppController.loadScripts(paths)           — run JavaScript node scripts
+ *     AppController.setDriverBackend(name)       — "auto" / "demo" / "virtual" / "udp" / "slcan"
+ *     AppController.setGatewayRoutes(json)       — route frames between channels
+ *     AppController.setCaptureFilter(json)       — per-channel ID pass lists (HW + RX thread)
+ *     AppController.setThreadPlacement(json)     — CPU pinning / RT priority per thread role
+ *     AppController.setLatencyPairs(json)        — request/response latency per pair
+ *     AppController.analyzeCycles(factor, path)  — cycle gaps / jitter report (cycleReport)
+ *     AppController.compareTraces(base, cand)    — per-message / per-signal trace diff
+ *     AppController.frameSharing = true          — publish frames to shared memory
+ *     AppController.signalStreaming = true       — serve decoded signals on localhost
+ *     AppController.metricsEnabled = true        — export pipeline metrics (OpenMetrics)
+ *     AppController.flightRecorder = true        — keep the last N minutes, dump to BLF
  *
  * ──────────────────────────────────────────────────────────────────────────
  *  CONNECT vs START — two separate user actions (like real CANoe):
@@ -50,11 +63,13 @@
  *  VectorCANDriver's async thread emits messageReceived(CANMessage) which
  *  Qt delivers to onFrameReceived() via a queued connection (automatic for
  *  cross-thread).  AppController accumulates frames in m_pending and a
- *  50 ms QTimer flushes them into TraceModel in a single batch, keeping
- *  the UI smooth even at high bus loads.
+ *  50 ms QTimer submits them to the DecodePipeline workers.  Decoded,
+ *  in-order batches come back via onDecodedBatches() and are inserted into
+ *  TraceModel in one go, keeping the UI smooth even at high bus loads.
  */
 
 #include <QObject>
+#include <QPointer>
 #include <QString>
 #include <QStringList>
 #include <QVector>
@@ -65,11 +80,31 @@
 #include <QVariantMap>
 #include <QSettings>  // WHY: persistent key-value store; Qt6::Core, no extra deps
 #include <array>
+#include <atomic>
 
 #include "hardware/CANInterface.h"
+#include "hardware/CaptureFilter.h"
+#include "hardware/VirtualCANDriver.h"
 #include "dbc/DBCParser.h"
 #include "trace/TraceModel.h"
 #include "trace/TraceFilterProxy.h"
+#include "trace/DecodePipeline.h"
+#include "trace/FlightRecorder.h"
+#include "trace/TraceJournal.h"
+#include "trace/TraceOverview.h"
+#include "analysis/LatencyAnalyzer.h"
+#include "analysis/CycleReportModel.h"
+#include "analysis/TraceDiff.h"
+#include "sim/ResidualBusSimulator.h"
+#include "sim/ScriptHost.h"
+#include "gateway/GatewayEngine.h"
+#include "ipc/SharedFrameRing.h"
+#include "stream/SignalStreamServer.h"
+#include "metrics/MetricsExporter.h"
+#include "util/ThreadPlacement.h"
+
+class MetricCounter;
+class MetricGauge;
 
 // ============================================================================
 //  Per-Channel Configuration
@@ -151,6 +186,22 @@ class AppController : public QObject
     Q_PROPERTY(bool inPlaceDisplayMode READ inPlaceDisplayMode
                WRITE setInPlaceDisplayMode NOTIFY inPlaceDisplayModeChanged)
 
+    // Simulation, gateway and capture services (Simulation / Settings pages)
+    Q_PROPERTY(bool residualBusRunning READ residualBusRunning NOTIFY residualBusRunningChanged)
+    Q_PROPERTY(bool scriptsRunning     READ scriptsRunning     NOTIFY scriptsRunningChanged)
+    Q_PROPERTY(bool gatewayEnabled     READ gatewayEnabled     WRITE setGatewayEnabled
+               NOTIFY gatewayEnabledChanged)
+    Q_PROPERTY(bool frameSharing       READ frameSharing       WRITE setFrameSharing
+               NOTIFY frameSharingChanged)
+    Q_PROPERTY(bool signalStreaming    READ signalStreaming    WRITE setSignalStreaming
+               NOTIFY signalStreamingChanged)
+    Q_PROPERTY(bool metricsEnabled     READ metricsEnabled     WRITE setMetricsEnabled
+               NOTIFY metricsEnabledChanged)
+    Q_PROPERTY(bool flightRecorder     READ flightRecorder     WRITE setFlightRecorder
+               NOTIFY flightRecorderChanged)
+    Q_PROPERTY(bool journaling         READ journaling         WRITE setJournaling
+               NOTIFY journalingChanged)
+
     // -----------------------------------------------------------------------
     //  Startup initialisation state — drives the splash screen.
     //
@@ -169,6 +220,11 @@ class AppController : public QObject
     /** Sort/filter proxy — QML TreeView binds to this instead of traceModel directly. */
     Q_PROPERTY(TraceFilterProxy* traceProxy READ traceProxy CONSTANT)
 
+    /** Result of analyzeCycles() — one row per (channel, ID). */
+    Q_PROPERTY(CycleReportModel* cycleReport READ cycleReport CONSTANT)
+    Q_PROPERTY(bool cycleAnalysisRunning READ cycleAnalysisRunning NOTIFY cycleAnalysisRunningChanged)
+    Q_PROPERTY(bool compareRunning       READ compareRunning       NOTIFY compareRunningChanged)
+
 public:
     static constexpr int MAX_CHANNELS = 4; ///< Maximum configurable CAN channels
 
@@ -189,6 +245,17 @@ public:
     bool        inPlaceDisplayMode() const { return m_inPlaceDisplayMode; }
     TraceModel* traceModel()        { return &m_traceModel; }
     TraceFilterProxy* traceProxy()   { return &m_traceProxy; }
+    CycleReportModel* cycleReport()  { return &m_cycleReport; }
+    bool        cycleAnalysisRunning() const { return m_cycleRunning; }
+    bool        compareRunning()       const { return m_compareRunning; }
+    bool        residualBusRunning() const { return m_residualBus.isRunning(); }
+    bool        scriptsRunning()     const { return m_scriptHost.isRunning(); }
+    bool        gatewayEnabled()     const { return m_gateway.isEnabled(); }
+    bool        frameSharing()       const { return m_frameRing.isOpen(); }
+    bool        signalStreaming()    const { return m_signalStream.isRunning(); }
+    bool        metricsEnabled()     const { return m_metricsExporter.isRunning(); }
+    bool        flightRecorder()     const { return m_flightRecorder.isRunning(); }
+    bool        journaling()         const { return m_journal.isRunning(); }
 
     // Splash / init properties
     QString     initStatus()  const { return m_initStatus; }
@@ -224,6 +291,26 @@ public slots:
     /** Re-scan hardware for available CAN channels (runs in background thread). */
     void refreshChannels();
 
+    /**
+     * @brief Driver backend: "auto" (Vector if present, else Demo), "demo",
+     *        "virtual" (in-process bus, see VirtualCANDriver), "udp"
+     *        (cannelloni CAN over UDP, see UdpCANDriver) or "slcan" (LAWICEL
+     *        serial adapters, see SlcanDriver).
+     *
+     * Persisted as "Driver/backend".  Switching requires a closed port and
+     * re-runs channel detection.
+     */
+    Q_INVOKABLE QString driverBackend() const { return m_driverBackend; }
+    Q_INVOKABLE bool    setDriverBackend(const QString& backend);
+
+    /**
+     * @brief UDP backend endpoint: local port to bind, peer as "host:port".
+     * Persisted as "Driver/udpLocalPort" / "Driver/udpPeer"; used on the
+     * next connect.  udpEndpoint() returns { "localPort", "peer" }.
+     */
+    Q_INVOKABLE bool        setUdpEndpoint(int localPort, const QString& peer);
+    Q_INVOKABLE QVariantMap udpEndpoint() const;
+
     /**
      * @brief Open the CAN port(s) based on the current channel configs.
      *
@@ -348,6 +435,304 @@ public slots:
      */
     Q_INVOKABLE void sendFrame(quint32 id, const QString& hexData, bool extended = false);
 
+    // -----------------------------------------------------------------------
+    //  Residual Bus Simulation
+    //
+    //  The DBC nodes (BU_) of every enabled channel can be simulated: their
+    //  messages are transmitted at GenMsgCycleTime through the active driver.
+    //  Node selection is persisted in QSettings ("Simulation/nodes").
+    // -----------------------------------------------------------------------
+
+    /**
+     * @brief List all DBC nodes of the enabled channels.
+     *
+     * Each entry: { "channel", "name", "messageCount", "cyclicCount", "selected" }.
+     */
+    Q_INVOKABLE QVariantList residualBusNodes();
+
+    /** Select / deselect one node (only while the simulation is stopped). */
+    Q_INVOKABLE void setResidualBusNodeEnabled(int channel, const QString& node, bool enabled);
+
+    /** Start transmitting the selected nodes' messages.  Requires connection. */
+    Q_INVOKABLE bool startResidualBus();
+    Q_INVOKABLE void stopResidualBus();
+
+    /** { "framesSent", "scheduled", "avgLatenessUs", "maxLatenessUs", "droppedUpdates", "txErrors" } */
+    Q_INVOKABLE QVariantMap residualBusStats() const;
+
+    /**
+     * @brief Virtual bus load and per-node arbitration counters.
+     *
+     * { "available", "frames", "busLoad", "totalLoad",
+     *   "nodes": [{ "name", "txFrames", "arbitrationLosses", "queueFull",
+     *               "maxQueueDelayUs", "queued" }, …] }
+     * "available" is false unless the virtual bus driver is active.
+     */
+    Q_INVOKABLE QVariantMap virtualBusStats() const;
+
+    /** Change one simulated signal (physical value); re-encodes only that signal. */
+    Q_INVOKABLE bool setSimSignal(int channel, const QString& message,
+                                  const QString& signalName, double value);
+
+    // -----------------------------------------------------------------------
+    //  Node Scripts (JavaScript, CAPL-like — see sim/ScriptRuntime.h)
+    //
+    //  Scripts see every received frame they subscribed to and may transmit
+    //  through the active driver.  They are unloaded on disconnect.
+    // -----------------------------------------------------------------------
+
+    /** Load one node per file (replaces loaded scripts).  Requires connection. */
+    Q_INVOKABLE bool loadScripts(const QStringList& paths);
+    Q_INVOKABLE void unloadScripts();
+
+    /** File paths of the last loaded scripts (persisted across sessions). */
+    Q_INVOKABLE QStringList scriptPaths() const;
+
+    /** [{ "node", "handler", "calls", "errors", "avgUs", "maxUs" }, …] */
+    Q_INVOKABLE QVariantList scriptHandlerStats() const;
+
+    // -----------------------------------------------------------------------
+    //  Gateway (frame routing — see gateway/GatewayEngine.h for the format)
+    //
+    //  Routes run on the driver receive thread, ahead of the trace pipeline.
+    //  The route table (JSON) and the on/off switch persist as
+    //  "Gateway/routes" and "Gateway/enabled".
+    // -----------------------------------------------------------------------
+
+    /** Compile and activate @p json.  Returns "" or the first error. */
+    Q_INVOKABLE QString setGatewayRoutes(const QString& json);
+    Q_INVOKABLE QString gatewayRoutes() const { return m_gatewayRoutes; }
+
+    /** Read a route file and activate it.  Returns "" or the error. */
+    Q_INVOKABLE QString loadGatewayRoutes(const QString& filePath);
+
+    void setGatewayEnabled(bool enabled);
+
+    /** [{ "route", "matched", "forwarded", "filtered", "txErrors", "avgUs", "maxUs" }, …] */
+    Q_INVOKABLE QVariantList gatewayStats() const;
+
+    // -----------------------------------------------------------------------
+    //  Capture filter (ID pass lists — see hardware/CaptureFilter.h)
+    //
+    //  Programmed into the interface's acceptance filter where the driver
+    //  has one, and applied on the driver receive thread before anything
+    //  else sees the frame — gateway, sharing and the trace included.
+    //  Persisted as "Capture/filter".
+    // -----------------------------------------------------------------------
+
+    /** Compile and activate @p json ("" clears).  Returns "" or the first error. */
+    Q_INVOKABLE QString setCaptureFilter(const QString& json);
+    Q_INVOKABLE QString captureFilter() const { return m_captureFilter.config(); }
+
+    /** { "active", "hardware", "channels": [{ "channel", "passed", "filtered" }, …] } */
+    Q_INVOKABLE QVariantMap captureFilterStats() const;
+
+    // -----------------------------------------------------------------------
+    //  Thread placement (affinity / real-time policy — see util/ThreadPlacement.h)
+    //
+    //  Applies to the receive, decode, logging and transmit threads, live
+    //  and future.  Persisted as "Threads/placement".
+    // -----------------------------------------------------------------------
+
+    /** Parse and apply @p json ("" restores defaults).  Returns "" or the error. */
+    Q_INVOKABLE QString setThreadPlacement(const QString& json);
+    Q_INVOKABLE QString threadPlacement() const;
+
+    /** [{ "name", "role", "result" }, …] — result is "" when fully applied */
+    Q_INVOKABLE QVariantList placedThreads() const;
+
+    /** Probe wake-up latency per role for @p durationMs (background);
+     *  the result arrives as threadLatencyMeasured(). */
+    Q_INVOKABLE void measureThreadLatency(int durationMs = 2000);
+
+    // -----------------------------------------------------------------------
+    //  Frame sharing (shared-memory ring — see ipc/autolens_ring.h)
+    //
+    //  Every received frame is written into a named shared-memory ring on
+    //  the driver thread, for other processes on this machine.  Persisted
+    //  as "Share/enabled"; "Share/name" and "Share/slots" override the
+    //  object name and ring size.
+    // -----------------------------------------------------------------------
+
+    void setFrameSharing(bool enabled);
+
+    /** { "name", "published" } */
+    Q_INVOKABLE QVariantMap frameSharingInfo() const;
+
+    // -----------------------------------------------------------------------
+    //  Signal streaming (localhost WebSocket/TCP — see
+    //  stream/SignalStreamServer.h for the protocol)
+    //
+    //  Serves the values the decode stage already produced while a
+    //  measurement runs.  Persisted as "Stream/enabled" and "Stream/port".
+    // -----------------------------------------------------------------------
+
+    void setSignalStreaming(bool enabled);
+
+    /** { "port", "clients": [{ "peer", "webSocket", "signals", "rateHz", "updates", "skipped" }] } */
+    Q_INVOKABLE QVariantMap signalStreamInfo() const;
+
+    // -----------------------------------------------------------------------
+    //  Metrics (OpenMetrics text — see metrics/MetricsRegistry.h)
+    //
+    //  Frames, bus load, drops, queue depths, decode latency, memory and
+    //  log-writer throughput, served at http://127.0.0.1:<port>/metrics and
+    //  optionally written to a file.  Persisted as "Metrics/enabled";
+    //  "Metrics/port" (0 = no HTTP), "Metrics/file" and
+    //  "Metrics/fileIntervalMs" configure the outputs.
+    //
+    //  Per-frame counters run only while export is on; a scrape therefore
+    //  covers the time since it was enabled.
+    // -----------------------------------------------------------------------
+
+    void setMetricsEnabled(bool enabled);
+
+    /** { "port", "file" } */
+    Q_INVOKABLE QVariantMap metricsInfo() const;
+
+    // -----------------------------------------------------------------------
+    //  Flight recorder (see trace/FlightRecorder.h)
+    //
+    //  Keeps the last "Recorder/windowMin" minutes of every channel in a
+    //  compressed ring capped at "Recorder/budgetMB", measuring or not.
+    //  dumpFlightRecorder() writes that window to BLF in the background;
+    //  an empty path picks a timestamped file in "Recorder/dir".
+    //  Trigger frames ("Recorder/triggerIds", hex; "Recorder/triggerOnError")
+    //  dump automatically "Recorder/postTriggerMs" after they arrive.
+    //  Persisted as "Recorder/enabled".
+    // -----------------------------------------------------------------------
+
+    void setFlightRecorder(bool enabled);
+
+    /** @return false if the recorder is off or a dump is still running. */
+    Q_INVOKABLE bool dumpFlightRecorder(const QString& filePath = QString());
+
+    /** { "frames", "segments", "compressedBytes", "rawBytes", "spanSec", "windowMin", "dir" } */
+    Q_INVOKABLE QVariantMap flightRecorderStats() const;
+
+    // -----------------------------------------------------------------------
+    //  Crash-safe journal (see trace/TraceJournal.h)
+    //
+    //  While on, every received frame is appended to a timestamped .alj
+    //  file in "Journal/dir" — self-describing blocks plus periodic
+    //  checkpoints, readable up to the last intact block after a crash.
+    //  importTraceLog() loads .alj files; scanJournal() reports what a
+    //  recovery scan finds without loading the frames.
+    //  Persisted as "Journal/enabled".
+    // -----------------------------------------------------------------------
+
+    void setJournaling(bool enabled);
+
+    /** { "path", "frames", "blocks", "checkpoints", "bytes", "error", "dir" } */
+    Q_INVOKABLE QVariantMap journalStats() const;
+
+    /**
+     * { "frames", "blocks", "checkpoints", "tailBlocks", "fileBytes",
+     *   "validBytes", "clean", "startTime", "firstSec", "lastSec", "scanMs" },
+     * or { "error" }.
+     */
+    Q_INVOKABLE QVariantMap scanJournal(const QString& filePath);
+
+    // -----------------------------------------------------------------------
+    //  Trace overview (minimap)
+    //
+    //  Every frame that reaches the trace — live or imported — is counted
+    //  into a TraceOverview bucket pyramid.  traceOverview() returns one
+    //  aggregate per minimap column:
+    //    { "firstSec", "endSec", "fromSec", "toSec", "columns",
+    //      "frames": [[per column] per channel], "errors": [...],
+    //      "load": [...] (busiest channel, 0..1), "maxFrames",
+    //      "hasSignal", "signal", "sigMin": [...], "sigMax": [...] }
+    //  Omitted / negative bounds mean the whole trace.  sigMin/sigMax hold
+    //  NaN for columns without the signal.
+    //
+    //  The min/max signal is chosen by name ("Overview/message",
+    //  "Overview/signal"); empty names turn it off.
+    // -----------------------------------------------------------------------
+
+    Q_INVOKABLE QVariantMap traceOverview(int columns, double fromSec = -1, double toSec = -1);
+    Q_INVOKABLE bool setOverviewSignal(const QString& messageName, const QString& signalName);
+
+    /** Proxy index of the first visible frame at or after @p seconds (invalid if none). */
+    Q_INVOKABLE QModelIndex traceIndexAtTime(double seconds) const;
+
+    /**
+     * @brief data() traffic of the trace view since resetTraceViewStats().
+     * { "dataCalls", "rowCalls", "snapshotBuilds", "scrollSteps",
+     *   "dataCallsPerStep", "buildsPerStep" } — see TraceModel ROW SNAPSHOTS.
+     */
+    Q_INVOKABLE QVariantMap traceViewStats() const;
+    Q_INVOKABLE void resetTraceViewStats();
+
+    // -----------------------------------------------------------------------
+    //  Latency analysis (see analysis/LatencyAnalyzer.h for the pair format)
+    //
+    //  Every frame that reaches the trace — live or imported — is matched
+    //  against the configured request/response pairs.  The pairs persist as
+    //  "Latency/pairs"; statistics restart when the trace is cleared.
+    // -----------------------------------------------------------------------
+
+    /** Parse and activate @p json.  Returns "" or the first error. */
+    Q_INVOKABLE QString setLatencyPairs(const QString& json);
+    Q_INVOKABLE QString latencyPairs() const { return m_latency.pairs(); }
+
+    /** Restart the statistics and run the whole current trace through the pairs. */
+    Q_INVOKABLE void analyzeTraceLatency();
+
+    /**
+     * [{ "pair", "timeoutMs", "requests", "responses", "timeouts", "unmatched",
+     *    "minUs", "maxUs", "meanUs", "p50Us", "p95Us", "p99Us",
+     *    "histogram": [{ "fromUs", "count" }, …] (non-empty bins only) }, …]
+     */
+    Q_INVOKABLE QVariantList latencyStats() const;
+
+    // -----------------------------------------------------------------------
+    //  Cycle gap / jitter report (see analysis/CycleAnalyzer.h)
+    //
+    //  Runs in the background over the current trace (empty @p filePath) or
+    //  over an ASC/BLF file read with TraceImporter, and fills cycleReport.
+    //  An interval above @p gapFactor × the nominal cycle is a gap.
+    // -----------------------------------------------------------------------
+
+    /** Start the analysis.  Returns false if one is already running. */
+    Q_INVOKABLE bool analyzeCycles(double gapFactor = 2.0, const QString& filePath = QString());
+
+    /** Proxy index of the frame (@p channel, @p id) at @p seconds, or the nearest visible row. */
+    Q_INVOKABLE QModelIndex traceIndexOfFrame(double seconds, int channel, uint id) const;
+
+    // -----------------------------------------------------------------------
+    //  Trace compare (see analysis/TraceDiff.h)
+    //
+    //  Reads a baseline and a candidate log with TraceImporter and compares
+    //  them in the background, decoding with the loaded DBC.  The result
+    //  stays until the next compareTraces(); compareRunning turns false
+    //  when it is ready.
+    // -----------------------------------------------------------------------
+
+    /** Start the comparison.  Returns false if one is already running. */
+    Q_INVOKABLE bool compareTraces(const QString& baselinePath, const QString& candidatePath,
+                                   bool bySequence = false);
+
+    /**
+     * [{ "index", "channel", "id", "name", "status" ("common" | "baseline" |
+     *    "candidate"), "baseFrames", "candFrames", "baseCycleMs", "candCycleMs",
+     *    "aligned", "onlyBase", "onlyCand", "payloadDiffs", "hitCount", "differs",
+     *    "signals": [{ "name", "unit", "compared", "differing", "maxAbsDiff" }] }, …]
+     *
+     * @p cycleTolerance is the relative cycle change that counts as a
+     * difference; @p differingOnly drops the messages without any.
+     */
+    Q_INVOKABLE QVariantList compareMessages(bool differingOnly = true,
+                                             double cycleTolerance = 0.1) const;
+
+    /**
+     * Side-by-side rows for message @p index (from compareMessages()):
+     * [{ "kind" ("signal" | "payload" | "baseline" | "candidate"), "signal",
+     *    "baseSec", "candSec", "baseValue", "candValue", "baseData", "candData" }, …]
+     * Times are relative to each capture's first frame; -1 = no frame.
+     */
+    Q_INVOKABLE QVariantList compareHits(int index) const;
+
     // -----------------------------------------------------------------------
     //  Persistent Settings  (QSettings — HKCU\Software\AutoLens\AutoLens on Win)
     //
@@ -413,6 +798,22 @@ signals:
     void frameCountChanged();
     void frameRateChanged();
     void inPlaceDisplayModeChanged();
+    void residualBusRunningChanged();
+    void scriptsRunningChanged();
+    void gatewayEnabledChanged();
+    void frameSharingChanged();
+    void signalStreamingChanged();
+    void metricsEnabledChanged();
+    void flightRecorderChanged();
+    void journalingChanged();
+    void cycleAnalysisRunningChanged();
+    void compareRunningChanged();
+
+    /** One line written by can.log() in a node script. */
+    void scriptOutput(const QString& line);
+
+    /** [{ "role", "samples", "minUs", "avgUs", "p99Us", "maxUs", "result" }, …] */
+    void threadLatencyMeasured(const QVariantList& results);
 
     /** Splash screen init progress. */
     void initStatusChanged();
@@ -426,12 +827,18 @@ private slots:
     /** Receives frames from the driver (via queued or direct connection). */
     void onFrameReceived(const CANManager::CANMessage& msg);
 
-    /** Flushes the m_pending buffer into TraceModel — called by m_flushTimer. */
+    /** Submits the m_pending buffer to the decode workers — called by m_flushTimer. */
     void flushPendingFrames();
 
+    /** Moves finished decode batches into TraceModel (DecodePipeline::batchesReady). */
+    void onDecodedBatches();
+
     /** Updates m_frameRate from m_framesSinceLastSec — called by m_rateTimer. */
     void updateFrameRate();
 
+    /** Refreshes the sampled metrics (gauges, mirrored counters) — m_metricsTimer. */
+    void sampleMetrics();
+
     // -----------------------------------------------------------------------
     //  Port health monitoring — fires every 2 seconds from m_portCheckTimer.
     //
@@ -472,8 +879,6 @@ private:
      */
     void setInitStatus(const QString& text);
 
-    TraceEntry buildEntry(const CANManager::CANMessage& msg) const;
-
     /** Strip "file:///" or "file://" prefix from QML FileDialog URLs. */
     static QString stripFileUrl(const QString& path);
 
@@ -493,11 +898,60 @@ private:
     /** Rebuild m_dbcDb by merging all enabled channels' DBC databases. */
     void rebuildMergedDbc();
 
+    /** Hand the enabled channels' DBCs to m_residualBus (while stopped). */
+    void configureResidualBus();
+
+    /** Hand the channel DBCs to m_gateway and recompile the routes. */
+    void configureGateway();
+
+    /** Re-resolve the latency pairs against m_dbcDb; unchanged pairs keep their statistics. */
+    void configureLatency();
+
+    /** Demo, virtual bus and UDP: the channel list never changes, no HW errors. */
+    bool hasFixedChannels() const;
+
+    /** Make @p driver the active driver: wire its signals, register virtual nodes. */
+    void installDriver(CANManager::ICANDriver* driver);
+
+    /** Disconnect the frame taps from @p driver and withdraw it from m_txDriver. */
+    void detachDriver(CANManager::ICANDriver* driver);
+
+    /**
+     * @brief Transmit from a worker thread (gateway, residual bus, scripts)
+     *        as virtual-bus node @p node — through m_txDriver, never m_driver.
+     */
+    CANManager::CANResult transmitAsNode(int node, const CANManager::CANMessage* frames,
+                                         int count, int* sent = nullptr);
+
+    /** Name, track and start a one-shot worker; it deletes itself when done. */
+    void startWorker(QThread* thread, const QString& name);
+
+    /** Create the driver for m_driverBackend ("auto" probes Vector XL). */
+    CANManager::ICANDriver* createDriver();
+
     // --- Driver ---
     CANManager::ICANDriver*            m_driver     = nullptr;
     QThread*                           m_initThread = nullptr;
     QList<CANManager::CANChannelInfo>  m_channelInfos;
     QStringList                        m_channelList;
+    QString                            m_driverBackend = QStringLiteral("auto");
+    quint16                            m_udpLocalPort  = 20000;
+    QString                            m_udpPeer       = QStringLiteral("127.0.0.1:20000");
+
+    // --- Virtual bus (only while VirtualCANDriver is the active driver) ---
+    //  The simulator and the scripts transmit as their own nodes so the bus
+    //  arbitrates them against each other and against the UI (host node).
+    CANManager::VirtualCANDriver*      m_virtualBus   = nullptr;
+    int                                m_residualNode = 0;
+    int                                m_scriptNode   = 0;
+    int                                m_gatewayNode  = 0;
+
+    //  The driver the worker-thread TX paths use.  m_driver / m_virtualBus
+    //  are UI-thread state; this is published by installDriver() after the
+    //  node ids and cleared by detachDriver() before the old driver is shut
+    //  down, so a gateway/simulator/script thread never reads a pointer
+    //  mid-swap.
+    std::atomic<CANManager::ICANDriver*> m_txDriver{nullptr};
 
     // --- Startup init state ---
     QString m_initStatus;
@@ -525,13 +979,93 @@ private:
     // --- Trace model ---
     TraceModel m_traceModel;
     TraceFilterProxy m_traceProxy;
+    TraceOverview    m_traceOverview;   ///< minimap buckets, fed with the trace
+
+    // --- Analysis (fed with every frame that reaches the trace) ---
+    LatencyAnalyzer  m_latency;
+    CycleReportModel m_cycleReport;
+    bool             m_cycleRunning = false;
+    QVector<TraceDiff::MessageDiff> m_compare;   ///< last compareTraces() result
+    bool             m_compareRunning = false;
+
+    //  One-shot workers (cycle report, compare, latency probe).  They post
+    //  their result back to `this`, so the destructor joins them first.
+    QList<QPointer<QThread>> m_workers;
 
     // --- Batching ---
     QVector<CANManager::CANMessage> m_pending;
+    DecodePipeline      m_decodePipeline;   ///< persistent decode workers
+    QVector<TraceEntry> m_decodedBatch;     ///< reused collect buffer (UI thread)
     QTimer   m_flushTimer;   ///< 50 ms → flushPendingFrames()
     QTimer   m_rateTimer;    ///< 1000 ms → updateFrameRate()
     QElapsedTimer m_measureStart;
 
+    // --- Residual bus simulation ---
+    ResidualBusSimulator m_residualBus;
+    std::atomic<quint64> m_residualTxErrors{0};   ///< written by the simulator thread
+
+    // --- Node scripts ---
+    ScriptHost  m_scriptHost;
+    QStringList m_scriptPaths;   ///< persisted as "Simulation/scripts"
+
+    // --- Gateway ---
+    GatewayEngine        m_gateway;
+    QString              m_gatewayRoutes;          ///< persisted as "Gateway/routes"
+    std::atomic<quint64> m_gatewayTxErrors{0};     ///< written by the driver thread
+
+    // --- Capture filter ---
+    CANManager::CaptureFilter m_captureFilter;
+    bool                      m_captureHardware = false;   ///< acceptance filter narrowed
+
+    // --- Frame sharing ---
+    SharedFrameRing      m_frameRing;
+
+    // --- Signal streaming ---
+    SignalStreamServer   m_signalStream;
+
+    // --- Flight recorder ---
+    FlightRecorder       m_flightRecorder;
+
+    // --- Crash-safe journal ---
+    TraceJournal         m_journal;
+
+    // --- Metrics ---
+    struct ChannelMetrics
+    {
+        MetricCounter* frames      = nullptr;
+        MetricCounter* errorFrames = nullptr;
+        MetricCounter* busyNs      = nullptr;   ///< on-wire time of received frames
+        MetricCounter* captureDrops = nullptr;  ///< mirrors CaptureFilter::stats()
+        MetricGauge*   frameRate   = nullptr;
+        MetricGauge*   busLoad     = nullptr;
+        quint64        lastFrames  = 0;         ///< at the previous sample (UI thread)
+        quint64        lastBusyNs  = 0;
+    };
+    void registerMetrics();
+    void countLogBytes(const QString& format, const QString& path, qint64 elapsedNs);
+    void applyOverviewSignal();
+
+    MetricsExporter      m_metricsExporter;
+    QTimer               m_metricsTimer;          ///< 1000 ms → sampleMetrics() while exporting
+    QElapsedTimer        m_metricsClock;          ///< interval between samples
+    std::array<ChannelMetrics, MAX_CHANNELS> m_channelMetrics;
+    std::atomic<bool>    m_metricsActive{false};  ///< gates the driver-thread counters
+    std::atomic<int>     m_metricBitrate{500000};       ///< for bus-busy time
+    std::atomic<int>     m_metricDataBitrate{2000000};
+    std::atomic<bool>    m_metricFdEnabled{false};
+    MetricGauge*         m_metricPending      = nullptr;
+    MetricGauge*         m_metricDecodeJobs   = nullptr;
+    MetricGauge*         m_metricTraceFrames  = nullptr;
+    MetricGauge*         m_metricTraceEncoded = nullptr;
+    MetricGauge*         m_metricMemoHitRatio = nullptr;
+    MetricCounter*       m_metricMemoHits     = nullptr;
+    MetricCounter*       m_metricMemoMisses   = nullptr;
+    quint64              m_lastMemoHits       = 0;
+    quint64              m_lastMemoMisses     = 0;
+    MetricGauge*         m_metricRss          = nullptr;
+    MetricCounter*       m_metricScriptDrops  = nullptr;
+    MetricCounter*       m_metricResidualDrops = nullptr;
+
     // --- Stats ---
     int m_frameRate          = 0;
     int m_framesSinceLastSec = 0;
@@ -801,16 +801,82 @@ void DBCParser::parseSignalValueType(const QString& line, DBCDatabase& db)
         sig->valueType = ValueType::Float64;
 }
 
-void DBCParser::parseAttributeDefinition(const QString& /*line*/, DBCDatabase& /*db*/)
+void DBCParser::parseAttributeDefinition(const QString& line, DBCDatabase& db)
 {
-    // BA_DEF_ and BA_DEF_DEF_ — store for potential future use
-    // Commonly used for GenMsgCycleTime, GenSigStartValue, etc.
-    // For now, we skip attribute definitions.
+    // BA_DEF_ BO_ "GenMsgCycleTime" INT 0 65535;   — definition (type/range)
+    // BA_DEF_DEF_ "GenMsgCycleTime" 100;           — default value
+    //
+    // Only the defaults matter for decoding/simulation.  The DBC format
+    // orders BA_DEF_DEF_ after all BO_/SG_ blocks and before any BA_ value,
+    // so applying a default to every message here and letting explicit
+    // BA_ lines override it afterwards gives the correct result.
+    if (!line.startsWith("BA_DEF_DEF_ "))
+        return;
+
+    static QRegularExpression re(R"re(BA_DEF_DEF_\s+"(\w+)"\s+"?([^";]*)"?\s*;)re");
+    auto match = re.match(line);
+    if (!match.hasMatch())
+        return;
+
+    const QString name  = match.captured(1);
+    const QString value = match.captured(2).trimmed();
+
+    if (name == QLatin1String("GenMsgCycleTime")) {
+        bool ok = false;
+        const int cycle = value.toInt(&ok);
+        if (ok) {
+            for (auto& msg : db.messages)
+                msg.cycleTimeMs = cycle;
+        }
+    } else if (name == QLatin1String("GenSigStartValue")) {
+        bool ok = false;
+        const double raw = value.toDouble(&ok);
+        if (ok) {
+            for (auto& msg : db.messages)
+                for (auto& sig : msg.signalList)
+                    sig.initialValue = sig.rawToPhysical(static_cast<int64_t>(raw));
+        }
+    }
 }
 
-void DBCParser::parseAttributeValue(const QString& /*line*/, DBCDatabase& /*db*/)
+void DBCParser::parseAttributeValue(const QString& line, DBCDatabase& db)
 {
-    // BA_ — attribute values; skip for now
+    // BA_ "GenMsgCycleTime" BO_ 100 10;
+    // BA_ "GenSigStartValue" SG_ 100 EngineSpeed 0;
+    // Network (BA_ "BusType" "CAN";) and node (BU_) attributes are ignored.
+    static QRegularExpression reMsg(R"re(BA_\s+"(\w+)"\s+BO_\s+(\d+)\s+([^;]+);)re");
+    static QRegularExpression reSig(R"re(BA_\s+"(\w+)"\s+SG_\s+(\d+)\s+(\w+)\s+([^;]+);)re");
+
+    auto lookup = [&db](const QString& idStr) -> DBCMessage* {
+        const uint32_t rawId = idStr.toUInt();
+        const uint32_t id = (rawId & 0x80000000u) ? (rawId & 0x1FFFFFFFu) : (rawId & 0x7FFu);
+        return db.messageById(id);
+    };
+
+    auto msgMatch = reMsg.match(line);
+    if (msgMatch.hasMatch()) {
+        if (msgMatch.captured(1) != QLatin1String("GenMsgCycleTime"))
+            return;
+        auto* msg = lookup(msgMatch.captured(2));
+        if (!msg) return;
+        bool ok = false;
+        const int cycle = msgMatch.captured(3).trimmed().toInt(&ok);
+        if (ok) msg->cycleTimeMs = cycle;
+        return;
+    }
+
+    auto sigMatch = reSig.match(line);
+    if (sigMatch.hasMatch()) {
+        if (sigMatch.captured(1) != QLatin1String("GenSigStartValue"))
+            return;
+        auto* msg = lookup(sigMatch.captured(2));
+        if (!msg) return;
+        auto* sig = msg->signal(sigMatch.captured(3));
+        if (!sig) return;
+        bool ok = false;
+        const double raw = sigMatch.captured(4).trimmed().toDouble(&ok);
+        if (ok) sig->initialValue = sig->rawToPhysical(static_cast<int64_t>(raw));
+    }
 }
 
 } // namespace DBCManager
@@ -62,7 +62,7 @@ struct DBCSignal
     QString   unit;                 ///< Unit string (e.g., "km/h", "degC")
     QStringList receivers;          ///< Receiving node names
     QString   comment;              ///< Signal comment
-    double    initialValue = 0.0;   ///< Initial/default value
+    double    initialValue = 0.0;   ///< Initial/default value (GenSigStartValue, physical)
 
     /// Value descriptions (e.g., 0="Off", 1="On")
     QMap<int64_t, QString> valueDescriptions;
@@ -122,6 +122,7 @@ struct DBCMessage
     QString   sender;               ///< Transmitting node name
     QString   comment;              ///< Message comment
     bool      isExtended = false;   ///< 29-bit extended ID
+    int       cycleTimeMs = 0;      ///< GenMsgCycleTime attribute (0 = not cyclic)
 
     /// Signals in this message (ordered by start bit)
     QVector<DBCSignal> signalList;
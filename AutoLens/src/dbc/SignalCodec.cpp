@@ -0,0 +1,169 @@
+/**
+ * @file SignalCodec.cpp
+ * @brief Segment compilation + fast bit extraction for DBC signals.
+ */
+
+#include "SignalCodec.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace DBCManager {
+
+//=============================================================================
+// Compilation
+//=============================================================================
+
+SignalCodec::SignalCodec(const DBCSignal& sig)
+{
+    if (sig.bitLength == 0 || sig.bitLength > 64)
+        return;
+
+    m_bitLength = static_cast<uint8_t>(sig.bitLength);
+    m_factor    = sig.factor;
+    m_offset    = sig.offset;
+    m_rawMask   = m_bitLength < 64 ? (1ULL << m_bitLength) - 1 : ~0ULL;
+
+    if (sig.valueType == ValueType::Float32 && sig.bitLength == 32)
+        m_kind = Kind::Float32;
+    else if (sig.valueType == ValueType::Float64 && sig.bitLength == 64)
+        m_kind = Kind::Float64;
+    else if (sig.valueType == ValueType::Signed)
+        m_kind = Kind::Signed;
+    else
+        m_kind = Kind::Unsigned;
+
+    if (m_kind == Kind::Signed && m_bitLength < 64)
+        m_signBit = 1ULL << (m_bitLength - 1);
+
+    // Walk the bits exactly like DBCParser's extractBitsLE/BE and group the
+    // ones that share a byte.  Within a byte both layouts map increasing
+    // bit index to increasing raw-value bit, so each group is one
+    // contiguous (shift, width) field.
+    const bool intel = sig.byteOrder == ByteOrder::LittleEndian;
+    uint32_t pos = sig.startBit;
+    for (uint32_t i = 0; i < sig.bitLength; ++i) {
+        const uint32_t byteIdx  = pos / 8;
+        const uint32_t bitIdx   = pos % 8;
+        const uint32_t rawBit   = intel ? i : sig.bitLength - 1 - i;
+
+        if (byteIdx > 255)
+            break;   // beyond any CAN FD frame
+
+        Segment* seg = nullptr;
+        for (int s = 0; s < m_segmentCount; ++s) {
+            if (m_segments[s].byteIndex == byteIdx) { seg = &m_segments[s]; break; }
+        }
+        if (!seg) {
+            if (m_segmentCount == 9) break;
+            seg = &m_segments[m_segmentCount++];
+            seg->byteIndex = static_cast<uint8_t>(byteIdx);
+            seg->shift     = static_cast<uint8_t>(bitIdx);
+            seg->rawShift  = static_cast<uint8_t>(rawBit);
+        }
+        if (bitIdx < seg->shift) {
+            // Motorola walks a byte from its high bit down: keep the lowest.
+            seg->shift    = static_cast<uint8_t>(bitIdx);
+            seg->rawShift = static_cast<uint8_t>(rawBit);
+        }
+        seg->mask = static_cast<uint8_t>(seg->mask | (1u << bitIdx));
+
+        if (intel)             ++pos;
+        else if (bitIdx == 0)  pos += 15;
+        else                   --pos;
+    }
+
+    for (int s = 0; s < m_segmentCount; ++s)
+        m_segments[s].mask = static_cast<uint8_t>(m_segments[s].mask >> m_segments[s].shift);
+}
+
+//=============================================================================
+// Bit access
+//=============================================================================
+
+uint64_t SignalCodec::extract(const uint8_t* data, int dataLength) const
+{
+    uint64_t raw = 0;
+    for (int s = 0; s < m_segmentCount; ++s) {
+        const Segment& seg = m_segments[s];
+        if (seg.byteIndex >= dataLength)
+            continue;
+        raw |= static_cast<uint64_t>((data[seg.byteIndex] >> seg.shift) & seg.mask)
+               << seg.rawShift;
+    }
+    return raw;
+}
+
+void SignalCodec::place(uint64_t raw, uint8_t* data, int dataLength) const
+{
+    for (int s = 0; s < m_segmentCount; ++s) {
+        const Segment& seg = m_segments[s];
+        if (seg.byteIndex >= dataLength)
+            continue;
+        const uint8_t bits = static_cast<uint8_t>((raw >> seg.rawShift) & seg.mask);
+        uint8_t& b = data[seg.byteIndex];
+        b = static_cast<uint8_t>((b & ~(seg.mask << seg.shift)) | (bits << seg.shift));
+    }
+}
+
+//=============================================================================
+// Decode / Encode
+//=============================================================================
+
+int64_t SignalCodec::decodeRaw(const uint8_t* data, int dataLength) const
+{
+    uint64_t raw = extract(data, dataLength);
+    if (m_signBit && (raw & m_signBit))
+        raw |= ~m_rawMask;   // sign-extend
+    return static_cast<int64_t>(raw);
+}
+
+double SignalCodec::decode(const uint8_t* data, int dataLength) const
+{
+    switch (m_kind) {
+    case Kind::Float32: {
+        const uint32_t u32 = static_cast<uint32_t>(extract(data, dataLength));
+        float f;
+        std::memcpy(&f, &u32, sizeof(f));
+        return static_cast<double>(f) * m_factor + m_offset;
+    }
+    case Kind::Float64: {
+        const uint64_t u64 = extract(data, dataLength);
+        double d;
+        std::memcpy(&d, &u64, sizeof(d));
+        return d * m_factor + m_offset;
+    }
+    default:
+        return static_cast<double>(decodeRaw(data, dataLength)) * m_factor + m_offset;
+    }
+}
+
+void SignalCodec::encode(double physical, uint8_t* data, int dataLength) const
+{
+    switch (m_kind) {
+    case Kind::Float32: {
+        const float f = static_cast<float>((physical - m_offset) / m_factor);
+        uint32_t u32;
+        std::memcpy(&u32, &f, sizeof(u32));
+        place(u32, data, dataLength);
+        return;
+    }
+    case Kind::Float64: {
+        const double d = (physical - m_offset) / m_factor;
+        uint64_t u64;
+        std::memcpy(&u64, &d, sizeof(u64));
+        place(u64, data, dataLength);
+        return;
+    }
+    default: {
+        // Same rounding as DBCSignal::physicalToRaw().
+        const int64_t raw = std::abs(m_factor) < 1e-15
+            ? 0
+            : static_cast<int64_t>(std::round((physical - m_offset) / m_factor));
+        place(static_cast<uint64_t>(raw) & m_rawMask, data, dataLength);
+        return;
+    }
+    }
+}
+
+} // namespace DBCManager
@@ -0,0 +1,70 @@
+#pragma once
+/**
+ * @file SignalCodec.h
+ * @brief Precompiled encoder/decoder for one DBC signal.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY precompile?
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  DBCSignal::decode() walks the signal bit by bit and re-derives the
+ *  Intel/Motorola layout on every call.  That is fine for the trace view,
+ *  but script handlers and the gateway decode the same few signals on
+ *  every matching frame.
+ *
+ *  SignalCodec does the layout work once: the signal is split into at most
+ *  9 byte-aligned segments ({byte, shift, mask, position in raw value}).
+ *  decode() is then one shift/mask/or per touched byte, for both byte
+ *  orders, and the float/sign/scale decisions are resolved up front.
+ *
+ *  Results are bit-identical to DBCSignal::decode() / encode(), including
+ *  bytes beyond the frame length being ignored.
+ */
+
+#include <cstdint>
+
+#include "dbc/DBCParser.h"
+
+namespace DBCManager {
+
+class SignalCodec
+{
+public:
+    SignalCodec() = default;
+    explicit SignalCodec(const DBCSignal& sig);
+
+    /** Raw bits → physical value. */
+    double decode(const uint8_t* data, int dataLength) const;
+
+    /** Physical value → raw bits; other bits of @p data are preserved. */
+    void encode(double physical, uint8_t* data, int dataLength) const;
+
+    /** Raw integer (sign-extended for signed signals). */
+    int64_t decodeRaw(const uint8_t* data, int dataLength) const;
+
+    bool isValid() const { return m_segmentCount > 0; }
+
+private:
+    enum class Kind : uint8_t { Unsigned, Signed, Float32, Float64 };
+
+    struct Segment
+    {
+        uint8_t byteIndex = 0;
+        uint8_t shift     = 0;   ///< lowest bit of the segment inside the byte
+        uint8_t mask      = 0;   ///< already shifted down (width bits set)
+        uint8_t rawShift  = 0;   ///< position of the segment in the raw value
+    };
+
+    uint64_t extract(const uint8_t* data, int dataLength) const;
+    void     place(uint64_t raw, uint8_t* data, int dataLength) const;
+
+    Segment  m_segments[9];
+    uint8_t  m_segmentCount = 0;
+    uint8_t  m_bitLength    = 0;
+    Kind     m_kind         = Kind::Unsigned;
+    uint64_t m_signBit      = 0;
+    uint64_t m_rawMask      = 0;
+    double   m_factor       = 1.0;
+    double   m_offset       = 0.0;
+};
+
+} // namespace DBCManager
@@ -0,0 +1,431 @@
+/**
+ * @file GatewayEngine.cpp
+ * @brief Route table compilation and the per-frame forwarding path.
+ */
+
+#include "gateway/GatewayEngine.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace CANManager;
+using namespace DBCManager;
+
+namespace {
+
+constexpr int kStdIds = 2048;
+
+uint64_t steadyNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * @brief Resolve a JSON ID: number, "0x…" string or DBC message name.
+ * @p extended is set only when the DBC message says so.
+ */
+bool parseId(const QJsonValue& value, const DBCDatabase* db,
+             uint32_t& id, bool& extended, QString& error)
+{
+    if (value.isDouble()) {
+        id = static_cast<uint32_t>(value.toDouble());
+        return true;
+    }
+    const QString text = value.toString().trimmed();
+    bool ok = false;
+    const uint32_t number = text.toUInt(&ok, 0);   // base 0: accepts "0x…"
+    if (ok) {
+        id = number;
+        return true;
+    }
+    if (db) {
+        if (const DBCMessage* msg = db->messageByName(text)) {
+            id       = msg->id;
+            extended = msg->isExtended;
+            return true;
+        }
+    }
+    error = QString("unknown message \"%1\"").arg(text);
+    return false;
+}
+
+QString idText(uint32_t id, bool extended)
+{
+    return QStringLiteral("0x") + QString::number(id, 16).toUpper().rightJustified(extended ? 8 : 3, QChar('0'))
+         + (extended ? QStringLiteral("x") : QString());
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Constructor / Destructor
+// ─────────────────────────────────────────────────────────────────────────────
+
+GatewayEngine::GatewayEngine(QObject* parent)
+    : QObject(parent)
+{
+}
+
+GatewayEngine::~GatewayEngine() = default;
+
+void GatewayEngine::setChannelDatabase(int channel, const DBCDatabase& db)
+{
+    if (channel < 1 || channel > MAX_CHANNELS) return;
+    m_channelDbs[channel - 1] = db;
+}
+
+void GatewayEngine::setEnabled(bool enabled)
+{
+    if (m_enabled.exchange(enabled) == enabled) return;
+    qDebug() << "[Gateway]" << (enabled ? "Enabled," : "Disabled,") << routeCount() << "route(s)";
+    emit enabledChanged();
+}
+
+int GatewayEngine::routeCount() const
+{
+    const auto table = std::atomic_load(&m_table);
+    return table ? static_cast<int>(table->routes.size()) : 0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Compilation
+// ─────────────────────────────────────────────────────────────────────────────
+
+QString GatewayEngine::setRoutes(const QString& json)
+{
+    auto table = std::make_shared<Table>();
+    if (!json.trimmed().isEmpty()) {
+        const QString error = compile(json, *table);
+        if (!error.isEmpty())
+            return error;
+    }
+
+    m_json = json;
+    std::atomic_store(&m_table, std::shared_ptr<const Table>(std::move(table)));
+    qDebug() << "[Gateway] Route table compiled:" << routeCount() << "route(s)";
+    return {};
+}
+
+QString GatewayEngine::compile(const QString& json, Table& t) const
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+        return QString("JSON error at offset %1: %2").arg(parseError.offset).arg(parseError.errorString());
+
+    const QJsonArray list = doc.isArray() ? doc.array()
+                                          : doc.object().value(QStringLiteral("routes")).toArray();
+    if (list.size() > 0xFFFF)
+        return QStringLiteral("Too many routes");
+
+    auto dbFor = [this](int channel) -> const DBCDatabase* {
+        return (channel >= 1 && channel <= MAX_CHANNELS) ? &m_channelDbs[channel - 1] : nullptr;
+    };
+
+    for (int i = 0; i < list.size(); ++i) {
+        const QJsonObject o = list[i].toObject();
+        const QString where = QString("Route %1").arg(i + 1);
+        QString error;
+        Route r;
+
+        // ── Source ──────────────────────────────────────────────────────────
+        const QJsonObject from = o.value(QStringLiteral("from")).toObject();
+        r.srcChannel = from.value(QStringLiteral("channel")).toInt(0);
+        if (r.srcChannel < 0 || r.srcChannel > MAX_CHANNELS)
+            return where + ": from.channel must be 0..4";
+        if (!from.contains(QStringLiteral("id")))
+            return where + ": from.id is missing";
+
+        const DBCDatabase* srcDb = dbFor(r.srcChannel ? r.srcChannel : 1);
+        bool dbcExtended = false;
+        if (!parseId(from.value(QStringLiteral("id")), srcDb, r.srcId, dbcExtended, error))
+            return where + ": " + error;
+        r.srcExtended = from.contains(QStringLiteral("extended"))
+                            ? from.value(QStringLiteral("extended")).toBool()
+                            : (dbcExtended || r.srcId > 0x7FF);
+
+        const uint32_t fullMask = r.srcExtended ? 0x1FFFFFFFu : 0x7FFu;
+        r.srcMask = fullMask;
+        if (from.contains(QStringLiteral("mask"))) {
+            uint32_t mask = 0;
+            bool unused = false;
+            if (!parseId(from.value(QStringLiteral("mask")), nullptr, mask, unused, error))
+                return where + ": bad mask";
+            r.srcMask = mask & fullMask;
+        }
+        r.srcId &= r.srcMask;
+
+        r.block = o.value(QStringLiteral("block")).toBool(false);
+        r.minIntervalNs = static_cast<uint64_t>(
+            std::max(0.0, o.value(QStringLiteral("minIntervalMs")).toDouble(0.0)) * 1e6);
+
+        // ── Destination ─────────────────────────────────────────────────────
+        if (!r.block) {
+            if (!o.contains(QStringLiteral("to")))
+                return where + ": \"to\" is missing (or set \"block\": true)";
+            const QJsonObject to = o.value(QStringLiteral("to")).toObject();
+            r.dstChannel = to.value(QStringLiteral("channel")).toInt(0);
+            if (r.dstChannel < 0 || r.dstChannel > MAX_CHANNELS)
+                return where + ": to.channel must be 0..4";
+
+            const DBCDatabase* dstDb = dbFor(r.dstChannel ? r.dstChannel
+                                                          : (r.srcChannel ? r.srcChannel : 1));
+            if (to.contains(QStringLiteral("id"))) {
+                bool dstDbcExtended = false;
+                if (!parseId(to.value(QStringLiteral("id")), dstDb, r.dstId, dstDbcExtended, error))
+                    return where + ": " + error;
+                r.remap = true;
+                r.dstExtended = to.contains(QStringLiteral("extended"))
+                                    ? to.value(QStringLiteral("extended")).toBool()
+                                    : (dstDbcExtended || r.dstId > 0x7FF);
+            }
+
+            // ── Signal rewrites ─────────────────────────────────────────────
+            const QJsonObject sigs = o.value(QStringLiteral("signals")).toObject();
+            if (!sigs.isEmpty()) {
+                const uint32_t outId = r.remap ? r.dstId : r.srcId;
+                const DBCMessage* dstMsg = dstDb ? dstDb->messageById(outId) : nullptr;
+                if (!dstMsg)
+                    return where + ": signal rewrites need a DBC message " + idText(outId, false)
+                           + " on the destination channel";
+                const DBCMessage* srcMsg = srcDb ? srcDb->messageById(r.srcId) : nullptr;
+                r.dstLength = qBound(0, static_cast<int>(dstMsg->dlc), 64);
+
+                for (auto it = sigs.begin(); it != sigs.end(); ++it) {
+                    const DBCSignal* target = dstMsg->signal(it.key());
+                    if (!target)
+                        return where + QString(": %1 has no signal \"%2\"").arg(dstMsg->name, it.key());
+
+                    Rewrite w;
+                    w.target = SignalCodec(*target);
+                    QString sourceName;
+                    if (it.value().isDouble()) {
+                        w.offset = it.value().toDouble();
+                    } else if (it.value().isString()) {
+                        sourceName = it.value().toString();
+                    } else if (it.value().isObject()) {
+                        const QJsonObject spec = it.value().toObject();
+                        sourceName = spec.value(QStringLiteral("from")).toString();
+                        w.factor   = spec.value(QStringLiteral("factor")).toDouble(1.0);
+                        w.offset   = spec.value(QStringLiteral("offset")).toDouble(0.0);
+                    } else {
+                        return where + QString(": bad value for signal \"%1\"").arg(it.key());
+                    }
+
+                    if (!sourceName.isEmpty()) {
+                        const DBCSignal* source = srcMsg ? srcMsg->signal(sourceName) : nullptr;
+                        if (!source)
+                            return where + QString(": source signal \"%1\" not found").arg(sourceName);
+                        w.source = SignalCodec(*source);
+                    }
+                    r.rewrites.append(w);
+                }
+            }
+        }
+
+        r.name = o.value(QStringLiteral("name")).toString();
+        if (r.name.isEmpty()) {
+            r.name = QString("%1 CH%2").arg(idText(r.srcId, r.srcExtended))
+                         .arg(r.srcChannel ? QString::number(r.srcChannel) : QStringLiteral("*"));
+            r.name += r.block ? QStringLiteral(" ✕")
+                              : QString(" → %1 CH%2")
+                                    .arg(r.remap ? idText(r.dstId, r.dstExtended) : QStringLiteral("same ID"))
+                                    .arg(r.dstChannel ? QString::number(r.dstChannel) : QStringLiteral("="));
+        }
+        t.routes.push_back(std::move(r));
+    }
+
+    // ── Loop check: an output must not match a forwarding route again ───────
+    for (const Route& a : t.routes) {
+        if (a.block) continue;
+        const int      outCh  = a.dstChannel ? a.dstChannel : a.srcChannel;   // 0 = any
+        const uint32_t outId  = a.remap ? a.dstId : a.srcId;
+        const bool     outExt = a.remap ? a.dstExtended : a.srcExtended;
+        for (const Route& b : t.routes) {
+            if (b.block || b.srcExtended != outExt) continue;
+            const bool channelOverlap = (b.srcChannel == 0 || outCh == 0 || b.srcChannel == outCh);
+            if (channelOverlap && (outId & b.srcMask) == b.srcId)
+                return QString("%1: output would be routed again by \"%2\"").arg(a.name, b.name);
+        }
+    }
+
+    // ── Lookup structures ───────────────────────────────────────────────────
+    const int n = static_cast<int>(t.routes.size());
+    t.counters.reset(new Counters[std::max(1, n)]);
+
+    std::vector<std::vector<uint16_t>> stdLists(MAX_CHANNELS * kStdIds);
+    for (int r = 0; r < n; ++r) {
+        const Route& route = t.routes[r];
+        for (int ch = 0; ch < MAX_CHANNELS; ++ch) {
+            if (route.srcChannel != 0 && route.srcChannel != ch + 1) continue;
+            if (!route.srcExtended) {
+                // Expand the mask: every matching standard ID gets the route.
+                for (uint32_t id = 0; id < kStdIds; ++id) {
+                    if ((id & route.srcMask) == route.srcId)
+                        stdLists[ch * kStdIds + id].push_back(static_cast<uint16_t>(r));
+                }
+            } else if (route.srcMask == 0x1FFFFFFFu) {
+                t.extExact[(quint64(ch) << 32) | route.srcId].append(static_cast<uint16_t>(r));
+            } else {
+                t.extMasked[ch].append(static_cast<uint16_t>(r));
+            }
+        }
+    }
+
+    t.stdSpan.assign(MAX_CHANNELS * kStdIds, 0);
+    for (int slot = 0; slot < MAX_CHANNELS * kStdIds; ++slot) {
+        const auto& list = stdLists[slot];
+        if (list.empty()) continue;
+        const int count = std::min<int>(static_cast<int>(list.size()), MAX_OUTPUTS);
+        t.stdSpan[slot] = (static_cast<uint32_t>(t.stdRoutes.size()) << 8) | static_cast<uint32_t>(count);
+        t.stdRoutes.insert(t.stdRoutes.end(), list.begin(), list.begin() + count);
+    }
+    return {};
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Forwarding path (driver thread)
+// ─────────────────────────────────────────────────────────────────────────────
+
+void GatewayEngine::process(const CANMessage& msg)
+{
+    // Our own transmissions come back as TX confirmations — never forward
+    // them (that is what would turn a gateway into a loop).
+    if (!m_enabled.load(std::memory_order_relaxed) || msg.isTxConfirm || msg.isError)
+        return;
+    if (msg.channel < 1 || msg.channel > MAX_CHANNELS)
+        return;
+
+    // Latency covers the whole callback path, including the route lookup.
+    const uint64_t t0 = steadyNs();
+
+    const std::shared_ptr<const Table> table = std::atomic_load(&m_table);
+    if (!table || table->routes.empty() || !m_transmit)
+        return;
+
+    // ── Candidate routes (in table order) ───────────────────────────────────
+    const int ch = msg.channel - 1;
+    uint16_t candidates[MAX_OUTPUTS];
+    int      candidateCount = 0;
+
+    if (!msg.isExtended) {
+        const uint32_t span = table->stdSpan[ch * kStdIds + (msg.id & 0x7FFu)];
+        if (span == 0) return;   // the common case: nothing routed
+        candidateCount = static_cast<int>(span & 0xFFu);
+        std::copy_n(table->stdRoutes.data() + (span >> 8), candidateCount, candidates);
+    } else {
+        const auto it = table->extExact.constFind((quint64(ch) << 32) | msg.id);
+        if (it != table->extExact.constEnd()) {
+            for (uint16_t r : *it)
+                if (candidateCount < MAX_OUTPUTS) candidates[candidateCount++] = r;
+        }
+        for (uint16_t r : table->extMasked[ch]) {
+            const Route& route = table->routes[r];
+            if ((msg.id & route.srcMask) == route.srcId && candidateCount < MAX_OUTPUTS)
+                candidates[candidateCount++] = r;
+        }
+        if (candidateCount == 0) return;
+        std::sort(candidates, candidates + candidateCount);   // restore table order
+    }
+
+    // ── Build the outputs ───────────────────────────────────────────────────
+    CANMessage out[MAX_OUTPUTS];
+    uint16_t   outRoute[MAX_OUTPUTS];
+    int        outCount = 0;
+
+    for (int c = 0; c < candidateCount; ++c) {
+        const Route& route = table->routes[candidates[c]];
+        Counters&    cnt   = table->counters[candidates[c]];
+        cnt.matched.fetch_add(1, std::memory_order_relaxed);
+
+        if (route.block) {
+            cnt.filtered.fetch_add(1, std::memory_order_relaxed);
+            break;   // deny rule: later routes do not see this frame
+        }
+        if (route.minIntervalNs) {
+            const uint64_t last = cnt.lastForwardNs.load(std::memory_order_relaxed);
+            if (last && t0 - last < route.minIntervalNs) {
+                cnt.filtered.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            cnt.lastForwardNs.store(t0, std::memory_order_relaxed);
+        }
+
+        CANMessage& o = out[outCount];
+        o = msg;
+        o.timestamp   = 0;
+        o.isTxConfirm = false;
+        if (route.dstChannel) o.channel = static_cast<uint8_t>(route.dstChannel);
+        if (route.remap) {
+            o.id         = route.dstId;
+            o.isExtended = route.dstExtended;
+        }
+
+        // Rewrites decode from the source frame but encode into the target
+        // message's layout, which may be longer or shorter.
+        const int srcLen = msg.dataLength();
+        if (route.dstLength > 0) {
+            if (route.dstLength > srcLen)
+                memset(o.data + srcLen, 0, size_t(route.dstLength - srcLen));
+            o.isFD = o.isFD || route.dstLength > 8;
+            o.dlc  = lengthToDlc(route.dstLength);
+        }
+        const int dstLen = o.dataLength();
+        for (const Rewrite& w : route.rewrites) {
+            const double value = w.source.isValid()
+                ? w.source.decode(msg.data, srcLen) * w.factor + w.offset
+                : w.offset;
+            w.target.encode(value, o.data, dstLen);
+        }
+        outRoute[outCount++] = candidates[c];
+    }
+    if (outCount == 0) return;
+
+    // ── One driver call for everything this frame produced ──────────────────
+    const int sent = m_transmit(out, outCount);
+    const uint64_t latency = steadyNs() - t0;
+
+    for (int i = 0; i < outCount; ++i) {
+        Counters& cnt = table->counters[outRoute[i]];
+        if (i < sent) cnt.forwarded.fetch_add(1, std::memory_order_relaxed);
+        else          cnt.txErrors.fetch_add(1, std::memory_order_relaxed);
+        cnt.totalNs.fetch_add(latency, std::memory_order_relaxed);
+        quint64 prev = cnt.maxNs.load(std::memory_order_relaxed);
+        while (latency > prev && !cnt.maxNs.compare_exchange_weak(prev, latency, std::memory_order_relaxed)) {}
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Stats
+// ─────────────────────────────────────────────────────────────────────────────
+
+QVector<GatewayEngine::RouteStats> GatewayEngine::stats() const
+{
+    QVector<RouteStats> result;
+    const auto table = std::atomic_load(&m_table);
+    if (!table) return result;
+
+    result.reserve(static_cast<int>(table->routes.size()));
+    for (size_t i = 0; i < table->routes.size(); ++i) {
+        const Counters& c = table->counters[i];
+        RouteStats s;
+        s.name      = table->routes[i].name;
+        s.matched   = c.matched.load(std::memory_order_relaxed);
+        s.forwarded = c.forwarded.load(std::memory_order_relaxed);
+        s.filtered  = c.filtered.load(std::memory_order_relaxed);
+        s.txErrors  = c.txErrors.load(std::memory_order_relaxed);
+        const quint64 attempts = s.forwarded + s.txErrors;
+        s.avgUs = attempts ? double(c.totalNs.load(std::memory_order_relaxed)) / attempts / 1000.0 : 0.0;
+        s.maxUs = double(c.maxNs.load(std::memory_order_relaxed)) / 1000.0;
+        result.append(s);
+    }
+    return result;
+}
@@ -0,0 +1,177 @@
+#pragma once
+/**
+ * @file GatewayEngine.h
+ * @brief Frame routing: ID remap, signal rewrite, filtering, batched TX.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHERE IT SITS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    driver RX thread ── messageReceived ─┬─ direct ─► GatewayEngine::process()
+ *                                         │              route table lookup
+ *                                         │              rewrite → transmitBatch()
+ *                                         └─ queued ─► AppController::onFrameReceived
+ *                                                        → DecodePipeline → trace
+ *
+ *  process() runs on the thread that emitted the frame, so forwarding never
+ *  waits for the UI event loop, the 50 ms flush or the decoder.  All frames
+ *  produced by one received frame leave in a single transmitBatch() call.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  ROUTES (JSON, persisted as "Gateway/routes")
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    { "routes": [
+ *      { "name": "Engine → body bus",
+ *        "from": { "channel": 1, "id": "0x0C4" },           // or "EngineData"
+ *        "to":   { "channel": 2, "id": "0x4C4" },           // omit id = keep
+ *        "signals": { "EngineSpeed": "EngineSpeed",         // copy from source
+ *                     "Counter":     0,                     // constant
+ *                     "SpeedKph":    { "from": "VehSpeed", "factor": 3.6 } },
+ *        "minIntervalMs": 0 },                              // rate limit
+ *      { "from": { "channel": 0, "id": "0x700", "mask": "0x700" },
+ *        "block": true }                                    // deny rule
+ *    ] }
+ *
+ *  channel 0 = any channel (source) / same channel (destination).
+ *  Routes are evaluated in order; a matching "block" route stops evaluation
+ *  of the routes after it for that frame.  Message and signal names resolve
+ *  against the channel DBCs when the table is compiled.
+ *
+ *  Only one port is open at a time in AutoLens, so every output leaves
+ *  through the active driver; "to.channel" is written into the frame and
+ *  takes effect once a driver opens several channels.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  COMPILED TABLE
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Standard IDs: a flat [channel][2048] span table (masks are expanded at
+ *  compile time) → a frame costs one array load.  Extended IDs: exact hash
+ *  plus a short list of masked routes.  Signal rewrites are precompiled
+ *  SignalCodecs.  The table is immutable and swapped atomically, so
+ *  setRoutes() never blocks the receive thread.
+ */
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "hardware/CANInterface.h"
+#include "dbc/DBCParser.h"
+#include "dbc/SignalCodec.h"
+
+class GatewayEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_CHANNELS = 4;
+    static constexpr int MAX_OUTPUTS  = 32;   ///< routes one frame can fire
+
+    /** Sends @p count frames; returns how many were accepted (driver thread). */
+    using TransmitFn = std::function<int(const CANManager::CANMessage* frames, int count)>;
+
+    struct RouteStats
+    {
+        QString name;
+        quint64 matched   = 0;
+        quint64 forwarded = 0;
+        quint64 filtered  = 0;   ///< blocked or rate-limited
+        quint64 txErrors  = 0;
+        double  avgUs     = 0.0; ///< receive callback → transmit returned
+        double  maxUs     = 0.0;
+    };
+
+    explicit GatewayEngine(QObject* parent = nullptr);
+    ~GatewayEngine() override;
+
+    void setTransmit(TransmitFn fn) { m_transmit = std::move(fn); }
+
+    /** DBC for @p channel (1-based); takes effect on the next compile. */
+    void setChannelDatabase(int channel, const DBCManager::DBCDatabase& db);
+
+    /**
+     * @brief Parse and compile @p json, then swap the table in.
+     * @return Empty string on success, otherwise the first error (the
+     *         previous table stays active).
+     */
+    QString setRoutes(const QString& json);
+    QString routes() const { return m_json; }
+
+    /** Recompile the current routes (after setChannelDatabase()). */
+    QString recompile() { return setRoutes(m_json); }
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    int  routeCount() const;
+
+    /** Route one received frame.  Called on the driver thread. */
+    void process(const CANManager::CANMessage& msg);
+
+    QVector<RouteStats> stats() const;
+
+signals:
+    void enabledChanged();
+
+private:
+    struct Rewrite
+    {
+        DBCManager::SignalCodec target;
+        DBCManager::SignalCodec source;   ///< valid → copy (scaled) from the source frame
+        double factor = 1.0;
+        double offset = 0.0;              ///< constant when source is invalid
+    };
+
+    struct Route
+    {
+        QString  name;
+        int      srcChannel = 0;          ///< 0 = any
+        uint32_t srcId      = 0;
+        uint32_t srcMask    = 0;
+        bool     srcExtended = false;
+        int      dstChannel = 0;          ///< 0 = same as source
+        bool     remap      = false;
+        uint32_t dstId      = 0;
+        bool     dstExtended = false;
+        bool     block      = false;
+        uint64_t minIntervalNs = 0;
+        QVector<Rewrite> rewrites;
+        int      dstLength  = 0;          ///< target DBC message bytes (rewrites only)
+    };
+
+    struct Counters
+    {
+        std::atomic<quint64> matched{0};
+        std::atomic<quint64> forwarded{0};
+        std::atomic<quint64> filtered{0};
+        std::atomic<quint64> txErrors{0};
+        std::atomic<quint64> totalNs{0};
+        std::atomic<quint64> maxNs{0};
+        std::atomic<quint64> lastForwardNs{0};
+    };
+
+    struct Table
+    {
+        std::vector<Route>          routes;
+        std::unique_ptr<Counters[]> counters;
+        std::vector<uint32_t>       stdSpan;     ///< [ch * 2048 + id] → begin << 8 | count
+        std::vector<uint16_t>       stdRoutes;
+        QHash<quint64, QVector<uint16_t>> extExact;   ///< ch << 32 | id
+        std::array<QVector<uint16_t>, MAX_CHANNELS> extMasked;
+    };
+
+    QString compile(const QString& json, Table& table) const;
+
+    TransmitFn m_transmit;
+    std::array<DBCManager::DBCDatabase, MAX_CHANNELS> m_channelDbs;
+    QString m_json;
+
+    std::shared_ptr<const Table> m_table;   ///< accessed with std::atomic_load/store
+    std::atomic<bool> m_enabled{false};
+};
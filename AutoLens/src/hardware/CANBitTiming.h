@@ -0,0 +1,201 @@
+#pragma once
+/**
+ * @file CANBitTiming.h
+ * @brief Exact on-wire bit counts and durations of CAN / CAN FD frames.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY exact and not "111 bits + worst case"?
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Bus-load and latency numbers are only meaningful if each frame occupies
+ *  the bus for as long as it would on a real wire.  Stuff bits depend on
+ *  the actual ID and payload (and, for classic CAN, the CRC), so they are
+ *  counted by building the unstuffed bit sequence and running the ISO
+ *  11898-1 stuffing rule over it:
+ *
+ *    Classic:  SOF | ID | RTR/SRR,IDE,… | DLC | DATA | CRC-15   ← stuffed
+ *              CRC delim | ACK | ACK delim | EOF(7)             ← not stuffed
+ *
+ *    FD:       SOF … BRS            nominal rate, dynamically stuffed
+ *              ESI | DLC | DATA     data rate (if BRS), dynamically stuffed
+ *              stuff count + CRC    data rate, FIXED stuff bit every 4 bits
+ *              CRC delim … EOF      nominal rate
+ *
+ *  The 3-bit interframe space is not part of the frame; callers add
+ *  IFS_BITS at the nominal rate between frames.
+ *
+ *  Header-only, Qt-free apart from CANMessage.
+ */
+
+#include <array>
+#include <cstdint>
+
+#include "hardware/CANInterface.h"
+
+namespace CANManager {
+namespace CANBitTiming {
+
+constexpr int IFS_BITS = 3;   ///< interframe space (intermission)
+
+/** Bit counts of one frame, split by bit-rate phase. */
+struct FrameBits
+{
+    int nominalBits = 0;   ///< bits sent at the nominal (arbitration) rate
+    int dataBits    = 0;   ///< bits sent at the FD data rate (0 without BRS)
+    int stuffBits   = 0;   ///< dynamic + fixed stuff bits (already included above)
+};
+
+namespace detail {
+
+/** Unstuffed bit sequence of one frame up to the end of the stuffed region. */
+class BitSeq
+{
+public:
+    void push(uint32_t value, int count)
+    {
+        for (int i = count - 1; i >= 0; --i)
+            m_bits[m_size++] = static_cast<uint8_t>((value >> i) & 1u);
+    }
+    int size() const { return m_size; }
+    uint8_t operator[](int i) const { return m_bits[i]; }
+
+private:
+    std::array<uint8_t, 640> m_bits{};   // FD 64 bytes ext: ~560 bits
+    int m_size = 0;
+};
+
+inline uint32_t crc15(const BitSeq& bits)
+{
+    uint32_t crc = 0;
+    for (int i = 0; i < bits.size(); ++i) {
+        const uint32_t next = bits[i] ^ ((crc >> 14) & 1u);
+        crc = (crc << 1) & 0x7FFFu;
+        if (next) crc ^= 0x4599u;
+    }
+    return crc;
+}
+
+/**
+ * @brief Count dynamic stuff bits over @p bits, reporting how many of them
+ *        fall at or after index @p splitAt (the FD data phase).
+ */
+inline int countStuffBits(const BitSeq& bits, int splitAt, int& stuffAfterSplit)
+{
+    int total = 0;
+    stuffAfterSplit = 0;
+    int run = 0;
+    uint8_t last = 2;
+    for (int i = 0; i < bits.size(); ++i) {
+        if (bits[i] == last) {
+            ++run;
+        } else {
+            last = bits[i];
+            run  = 1;
+        }
+        if (run == 5) {
+            ++total;
+            if (i >= splitAt) ++stuffAfterSplit;
+            last = static_cast<uint8_t>(!last);   // the stuff bit starts a new run
+            run  = 1;
+        }
+    }
+    return total;
+}
+
+} // namespace detail
+
+/** Exact bit counts of @p msg on the wire (excluding the interframe space). */
+inline FrameBits frameBits(const CANMessage& msg, bool brsEnabled = true)
+{
+    FrameBits fb;
+
+    if (msg.isError) {
+        // Error flag (6) + superposition (worst 6) + delimiter (8).
+        fb.nominalBits = 20;
+        return fb;
+    }
+
+    const int  len    = msg.isRemote ? 0 : msg.dataLength();
+    const int  dlc    = msg.dlc & 0x0F;
+    const bool ext    = msg.isExtended;
+    const uint32_t id = msg.id;
+
+    detail::BitSeq bits;
+    bits.push(0, 1);   // SOF
+
+    if (ext) {
+        bits.push((id >> 18) & 0x7FFu, 11);   // base ID
+        bits.push(1, 1);                      // SRR
+        bits.push(1, 1);                      // IDE
+        bits.push(id & 0x3FFFFu, 18);         // extended ID
+    } else {
+        bits.push(id & 0x7FFu, 11);
+    }
+
+    if (!msg.isFD) {
+        // ── Classic CAN ──────────────────────────────────────────────────────
+        bits.push(msg.isRemote ? 1 : 0, 1);   // RTR
+        if (ext) bits.push(0, 2);             // r1, r0
+        else     bits.push(0, 2);             // IDE, r0
+        bits.push(static_cast<uint32_t>(dlc), 4);
+        for (int i = 0; i < len; ++i)
+            bits.push(msg.data[i], 8);
+        bits.push(detail::crc15(bits), 15);
+
+        int unused = 0;
+        fb.stuffBits   = detail::countStuffBits(bits, bits.size(), unused);
+        fb.nominalBits = bits.size() + fb.stuffBits + 1 /*CRC del*/ + 2 /*ACK*/ + 7 /*EOF*/;
+        return fb;
+    }
+
+    // ── CAN FD ───────────────────────────────────────────────────────────────
+    const bool brs = brsEnabled && msg.isBRS;
+    bits.push(0, 1);                         // RRS
+    if (!ext) bits.push(0, 1);               // IDE (dominant for base format)
+    bits.push(1, 1);                         // FDF
+    bits.push(0, 1);                         // res
+    bits.push(brs ? 1 : 0, 1);               // BRS
+    const int dataPhaseStart = bits.size();  // rate switches after the BRS bit
+    bits.push(0, 1);                         // ESI (error active)
+    bits.push(static_cast<uint32_t>(dlc), 4);
+    for (int i = 0; i < len; ++i)
+        bits.push(msg.data[i], 8);
+
+    int dynStuffData = 0;
+    const int dynStuff = detail::countStuffBits(bits, dataPhaseStart, dynStuffData);
+
+    // CRC field: 4-bit stuff count + CRC-17 (≤ 16 bytes) or CRC-21, with a
+    // fixed stuff bit before the stuff count and after every 4 bits.
+    const int crcLen     = len <= 16 ? 17 : 21;
+    const int fixedStuff = len <= 16 ? 6 : 7;
+    const int crcField   = 4 + crcLen + fixedStuff;
+
+    const int arbBits  = dataPhaseStart + (dynStuff - dynStuffData);
+    const int dataBits = (bits.size() - dataPhaseStart) + dynStuffData + crcField;
+    const int tailBits = 1 /*CRC del*/ + 2 /*ACK*/ + 7 /*EOF*/;
+
+    fb.stuffBits = dynStuff + fixedStuff;
+    if (brs) {
+        fb.nominalBits = arbBits + tailBits;
+        fb.dataBits    = dataBits;
+    } else {
+        fb.nominalBits = arbBits + dataBits + tailBits;
+    }
+    return fb;
+}
+
+/** Nanoseconds @p bits occupy at @p bitrate bit/s. */
+inline uint64_t bitsToNs(int bits, int bitrate)
+{
+    return bitrate > 0 ? (static_cast<uint64_t>(bits) * 1000000000ull) / static_cast<uint64_t>(bitrate) : 0;
+}
+
+/** Time from SOF to the end of EOF for @p msg (no interframe space). */
+inline uint64_t frameDurationNs(const CANMessage& msg, int nominalBitrate, int dataBitrate,
+                                bool fdEnabled = true)
+{
+    const FrameBits fb = frameBits(msg, fdEnabled);
+    return bitsToNs(fb.nominalBits, nominalBitrate) + bitsToNs(fb.dataBits, dataBitrate);
+}
+
+} // namespace CANBitTiming
+} // namespace CANManager
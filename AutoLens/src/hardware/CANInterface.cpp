@@ -14,6 +14,18 @@
  * — which causes the classic "unresolved external symbol qt_metacall" error.
  *
  * This stub file satisfies that requirement with zero overhead.
+ * It also holds the capture pre-filter hook, which needs the full
+ * CaptureFilter definition.
  */
 
 #include "CANInterface.h"
+#include "CaptureFilter.h"
+
+namespace CANManager {
+
+bool ICANDriver::passesCaptureFilter(const CANMessage& msg) const
+{
+    return !m_captureFilter || m_captureFilter->accept(msg);
+}
+
+} // namespace CANManager
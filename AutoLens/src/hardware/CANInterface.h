@@ -7,6 +7,7 @@
  * Concrete drivers implement this interface:
  *   VectorCANDriver — talks to Vector VN hardware via vxlapi64.dll
  *   DemoCANDriver   — generates synthetic traffic (no hardware needed)
+ *   VirtualCANDriver — in-process bus with several nodes and arbitration
  *
  * Key types:
  *   CANMessage      — one CAN/CAN-FD frame (id, data, timestamp, flags)
@@ -31,6 +32,8 @@
 
 namespace CANManager {
 
+class CaptureFilter;
+
 // ============================================================================
 //  CAN DLC ↔ Data-Length helpers (supports CAN FD extended DLCs)
 // ============================================================================
@@ -159,6 +162,9 @@ struct CANResult
  * Currently implemented:
  *   VectorCANDriver — Vector VN series via vxlapi64.dll
  *   DemoCANDriver   — fake traffic, always available
+ *   VirtualCANDriver — simulated multi-node bus, always available
+ *   UdpCANDriver    — cannelloni CAN over UDP (remote benches)
+ *   SlcanDriver     — LAWICEL SLCAN serial adapters (CANable, USBtin)
  *
  * Lifecycle
  * ─────────
@@ -195,16 +201,61 @@ public:
 
     // --- Data operations ---
     virtual CANResult transmit(const CANMessage& msg) = 0;
+
+    /**
+     * @brief Transmit @p count frames with as few driver calls as possible.
+     *
+     * Stops at the first failure; @p sent receives the number of frames
+     * accepted (always a prefix of @p frames).  The default implementation
+     * calls transmit() per frame — drivers with a native multi-frame API
+     * override it.  Same threading rules as transmit().
+     */
+    virtual CANResult transmitBatch(const CANMessage* frames, int count, int* sent = nullptr)
+    {
+        int done = 0;
+        CANResult result = CANResult::Success();
+        for (; done < count; ++done) {
+            result = transmit(frames[done]);
+            if (!result.success) break;
+        }
+        if (sent) *sent = done;
+        return result;
+    }
     virtual CANResult receive(CANMessage& msg, int timeoutMs = 1000) = 0;
     virtual CANResult flushReceiveQueue() = 0;
     virtual QString   lastError() const = 0;
 
+    // --- Capture filter (see CaptureFilter.h) ---
+
+    /**
+     * @brief Pre-filter received frames with @p filter before messageReceived().
+     *
+     * Set once, before the receive thread starts; the filter's table can be
+     * changed at any time.  nullptr (the default) passes everything.
+     */
+    void setCaptureFilter(CaptureFilter* filter) { m_captureFilter = filter; }
+
+    /**
+     * @brief Program the interface's acceptance filter from the capture filter.
+     *
+     * Called after openChannel() and whenever the pass lists change.  Returns
+     * true if the hardware now drops frames itself; the default (no hardware
+     * filter) returns false and the software pre-filter does all the work.
+     */
+    virtual bool applyAcceptanceFilter() { return false; }
+
 signals:
     /** Emitted from the receive thread — connected via queued connection. */
     void messageReceived(const CANManager::CANMessage& msg);
     void errorOccurred(const QString& error);
     void channelOpened();
     void channelClosed();
+
+protected:
+    /** Call on the receive thread before emitting messageReceived(). */
+    bool passesCaptureFilter(const CANMessage& msg) const;
+
+    CaptureFilter* m_captureFilter = nullptr;
 };
 
 } // namespace CANManager
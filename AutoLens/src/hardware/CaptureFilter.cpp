@@ -0,0 +1,221 @@
+/**
+ * @file CaptureFilter.cpp
+ * @brief Pass-list parsing, table compilation and the receive-thread test.
+ */
+
+#include "hardware/CaptureFilter.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+namespace CANManager {
+
+namespace {
+
+constexpr uint32_t kStdMask = 0x7FFu;
+constexpr uint32_t kExtMask = 0x1FFFFFFFu;
+
+/** "0x100", 256, "0x100-0x1FF" → inclusive range. */
+bool parseRange(const QJsonValue& value, uint32_t fullMask,
+                CaptureFilter::Range& r, QString& error)
+{
+    if (value.isDouble()) {
+        r.first = r.last = static_cast<uint32_t>(value.toDouble());
+    } else {
+        const QString text = value.toString().trimmed();
+        const int dash = text.indexOf(QLatin1Char('-'));
+        bool okA = false, okB = true;
+        r.first = text.left(dash < 0 ? text.size() : dash).trimmed().toUInt(&okA, 0);
+        r.last  = dash < 0 ? r.first : text.mid(dash + 1).trimmed().toUInt(&okB, 0);
+        if (!okA || !okB) {
+            error = QString("bad ID or range \"%1\"").arg(text);
+            return false;
+        }
+    }
+    if (r.first > r.last)
+        std::swap(r.first, r.last);
+    if (r.last > fullMask) {
+        error = QString("ID 0x%1 out of range").arg(r.last, 0, 16);
+        return false;
+    }
+    return true;
+}
+
+void sortAndMerge(QVector<CaptureFilter::Range>& ranges)
+{
+    std::sort(ranges.begin(), ranges.end(),
+              [](const CaptureFilter::Range& a, const CaptureFilter::Range& b) { return a.first < b.first; });
+    QVector<CaptureFilter::Range> merged;
+    for (const CaptureFilter::Range& r : ranges) {
+        if (!merged.isEmpty() && r.first <= merged.last().last + 1)
+            merged.last().last = std::max(merged.last().last, r.last);
+        else
+            merged.append(r);
+    }
+    ranges = merged;
+}
+
+inline int slotOf(uint8_t channel)
+{
+    return (channel >= 1 && channel <= CaptureFilter::MAX_CHANNELS) ? channel : 0;
+}
+
+} // namespace
+
+CaptureFilter::CaptureFilter()
+    : m_table(std::make_shared<Table>())
+{
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Configuration
+// ─────────────────────────────────────────────────────────────────────────────
+
+QString CaptureFilter::setConfig(const QString& json)
+{
+    auto table = std::make_shared<Table>();
+    if (!json.trimmed().isEmpty()) {
+        const QString error = parse(json, *table);
+        if (!error.isEmpty())
+            return error;
+    }
+
+    // Channels without their own entry inherit the channel 0 list.
+    bool active = false;
+    for (int c = 0; c <= MAX_CHANNELS; ++c) {
+        if (c > 0 && !table->rules[c].active)
+            table->rules[c] = table->rules[0];
+        const ChannelRules& r = table->rules[c];
+        Compiled& out = table->compiled[c];
+        out.active = r.active;
+        out.ext    = r.ext;
+        for (const Range& s : r.std)
+            for (uint32_t id = s.first; id <= s.last; ++id)
+                out.stdBits[id >> 6] |= 1ull << (id & 63);
+        active |= r.active;
+    }
+
+    m_json = json;
+    std::atomic_store(&m_table, std::shared_ptr<const Table>(std::move(table)));
+    m_active.store(active, std::memory_order_relaxed);
+    resetStats();
+    qDebug() << "[CaptureFilter]" << (active ? "Pass lists active" : "Cleared — all frames pass");
+    return {};
+}
+
+QString CaptureFilter::parse(const QString& json, Table& t)
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+        return QString("JSON error at offset %1: %2").arg(parseError.offset).arg(parseError.errorString());
+
+    const QJsonArray list = doc.isArray() ? doc.array()
+                                          : doc.object().value(QStringLiteral("channels")).toArray();
+    for (int i = 0; i < list.size(); ++i) {
+        const QJsonObject o = list[i].toObject();
+        const QString where = QString("Entry %1").arg(i + 1);
+        const int channel = o.value(QStringLiteral("channel")).toInt(0);
+        if (channel < 0 || channel > MAX_CHANNELS)
+            return where + QString(": channel must be 0..%1").arg(MAX_CHANNELS);
+
+        ChannelRules& rules = t.rules[channel];
+        if (rules.active)
+            return where + QString(": channel %1 listed twice").arg(channel);
+        rules.active = true;
+
+        QString error;
+        for (const QJsonValue& v : o.value(QStringLiteral("std")).toArray()) {
+            Range r;
+            if (!parseRange(v, kStdMask, r, error))
+                return where + ": " + error;
+            rules.std.append(r);
+        }
+        for (const QJsonValue& v : o.value(QStringLiteral("ext")).toArray()) {
+            Range r;
+            if (!parseRange(v, kExtMask, r, error))
+                return where + ": " + error;
+            rules.ext.append(r);
+        }
+        sortAndMerge(rules.std);
+        sortAndMerge(rules.ext);
+    }
+    return {};
+}
+
+CaptureFilter::ChannelRules CaptureFilter::rules(int channel) const
+{
+    const auto table = std::atomic_load(&m_table);
+    return table->rules[slotOf(uint8_t(std::clamp(channel, 0, 255)))];
+}
+
+void CaptureFilter::coveringCode(const QVector<Range>& ranges, uint32_t fullMask,
+                                 uint32_t& code, uint32_t& mask)
+{
+    // Bits that differ anywhere in the list are "don't care".  Inside one
+    // range every bit at or below the highest differing bit of first^last
+    // takes both values.
+    uint32_t vary = 0;
+    code = ranges.isEmpty() ? 0 : ranges.first().first;
+    for (const Range& r : ranges) {
+        uint32_t span = r.first ^ r.last;
+        span |= span >> 1;  span |= span >> 2;  span |= span >> 4;
+        span |= span >> 8;  span |= span >> 16;
+        vary |= span | (r.first ^ code);
+    }
+    mask = ranges.isEmpty() ? 0 : (fullMask & ~vary);
+    code &= mask;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Receive thread
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool CaptureFilter::accept(const CANMessage& msg)
+{
+    if (!m_active.load(std::memory_order_relaxed) || msg.isError || msg.isTxConfirm)
+        return true;
+
+    const int slot = slotOf(msg.channel);
+    const auto table = std::atomic_load(&m_table);
+    const Compiled& c = table->compiled[slot];
+
+    bool pass = true;
+    if (c.active) {
+        if (!msg.isExtended) {
+            const uint32_t id = msg.id & kStdMask;
+            pass = (c.stdBits[id >> 6] >> (id & 63)) & 1u;
+        } else {
+            const auto it = std::upper_bound(c.ext.begin(), c.ext.end(), msg.id,
+                                             [](uint32_t id, const Range& r) { return id < r.first; });
+            pass = it != c.ext.begin() && msg.id <= (it - 1)->last;
+        }
+    }
+    (pass ? m_passed : m_filtered)[slot].fetch_add(1, std::memory_order_relaxed);
+    return pass;
+}
+
+QVector<CaptureFilter::ChannelStats> CaptureFilter::stats() const
+{
+    QVector<ChannelStats> out;
+    for (int c = 1; c <= MAX_CHANNELS; ++c)
+        out.append({ c, m_passed[c].load(std::memory_order_relaxed),
+                     m_filtered[c].load(std::memory_order_relaxed) });
+    out.append({ 0, m_passed[0].load(std::memory_order_relaxed),
+                 m_filtered[0].load(std::memory_order_relaxed) });
+    return out;
+}
+
+void CaptureFilter::resetStats()
+{
+    for (int c = 0; c <= MAX_CHANNELS; ++c) {
+        m_passed[c].store(0, std::memory_order_relaxed);
+        m_filtered[c].store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace CANManager
@@ -0,0 +1,138 @@
+#pragma once
+/**
+ * @file CaptureFilter.h
+ * @brief Per-channel ID pass lists: hardware acceptance + receive-thread bitmap.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  On a fully loaded bus most IDs are often of no interest, yet each one
+ *  costs a driver receive, a queued signal, a trace row and a decode.  The
+ *  cheapest frame is one that never leaves the interface; the next
+ *  cheapest is one dropped on the receive thread before messageReceived().
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  CONFIG (JSON, persisted as "Capture/filter")
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    { "channels": [
+ *      { "channel": 1,
+ *        "std": [ "0x100-0x1FF", "0x7DF", "0x7E8-0x7EF" ],  // 11-bit IDs
+ *        "ext": [ "0x18DA00F1-0x18DAFFF1" ] },              // 29-bit IDs
+ *      { "channel": 0, "std": [ "0x000-0x0FF" ] }          // any other channel
+ *    ] }
+ *
+ *  A channel with an entry passes only the listed IDs — "std" without
+ *  "ext" drops every extended frame.  A channel without an entry (and no
+ *  channel 0 entry) passes everything.  Error frames and TX echoes always
+ *  pass.  IDs are numbers or "0x…" strings; "a-b" is an inclusive range.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  TWO STAGES
+ * ═══════════════════════════════════════════════════════════════════════════
+ *    hardware   drivers with an acceptance filter (Vector: one code/mask
+ *               pair per ID type) program coveringCode() of the pass list
+ *               — a superset, since one code/mask cannot express arbitrary
+ *               ranges, so the software stage still runs after it
+ *    software   accept() on the driver receive thread: a 2048-bit bitmap
+ *               per channel for standard IDs (one load and a shift),
+ *               sorted merged ranges (binary search) for extended IDs
+ *
+ *  The compiled table is immutable and swapped atomically, like the
+ *  gateway's route table, so setConfig() never blocks the receive thread.
+ *  Dropped frames are counted per channel; the driver thread only does
+ *  relaxed increments.
+ */
+
+#include <QString>
+#include <QVector>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "hardware/CANInterface.h"
+
+namespace CANManager {
+
+class CaptureFilter
+{
+public:
+    static constexpr int MAX_CHANNELS = 4;   ///< per-channel counters; others share slot 0
+
+    struct Range
+    {
+        uint32_t first = 0;
+        uint32_t last  = 0;
+    };
+
+    /** The pass list of one channel, as configured (ranges sorted and merged). */
+    struct ChannelRules
+    {
+        bool           active = false;   ///< false → everything passes
+        QVector<Range> std;
+        QVector<Range> ext;
+    };
+
+    struct ChannelStats
+    {
+        int     channel  = 0;            ///< 0 = channels above MAX_CHANNELS
+        quint64 passed   = 0;
+        quint64 filtered = 0;
+    };
+
+    CaptureFilter();
+
+    /**
+     * @brief Parse and compile @p json, then swap the table in.
+     * @return Empty string on success, otherwise the first error (the
+     *         previous table stays active).  Empty JSON clears the filter.
+     */
+    QString setConfig(const QString& json);
+    QString config() const { return m_json; }
+
+    /** True while at least one channel has a pass list. */
+    bool isActive() const { return m_active.load(std::memory_order_relaxed); }
+
+    /** Pass list that applies to @p channel (1-based). */
+    ChannelRules rules(int channel) const;
+
+    /** Pre-filter one received frame and count it.  Called on the driver thread. */
+    bool accept(const CANMessage& msg);
+
+    QVector<ChannelStats> stats() const;
+    void resetStats();
+
+    /**
+     * @brief Smallest single acceptance code/mask that passes every ID in
+     *        @p ranges ((id & mask) == code).  @p fullMask is 0x7FF or
+     *        0x1FFFFFFF.  An empty list yields mask = 0 — callers close the
+     *        ID type instead.
+     */
+    static void coveringCode(const QVector<Range>& ranges, uint32_t fullMask,
+                             uint32_t& code, uint32_t& mask);
+
+private:
+    struct Compiled
+    {
+        bool                      active = false;
+        std::array<quint64, 32>   stdBits{};   ///< 2048 standard IDs
+        QVector<Range>            ext;
+    };
+    struct Table
+    {
+        std::array<ChannelRules, MAX_CHANNELS + 1> rules;   ///< [0] = any other channel
+        std::array<Compiled, MAX_CHANNELS + 1>     compiled;
+    };
+
+    static QString parse(const QString& json, Table& t);
+
+    std::shared_ptr<const Table> m_table;   ///< accessed with std::atomic_load/store
+    std::atomic<bool>            m_active{false};
+    QString                      m_json;
+
+    std::array<std::atomic<quint64>, MAX_CHANNELS + 1> m_passed{};
+    std::array<std::atomic<quint64>, MAX_CHANNELS + 1> m_filtered{};
+};
+
+} // namespace CANManager
@@ -8,6 +8,8 @@
  *
  * DBC-driven mode emits real message IDs from the loaded file and encodes
  * payloads via DBC signal definitions, so runtime decode can be verified.
+ * Scheduling is delegated to ResidualBusSimulator; this file only animates
+ * signal values and forwards the simulator's frames as received traffic.
  */
 
 #include "DemoCANDriver.h"
@@ -17,6 +19,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <limits>
 
 using namespace DBCManager;
 
@@ -25,6 +28,8 @@ namespace CANManager {
 namespace {
 
 constexpr int kTickMs = 10;
+constexpr int kStimulusMs = 100;      ///< signal animation rate in DBC mode
+constexpr int kDefaultCycleMs = 100;  ///< period for DBC messages without GenMsgCycleTime
 
 bool hasFiniteRange(const DBCSignal& sig)
 {
@@ -59,7 +64,9 @@ DemoCANDriver::~DemoCANDriver()
 
 void DemoCANDriver::setSimulationDatabase(const DBCDatabase& db)
 {
-    m_simPlans.clear();
+    stopDbcSimulation();
+
+    m_sim.clearConfiguration();
     m_useDbcSimulation = false;
 
     if (db.messages.isEmpty()) {
@@ -67,61 +74,79 @@ void DemoCANDriver::setSimulationDatabase(const DBCDatabase& db)
         return;
     }
 
-    QVector<DBCMessage> candidates;
-    candidates.reserve(db.messages.size());
+    // Demo mode plays every node of the database on channel 1.
+    m_sim.setChannelDatabase(1, db);
+    m_sim.setAllNodesEnabled(true);
+    m_sim.setDefaultCycleMs(kDefaultCycleMs);
+    m_useDbcSimulation = true;
 
-    // Restrict to classic CAN messages with actual signals.
-    for (const auto& msg : db.messages) {
-        if (msg.dlc == 0 || msg.dlc > 8)
-            continue;
-        if (msg.signalList.isEmpty())
-            continue;
-        candidates.append(msg);
-    }
+    qDebug() << "[DemoDriver] DBC simulation profile active:"
+             << db.messages.size() << "messages from" << db.nodes.size() << "nodes";
+
+    if (m_open)
+        startDbcSimulation();
+}
+
+void DemoCANDriver::startDbcSimulation()
+{
+    if (!m_useDbcSimulation || m_sim.isRunning())
+        return;
+
+    // Runs on the simulator thread.  messageReceived is therefore delivered
+    // to AppController through a queued connection.
+    m_simStartNs = m_elapsed.nsecsElapsed();
+    const qint64 startNs = m_simStartNs;
+    m_sim.setFrameSink([this, startNs](const QVector<CANMessage>& frames) {
+        for (CANMessage msg : frames) {
+            msg.channel   = 1;
+            msg.timestamp = static_cast<uint64_t>(startNs) + msg.timestamp;
+            if (passesCaptureFilter(msg))
+                emit messageReceived(msg);
+        }
+    });
 
-    if (candidates.isEmpty()) {
-        qDebug() << "[DemoDriver] DBC loaded but no usable classic messages."
-                 << "Using built-in simulation.";
+    if (!m_sim.start()) {
+        m_useDbcSimulation = false;   // nothing cyclic — fall back to built-in
         return;
     }
 
-    std::sort(candidates.begin(), candidates.end(),
-              [](const DBCMessage& a, const DBCMessage& b) {
-                  if (a.id != b.id)
-                      return a.id < b.id;
-                  return a.name < b.name;
-              });
-
-    // Spread message rates from 10 ms to 2 s.
-    static const int periods[] = {1, 2, 5, 10, 20, 50, 100, 200};
-    constexpr int periodCount = sizeof(periods) / sizeof(periods[0]);
-    constexpr int maxPlans = 8;
-    const int count = qMin(candidates.size(), maxPlans);
-
-    m_simPlans.reserve(count);
-    for (int i = 0; i < count; ++i) {
-        SimMessagePlan plan;
-        plan.message = candidates[i];
-        plan.periodTicks = periods[i % periodCount];
-        m_simPlans.append(plan);
+    // Flattened "last value" table so unchanged signals are never re-sent.
+    const int count = m_sim.scheduledMessageCount();
+    // Mux layout is fixed per message: find the selector and the distinct
+    // branch values once, so the stimulus can rotate through them.
+    m_stimulusOffset.resize(count);
+    m_stimulusMuxSel.fill(-1, count);
+    m_stimulusMuxValues.fill({}, count);
+    int total = 0;
+    for (int h = 0; h < count; ++h) {
+        const DBCMessage& msg = *m_sim.messageDefinition(h);
+        m_stimulusOffset[h] = total;
+        total += msg.signalList.size();
+
+        for (int i = 0; i < msg.signalList.size(); ++i) {
+            const DBCSignal& sig = msg.signalList[i];
+            if (sig.muxIndicator == "M")
+                m_stimulusMuxSel[h] = i;
+            else if (sig.muxValue >= 0 && !m_stimulusMuxValues[h].contains(sig.muxValue))
+                m_stimulusMuxValues[h].append(sig.muxValue);
+        }
     }
+    m_lastStimulus.fill(std::numeric_limits<double>::quiet_NaN(), total);
+    m_stimulusStep = 0;
 
-    m_useDbcSimulation = !m_simPlans.isEmpty();
-
-    QStringList summary;
-    summary.reserve(m_simPlans.size());
-    for (const auto& plan : m_simPlans) {
-        summary.append(
-            QString("0x%1(%2/%3ms)")
-                .arg(plan.message.id, plan.message.isExtended ? 8 : 3, 16, QChar('0'))
-                .arg(plan.message.name)
-                .arg(plan.periodTicks * kTickMs)
-                .toUpper()
-        );
+    if (!m_stimulusTimer) {
+        m_stimulusTimer = new QTimer(this);
+        m_stimulusTimer->setInterval(kStimulusMs);
+        connect(m_stimulusTimer, &QTimer::timeout, this, &DemoCANDriver::onStimulusTick);
     }
+    m_stimulusTimer->start();
+}
 
-    qDebug() << "[DemoDriver] DBC simulation profile active:"
-             << summary.join(", ");
+void DemoCANDriver::stopDbcSimulation()
+{
+    if (m_stimulusTimer)
+        m_stimulusTimer->stop();
+    m_sim.stop();
 }
 
 // ============================================================================
@@ -173,6 +198,8 @@ CANResult DemoCANDriver::openChannel(const CANChannelInfo& /*channel*/,
     connect(m_timer, &QTimer::timeout, this, &DemoCANDriver::onTick);
     m_timer->start();
 
+    startDbcSimulation();
+
     qDebug() << "[DemoDriver] Channel opened - synthetic traffic started";
     emit channelOpened();
     return CANResult::Success();
@@ -183,6 +210,8 @@ void DemoCANDriver::closeChannel()
     if (!m_open)
         return;
 
+    stopDbcSimulation();
+
     if (m_timer) {
         m_timer->stop();
         delete m_timer;
@@ -228,91 +257,9 @@ void DemoCANDriver::onTick()
     ++m_tick;
     const double seconds = m_elapsed.elapsed() / 1000.0;
 
-    // ------------------------------------------------------------------------
-    // DBC-driven simulation mode
-    // ------------------------------------------------------------------------
-    if (m_useDbcSimulation && !m_simPlans.isEmpty()) {
-        for (int planIndex = 0; planIndex < m_simPlans.size(); ++planIndex) {
-            const auto& plan = m_simPlans[planIndex];
-            if (plan.periodTicks <= 0 || (m_tick % plan.periodTicks) != 0)
-                continue;
-
-            const int dataLen = std::clamp(static_cast<int>(plan.message.dlc), 0, 8);
-            uint8_t data[8] = {};
-            QMap<QString, double> signalValues;
-
-            // Mux handling: pick one active mux branch if present.
-            const DBCSignal* muxSignal = nullptr;
-            QList<int> muxRawValues;
-            for (const auto& sig : plan.message.signalList) {
-                if (sig.muxIndicator == "M") {
-                    muxSignal = &sig;
-                } else if (sig.muxValue >= 0 && !muxRawValues.contains(sig.muxValue)) {
-                    muxRawValues.append(sig.muxValue);
-                }
-            }
-
-            int activeMuxRaw = -1;
-            if (muxSignal) {
-                if (!muxRawValues.isEmpty()) {
-                    const int selector = (m_tick / qMax(1, plan.periodTicks) + planIndex)
-                                       % muxRawValues.size();
-                    activeMuxRaw = muxRawValues[selector];
-                } else {
-                    activeMuxRaw = 0;
-                }
-
-                double muxPhys = muxSignal->rawToPhysical(activeMuxRaw);
-                muxPhys = clampToSignalRange(muxPhys, *muxSignal);
-                signalValues.insert(muxSignal->name, muxPhys);
-            }
-
-            int signalIndex = 0;
-            for (const auto& sig : plan.message.signalList) {
-                ++signalIndex;
-
-                if (sig.muxIndicator == "M")
-                    continue;
-
-                const bool isMuxedSignal =
-                    !sig.muxIndicator.isEmpty()
-                    && (sig.muxIndicator.startsWith('m') || sig.muxIndicator.startsWith('M'));
-                if (isMuxedSignal && activeMuxRaw >= 0 && sig.muxValue != activeMuxRaw)
-                    continue;
-
-                double value = 0.0;
-
-                if (!sig.valueDescriptions.isEmpty()) {
-                    QList<int64_t> rawKeys = sig.valueDescriptions.keys();
-                    std::sort(rawKeys.begin(), rawKeys.end());
-                    const int idx = (m_tick / qMax(1, plan.periodTicks)
-                                     + planIndex + signalIndex) % rawKeys.size();
-                    value = sig.rawToPhysical(rawKeys[idx]);
-                } else if (sig.bitLength == 1
-                           && sig.valueType != ValueType::Float32
-                           && sig.valueType != ValueType::Float64) {
-                    const int toggle = (m_tick / (5 + planIndex + signalIndex)) % 2;
-                    value = sig.rawToPhysical(toggle);
-                } else if (hasFiniteRange(sig)) {
-                    const double center = (sig.minimum + sig.maximum) * 0.5;
-                    const double amplitude = (sig.maximum - sig.minimum) * 0.35;
-                    const double freq = 0.12 + (planIndex * 0.03) + (signalIndex * 0.015);
-                    value = center + amplitude * std::sin(seconds * freq + planIndex);
-                } else if (std::abs(sig.initialValue) > 1e-9) {
-                    value = sig.initialValue;
-                } else {
-                    value = sig.offset;
-                }
-
-                value = clampToSignalRange(value, sig);
-                signalValues.insert(sig.name, value);
-            }
-
-            plan.message.encodeAll(signalValues, data, dataLen);
-            emitFrame(plan.message.id, data, static_cast<uint8_t>(dataLen), plan.message.isExtended);
-        }
+    // DBC-driven traffic is scheduled by m_sim on its own thread.
+    if (m_sim.isRunning())
         return;
-    }
 
     // ------------------------------------------------------------------------
     // Legacy built-in simulation (fallback when no DBC profile is configured)
@@ -392,6 +339,71 @@ void DemoCANDriver::onTick()
     }
 }
 
+// ============================================================================
+//  DBC stimulus (100 ms)
+// ============================================================================
+
+void DemoCANDriver::onStimulusTick()
+{
+    ++m_stimulusStep;
+    const int    step    = m_stimulusStep;
+    const double seconds = m_elapsed.elapsed() / 1000.0;
+    const int    count   = m_sim.scheduledMessageCount();
+
+    for (int h = 0; h < count; ++h) {
+        const DBCMessage& msg = *m_sim.messageDefinition(h);
+        const int base = m_stimulusOffset[h];
+
+        // Mux: pick this tick's active branch first.  All branches share the
+        // same payload bits, so only the active one may be written.
+        const int         muxSel       = m_stimulusMuxSel[h];
+        const QList<int>& muxRawValues = m_stimulusMuxValues[h];
+        int activeMuxRaw = -1;
+        if (muxSel >= 0)
+            activeMuxRaw = muxRawValues.isEmpty()
+                               ? 0
+                               : muxRawValues[(step / 10 + h) % muxRawValues.size()];
+
+        for (int i = 0; i < msg.signalList.size(); ++i) {
+            const DBCSignal& sig = msg.signalList[i];
+            const int signalIndex = i + 1;
+            double value = 0.0;
+
+            if (i == muxSel) {
+                value = sig.rawToPhysical(activeMuxRaw);
+            } else if (activeMuxRaw >= 0 && sig.muxValue >= 0 && sig.muxValue != activeMuxRaw) {
+                // Inactive branch: its bits now belong to another branch, so
+                // forget the last value and re-send when it comes back.
+                m_lastStimulus[base + i] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            } else if (!sig.valueDescriptions.isEmpty()) {
+                const QList<int64_t> rawKeys = sig.valueDescriptions.keys();   // sorted (QMap)
+                value = sig.rawToPhysical(rawKeys[(step / 10 + h + signalIndex) % rawKeys.size()]);
+            } else if (sig.bitLength == 1
+                       && sig.valueType != ValueType::Float32
+                       && sig.valueType != ValueType::Float64) {
+                value = sig.rawToPhysical((step / (5 + h % 8 + signalIndex)) % 2);
+            } else if (hasFiniteRange(sig)) {
+                const double center    = (sig.minimum + sig.maximum) * 0.5;
+                const double amplitude = (sig.maximum - sig.minimum) * 0.35;
+                const double freq      = 0.12 + (h % 8) * 0.03 + signalIndex * 0.015;
+                value = center + amplitude * std::sin(seconds * freq + h);
+            } else {
+                continue;   // keep the GenSigStartValue encoded at start
+            }
+
+            value = clampToSignalRange(value, sig);
+
+            // Skip unchanged signals — the simulator re-encodes per update.
+            double& last = m_lastStimulus[base + i];
+            if (last == value)
+                continue;
+            if (m_sim.setSignalValue(h, i, value))
+                last = value;
+        }
+    }
+}
+
 // ============================================================================
 //  Helper
 // ============================================================================
@@ -405,7 +417,8 @@ void DemoCANDriver::emitFrame(uint32_t id, const uint8_t* data, uint8_t dlc, boo
     msg.channel    = 1;
     msg.timestamp  = static_cast<uint64_t>(m_elapsed.nsecsElapsed());
     std::memcpy(msg.data, data, dlc);
-    emit messageReceived(msg);
+    if (passesCaptureFilter(msg))
+        emit messageReceived(msg);
 }
 
 } // namespace CANManager
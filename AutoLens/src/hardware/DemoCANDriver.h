@@ -26,10 +26,15 @@
  *  • Because the emit happens on the UI thread (same as AppController),
  *    Qt uses a direct connection — still safe, no queuing needed here.
  *  • Timestamps are in nanoseconds to match the Vector XL API convention.
+ *  • With a DBC loaded, every message is scheduled by ResidualBusSimulator
+ *    (its own thread, timing wheel).  Frames then arrive at AppController
+ *    through a queued connection; a 100 ms stimulus timer on the UI thread
+ *    animates signal values.
  */
 
 #include "CANInterface.h"
 #include "dbc/DBCParser.h"
+#include "sim/ResidualBusSimulator.h"
 #include <QTimer>
 #include <QElapsedTimer>
 #include <QVector>
@@ -49,7 +54,8 @@ public:
      *
      * When a non-empty database is provided, DemoCANDriver emits frames whose
      * IDs and payload layouts come from the DBC file so runtime decoding can be
-     * verified directly in the trace view.
+     * verified directly in the trace view.  All nodes are simulated; messages
+     * without GenMsgCycleTime are sent every 100 ms.
      */
     void setSimulationDatabase(const DBCManager::DBCDatabase& db);
 
@@ -79,11 +85,12 @@ private slots:
     /** Called by QTimer every 10 ms — the "heartbeat" of the simulation. */
     void onTick();
 
+    /** Called every 100 ms in DBC mode — pushes new signal values to m_sim. */
+    void onStimulusTick();
+
 private:
-    struct SimMessagePlan {
-        DBCManager::DBCMessage message;
-        int periodTicks = 1;    ///< 1 tick = 10 ms
-    };
+    void startDbcSimulation();
+    void stopDbcSimulation();
 
     // Build and emit one simulated CAN frame
     void emitFrame(uint32_t id, const uint8_t* data, uint8_t dlc,
@@ -95,8 +102,16 @@ private:
     QElapsedTimer m_elapsed;        ///< Measures time since openChannel() call
     int           m_tick      = 0;  ///< Tick counter used to derive sub-rates
 
-    QVector<SimMessagePlan> m_simPlans;  ///< Active DBC-based simulation plans
-    bool                    m_useDbcSimulation = false;
+    // --- DBC-driven mode ---
+    ResidualBusSimulator m_sim;
+    QTimer*         m_stimulusTimer = nullptr;
+    int             m_stimulusStep  = 0;
+    QVector<double> m_lastStimulus;     ///< per (message, signal), flattened
+    QVector<int>    m_stimulusOffset;   ///< message handle → index into m_lastStimulus
+    QVector<int>    m_stimulusMuxSel;   ///< message handle → selector signal index, -1 if none
+    QVector<QList<int>> m_stimulusMuxValues;   ///< message handle → distinct branch values
+    qint64          m_simStartNs    = 0;   ///< m_elapsed at simulator start
+    bool            m_useDbcSimulation = false;
 };
 
 } // namespace CANManager
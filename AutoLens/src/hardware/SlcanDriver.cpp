@@ -0,0 +1,671 @@
+/**
+ * @file SlcanDriver.cpp
+ * @brief SLCAN (LAWICEL) serial adapters: chunked reads, table-driven parser.
+ */
+
+#include "SlcanDriver.h"
+#include "util/ThreadPlacement.h"
+
+#include <QDebug>
+#include <QDir>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <cerrno>
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <termios.h>
+#  include <unistd.h>
+#endif
+
+namespace CANManager {
+
+namespace {
+
+constexpr uint8_t kChannel   = 1;
+constexpr int     kPollMs    = 50;       ///< re-check m_running this often
+constexpr uint8_t kBad       = 0x80;     ///< kHex marker for a non-hex byte
+
+// ── Hex digit table: value 0-15, or kBad ────────────────────────────────────
+struct HexTable
+{
+    uint8_t v[256];
+    constexpr HexTable() : v()
+    {
+        for (int i = 0; i < 256; ++i) v[i] = kBad;
+        for (int i = 0; i < 10; ++i)  v['0' + i] = uint8_t(i);
+        for (int i = 0; i < 6; ++i) { v['A' + i] = uint8_t(10 + i); v['a' + i] = uint8_t(10 + i); }
+    }
+};
+constexpr HexTable kHex;
+
+// ── Record type table: first byte → ID digits + flags (0 = not a frame) ─────
+enum : uint8_t { kExt = 0x10, kRtr = 0x20, kFd = 0x40, kBrs = 0x80 };
+
+struct TypeTable
+{
+    uint8_t v[256];   ///< low nibble = ID hex digits, high nibble = flags
+    constexpr TypeTable() : v()
+    {
+        v['t'] = 3;  v['T'] = 8 | kExt;
+        v['r'] = 3 | kRtr;  v['R'] = 8 | kExt | kRtr;
+        v['d'] = 3 | kFd;   v['D'] = 8 | kExt | kFd;
+        v['b'] = 3 | kFd | kBrs;  v['B'] = 8 | kExt | kFd | kBrs;
+    }
+};
+constexpr TypeTable kType;
+
+constexpr char kHexDigits[] = "0123456789ABCDEF";
+
+/** "S<n>" digit for a nominal bitrate, or 0 if SLCAN has none. */
+char nominalCode(int bitrate)
+{
+    switch (bitrate) {
+    case 10000:   return '0';
+    case 20000:   return '1';
+    case 50000:   return '2';
+    case 100000:  return '3';
+    case 125000:  return '4';
+    case 250000:  return '5';
+    case 500000:  return '6';
+    case 800000:  return '7';
+    case 1000000: return '8';
+    default:      return 0;
+    }
+}
+
+/** "Y<n>" digit for an FD data bitrate (CANable 2.0 convention: n Mbit/s). */
+char dataCode(int bitrate)
+{
+    switch (bitrate) {
+    case 1000000: return '1';
+    case 2000000: return '2';
+    case 4000000: return '4';
+    case 5000000: return '5';
+    case 8000000: return '8';
+    default:      return 0;
+    }
+}
+
+#ifdef Q_OS_WIN
+inline HANDLE handle(qintptr p) { return reinterpret_cast<HANDLE>(p); }
+
+/** Overlapped read/write on @p h; waits for completion.  Returns bytes or -1. */
+int overlappedIo(HANDLE h, bool write, void* buf, DWORD len)
+{
+    OVERLAPPED ov{};
+    ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    DWORD n = 0;
+    BOOL ok = write ? WriteFile(h, buf, len, &n, &ov) : ReadFile(h, buf, len, &n, &ov);
+    if (!ok && GetLastError() == ERROR_IO_PENDING)
+        ok = GetOverlappedResult(h, &ov, &n, TRUE);
+    CloseHandle(ov.hEvent);
+    return ok ? int(n) : -1;
+}
+#else
+speed_t baudConstant(int baud)
+{
+    switch (baud) {
+    case 9600:    return B9600;
+    case 19200:   return B19200;
+    case 38400:   return B38400;
+    case 57600:   return B57600;
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+#  ifdef B460800
+    case 460800:  return B460800;
+#  endif
+#  ifdef B921600
+    case 921600:  return B921600;
+#  endif
+#  ifdef B1000000
+    case 1000000: return B1000000;
+#  endif
+#  ifdef B2000000
+    case 2000000: return B2000000;
+#  endif
+#  ifdef B3000000
+    case 3000000: return B3000000;
+#  endif
+    default:      return B115200;
+    }
+}
+#endif
+
+} // namespace
+
+// ============================================================================
+//  Ctor / Dtor
+// ============================================================================
+
+SlcanDriver::SlcanDriver(QObject* parent) : ICANDriver(parent) {}
+
+SlcanDriver::~SlcanDriver()
+{
+    shutdown();
+}
+
+void SlcanDriver::shutdown()
+{
+    closeChannel();
+}
+
+// ============================================================================
+//  Record format
+// ============================================================================
+
+/*static*/ bool SlcanDriver::decodeRecord(const char* rec, int len, CANMessage& msg, int& tsMs)
+{
+    const auto* r = reinterpret_cast<const uint8_t*>(rec);
+    const uint8_t type = len > 0 ? kType.v[r[0]] : 0;
+    const int idDigits = type & 0x0F;
+    if (idDigits == 0 || len < idDigits + 2)
+        return false;
+
+    // Invalid hex digits set kBad in `bad`; checked once at the end.
+    uint8_t  bad = 0;
+    uint32_t id  = 0;
+    for (int i = 1; i <= idDigits; ++i) {
+        const uint8_t v = kHex.v[r[i]];
+        bad |= v;
+        id = (id << 4) | (v & 0x0F);
+    }
+    const uint8_t dlc = kHex.v[r[idDigits + 1]];
+    bad |= dlc;
+
+    const bool fd     = (type & kFd) != 0;
+    const bool remote = (type & kRtr) != 0;
+    const int  bytes  = remote ? 0 : (fd ? dlcToLength(dlc & 0x0F) : std::min<int>(dlc & 0x0F, 8));
+
+    int pos = idDigits + 2;
+    const int rest = len - pos - 2 * bytes;
+    if (rest != 0 && rest != 4)
+        return false;
+
+    msg = CANMessage();
+    for (int i = 0; i < bytes; ++i, pos += 2) {
+        const uint8_t hi = kHex.v[r[pos]];
+        const uint8_t lo = kHex.v[r[pos + 1]];
+        bad |= hi | lo;
+        msg.data[i] = uint8_t((hi << 4) | (lo & 0x0F));
+    }
+
+    tsMs = -1;
+    if (rest == 4) {
+        int ts = 0;
+        for (int i = 0; i < 4; ++i) {
+            const uint8_t v = kHex.v[r[pos + i]];
+            bad |= v;
+            ts = (ts << 4) | (v & 0x0F);
+        }
+        tsMs = ts;
+    }
+
+    const bool ext = (type & kExt) != 0;
+    if ((bad & kBad) || (!fd && dlc > 8) || id > (ext ? 0x1FFFFFFFu : 0x7FFu))
+        return false;
+
+    msg.id         = id;
+    msg.dlc        = dlc;
+    msg.isExtended = ext;
+    msg.isRemote   = remote;
+    msg.isFD       = fd;
+    msg.isBRS      = (type & kBrs) != 0;
+    msg.channel    = kChannel;
+    return true;
+}
+
+/*static*/ int SlcanDriver::encodeRecord(const CANMessage& msg, char* out)
+{
+    char type = msg.isFD ? (msg.isBRS ? 'b' : 'd') : (msg.isRemote ? 'r' : 't');
+    if (msg.isExtended)
+        type = char(type - ('a' - 'A'));
+
+    int pos = 0;
+    out[pos++] = type;
+    const int idDigits = msg.isExtended ? 8 : 3;
+    for (int i = idDigits - 1; i >= 0; --i)
+        out[pos++] = kHexDigits[(msg.id >> (4 * i)) & 0x0F];
+
+    const uint8_t dlc = msg.isFD ? uint8_t(msg.dlc & 0x0F) : uint8_t(std::min<int>(msg.dlc, 8));
+    out[pos++] = kHexDigits[dlc];
+
+    const int bytes = (msg.isRemote && !msg.isFD) ? 0 : msg.dataLength();
+    for (int i = 0; i < bytes; ++i) {
+        out[pos++] = kHexDigits[msg.data[i] >> 4];
+        out[pos++] = kHexDigits[msg.data[i] & 0x0F];
+    }
+    out[pos++] = '\r';
+    return pos;
+}
+
+// ============================================================================
+//  Channel Detection — one "channel" per serial port
+// ============================================================================
+
+QList<CANChannelInfo> SlcanDriver::detectChannels()
+{
+    QStringList ports = m_extraPorts;
+
+#ifdef Q_OS_WIN
+    HKEY key = nullptr;
+    if (RegOpenKeyExW(HKEY_LOCAL_MACHINE, L"HARDWARE\\DEVICEMAP\\SERIALCOMM",
+                      0, KEY_READ, &key) == ERROR_SUCCESS) {
+        for (DWORD i = 0;; ++i) {
+            wchar_t name[256];
+            wchar_t value[64];
+            DWORD nameLen = 256, valueLen = sizeof(value), type = 0;
+            if (RegEnumValueW(key, i, name, &nameLen, nullptr, &type,
+                              reinterpret_cast<BYTE*>(value), &valueLen) != ERROR_SUCCESS)
+                break;
+            if (type == REG_SZ)
+                ports.append(QString::fromWCharArray(value));
+        }
+        RegCloseKey(key);
+    }
+#else
+    const QDir dev(QStringLiteral("/dev"));
+    const QStringList names = dev.entryList({ QStringLiteral("ttyACM*"), QStringLiteral("ttyUSB*"),
+                                              QStringLiteral("cu.usbmodem*"), QStringLiteral("cu.usbserial*") },
+                                            QDir::System | QDir::Files, QDir::Name);
+    for (const QString& n : names)
+        ports.append(dev.filePath(n));
+#endif
+    ports.removeDuplicates();
+
+    QList<CANChannelInfo> list;
+    for (int i = 0; i < ports.size(); ++i) {
+        CANChannelInfo ch;
+        ch.name         = ports[i];
+        ch.hwTypeName   = QStringLiteral("SLCAN");
+        ch.channelIndex = i;
+        ch.channelMask  = 1ull << std::min(i, 63);
+        ch.supportsFD   = true;   // unknown until opened; FD firmware accepts d/b records
+        list.append(ch);
+    }
+    return list;
+}
+
+// ============================================================================
+//  Open / Close
+// ============================================================================
+
+CANResult SlcanDriver::openChannel(const CANChannelInfo& channel, const CANBusConfig& config)
+{
+    if (isOpen())
+        return CANResult::Failure("Already open");
+
+    const char sCode = nominalCode(config.bitrate);
+    if (!sCode)
+        return fail(QString("SLCAN has no preset for %1 bit/s").arg(config.bitrate));
+    const char yCode = config.fdEnabled ? dataCode(config.fdDataBitrate) : 0;
+    if (config.fdEnabled && !yCode)
+        return fail(QString("SLCAN has no FD preset for %1 bit/s").arg(config.fdDataBitrate));
+
+    m_portName = channel.name;
+
+#ifdef Q_OS_WIN
+    const QString path = m_portName.startsWith(QLatin1String("\\\\.\\"))
+                       ? m_portName : QStringLiteral("\\\\.\\") + m_portName;
+    HANDLE h = CreateFileW(reinterpret_cast<const wchar_t*>(path.utf16()),
+                           GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+                           FILE_FLAG_OVERLAPPED, nullptr);
+    if (h == INVALID_HANDLE_VALUE)
+        return fail(QString("Cannot open %1: %2").arg(m_portName, qt_error_string(int(GetLastError()))));
+
+    DCB dcb{};
+    dcb.DCBlength = sizeof(dcb);
+    GetCommState(h, &dcb);
+    dcb.BaudRate     = DWORD(m_baud);
+    dcb.ByteSize     = 8;
+    dcb.Parity       = NOPARITY;
+    dcb.StopBits     = ONESTOPBIT;
+    dcb.fBinary      = TRUE;
+    dcb.fOutxCtsFlow = FALSE;
+    dcb.fOutxDsrFlow = FALSE;
+    dcb.fDtrControl  = DTR_CONTROL_ENABLE;
+    dcb.fRtsControl  = RTS_CONTROL_ENABLE;
+    SetCommState(h, &dcb);
+    SetupComm(h, READ_CHUNK * 4, READ_CHUNK);
+
+    // Return as soon as any byte is there, or after kPollMs of silence
+    COMMTIMEOUTS to{};
+    to.ReadIntervalTimeout        = MAXDWORD;
+    to.ReadTotalTimeoutMultiplier = MAXDWORD;
+    to.ReadTotalTimeoutConstant   = kPollMs;
+    to.WriteTotalTimeoutConstant  = 1000;
+    SetCommTimeouts(h, &to);
+    PurgeComm(h, PURGE_RXCLEAR | PURGE_TXCLEAR);
+    m_port = reinterpret_cast<qintptr>(h);
+#else
+    const int fd = ::open(m_portName.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0)
+        return fail(QString("Cannot open %1: %2").arg(m_portName, qt_error_string(errno)));
+
+    termios tio{};
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        cfsetispeed(&tio, baudConstant(m_baud));
+        cfsetospeed(&tio, baudConstant(m_baud));
+        tio.c_cc[VMIN]  = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+        tcflush(fd, TCIOFLUSH);
+    }
+    m_port = fd;
+#endif
+
+    m_config = config;
+    m_rxBuf.assign(READ_CHUNK + MAX_RECORD, 0);
+    m_carry  = 0;
+    m_batch.clear();
+    m_batch.reserve((READ_CHUNK + MAX_RECORD) / 6 + 1);   // shortest record: "t0000\r"
+    m_haveTs = false;
+    m_rxStats = LinkStats();
+    {
+        QMutexLocker lock(&m_statsMutex);
+        m_stats = LinkStats();
+    }
+    m_lastError.clear();
+
+    // Close (in case the adapter was left open), configure, go on bus.
+    // Responses ('\r' / BELL) are consumed by the receive thread.
+    const char sCmd[] = { 'S', sCode, 0 };
+    const char yCmd[] = { 'Y', yCode, 0 };
+    bool ok = writePort("\r\r\r", 3) && sendCommand("C") && sendCommand(sCmd);
+    if (ok && yCode)
+        ok = sendCommand(yCmd);
+    ok = ok && sendCommand("Z1") && sendCommand(config.listenOnly ? "L" : "O");
+    if (!ok) {
+        const CANResult r = fail(QString("Write to %1 failed").arg(m_portName));
+        closeChannel();
+        return r;
+    }
+
+    m_clock.start();
+    m_running  = true;
+    m_rxThread = QThread::create([this]() { rxLoop(); });
+    m_rxThread->setObjectName(QStringLiteral("AutoLens_SLCAN_RX"));
+    m_rxThread->start(QThread::HighPriority);
+
+    qDebug() << "[SLCAN] Opened" << m_portName << "S" + QString(QChar(sCode))
+             << (yCode ? "Y" + QString(QChar(yCode)) : QString())
+             << (config.listenOnly ? "listen-only" : "normal");
+    emit channelOpened();
+    return CANResult::Success();
+}
+
+void SlcanDriver::closeChannel()
+{
+    if (!isOpen()) return;
+
+    const bool wasRunning = m_running.exchange(false);
+    if (m_rxThread) {
+        m_rxThread->wait();   // returns within kPollMs
+        delete m_rxThread;
+        m_rxThread = nullptr;
+    }
+
+    QMutexLocker lock(&m_txMutex);
+    sendCommand("C");   // off bus; harmless if the port is already gone
+#ifdef Q_OS_WIN
+    CloseHandle(handle(m_port));
+#else
+    ::close(int(m_port));
+#endif
+    m_port = -1;
+    lock.unlock();
+
+    if (wasRunning) {
+        const LinkStats st = stats();
+        qDebug() << "[SLCAN] Closed" << m_portName << ":" << st.frames << "frames,"
+                 << st.bytes << "bytes," << st.malformed << "malformed," << st.refused << "refused";
+        emit channelClosed();
+    }
+}
+
+// ============================================================================
+//  Port I/O
+// ============================================================================
+
+int SlcanDriver::readPort(char* buf, int maxLen)
+{
+#ifdef Q_OS_WIN
+    return overlappedIo(handle(m_port), false, buf, DWORD(maxLen));
+#else
+    pollfd pfd{};
+    pfd.fd     = int(m_port);
+    pfd.events = POLLIN;
+    const int ready = ::poll(&pfd, 1, kPollMs);
+    if (ready < 0)
+        return errno == EINTR ? 0 : -1;
+    if (ready == 0)
+        return 0;
+    if (pfd.revents & (POLLHUP | POLLERR | POLLNVAL))
+        return -1;   // adapter unplugged / pty master closed
+    const ssize_t n = ::read(int(m_port), buf, size_t(maxLen));
+    if (n < 0)
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    return int(n);
+#endif
+}
+
+bool SlcanDriver::writePort(const char* data, int len)
+{
+#ifdef Q_OS_WIN
+    return overlappedIo(handle(m_port), true, const_cast<char*>(data), DWORD(len)) == len;
+#else
+    while (len > 0) {
+        const ssize_t n = ::write(int(m_port), data, size_t(len));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) { QThread::usleep(100); continue; }
+            return false;
+        }
+        data += n;
+        len  -= int(n);
+    }
+    return true;
+#endif
+}
+
+bool SlcanDriver::sendCommand(const char* cmd)
+{
+    char line[16];
+    const int n = int(std::strlen(cmd));
+    std::memcpy(line, cmd, size_t(n));
+    line[n] = '\r';
+    return writePort(line, n + 1);
+}
+
+// ============================================================================
+//  Receive thread
+// ============================================================================
+
+void SlcanDriver::rxLoop()
+{
+    ThreadPlacement::Scope placement(ThreadPlacement::Receive);
+    while (m_running.load(std::memory_order_relaxed)) {
+        const int n = readPort(m_rxBuf.data() + m_carry, READ_CHUNK);
+        if (n < 0) {
+            if (!m_running.load()) break;
+            const QString err = QString("Serial port lost: %1").arg(m_portName);
+            qWarning() << "[SLCAN]" << err;
+            emit errorOccurred(err);   // AppController disconnects
+            break;
+        }
+        if (n == 0)
+            continue;
+
+        const int total    = m_carry + n;
+        const int consumed = parseBuffer(total, static_cast<uint64_t>(m_clock.nsecsElapsed()));
+        m_rxStats.bytes += quint64(n);
+
+        for (const CANMessage& msg : m_batch)
+            if (passesCaptureFilter(msg))
+                emit messageReceived(msg);
+
+        // Keep a partial record for the next read; a "record" longer than
+        // any valid one is line noise.
+        m_carry = total - consumed;
+        if (m_carry > MAX_RECORD) {
+            ++m_rxStats.malformed;
+            m_carry = 0;
+        } else if (m_carry > 0) {
+            std::memmove(m_rxBuf.data(), m_rxBuf.data() + consumed, size_t(m_carry));
+        }
+
+        QMutexLocker lock(&m_statsMutex);
+        m_stats = m_rxStats;
+    }
+}
+
+int SlcanDriver::parseBuffer(int len, uint64_t hostNs)
+{
+    m_batch.clear();
+
+    const char* const base = m_rxBuf.data();
+    const char* p   = base;
+    const char* end = base + len;
+
+    while (const char* cr = static_cast<const char*>(std::memchr(p, '\r', size_t(end - p)))) {
+        // BELL (refused command) is a single byte without '\r'
+        while (p < cr && *p == '\a') {
+            ++m_rxStats.refused;
+            ++p;
+        }
+        const int n = int(cr - p);
+        if (n > 0 && kType.v[uint8_t(*p)] != 0) {
+            m_batch.emplace_back();
+            int tsMs = -1;
+            if (decodeRecord(p, n, m_batch.back(), tsMs)) {
+                m_batch.back().timestamp = frameTimeNs(tsMs, hostNs);
+                ++m_rxStats.frames;
+            } else {
+                m_batch.pop_back();
+                ++m_rxStats.malformed;
+            }
+        }
+        // else: OK ('\r'), transmit ack (z/Z), version/status replies
+        p = cr + 1;
+    }
+    while (p < end && *p == '\a') {
+        ++m_rxStats.refused;
+        ++p;
+    }
+    return int(p - base);
+}
+
+uint64_t SlcanDriver::frameTimeNs(int tsMs, uint64_t hostNs)
+{
+    if (tsMs < 0)
+        return hostNs;
+
+    if (!m_haveTs) {
+        m_haveTs        = true;
+        m_tsBaseNs      = hostNs;
+        m_tsUnwrappedMs = 0;
+        m_lastTsMs      = tsMs;
+        m_lastTsHostNs  = hostNs;
+        return hostNs;
+    }
+
+    // Adapter clock wraps every 60 s; the host clock tells how many
+    // rollovers a long silence spanned.
+    uint64_t delta = uint64_t((tsMs - m_lastTsMs + 60000) % 60000);
+    const uint64_t hostDeltaMs = (hostNs - m_lastTsHostNs) / 1000000u;
+    if (hostDeltaMs > delta + 30000)
+        delta += ((hostDeltaMs - delta + 30000) / 60000) * 60000;
+
+    m_tsUnwrappedMs += delta;
+    m_lastTsMs       = tsMs;
+    m_lastTsHostNs   = hostNs;
+    return m_tsBaseNs + m_tsUnwrappedMs * 1000000u;
+}
+
+// ============================================================================
+//  Transmit
+// ============================================================================
+
+CANResult SlcanDriver::transmitBatch(const CANMessage* frames, int count, int* sent)
+{
+    if (sent) *sent = 0;
+    if (m_config.listenOnly)
+        return CANResult::Failure("No TX access (listen-only)");
+
+    for (int i = 0; i < count; ++i) {
+        if (frames[i].isFD && !m_config.fdEnabled)
+            return CANResult::Failure("CAN FD frame on a classic CAN channel");
+    }
+
+    // Up to TX_CHUNK_FRAMES records leave in one write().  The encode
+    // buffer is sized once and shared by every caller under m_txMutex —
+    // this is the gateway's per-frame path, no allocation here.
+    {
+        QMutexLocker lock(&m_txMutex);
+        if (!isOpen())
+            return CANResult::Failure("Not open");
+        if (m_txBuf.empty())
+            m_txBuf.resize(size_t(TX_CHUNK_FRAMES) * MAX_RECORD);
+
+        for (int first = 0; first < count; first += TX_CHUNK_FRAMES) {
+            const int last = qMin(count, first + TX_CHUNK_FRAMES);
+            int len = 0;
+            for (int i = first; i < last; ++i)
+                len += encodeRecord(frames[i], m_txBuf.data() + len);
+            if (!writePort(m_txBuf.data(), len)) {
+                if (sent) *sent = first;   // earlier chunks are on the wire
+                return CANResult::Failure(QString("Write to %1 failed").arg(m_portName));
+            }
+        }
+    }
+
+    // TX echo (the adapter only acknowledges with 'z')
+    const uint64_t now = static_cast<uint64_t>(m_clock.nsecsElapsed());
+    for (int i = 0; i < count; ++i) {
+        CANMessage echo  = frames[i];
+        echo.channel     = kChannel;
+        echo.timestamp   = now;
+        echo.isTxConfirm = true;
+        emit messageReceived(echo);
+    }
+    if (sent) *sent = count;
+    return CANResult::Success();
+}
+
+// ============================================================================
+//  Misc
+// ============================================================================
+
+CANResult SlcanDriver::receive(CANMessage& /*msg*/, int /*timeoutMs*/)
+{
+    return CANResult::Failure("SLCAN driver delivers frames via messageReceived()");
+}
+
+QString SlcanDriver::lastError() const
+{
+    return m_lastError;
+}
+
+SlcanDriver::LinkStats SlcanDriver::stats() const
+{
+    QMutexLocker lock(&m_statsMutex);
+    return m_stats;
+}
+
+CANResult SlcanDriver::fail(const QString& msg)
+{
+    m_lastError = msg;
+    qWarning() << "[SLCAN]" << msg;
+    return CANResult::Failure(msg);
+}
+
+} // namespace CANManager
@@ -0,0 +1,155 @@
+#pragma once
+/**
+ * @file SlcanDriver.h
+ * @brief LAWICEL SLCAN adapters (CANable, USBtin, CANUSB) over a serial port.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  PROTOCOL
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  ASCII records terminated by '\r', hex digits upper or lower case:
+ *
+ *    t iii L dd…  [tttt]   standard data        T iiiiiiii L dd… [tttt]  extended
+ *    r iii L      [tttt]   standard remote      R iiiiiiii L     [tttt]  extended
+ *    d iii L dd…  [tttt]   FD, no BRS           D iiiiiiii L dd… [tttt]  (CANable 2.0
+ *    b iii L dd…  [tttt]   FD with BRS          B iiiiiiii L dd… [tttt]   FD firmware)
+ *
+ *  L is the DLC (0-8, or 0-F for FD).  tttt is the optional adapter
+ *  timestamp in ms (0…59999, enabled with "Z1").  '\r' alone is an OK,
+ *  '\a' (BELL) a refused command; "z"/"Z" acknowledge a transmit.
+ *
+ *  Open sequence: C, S<n> (nominal bitrate), Y<n> (FD data bitrate),
+ *  Z1 (timestamps), then O — or L for listen-only.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  RECEIVE PATH
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  A dedicated thread reads up to READ_CHUNK bytes per system call (one
+ *  USB bulk transfer holds dozens of records).  Complete records are parsed
+ *  in place — hex digits through a 256-entry table, invalid bytes OR-ed into
+ *  one flag that is tested once per record — into a CANMessage batch; a
+ *  trailing partial record moves to the front of the buffer for the next
+ *  read.  Adapter timestamps are unwrapped across the 60 s rollover (the
+ *  host clock resolves multiple rollovers during silence); without them the
+ *  frames get the host time of the read.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  PORTS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  detectChannels() lists the serial ports (Windows: SERIALCOMM registry
+ *  key; Linux: /dev/ttyACM*, /dev/ttyUSB*) plus setExtraPorts() — e.g. the
+ *  slave side of a pseudo-terminal (/dev/pts/N) driven by a test script.
+ */
+
+#include "CANInterface.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <vector>
+
+namespace CANManager {
+
+class SlcanDriver : public ICANDriver
+{
+    Q_OBJECT
+
+public:
+    static constexpr int READ_CHUNK      = 16384;   ///< bytes per read()
+    static constexpr int MAX_RECORD      = 160;     ///< longest valid record ("B" + 64 bytes + ts)
+    static constexpr int TX_CHUNK_FRAMES = 64;      ///< records per write() in transmitBatch()
+    static constexpr int DEFAULT_BAUD    = 115200;  ///< ignored by USB CDC adapters
+
+    struct LinkStats
+    {
+        quint64 bytes     = 0;
+        quint64 frames    = 0;
+        quint64 malformed = 0;   ///< records that failed to parse
+        quint64 refused   = 0;   ///< BELL responses
+    };
+
+    explicit SlcanDriver(QObject* parent = nullptr);
+    ~SlcanDriver() override;
+
+    /** Extra port names offered by detectChannels() (e.g. a pty). */
+    void setExtraPorts(const QStringList& ports) { m_extraPorts = ports; }
+    void setBaudRate(int baud)                   { m_baud = baud; }
+
+    LinkStats stats() const;
+
+    // --- Record format (static, no port) ---
+
+    /**
+     * @brief Decode one record (without '\r') into @p msg.
+     * @param tsMs  Receives the adapter timestamp, or -1 if the record has none.
+     * @return false if the record is not a well-formed frame record.
+     */
+    static bool decodeRecord(const char* rec, int len, CANMessage& msg, int& tsMs);
+
+    /** Write the transmit record for @p msg (including '\r'); returns its length. */
+    static int encodeRecord(const CANMessage& msg, char* out);
+
+    // --- ICANDriver interface ---
+    bool    initialize()  override { return true; }
+    void    shutdown()    override;
+    bool    isAvailable() const override { return true; }
+    QString driverName()  const override { return QStringLiteral("SLCAN serial adapter"); }
+
+    QList<CANChannelInfo> detectChannels() override;
+
+    CANResult openChannel(const CANChannelInfo& channel,
+                          const CANBusConfig& config) override;
+    void      closeChannel() override;
+    bool      isOpen() const override { return m_port >= 0; }
+
+    CANResult transmit(const CANMessage& msg) override { return transmitBatch(&msg, 1); }
+    CANResult transmitBatch(const CANMessage* frames, int count, int* sent = nullptr) override;
+
+    /** Not used — frames are pushed through messageReceived(). */
+    CANResult receive(CANMessage& msg, int timeoutMs = 1000) override;
+    CANResult flushReceiveQueue() override { return CANResult::Success(); }
+    QString   lastError() const override;
+
+private:
+    void rxLoop();
+    int  parseBuffer(int len, uint64_t hostNs);   ///< returns bytes consumed
+    uint64_t frameTimeNs(int tsMs, uint64_t hostNs);
+
+    int  readPort(char* buf, int maxLen);          ///< 0 on timeout, -1 on error
+    bool writePort(const char* data, int len);
+    bool sendCommand(const char* cmd);
+    CANResult fail(const QString& msg);
+
+    // --- Configuration ---
+    QStringList  m_extraPorts;
+    int          m_baud = DEFAULT_BAUD;
+    CANBusConfig m_config;
+    QString      m_portName;
+
+    // --- Port (fd on POSIX, HANDLE on Windows; -1 = closed) ---
+    qintptr            m_port = -1;
+    QThread*           m_rxThread = nullptr;
+    std::atomic<bool>  m_running{false};
+    QElapsedTimer      m_clock;
+
+    // --- Receive state (rx thread only) ---
+    std::vector<char>       m_rxBuf;     ///< READ_CHUNK + MAX_RECORD (carry-over)
+    int                     m_carry = 0; ///< bytes of a partial record at m_rxBuf[0]
+    std::vector<CANMessage> m_batch;     ///< frames parsed from one read
+    bool                    m_haveTs      = false;
+    int                     m_lastTsMs    = 0;
+    uint64_t                m_lastTsHostNs = 0;
+    uint64_t                m_tsBaseNs     = 0;   ///< host time of the first timestamp
+    uint64_t                m_tsUnwrappedMs = 0;
+    LinkStats               m_rxStats;
+
+    QMutex             m_txMutex;
+    std::vector<char>  m_txBuf;   ///< TX_CHUNK_FRAMES * MAX_RECORD, guarded by m_txMutex
+    mutable QMutex     m_statsMutex;
+    LinkStats          m_stats;
+    QString            m_lastError;
+};
+
+} // namespace CANManager
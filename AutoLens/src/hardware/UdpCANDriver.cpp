@@ -0,0 +1,739 @@
+/**
+ * @file UdpCANDriver.cpp
+ * @brief cannelloni-compatible CAN over UDP: batched receive, reorder window.
+ */
+
+#include "UdpCANDriver.h"
+#include "util/ThreadPlacement.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#  ifndef SIO_UDP_CONNRESET
+#    define SIO_UDP_CONNRESET _WSAIOW(IOC_VENDOR, 12)
+#  endif
+#else
+#  include <arpa/inet.h>
+#  include <cerrno>
+#  include <ctime>
+#  include <netdb.h>
+#  include <netinet/in.h>
+#  include <poll.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+namespace CANManager {
+
+namespace {
+
+// cannelloni protocol constants (cannelloni/parser.h)
+constexpr uint8_t  kVersion   = 2;
+constexpr uint8_t  kOpData    = 0;
+
+// SocketCAN flags as they appear in can_id / len / flags on the wire
+constexpr uint32_t kEffFlag   = 0x80000000u;
+constexpr uint32_t kRtrFlag   = 0x40000000u;
+constexpr uint32_t kErrFlag   = 0x20000000u;
+constexpr uint8_t  kFdFrame   = 0x80;
+constexpr uint8_t  kFdBrs     = 0x01;
+
+constexpr uint8_t  kChannel   = 1;          ///< one UDP link = one channel
+constexpr int      kRcvBufBytes = 4 << 20;  ///< absorb bursts while the thread is descheduled
+constexpr int      kIdlePollMs  = 50;       ///< re-check m_running this often
+
+#ifdef Q_OS_WIN
+using NativeSocket = SOCKET;
+inline NativeSocket native(qintptr s) { return static_cast<SOCKET>(s); }
+inline int lastSocketError() { return WSAGetLastError(); }
+inline void closeNative(qintptr s) { ::closesocket(native(s)); }
+#else
+using NativeSocket = int;
+inline NativeSocket native(qintptr s) { return static_cast<int>(s); }
+inline int lastSocketError() { return errno; }
+inline void closeNative(qintptr s) { ::close(native(s)); }
+#endif
+
+QString socketErrorText(const QString& what, int code)
+{
+    return QString("%1: %2 (%3)").arg(what, qt_error_string(code)).arg(code);
+}
+
+inline void putBe32(uint8_t* p, uint32_t v)
+{
+    p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16); p[2] = uint8_t(v >> 8); p[3] = uint8_t(v);
+}
+
+inline uint32_t getBe32(const uint8_t* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+} // namespace
+
+// ============================================================================
+//  Receive vectors
+//
+//  WHY preallocated: recvmmsg() needs one msghdr + iovec + control buffer per
+//  datagram.  They point into m_ring once at openChannel() and are reused
+//  for every batch — the receive loop does not allocate.
+// ============================================================================
+
+struct UdpCANDriver::RxVectors
+{
+#ifdef Q_OS_LINUX
+    std::array<mmsghdr, RX_BATCH> hdrs{};
+    std::array<iovec,   RX_BATCH> iov{};
+    alignas(cmsghdr) std::array<std::array<char, 64>, RX_BATCH> control{};
+#endif
+};
+
+// ============================================================================
+//  Ctor / Dtor
+// ============================================================================
+
+UdpCANDriver::UdpCANDriver(QObject* parent)
+    : ICANDriver(parent)
+    , m_rxv(std::make_unique<RxVectors>())
+{
+}
+
+UdpCANDriver::~UdpCANDriver()
+{
+    shutdown();
+}
+
+bool UdpCANDriver::initialize()
+{
+#ifdef Q_OS_WIN
+    if (!m_wsaStarted) {
+        WSADATA wsa;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+            m_lastError = QStringLiteral("WSAStartup failed");
+            return false;
+        }
+        m_wsaStarted = true;
+    }
+#endif
+    return true;
+}
+
+void UdpCANDriver::shutdown()
+{
+    closeChannel();
+#ifdef Q_OS_WIN
+    if (m_wsaStarted) {
+        WSACleanup();
+        m_wsaStarted = false;
+    }
+#endif
+}
+
+void UdpCANDriver::setEndpoint(quint16 localPort, const QString& peerHost, quint16 peerPort)
+{
+    m_localPort = localPort;
+    m_peerHost  = peerHost;
+    m_peerPort  = peerPort;
+}
+
+// ============================================================================
+//  Wire format
+// ============================================================================
+
+/*static*/ int UdpCANDriver::encodeFrame(const CANMessage& msg, uint8_t* out, int pos, int capacity)
+{
+    const int payload = msg.isRemote ? 0 : msg.dataLength();
+    const int end     = pos + 5 + (msg.isFD ? 1 : 0) + payload;
+    if (end > capacity)
+        return -1;
+
+    uint32_t canId = msg.id & (msg.isExtended ? 0x1FFFFFFFu : 0x7FFu);
+    if (msg.isExtended) canId |= kEffFlag;
+    if (msg.isRemote)   canId |= kRtrFlag;
+    if (msg.isError)    canId |= kErrFlag;
+    putBe32(out + pos, canId);
+    pos += 4;
+
+    if (msg.isFD) {
+        out[pos++] = uint8_t(payload | kFdFrame);
+        out[pos++] = msg.isBRS ? kFdBrs : 0;
+    } else {
+        // RTR frames carry the requested DLC but no data
+        out[pos++] = uint8_t(std::min<int>(msg.dlc, 8));
+    }
+    std::memcpy(out + pos, msg.data, size_t(payload));
+    return end;
+}
+
+/*static*/ int UdpCANDriver::decodeDatagram(const uint8_t* data, int len,
+                                            CANMessage* frames, int maxFrames)
+{
+    if (len < HEADER_SIZE || data[0] != kVersion || data[1] != kOpData)
+        return -1;
+
+    const int count = (int(data[3]) << 8) | data[4];
+    if (count > maxFrames)
+        return -1;
+
+    int pos = HEADER_SIZE;
+    for (int i = 0; i < count; ++i) {
+        if (pos + 5 > len)
+            return -1;
+        const uint32_t canId = getBe32(data + pos);
+        const uint8_t  lenByte = data[pos + 4];
+        pos += 5;
+
+        CANMessage& m = frames[i];
+        m = CANMessage();
+        m.isExtended = (canId & kEffFlag) != 0;
+        m.isRemote   = (canId & kRtrFlag) != 0;
+        m.isError    = (canId & kErrFlag) != 0;
+        m.id         = canId & (m.isExtended ? 0x1FFFFFFFu : 0x7FFu);
+        m.channel    = kChannel;
+
+        int payload = 0;
+        if (lenByte & kFdFrame) {
+            if (pos >= len)
+                return -1;
+            const uint8_t flags = data[pos++];
+            payload = std::min<int>(lenByte & ~kFdFrame, 64);
+            m.isFD  = true;
+            m.isBRS = (flags & kFdBrs) != 0;
+            m.dlc   = lengthToDlc(payload);
+        } else {
+            m.dlc   = std::min<uint8_t>(lenByte, 8);
+            payload = m.dlc;
+        }
+
+        if (!m.isRemote) {
+            if (pos + payload > len)
+                return -1;
+            std::memcpy(m.data, data + pos, size_t(payload));
+            pos += payload;
+        }
+    }
+    return count;
+}
+
+// ============================================================================
+//  Channel Detection
+// ============================================================================
+
+QList<CANChannelInfo> UdpCANDriver::detectChannels()
+{
+    CANChannelInfo ch;
+    ch.name        = QString("UDP %1:%2 (local :%3)").arg(m_peerHost).arg(m_peerPort).arg(m_localPort);
+    ch.hwTypeName  = QStringLiteral("cannelloni");
+    ch.channelMask = 1;
+    ch.supportsFD  = true;
+    ch.isOnBus     = true;
+    return {ch};
+}
+
+// ============================================================================
+//  Open / Close
+// ============================================================================
+
+CANResult UdpCANDriver::openChannel(const CANChannelInfo& /*channel*/,
+                                    const CANBusConfig& config)
+{
+    if (isOpen())
+        return CANResult::Failure("Already open");
+    if (!initialize())
+        return CANResult::Failure(m_lastError);
+
+    // ── Resolve the peer (IPv4, like cannelloni) ────────────────────────────
+    addrinfo hints{};
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(m_peerHost.toUtf8().constData(), nullptr, &hints, &res) != 0 || !res)
+        return fail(QString("Cannot resolve peer %1").arg(m_peerHost));
+    sockaddr_in peer{};
+    std::memcpy(&peer, res->ai_addr, sizeof(peer));
+    freeaddrinfo(res);
+    peer.sin_port = htons(m_peerPort);
+    static_assert(sizeof(sockaddr_in) <= sizeof(m_peerAddr), "m_peerAddr too small");
+    std::memcpy(m_peerAddr.data(), &peer, sizeof(peer));
+
+    // ── Socket ───────────────────────────────────────────────────────────────
+    const NativeSocket s = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef Q_OS_WIN
+    if (s == INVALID_SOCKET)
+#else
+    if (s < 0)
+#endif
+        return fail(socketErrorText(QStringLiteral("socket"), lastSocketError()));
+
+    const int rcvBuf = kRcvBufBytes;
+    setsockopt(s, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&rcvBuf), sizeof(rcvBuf));
+
+    sockaddr_in local{};
+    local.sin_family      = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port        = htons(m_localPort);
+    if (::bind(s, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0) {
+        const int err = lastSocketError();
+        const CANResult r = fail(socketErrorText(QString("bind :%1").arg(m_localPort), err));
+        closeNative(qintptr(s));
+        return r;
+    }
+
+#ifdef Q_OS_WIN
+    // Non-blocking for the recvfrom() drain loop; and do not let an ICMP
+    // "port unreachable" from an absent peer fail the next recvfrom().
+    u_long nonBlocking = 1;
+    ioctlsocket(s, FIONBIO, &nonBlocking);
+    BOOL connReset = FALSE;
+    DWORD bytes = 0;
+    WSAIoctl(s, SIO_UDP_CONNRESET, &connReset, sizeof(connReset), nullptr, 0, &bytes, nullptr, nullptr);
+#elif defined(Q_OS_LINUX)
+    const int on = 1;
+    setsockopt(s, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+#endif
+
+    // ── Receive state ───────────────────────────────────────────────────────
+    m_ring.assign(RX_BATCH, Slot());
+    m_holdSlots.assign(REORDER_WINDOW, Slot());
+    m_decoded.assign(MAX_FRAMES_PER_DATAGRAM, CANMessage());
+#ifdef Q_OS_LINUX
+    for (int i = 0; i < RX_BATCH; ++i) {
+        m_rxv->iov[i].iov_base = m_ring[i].bytes.data();
+        m_rxv->iov[i].iov_len  = RX_DATAGRAM_MAX;
+    }
+#endif
+    m_heldCount = 0;
+    m_seqValid  = false;
+    m_behindRun = 0;
+    m_delivered.reset();
+    m_rxStats = LinkStats();
+    {
+        QMutexLocker lock(&m_statsMutex);
+        m_stats = LinkStats();
+    }
+    m_txSeq  = 0;
+    m_config = config;
+    m_lastError.clear();
+
+    m_clock.start();
+#ifdef Q_OS_LINUX
+    timespec rt{};
+    clock_gettime(CLOCK_REALTIME, &rt);
+    m_realtimeOffsetNs = int64_t(rt.tv_sec) * 1000000000LL + rt.tv_nsec - m_clock.nsecsElapsed();
+#endif
+
+    m_socket  = qintptr(s);
+    m_running = true;
+    m_rxThread = QThread::create([this]() { rxLoop(); });
+    m_rxThread->setObjectName(QStringLiteral("AutoLens_UDP_RX"));
+    m_rxThread->start(QThread::HighPriority);
+
+    qDebug() << "[UdpCAN] Opened: local port" << m_localPort
+             << "peer" << QString("%1:%2").arg(m_peerHost).arg(m_peerPort);
+    emit channelOpened();
+    return CANResult::Success();
+}
+
+void UdpCANDriver::closeChannel()
+{
+    if (!isOpen()) return;
+
+    m_running = false;
+    if (m_rxThread) {
+        m_rxThread->wait();   // returns within kIdlePollMs
+        delete m_rxThread;
+        m_rxThread = nullptr;
+    }
+    {
+        QMutexLocker lock(&m_txMutex);
+        closeNative(m_socket);
+        m_socket = -1;
+    }
+
+    const LinkStats st = stats();
+    qDebug() << "[UdpCAN] Closed:" << st.datagrams << "datagrams," << st.frames << "frames,"
+             << st.lost << "lost," << st.reordered << "reordered," << st.late << "late,"
+             << st.duplicates << "duplicate," << st.malformed << "malformed";
+    emit channelClosed();
+}
+
+// ============================================================================
+//  Receive thread
+// ============================================================================
+
+void UdpCANDriver::rxLoop()
+{
+    ThreadPlacement::Scope placement(ThreadPlacement::Receive);
+    bool errorReported = false;
+
+    while (m_running.load(std::memory_order_relaxed)) {
+        const int n = receiveBatch();
+        if (n < 0) {
+            // Report the first socket error once; keep trying (the peer may
+            // simply not be up yet).
+            if (!errorReported) {
+                errorReported = true;
+                const QString err = socketErrorText(QStringLiteral("recv"), lastSocketError());
+                qWarning() << "[UdpCAN]" << err;
+                emit errorOccurred(err);
+            }
+            QThread::msleep(kIdlePollMs);
+            continue;
+        }
+
+        for (int i = 0; i < n; ++i)
+            acceptDatagram(m_ring[i]);
+
+        // A gap that is still open after REORDER_TIMEOUT_US is lost: skip
+        // to the first held datagram and release everything behind it.
+        if (m_heldCount > 0
+            && nowNs() - m_holdSinceNs >= uint64_t(REORDER_TIMEOUT_US) * 1000u) {
+            const int before = m_heldCount;
+            while (m_heldCount == before)
+                skipGap();
+            m_holdSinceNs = nowNs();
+        }
+
+        {
+            QMutexLocker lock(&m_statsMutex);
+            m_stats.datagrams  = m_rxStats.datagrams;
+            m_stats.frames     = m_rxStats.frames;
+            m_stats.lost       = m_rxStats.lost;
+            m_stats.reordered  = m_rxStats.reordered;
+            m_stats.late       = m_rxStats.late;
+            m_stats.duplicates = m_rxStats.duplicates;
+            m_stats.malformed  = m_rxStats.malformed;
+        }
+    }
+}
+
+int UdpCANDriver::receiveBatch()
+{
+    const NativeSocket s = native(m_socket);
+
+    // Wait at most until the open gap times out (or the idle poll period)
+    int timeoutMs = kIdlePollMs;
+    if (m_heldCount > 0) {
+        const uint64_t waited = nowNs() - m_holdSinceNs;
+        const uint64_t limit  = uint64_t(REORDER_TIMEOUT_US) * 1000u;
+        timeoutMs = waited >= limit ? 0 : int((limit - waited + 999999u) / 1000000u);
+    }
+
+#ifdef Q_OS_WIN
+    WSAPOLLFD pfd{};
+    pfd.fd     = s;
+    pfd.events = POLLRDNORM;
+    const int ready = WSAPoll(&pfd, 1, timeoutMs);
+#else
+    pollfd pfd{};
+    pfd.fd     = s;
+    pfd.events = POLLIN;
+    const int ready = ::poll(&pfd, 1, timeoutMs);
+    if (ready < 0 && errno == EINTR)
+        return 0;
+#endif
+    if (ready < 0)
+        return -1;
+    if (ready == 0)
+        return 0;
+
+    const uint64_t fallbackNs = nowNs();
+
+#ifdef Q_OS_LINUX
+    // ── One system call for up to RX_BATCH datagrams ────────────────────────
+    for (int i = 0; i < RX_BATCH; ++i) {
+        msghdr& h = m_rxv->hdrs[i].msg_hdr;
+        h.msg_name       = nullptr;
+        h.msg_namelen    = 0;
+        h.msg_iov        = &m_rxv->iov[i];
+        h.msg_iovlen     = 1;
+        h.msg_control    = m_rxv->control[i].data();
+        h.msg_controllen = m_rxv->control[i].size();
+        h.msg_flags      = 0;
+    }
+    const int n = ::recvmmsg(s, m_rxv->hdrs.data(), RX_BATCH, MSG_DONTWAIT, nullptr);
+    if (n < 0)
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+
+    for (int i = 0; i < n; ++i) {
+        Slot& slot = m_ring[i];
+        msghdr& h  = m_rxv->hdrs[i].msg_hdr;
+        slot.len   = (h.msg_flags & MSG_TRUNC) ? -1 : int(m_rxv->hdrs[i].msg_len);
+        slot.rxNs  = fallbackNs;
+        for (cmsghdr* c = CMSG_FIRSTHDR(&h); c; c = CMSG_NXTHDR(&h, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+                timespec ts;
+                std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                const int64_t ns = int64_t(ts.tv_sec) * 1000000000LL + ts.tv_nsec - m_realtimeOffsetNs;
+                slot.rxNs = ns > 0 ? uint64_t(ns) : 0;
+            }
+        }
+    }
+    return n;
+#else
+    // ── No recvmmsg: drain with non-blocking recvfrom ───────────────────────
+    int n = 0;
+    for (; n < RX_BATCH; ++n) {
+        Slot& slot = m_ring[n];
+#  ifdef Q_OS_WIN
+        const int got = ::recvfrom(s, reinterpret_cast<char*>(slot.bytes.data()),
+                                   RX_DATAGRAM_MAX, 0, nullptr, nullptr);
+        if (got < 0) {
+            const int err = WSAGetLastError();
+            if (err == WSAEWOULDBLOCK || err == WSAECONNRESET) break;
+            if (err == WSAEMSGSIZE) { slot.len = -1; slot.rxNs = fallbackNs; continue; }
+            return n > 0 ? n : -1;
+        }
+#  else
+        const ssize_t got = ::recvfrom(s, slot.bytes.data(), RX_DATAGRAM_MAX,
+                                       MSG_DONTWAIT, nullptr, nullptr);
+        if (got < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+            return n > 0 ? n : -1;
+        }
+#  endif
+        slot.len  = int(got);
+        slot.rxNs = fallbackNs;
+    }
+    return n;
+#endif
+}
+
+// ============================================================================
+//  Sequencing
+//
+//  seq_no is 8 bit.  Relative to m_expected a datagram is
+//    ahead == 0           in order           → deliver, then release held
+//    0 < ahead < window   ahead of a gap      → hold
+//    window ≤ ahead < 128 far ahead           → skip gaps until it fits
+//    ahead ≥ 128          behind              → late (deliver) or duplicate
+// ============================================================================
+
+void UdpCANDriver::acceptDatagram(const Slot& slot)
+{
+    if (slot.len < HEADER_SIZE || slot.bytes[0] != kVersion || slot.bytes[1] != kOpData) {
+        ++m_rxStats.malformed;
+        return;
+    }
+
+    const uint8_t seq = slot.bytes[2];
+    if (!m_seqValid) {
+        m_expected = seq;
+        m_seqValid = true;
+    }
+
+    uint8_t ahead = uint8_t(seq - m_expected);
+    if (ahead >= 128) {
+        if (++m_behindRun < RESYNC_AFTER) {
+            if (m_delivered.test(seq)) {
+                ++m_rxStats.duplicates;
+            } else {
+                ++m_rxStats.late;
+                deliver(slot.bytes.data(), slot.len, slot.rxNs, seq);
+            }
+            return;
+        }
+        // A run of "old" sequence numbers: the peer restarted.  Flush what
+        // is held and follow the new numbering.
+        while (m_heldCount > 0)
+            skipGap();
+        m_delivered.reset();
+        m_expected = seq;
+        ahead      = 0;
+    }
+    m_behindRun = 0;
+
+    while (ahead >= REORDER_WINDOW) {
+        skipGap();
+        ahead = uint8_t(seq - m_expected);
+    }
+
+    if (ahead == 0) {
+        deliver(slot.bytes.data(), slot.len, slot.rxNs, seq);
+        ++m_expected;
+        releaseHeld();
+        return;
+    }
+
+    Slot& hold = m_holdSlots[seq % REORDER_WINDOW];
+    if (hold.held) {   // same seq (the window never aliases) → duplicate
+        ++m_rxStats.duplicates;
+        return;
+    }
+    std::memcpy(hold.bytes.data(), slot.bytes.data(), size_t(slot.len));
+    hold.len  = slot.len;
+    hold.rxNs = slot.rxNs;
+    hold.seq  = seq;
+    hold.held = true;
+    if (m_heldCount++ == 0)
+        m_holdSinceNs = nowNs();
+    ++m_rxStats.reordered;
+}
+
+void UdpCANDriver::releaseHeld()
+{
+    while (m_heldCount > 0) {
+        Slot& hold = m_holdSlots[m_expected % REORDER_WINDOW];
+        if (!hold.held || hold.seq != m_expected)
+            return;
+        hold.held = false;
+        --m_heldCount;
+        deliver(hold.bytes.data(), hold.len, hold.rxNs, hold.seq);
+        ++m_expected;
+    }
+}
+
+void UdpCANDriver::skipGap()
+{
+    Slot& hold = m_holdSlots[m_expected % REORDER_WINDOW];
+    if (hold.held && hold.seq == m_expected) {
+        releaseHeld();   // not a gap after all
+        return;
+    }
+    ++m_rxStats.lost;
+    ++m_expected;
+    releaseHeld();
+}
+
+void UdpCANDriver::deliver(const uint8_t* data, int len, uint64_t rxNs, uint8_t seq)
+{
+    m_delivered.set(seq);
+    m_delivered.reset(uint8_t(seq + 128));   // forget the opposite half
+
+    const int n = decodeDatagram(data, len, m_decoded.data(), MAX_FRAMES_PER_DATAGRAM);
+    if (n < 0) {
+        ++m_rxStats.malformed;
+        return;
+    }
+    ++m_rxStats.datagrams;
+    m_rxStats.frames += quint64(n);
+
+    for (int i = 0; i < n; ++i) {
+        CANMessage& msg = m_decoded[i];
+        if (msg.isError)
+            continue;   // same as VectorCANDriver's receive thread
+        msg.timestamp = rxNs;
+        if (passesCaptureFilter(msg))
+            emit messageReceived(msg);
+    }
+}
+
+// ============================================================================
+//  Transmit
+// ============================================================================
+
+CANResult UdpCANDriver::transmitBatch(const CANMessage* frames, int count, int* sent)
+{
+    if (sent) *sent = 0;
+    if (m_config.listenOnly)
+        return CANResult::Failure("No TX access (listen-only)");
+
+    int done = 0;
+    CANResult result = CANResult::Success();
+    {
+        QMutexLocker lock(&m_txMutex);
+        if (m_socket < 0)
+            return CANResult::Failure("Not open");
+
+        // Pack as many frames per datagram as fit into one MTU
+        int pos      = HEADER_SIZE;
+        int inFlight = 0;
+        for (int i = 0; i < count; ++i) {
+            if (frames[i].isFD && !m_config.fdEnabled) {
+                result = CANResult::Failure("CAN FD frame on a classic CAN channel");
+                break;
+            }
+            int next = encodeFrame(frames[i], m_txBuf.data(), pos, TX_DATAGRAM_MAX);
+            if (next < 0) {
+                result   = sendDatagram(pos, inFlight);
+                if (!result.success) { inFlight = 0; break; }
+                done    += inFlight;
+                inFlight = 0;
+                next     = encodeFrame(frames[i], m_txBuf.data(), HEADER_SIZE, TX_DATAGRAM_MAX);
+            }
+            pos = next;
+            ++inFlight;
+        }
+        // The packed prefix goes out even when a later frame was rejected
+        if (inFlight > 0) {
+            const CANResult flushed = sendDatagram(pos, inFlight);
+            if (flushed.success) done += inFlight;
+            else                 result = flushed;
+        }
+    }
+
+    if (done > 0) {
+        QMutexLocker lock(&m_statsMutex);
+        m_stats.txFrames += quint64(done);
+    }
+
+    // TX echo, outside the lock: a direct-connected slot may transmit again
+    const uint64_t now = nowNs();
+    for (int i = 0; i < done; ++i) {
+        CANMessage echo  = frames[i];
+        echo.channel     = kChannel;
+        echo.timestamp   = now;
+        echo.isTxConfirm = true;
+        emit messageReceived(echo);
+    }
+
+    if (sent) *sent = done;
+    return result;
+}
+
+CANResult UdpCANDriver::sendDatagram(int len, int frames)
+{
+    m_txBuf[0] = kVersion;
+    m_txBuf[1] = kOpData;
+    m_txBuf[2] = m_txSeq;
+    m_txBuf[3] = uint8_t(frames >> 8);
+    m_txBuf[4] = uint8_t(frames);
+
+    const auto* to = reinterpret_cast<const sockaddr*>(m_peerAddr.data());
+    const auto sentBytes = ::sendto(native(m_socket), reinterpret_cast<const char*>(m_txBuf.data()),
+                                    len, 0, to, sizeof(sockaddr_in));
+    if (sentBytes != len)
+        return CANResult::Failure(socketErrorText(QStringLiteral("sendto"), lastSocketError()));
+
+    ++m_txSeq;
+    QMutexLocker lock(&m_statsMutex);
+    ++m_stats.txDatagrams;
+    return CANResult::Success();
+}
+
+// ============================================================================
+//  Misc
+// ============================================================================
+
+CANResult UdpCANDriver::receive(CANMessage& /*msg*/, int /*timeoutMs*/)
+{
+    return CANResult::Failure("UDP driver delivers frames via messageReceived()");
+}
+
+QString UdpCANDriver::lastError() const
+{
+    return m_lastError;
+}
+
+UdpCANDriver::LinkStats UdpCANDriver::stats() const
+{
+    QMutexLocker lock(&m_statsMutex);
+    return m_stats;
+}
+
+CANResult UdpCANDriver::fail(const QString& msg)
+{
+    m_lastError = msg;
+    qWarning() << "[UdpCAN]" << msg;
+    return CANResult::Failure(msg);
+}
+
+} // namespace CANManager
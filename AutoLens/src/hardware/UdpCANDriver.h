@@ -0,0 +1,204 @@
+#pragma once
+/**
+ * @file UdpCANDriver.h
+ * @brief CAN over UDP, wire-compatible with cannelloni (protocol version 2).
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WIRE FORMAT
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  One datagram carries many frames:
+ *
+ *    header  version(1)=2 | op_code(1)=0 DATA | seq_no(1) | count(2, BE)
+ *    frame   can_id(4, BE, SocketCAN flags) | len(1) [| fd_flags(1)] | data
+ *
+ *  can_id bit 31 = extended, bit 30 = RTR, bit 29 = error frame.
+ *  len bit 7 marks a CAN FD frame; the FD flags byte follows (0x01 BRS,
+ *  0x02 ESI) and len is then the payload byte count.  RTR frames carry no
+ *  data.  cannelloni sends no timestamps — frames are stamped with the
+ *  kernel receive time of their datagram (SO_TIMESTAMPNS on Linux).
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  RECEIVE PATH
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    socket ─ recvmmsg(RX_BATCH) ─► rx ring (preallocated datagram slots)
+ *                                       │
+ *                          seq_no == expected? ──yes──► parse ─► messageReceived
+ *                                       │ no (ahead, within window)
+ *                                       ▼
+ *                                  hold slot ─── gap filled / timeout ───┘
+ *
+ *  One system call drains up to RX_BATCH datagrams.  Datagrams that arrive
+ *  ahead of a gap are held (up to REORDER_WINDOW) and released in sequence
+ *  order once the gap is filled, or after REORDER_TIMEOUT_US, when the gap
+ *  counts as lost.  A datagram that arrives after its gap was given up is
+ *  still delivered ("late"); one whose sequence number was already
+ *  delivered is dropped as a duplicate.  Windows has no recvmmsg, so there
+ *  the same loop drains the socket with non-blocking recvfrom().
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  TRANSMIT PATH
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  transmitBatch() packs frames into datagrams of at most TX_DATAGRAM_MAX
+ *  bytes (one Ethernet MTU); transmit() sends a single-frame datagram.
+ *  Sent frames are echoed as isTxConfirm.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  TESTING ON LOCALHOST
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Point the peer at our own port (local 20000, peer 127.0.0.1:20000) and
+ *  every transmitted datagram comes back as received traffic.  Against a
+ *  real bench, or a vcan interface on Linux:
+ *
+ *    cannelloni -I vcan0 -R <AutoLens host> -r 20000 -l 20001
+ *
+ *  with AutoLens on local port 20000 and peer <bench>:20001.
+ */
+
+#include "CANInterface.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <memory>
+#include <vector>
+
+namespace CANManager {
+
+class UdpCANDriver : public ICANDriver
+{
+    Q_OBJECT
+
+public:
+    static constexpr quint16 DEFAULT_PORT       = 20000;  ///< cannelloni default
+    static constexpr int     RX_BATCH           = 64;     ///< datagrams per recvmmsg()
+    static constexpr int     RX_DATAGRAM_MAX    = 2048;   ///< bytes per ring slot
+    static constexpr int     TX_DATAGRAM_MAX    = 1472;   ///< 1500 MTU − IP − UDP
+    static constexpr int     REORDER_WINDOW     = 16;     ///< datagrams held for a gap
+    static constexpr int     REORDER_TIMEOUT_US = 2000;   ///< then the gap is lost
+
+    struct LinkStats
+    {
+        quint64 datagrams   = 0;
+        quint64 frames      = 0;
+        quint64 lost        = 0;   ///< sequence numbers given up on
+        quint64 reordered   = 0;   ///< datagrams held until a gap was filled
+        quint64 late        = 0;   ///< arrived after their gap was given up
+        quint64 duplicates  = 0;
+        quint64 malformed   = 0;   ///< bad header / truncated frame
+        quint64 txDatagrams = 0;
+        quint64 txFrames    = 0;
+    };
+
+    explicit UdpCANDriver(QObject* parent = nullptr);
+    ~UdpCANDriver() override;
+
+    /** Local port to bind and the peer to send to; used by the next openChannel(). */
+    void setEndpoint(quint16 localPort, const QString& peerHost, quint16 peerPort);
+
+    LinkStats stats() const;
+
+    // --- Wire format (static, no socket) ---
+
+    /** Append @p msg to @p out at @p pos; returns the new end or -1 if it does not fit. */
+    static int encodeFrame(const CANMessage& msg, uint8_t* out, int pos, int capacity);
+
+    /**
+     * @brief Decode the frames of one DATA datagram into @p frames.
+     * @return Number of frames, or -1 if the header is not a cannelloni
+     *         v2 DATA header or a frame is truncated.
+     */
+    static int decodeDatagram(const uint8_t* data, int len, CANMessage* frames, int maxFrames);
+
+    // --- ICANDriver interface ---
+    bool    initialize()  override;
+    void    shutdown()    override;
+    bool    isAvailable() const override { return true; }
+    QString driverName()  const override { return QStringLiteral("CAN over UDP (cannelloni)"); }
+
+    QList<CANChannelInfo> detectChannels() override;
+
+    CANResult openChannel(const CANChannelInfo& channel,
+                          const CANBusConfig& config) override;
+    void      closeChannel() override;
+    bool      isOpen() const override { return m_socket >= 0; }
+
+    CANResult transmit(const CANMessage& msg) override { return transmitBatch(&msg, 1); }
+    CANResult transmitBatch(const CANMessage* frames, int count, int* sent = nullptr) override;
+
+    /** Not used — frames are pushed through messageReceived(). */
+    CANResult receive(CANMessage& msg, int timeoutMs = 1000) override;
+    CANResult flushReceiveQueue() override { return CANResult::Success(); }
+    QString   lastError() const override;
+
+private:
+    static constexpr int HEADER_SIZE             = 5;
+    static constexpr int MAX_FRAMES_PER_DATAGRAM = RX_DATAGRAM_MAX / 5;
+    static constexpr int RESYNC_AFTER            = 8;   ///< behind-window datagrams → peer restarted
+
+    /** One datagram buffer plus its receive time (rx ring and hold slots). */
+    struct Slot
+    {
+        std::array<uint8_t, RX_DATAGRAM_MAX> bytes;
+        int      len  = 0;
+        uint64_t rxNs = 0;
+        uint8_t  seq  = 0;
+        bool     held = false;
+    };
+
+    struct RxVectors;   ///< platform recvmmsg headers, see .cpp
+
+    void rxLoop();
+    int  receiveBatch();   ///< fills m_ring; returns count, 0 on timeout, -1 on error
+    void acceptDatagram(const Slot& slot);
+    void deliver(const uint8_t* data, int len, uint64_t rxNs, uint8_t seq);
+    void releaseHeld();    ///< deliver held datagrams that are now in sequence
+    void skipGap();        ///< give up on m_expected and move on
+    uint64_t nowNs() const { return static_cast<uint64_t>(m_clock.nsecsElapsed()); }
+
+    CANResult sendDatagram(int len, int frames);
+    CANResult fail(const QString& msg);
+
+    // --- Configuration ---
+    quint16      m_localPort = DEFAULT_PORT;
+    QString      m_peerHost  = QStringLiteral("127.0.0.1");
+    quint16      m_peerPort  = DEFAULT_PORT;
+    CANBusConfig m_config;
+
+    // --- Socket (native handle; -1 = closed) ---
+    qintptr                 m_socket = -1;
+    std::array<uint8_t, 16> m_peerAddr{};   ///< sockaddr_in, opaque here
+    bool                    m_wsaStarted = false;
+
+    QThread*           m_rxThread = nullptr;
+    std::atomic<bool>  m_running{false};
+    QElapsedTimer      m_clock;              ///< timestamps are ns since openChannel()
+    int64_t            m_realtimeOffsetNs = 0;   ///< kernel (realtime) stamp → m_clock
+
+    // --- Receive state (rx thread only) ---
+    std::unique_ptr<RxVectors> m_rxv;
+    std::vector<Slot>  m_ring;               ///< RX_BATCH slots, refilled per batch
+    std::vector<Slot>  m_holdSlots;          ///< REORDER_WINDOW slots, index seq % window
+    int                m_heldCount   = 0;
+    uint64_t           m_holdSinceNs = 0;
+    uint8_t            m_expected    = 0;
+    bool               m_seqValid    = false;
+    int                m_behindRun   = 0;
+    std::bitset<256>   m_delivered;          ///< recently delivered seq numbers
+    std::vector<CANMessage> m_decoded;       ///< decode scratch
+    LinkStats          m_rxStats;            ///< published to m_stats once per batch
+
+    // --- Transmit state ---
+    QMutex             m_txMutex;
+    std::array<uint8_t, TX_DATAGRAM_MAX> m_txBuf{};
+    uint8_t            m_txSeq = 0;
+
+    mutable QMutex     m_statsMutex;
+    LinkStats          m_stats;
+    QString            m_lastError;
+};
+
+} // namespace CANManager
@@ -19,6 +19,8 @@
  */
 
 #include "VectorCANDriver.h"
+#include "CaptureFilter.h"
+#include "util/ThreadPlacement.h"
 
 #include <QDebug>
 #include <QCoreApplication>
@@ -127,7 +129,7 @@ void VectorCANDriver::unloadLibrary()
     m_xlCanTransmitEx = nullptr;   m_xlReceive = nullptr;
     m_xlCanReceive = nullptr;      m_xlSetNotification = nullptr;
     m_xlFlushReceiveQueue = nullptr; m_xlGetErrorString = nullptr;
-    m_xlGetEventString = nullptr;
+    m_xlGetEventString = nullptr;   m_xlCanSetChannelAcceptance = nullptr;
 }
 
 bool VectorCANDriver::resolveFunctions()
@@ -166,6 +168,7 @@ bool VectorCANDriver::resolveFunctions()
     RESOLVE_XL_OPTIONAL(xlCanReceive,           XLCANRECEIVE)
     RESOLVE_XL_OPTIONAL(xlGetErrorString,       XLGETERRORSTRING)
     RESOLVE_XL_OPTIONAL(xlGetEventString,       XLGETEVENTSTRING)
+    RESOLVE_XL_OPTIONAL(xlCanSetChannelAcceptance, XLCANSETCHANNELACCEPTANCE)
 
 #undef RESOLVE_XL
 #undef RESOLVE_XL_OPTIONAL
@@ -401,6 +404,7 @@ CANResult VectorCANDriver::openChannel(const CANChannelInfo& channel,
         }
         int outMode = config.listenOnly ? XL_OUTPUT_MODE_SILENT : XL_OUTPUT_MODE_NORMAL;
         m_xlCanSetChannelOutput(m_portHandle, m_channelMask, outMode);
+        programAcceptance();
     } else {
         qWarning() << "[VectorCAN] No init access — listen-only (another app owns it)";
     }
@@ -425,6 +429,46 @@ CANResult VectorCANDriver::openChannel(const CANChannelInfo& channel,
     return CANResult::Success();
 }
 
+bool VectorCANDriver::applyAcceptanceFilter()
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_portHandle == XL_INVALID_PORTHANDLE || !(m_permissionMask & m_channelMask))
+        return false;
+    return programAcceptance();
+}
+
+bool VectorCANDriver::programAcceptance()
+{
+    // One code/mask pair per ID type: (id & mask) == (code & mask) passes.
+    // The pair covers the pass list (a superset for scattered ranges); the
+    // receive thread's bitmap removes the rest.  Frames of this port carry
+    // channel 1, so that is the list that applies.
+    if (!m_xlCanSetChannelAcceptance || !m_captureFilter)
+        return false;
+
+    const CaptureFilter::ChannelRules rules = m_captureFilter->rules(1);
+    bool narrowed = false;
+    auto program = [&](const QVector<CaptureFilter::Range>& ranges, uint32_t fullMask,
+                       unsigned idRange, unsigned long closed) {
+        uint32_t code = 0, mask = 0;
+        if (rules.active && ranges.isEmpty()) {
+            code = mask = closed;               // documented "close" pattern
+        } else if (rules.active) {
+            CaptureFilter::coveringCode(ranges, fullMask, code, mask);
+        }
+        // !active: code = mask = 0 → open for every ID
+        narrowed |= mask != 0;
+        XLstatus s = m_xlCanSetChannelAcceptance(m_portHandle, m_channelMask, code, mask, idRange);
+        if (s != XL_SUCCESS)
+            qWarning() << "[VectorCAN] xlCanSetChannelAcceptance:" << xlStatusToString(s);
+        return s == XL_SUCCESS;
+    };
+    const bool stdOk = program(rules.std, 0x7FFu,      XL_CAN_STD, 0xFFFu);
+    const bool extOk = program(rules.ext, 0x1FFFFFFFu, XL_CAN_EXT, 0xFFFFFFFFu);
+    qDebug() << "[VectorCAN] Acceptance filter" << (narrowed ? "narrowed" : "open");
+    return stdOk && extOk && narrowed;
+}
+
 void VectorCANDriver::closeChannel()
 {
     stopAsyncReceive();
@@ -462,15 +506,33 @@ CANResult VectorCANDriver::transmit(const CANMessage& msg)
     return (msg.isFD && m_isFD) ? transmitFD(msg) : transmitClassic(msg);
 }
 
-CANResult VectorCANDriver::transmitClassic(const CANMessage& msg)
+/*static*/ void VectorCANDriver::fillClassicEvent(const CANMessage& msg, XLevent& ev)
 {
-    XLevent ev; memset(&ev, 0, sizeof(ev));
+    memset(&ev, 0, sizeof(ev));
     ev.tag = XL_TRANSMIT_MSG;
     ev.tagData.msg.id  = msg.id;
     ev.tagData.msg.dlc = qMin((unsigned short)msg.dlc, (unsigned short)8);
     if (msg.isExtended) ev.tagData.msg.id |= XL_CAN_EXT_MSG_ID;
     if (msg.isRemote)   ev.tagData.msg.flags |= XL_CAN_MSG_FLAG_REMOTE_FRAME;
     memcpy(ev.tagData.msg.data, msg.data, ev.tagData.msg.dlc);
+}
+
+/*static*/ void VectorCANDriver::fillFdEvent(const CANMessage& msg, XLcanTxEvent& tx)
+{
+    memset(&tx, 0, sizeof(tx));
+    tx.tag = XL_CAN_EV_TAG_TX_MSG;
+    tx.tagData.canMsg.canId  = msg.id | (msg.isExtended ? XL_CAN_EXT_MSG_ID : 0);
+    tx.tagData.canMsg.msgFlags = XL_CAN_TXMSG_FLAG_EDL;
+    if (msg.isBRS)   tx.tagData.canMsg.msgFlags |= XL_CAN_TXMSG_FLAG_BRS;
+    if (msg.isRemote)tx.tagData.canMsg.msgFlags |= XL_CAN_TXMSG_FLAG_RTR;
+    tx.tagData.canMsg.dlc = msg.dlc;
+    memcpy(tx.tagData.canMsg.data, msg.data, dlcToLength(msg.dlc));
+}
+
+CANResult VectorCANDriver::transmitClassic(const CANMessage& msg)
+{
+    XLevent ev;
+    fillClassicEvent(msg, ev);
 
     unsigned cnt = 1;
     XLstatus s = m_xlCanTransmit(m_portHandle, m_channelMask, &cnt, &ev);
@@ -482,14 +544,8 @@ CANResult VectorCANDriver::transmitFD(const CANMessage& msg)
     if (!m_xlCanTransmitEx)
         return CANResult::Failure("FD transmit not available");
 
-    XLcanTxEvent tx; memset(&tx, 0, sizeof(tx));
-    tx.tag = XL_CAN_EV_TAG_TX_MSG;
-    tx.tagData.canMsg.canId  = msg.id | (msg.isExtended ? XL_CAN_EXT_MSG_ID : 0);
-    tx.tagData.canMsg.msgFlags = XL_CAN_TXMSG_FLAG_EDL;
-    if (msg.isBRS)   tx.tagData.canMsg.msgFlags |= XL_CAN_TXMSG_FLAG_BRS;
-    if (msg.isRemote)tx.tagData.canMsg.msgFlags |= XL_CAN_TXMSG_FLAG_RTR;
-    tx.tagData.canMsg.dlc = msg.dlc;
-    memcpy(tx.tagData.canMsg.data, msg.data, dlcToLength(msg.dlc));
+    XLcanTxEvent tx;
+    fillFdEvent(msg, tx);
 
     unsigned sent = 0;
     XLstatus s = m_xlCanTransmitEx(m_portHandle, m_channelMask, 1, &sent, &tx);
@@ -498,6 +554,57 @@ CANResult VectorCANDriver::transmitFD(const CANMessage& msg)
     return CANResult::Success();
 }
 
+CANResult VectorCANDriver::transmitBatch(const CANMessage* frames, int count, int* sent)
+{
+    // WHY batch: one xlCanTransmit call per frame costs a kernel round trip
+    // each.  The gateway forwards several frames per received frame, so
+    // consecutive frames of the same kind (classic / FD) go in one call.
+    constexpr int kChunk = 32;
+
+    if (sent) *sent = 0;
+    QMutexLocker lock(&m_mutex);
+    if (m_portHandle == XL_INVALID_PORTHANDLE)
+        return CANResult::Failure("Channel not open");
+    if (!(m_permissionMask & m_channelMask))
+        return CANResult::Failure("No TX access (listen-only)");
+
+    int done = 0;
+    while (done < count) {
+        const bool fd = frames[done].isFD && m_isFD;
+        int n = 0;
+
+        if (fd) {
+            if (!m_xlCanTransmitEx)
+                return CANResult::Failure("FD transmit not available");
+            XLcanTxEvent tx[kChunk];
+            while (n < kChunk && done + n < count && frames[done + n].isFD) {
+                fillFdEvent(frames[done + n], tx[n]);
+                ++n;
+            }
+            unsigned accepted = 0;
+            XLstatus s = m_xlCanTransmitEx(m_portHandle, m_channelMask,
+                                           static_cast<unsigned>(n), &accepted, tx);
+            done += static_cast<int>(accepted);
+            if (sent) *sent = done;
+            if (s != XL_SUCCESS)               return makeError("xlCanTransmitEx", s);
+            if (static_cast<int>(accepted) < n) return CANResult::Failure("TX queue full");
+        } else {
+            XLevent ev[kChunk];
+            while (n < kChunk && done + n < count && !(frames[done + n].isFD && m_isFD)) {
+                fillClassicEvent(frames[done + n], ev[n]);
+                ++n;
+            }
+            unsigned cnt = static_cast<unsigned>(n);   // in: queued, out: accepted
+            XLstatus s = m_xlCanTransmit(m_portHandle, m_channelMask, &cnt, ev);
+            done += static_cast<int>(cnt);
+            if (sent) *sent = done;
+            if (s != XL_SUCCESS)          return makeError("xlCanTransmit", s);
+            if (static_cast<int>(cnt) < n) return CANResult::Failure("TX queue full");
+        }
+    }
+    return CANResult::Success();
+}
+
 // ============================================================================
 //  Receive
 // ============================================================================
@@ -581,10 +688,11 @@ void VectorCANDriver::startAsyncReceive()
     m_asyncRunning = true;
     // QThread::create() wraps a lambda in a QThread — no subclassing needed.
     m_rxThread = QThread::create([this]() {
+        ThreadPlacement::Scope placement(ThreadPlacement::Receive);
         while (m_asyncRunning.load()) {
             CANMessage msg;
             auto res = receive(msg, 100);   // 100 ms timeout → re-check flag
-            if (res.success && !msg.isError && !msg.isTxConfirm)
+            if (res.success && !msg.isError && !msg.isTxConfirm && passesCaptureFilter(msg))
                 emit messageReceived(msg);  // ← crosses to UI thread (queued)
         }
     });
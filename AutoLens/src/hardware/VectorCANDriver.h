@@ -17,6 +17,7 @@
  *   • Classic CAN (HS) and CAN FD
  *   • Async receive thread → emits messageReceived() signal
  *   • Mutex-protected transmit so the UI can call transmit() safely
+ *   • Hardware acceptance filter programmed from the capture filter
  *
  * Usage (see also AppController):
  * @code
@@ -73,10 +74,16 @@ public:
     bool      isOpen() const override;
 
     CANResult transmit(const CANMessage& msg) override;
+
+    /** Hands up to 32 frames per xlCanTransmit / xlCanTransmitEx call. */
+    CANResult transmitBatch(const CANMessage* frames, int count, int* sent = nullptr) override;
     CANResult receive(CANMessage& msg, int timeoutMs = 1000) override;
     CANResult flushReceiveQueue() override;
     QString   lastError() const override;
 
+    /** Programs xlCanSetChannelAcceptance() when the DLL exports it. */
+    bool      applyAcceptanceFilter() override;
+
     // --- Vector-specific extras ---
 
     /** Start a background thread that calls receive() in a loop and emits
@@ -107,6 +114,11 @@ private:
     // Transmit helpers (split by classic / FD)
     CANResult transmitClassic(const CANMessage& msg);
     CANResult transmitFD(const CANMessage& msg);
+    static void fillClassicEvent(const CANMessage& msg, XLevent& ev);
+    static void fillFdEvent(const CANMessage& msg, XLcanTxEvent& tx);
+
+    // Acceptance filter from the capture filter's channel 1 list (m_mutex held)
+    bool programAcceptance();
 
     // Receive helpers
     CANResult receiveClassic(CANMessage& msg, int timeoutMs);
@@ -162,6 +174,7 @@ private:
     XLFLUSHRECEIVEQUEUE         m_xlFlushReceiveQueue       = nullptr;
     XLGETERRORSTRING            m_xlGetErrorString          = nullptr;
     XLGETEVENTSTRING            m_xlGetEventString          = nullptr;
+    XLCANSETCHANNELACCEPTANCE   m_xlCanSetChannelAcceptance = nullptr;
 };
 
 } // namespace CANManager
@@ -0,0 +1,352 @@
+/**
+ * @file VirtualCANDriver.cpp
+ * @brief Virtual bus thread: arbitration, bit-time accurate delivery.
+ */
+
+#include "VirtualCANDriver.h"
+#include "CANBitTiming.h"
+#include "util/ThreadPlacement.h"
+
+#include <QDeadlineTimer>
+#include <QDebug>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace CANManager {
+
+namespace {
+
+constexpr uint8_t kBusChannel = 1;   ///< the virtual bus appears as channel 1
+
+} // namespace
+
+// ============================================================================
+//  Ctor / Dtor
+// ============================================================================
+
+VirtualCANDriver::VirtualCANDriver(QObject* parent) : ICANDriver(parent)
+{
+    addNode(QStringLiteral("Host"), true);   // HOST_NODE == 0
+}
+
+VirtualCANDriver::~VirtualCANDriver()
+{
+    shutdown();
+}
+
+void VirtualCANDriver::shutdown()
+{
+    closeChannel();
+}
+
+// ============================================================================
+//  Nodes
+// ============================================================================
+
+int VirtualCANDriver::addNode(const QString& name, bool txConfirm)
+{
+    QMutexLocker lock(&m_mutex);
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        if (m_nodes[i].name == name)
+            return static_cast<int>(i);
+    }
+    Node node;
+    node.name       = name;
+    node.stats.name = name;
+    node.txConfirm  = txConfirm;
+    m_nodes.push_back(std::move(node));
+    return static_cast<int>(m_nodes.size()) - 1;
+}
+
+/*static*/ uint32_t VirtualCANDriver::arbitrationKey(const CANMessage& msg)
+{
+    // Bit layout mirrors the wire order of the arbitration field:
+    //   standard: ID[10:0] | RTR
+    //   extended: ID[28:18] | SRR(1) | IDE(1) | ID[17:0] | RTR
+    // FD frames have no RTR (RRS is always dominant).
+    const bool rtr = msg.isRemote && !msg.isFD;
+    if (!msg.isExtended)
+        return ((msg.id & 0x7FFu) << 21) | (rtr ? (1u << 20) : 0u);
+
+    return (((msg.id >> 18) & 0x7FFu) << 21)
+         | (1u << 20) | (1u << 19)
+         | ((msg.id & 0x3FFFFu) << 1)
+         | (rtr ? 1u : 0u);
+}
+
+CANResult VirtualCANDriver::transmitFrom(int node, const CANMessage& msg)
+{
+    QMutexLocker lock(&m_mutex);
+    const CANResult r = enqueueLocked(node, msg);
+    if (r.success)
+        m_wake.wakeOne();
+    return r;
+}
+
+CANResult VirtualCANDriver::transmitBatchFrom(int node, const CANMessage* frames, int count, int* sent)
+{
+    QMutexLocker lock(&m_mutex);
+    int done = 0;
+    CANResult r = CANResult::Success();
+    for (; done < count; ++done) {
+        r = enqueueLocked(node, frames[done]);
+        if (!r.success) break;
+    }
+    if (done > 0)
+        m_wake.wakeOne();
+    if (sent) *sent = done;
+    return r;
+}
+
+CANResult VirtualCANDriver::enqueueLocked(int node, const CANMessage& msg)
+{
+    if (!m_thread)
+        return CANResult::Failure("Virtual bus not open");
+    if (node < 0 || node >= static_cast<int>(m_nodes.size()))
+        return CANResult::Failure(QString("Unknown virtual node %1").arg(node));
+    if (node == HOST_NODE && m_config.listenOnly)
+        return CANResult::Failure("No TX access (listen-only)");
+    if (msg.isFD && !m_config.fdEnabled)
+        return CANResult::Failure("CAN FD frame on a classic CAN channel");
+
+    Node& n = m_nodes[node];
+    if (static_cast<int>(n.heap.size()) >= TX_QUEUE_LIMIT) {
+        ++n.stats.queueFull;
+        return CANResult::Failure(QString("TX queue full (%1)").arg(n.name));
+    }
+
+    Pending p;
+    p.key       = arbitrationKey(msg);
+    p.seq       = m_seq++;
+    p.enqueueNs = static_cast<uint64_t>(m_clock.nsecsElapsed());
+    p.msg       = msg;
+
+    // A node with an empty queue becomes ready now; one that already has
+    // frames keeps its readiness (it is waiting for the bus).
+    if (n.heap.empty())
+        n.readySinceNs = p.enqueueNs;
+
+    n.heap.push_back(p);
+    std::push_heap(n.heap.begin(), n.heap.end(), &VirtualCANDriver::later);
+    return CANResult::Success();
+}
+
+// ============================================================================
+//  Channel Detection
+// ============================================================================
+
+QList<CANChannelInfo> VirtualCANDriver::detectChannels()
+{
+    CANChannelInfo ch;
+    ch.name        = QStringLiteral("Virtual Bus 1");
+    ch.hwTypeName  = QStringLiteral("Virtual");
+    ch.channelMask = 1;
+    ch.supportsFD  = true;
+    ch.isOnBus     = true;
+    return {ch};
+}
+
+// ============================================================================
+//  Open / Close
+// ============================================================================
+
+CANResult VirtualCANDriver::openChannel(const CANChannelInfo& /*channel*/,
+                                        const CANBusConfig& config)
+{
+    if (m_thread)
+        return CANResult::Failure("Already open");
+    if (config.bitrate <= 0 || (config.fdEnabled && config.fdDataBitrate <= 0)) {
+        QMutexLocker lock(&m_mutex);
+        m_lastError = QString("Invalid bitrate %1 / %2").arg(config.bitrate).arg(config.fdDataBitrate);
+        return CANResult::Failure(m_lastError);
+    }
+
+    {
+        QMutexLocker lock(&m_mutex);
+        m_config = config;
+        m_stop   = false;
+        m_busIdleSinceNs  = 0;
+        m_seq             = 0;
+        m_frames          = 0;
+        m_busyNs          = 0;
+        m_lastStatsNs     = 0;
+        m_lastStatsBusyNs = 0;
+        m_lastError.clear();
+        for (Node& n : m_nodes) {
+            n.heap.clear();
+            n.readySinceNs = 0;
+            n.stats = NodeStats();
+            n.stats.name = n.name;
+        }
+        m_clock.start();
+
+        m_thread = QThread::create([this]() { busLoop(); });
+    }
+    m_thread->setObjectName(QStringLiteral("AutoLens_VirtualBus"));
+    m_thread->start(QThread::TimeCriticalPriority);
+
+    qDebug() << "[VirtualBus] Opened:" << config.bitrate << "bit/s"
+             << (config.fdEnabled ? QString("FD %1 bit/s").arg(config.fdDataBitrate) : QString())
+             << m_nodes.size() << "node(s)";
+    emit channelOpened();
+    return CANResult::Success();
+}
+
+void VirtualCANDriver::closeChannel()
+{
+    QThread* thread = nullptr;
+    {
+        QMutexLocker lock(&m_mutex);
+        if (!m_thread) return;
+        thread   = m_thread;
+        m_thread = nullptr;   // transmitFrom() now fails fast
+        m_stop   = true;
+        m_wake.wakeAll();
+    }
+    thread->wait();
+    delete thread;
+
+    {
+        QMutexLocker lock(&m_mutex);
+        for (Node& n : m_nodes)
+            n.heap.clear();
+    }
+
+    qDebug() << "[VirtualBus] Closed after" << m_frames << "frames";
+    emit channelClosed();
+}
+
+// ============================================================================
+//  Receive (unused)
+// ============================================================================
+
+CANResult VirtualCANDriver::receive(CANMessage& /*msg*/, int /*timeoutMs*/)
+{
+    return CANResult::Failure("Virtual bus delivers frames via messageReceived()");
+}
+
+CANResult VirtualCANDriver::flushReceiveQueue()
+{
+    return CANResult::Success();
+}
+
+QString VirtualCANDriver::lastError() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_lastError;
+}
+
+// ============================================================================
+//  Bus thread
+// ============================================================================
+
+void VirtualCANDriver::busLoop()
+{
+    // The bus thread is where frames are "received" — place it like one.
+    ThreadPlacement::Scope placement(ThreadPlacement::Receive);
+    const uint64_t ifsNs = CANBitTiming::bitsToNs(CANBitTiming::IFS_BITS, m_config.bitrate);
+
+    QMutexLocker lock(&m_mutex);
+    while (!m_stop) {
+        // ── 1. When does the next frame start? ──────────────────────────────
+        uint64_t earliest = std::numeric_limits<uint64_t>::max();
+        for (const Node& n : m_nodes) {
+            if (!n.heap.empty())
+                earliest = std::min(earliest, n.readySinceNs);
+        }
+        if (earliest == std::numeric_limits<uint64_t>::max()) {
+            m_wake.wait(&m_mutex);   // bus idle — wait for a transmit
+            continue;
+        }
+        const uint64_t start = std::max(m_busIdleSinceNs, earliest);
+
+        // ── 2. Arbitration among all nodes ready at SOF ─────────────────────
+        int winner = -1;
+        for (int i = 0; i < static_cast<int>(m_nodes.size()); ++i) {
+            const Node& n = m_nodes[i];
+            if (n.heap.empty() || n.readySinceNs > start) continue;
+            if (winner < 0 || later(m_nodes[winner].heap.front(), n.heap.front()))
+                winner = i;
+        }
+        for (int i = 0; i < static_cast<int>(m_nodes.size()); ++i) {
+            Node& n = m_nodes[i];
+            if (i != winner && !n.heap.empty() && n.readySinceNs <= start)
+                ++n.stats.arbitrationLosses;
+        }
+
+        Node& w = m_nodes[winner];
+        std::pop_heap(w.heap.begin(), w.heap.end(), &VirtualCANDriver::later);
+        Pending p = std::move(w.heap.back());
+        w.heap.pop_back();
+
+        // ── 3. Occupy the bus for the exact frame duration ──────────────────
+        const uint64_t durationNs = CANBitTiming::frameDurationNs(
+            p.msg, m_config.bitrate, m_config.fdDataBitrate, m_config.fdEnabled);
+        const uint64_t end = start + durationNs;
+
+        m_busIdleSinceNs = end + ifsNs;
+        w.readySinceNs   = m_busIdleSinceNs;   // its next frame contends right after
+        m_busyNs        += durationNs + ifsNs;
+        ++m_frames;
+        ++w.stats.txFrames;
+        w.stats.maxQueueDelayUs = std::max(w.stats.maxQueueDelayUs,
+                                           double(end - p.enqueueNs) / 1000.0);
+
+        // ── 4. Deliver once wall time has reached the end of the frame ──────
+        //  Transmits during the wait only wake us early; the frame is
+        //  already committed, so just go back to sleep.
+        for (;;) {
+            const auto now = static_cast<uint64_t>(m_clock.nsecsElapsed());
+            if (m_stop || now >= end) break;
+            m_wake.wait(&m_mutex, QDeadlineTimer(std::chrono::nanoseconds(end - now),
+                                                 Qt::PreciseTimer));
+        }
+        if (m_stop) break;
+
+        CANMessage msg  = p.msg;
+        msg.channel     = kBusChannel;
+        msg.timestamp   = end;
+        msg.isTxConfirm = m_nodes[winner].txConfirm;
+        if (!passesCaptureFilter(msg))
+            continue;
+
+        // Emit outside the lock: a direct-connected slot may transmit again.
+        lock.unlock();
+        emit messageReceived(msg);
+        lock.relock();
+    }
+}
+
+// ============================================================================
+//  Stats
+// ============================================================================
+
+VirtualCANDriver::BusStats VirtualCANDriver::stats() const
+{
+    QMutexLocker lock(&m_mutex);
+
+    BusStats s;
+    s.frames = m_frames;
+
+    const auto now = static_cast<uint64_t>(m_clock.isValid() ? m_clock.nsecsElapsed() : 0);
+    if (now > m_lastStatsNs) {
+        const double busy = double(m_busyNs - m_lastStatsBusyNs);
+        s.busLoadPercent = std::min(100.0, 100.0 * busy / double(now - m_lastStatsNs));
+    }
+    if (now > 0)
+        s.totalLoadPercent = std::min(100.0, 100.0 * double(m_busyNs) / double(now));
+    m_lastStatsNs     = now;
+    m_lastStatsBusyNs = m_busyNs;
+
+    s.nodes.reserve(static_cast<int>(m_nodes.size()));
+    for (const Node& n : m_nodes) {
+        NodeStats ns = n.stats;
+        ns.queued = static_cast<int>(n.heap.size());
+        s.nodes.append(ns);
+    }
+    return s;
+}
+
+} // namespace CANManager
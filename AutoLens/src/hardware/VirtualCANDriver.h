@@ -0,0 +1,180 @@
+#pragma once
+/**
+ * @file VirtualCANDriver.h
+ * @brief In-process virtual CAN bus with ID arbitration and bit timing.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHAT IT DOES
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  DemoCANDriver is a one-way source.  VirtualCANDriver is a bus: any number
+ *  of logical nodes (the UI, the residual bus simulator, node scripts, …)
+ *  queue frames, and one bus thread serialises them exactly like a wire:
+ *
+ *    node "Host"         ─┐
+ *    node "ResidualBus"  ─┼─► arbitration ─► frame on bus ─► messageReceived
+ *    node "Scripts"      ─┘   (lowest ID      (duration from CANBitTiming:
+ *                              wins)           bitrate, FD data rate, stuffing)
+ *
+ *  Every frame is timestamped with the end of its EOF on a virtual bus clock:
+ *
+ *    start = max(bus idle since, earliest node ready)
+ *    end   = start + frameDurationNs(frame)
+ *    next  = end + 3 bit times (interframe space)
+ *
+ *  A node becomes ready at the wall-clock moment its queue goes from empty
+ *  to non-empty, so the first frame after an idle bus starts at a wall
+ *  time and inherits its scheduling jitter — absolute timestamps, and
+ *  which nodes are ready in time to contend, vary from run to run.  While
+ *  the bus stays busy the spacing is exact: back-to-back frames are
+ *  separated by their computed durations and IFS only.  This is a live
+ *  bus, not a deterministic replay.  Frames are delivered once wall time
+ *  has caught up with their end time, so the trace sees a realistic rate
+ *  and bus load.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  ARBITRATION
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Each node has a TX queue ordered by arbitration priority (FIFO within one
+ *  ID) and offers its highest-priority frame.  All nodes ready at `start`
+ *  contend; the lowest arbitration key wins and the others count an
+ *  arbitration loss.  The key is the bit sequence up to the end of the
+ *  arbitration field, so a standard frame beats an extended frame with the
+ *  same base ID, and a data frame beats a remote frame.
+ *
+ *  Frames from HOST_NODE (transmit()) are echoed with isTxConfirm, like a
+ *  hardware TX confirmation; other nodes' frames arrive as normal RX unless
+ *  the node was added with txConfirm (e.g. the gateway).
+ *  Listen-only blocks only the host node — simulated nodes keep talking.
+ */
+
+#include "CANInterface.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <vector>
+
+namespace CANManager {
+
+class VirtualCANDriver : public ICANDriver
+{
+    Q_OBJECT
+
+public:
+    static constexpr int HOST_NODE      = 0;      ///< node behind transmit()
+    static constexpr int TX_QUEUE_LIMIT = 4096;   ///< frames per node before TX fails
+
+    /** Per-node counters. */
+    struct NodeStats
+    {
+        QString name;
+        quint64 txFrames          = 0;
+        quint64 arbitrationLosses = 0;
+        quint64 queueFull         = 0;   ///< transmits rejected (queue at limit)
+        double  maxQueueDelayUs   = 0.0; ///< worst enqueue → end of frame
+        int     queued            = 0;
+    };
+
+    struct BusStats
+    {
+        quint64 frames         = 0;
+        double  busLoadPercent = 0.0;   ///< since the previous stats() call
+        double  totalLoadPercent = 0.0; ///< since openChannel()
+        QVector<NodeStats> nodes;
+    };
+
+    explicit VirtualCANDriver(QObject* parent = nullptr);
+    ~VirtualCANDriver() override;
+
+    /**
+     * @brief Register a logical node; returns its id.
+     * Idempotent by name, so callers may re-register after a reconnect.
+     * With @p txConfirm the node's frames are delivered as TX echoes (like
+     * HOST_NODE) — for nodes that act on behalf of AutoLens itself and must
+     * not see their own output as received traffic.  Thread-safe.
+     */
+    int addNode(const QString& name, bool txConfirm = false);
+
+    /** Queue @p msg for transmission by @p node.  Any thread, never blocks. */
+    CANResult transmitFrom(int node, const CANMessage& msg);
+
+    /** Queue @p count frames for @p node under one lock (see transmitBatch()). */
+    CANResult transmitBatchFrom(int node, const CANMessage* frames, int count, int* sent = nullptr);
+
+    BusStats stats() const;
+
+    // --- ICANDriver interface ---
+    bool    initialize()  override { return true; }
+    void    shutdown()    override;
+    bool    isAvailable() const override { return true; }
+    QString driverName()  const override { return QStringLiteral("Virtual bus (simulated nodes)"); }
+
+    QList<CANChannelInfo> detectChannels() override;
+
+    CANResult openChannel(const CANChannelInfo& channel,
+                          const CANBusConfig& config) override;
+    void      closeChannel() override;
+    bool      isOpen() const override { return m_thread != nullptr; }
+
+    /** Transmit as HOST_NODE. */
+    CANResult transmit(const CANMessage& msg) override { return transmitFrom(HOST_NODE, msg); }
+    CANResult transmitBatch(const CANMessage* frames, int count, int* sent = nullptr) override
+    {
+        return transmitBatchFrom(HOST_NODE, frames, count, sent);
+    }
+
+    /** Not used — frames are pushed through messageReceived(). */
+    CANResult receive(CANMessage& msg, int timeoutMs = 1000) override;
+    CANResult flushReceiveQueue() override;
+    QString   lastError() const override;
+
+    /** Arbitration key: lower wins.  Compares like the wire bits SOF..RTR. */
+    static uint32_t arbitrationKey(const CANMessage& msg);
+
+private:
+    struct Pending
+    {
+        uint32_t   key       = 0;
+        quint64    seq       = 0;     ///< FIFO order within one key
+        uint64_t   enqueueNs = 0;
+        CANMessage msg;
+    };
+
+    struct Node
+    {
+        QString              name;
+        std::vector<Pending> heap;          ///< min-heap on (key, seq)
+        uint64_t             readySinceNs = 0;   ///< first moment the head could start
+        bool                 txConfirm    = false;
+        NodeStats            stats;
+    };
+
+    static bool later(const Pending& a, const Pending& b)
+    {
+        return a.key != b.key ? a.key > b.key : a.seq > b.seq;
+    }
+
+    CANResult enqueueLocked(int node, const CANMessage& msg);
+    void busLoop();
+
+    mutable QMutex     m_mutex;
+    QWaitCondition     m_wake;
+    std::vector<Node>  m_nodes;
+    QThread*           m_thread = nullptr;
+    bool               m_stop   = false;
+    QString            m_lastError;
+
+    CANBusConfig       m_config;
+    QElapsedTimer      m_clock;          ///< wall clock since openChannel()
+    uint64_t           m_busIdleSinceNs = 0;
+    quint64            m_seq     = 0;
+    quint64            m_frames  = 0;
+    uint64_t           m_busyNs  = 0;    ///< sum of frame + IFS durations
+
+    mutable uint64_t   m_lastStatsNs     = 0;
+    mutable uint64_t   m_lastStatsBusyNs = 0;
+};
+
+} // namespace CANManager
@@ -0,0 +1,231 @@
+/**
+ * @file SharedFrameRing.cpp
+ * @brief Shared-memory frame ring: platform mapping and the publish path.
+ */
+
+#include "ipc/SharedFrameRing.h"
+#include "ipc/autolens_ring.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+
+#include <chrono>
+#include <cstring>
+
+#ifndef Q_OS_WIN
+#  include <cerrno>
+#endif
+
+using namespace CANManager;
+
+// The writer treats the C layout's u32/u64 words as std::atomic — valid as
+// long as those are plain, lock-free words (true on every supported target).
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "atomic<u64> must be a plain word");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "atomic<u32> must be a plain word");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "readers in other processes need lock-free u64");
+
+namespace {
+
+template <typename T>
+std::atomic<T>& atomicAt(T& word)
+{
+    return *reinterpret_cast<std::atomic<T>*>(&word);
+}
+
+uint8_t frameFlags(const CANMessage& msg)
+{
+    return uint8_t((msg.isExtended  ? ALR_FLAG_EXTENDED : 0)
+                 | (msg.isFD        ? ALR_FLAG_FD       : 0)
+                 | (msg.isBRS       ? ALR_FLAG_BRS      : 0)
+                 | (msg.isRemote    ? ALR_FLAG_REMOTE   : 0)
+                 | (msg.isError     ? ALR_FLAG_ERROR    : 0)
+                 | (msg.isTxConfirm ? ALR_FLAG_TX       : 0));
+}
+
+int roundUpPow2(int n)
+{
+    int p = SharedFrameRing::MIN_SLOTS;
+    while (p < n && p < SharedFrameRing::MAX_SLOTS)
+        p <<= 1;
+    return p;
+}
+
+QString systemError(const QString& what)
+{
+#ifdef Q_OS_WIN
+    const int code = static_cast<int>(GetLastError());
+#else
+    const int code = errno;
+#endif
+    return QString("%1: %2 (%3)").arg(what, qt_error_string(code)).arg(code);
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Mapping — owns the view; unmapped when the last publish() drops it
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct SharedFrameRing::Mapping
+{
+    void*       base   = nullptr;
+    size_t      size   = 0;
+#ifdef Q_OS_WIN
+    HANDLE      handle = nullptr;
+#endif
+    alr_header* header = nullptr;
+    alr_slot*   ring   = nullptr;
+    uint64_t    mask   = 0;
+
+    ~Mapping()
+    {
+#ifdef Q_OS_WIN
+        if (base)   UnmapViewOfFile(base);
+        if (handle) CloseHandle(handle);
+#else
+        if (base)   munmap(base, size);
+#endif
+    }
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Lifecycle
+// ─────────────────────────────────────────────────────────────────────────────
+
+QString SharedFrameRing::defaultName()
+{
+    return QStringLiteral(ALR_DEFAULT_NAME);
+}
+
+SharedFrameRing::SharedFrameRing(QObject* parent)
+    : QObject(parent)
+{
+}
+
+SharedFrameRing::~SharedFrameRing()
+{
+    close();
+}
+
+QString SharedFrameRing::open(const QString& name, int slotCount)
+{
+    close();
+
+    const int    count = roundUpPow2(slotCount);
+    const size_t size  = ALR_HEADER_SIZE + size_t(count) * ALR_SLOT_SIZE;
+    auto map = std::make_shared<Mapping>();
+    map->size = size;
+
+#ifdef Q_OS_WIN
+    // An existing object means a reader still holds the previous ring open;
+    // it is reused (and re-initialised below) if it is large enough.
+    map->handle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                     DWORD(uint64_t(size) >> 32), DWORD(size & 0xFFFFFFFFu),
+                                     reinterpret_cast<LPCWSTR>(name.utf16()));
+    if (!map->handle)
+        return systemError(QStringLiteral("CreateFileMapping ") + name);
+    map->base = MapViewOfFile(map->handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (!map->base)
+        return systemError(QStringLiteral("MapViewOfFile ") + name);
+    MEMORY_BASIC_INFORMATION info{};
+    if (!VirtualQuery(map->base, &info, sizeof(info)) || info.RegionSize < size)
+        return QString("%1 is still mapped by a reader with a smaller ring — close it first").arg(name);
+#else
+    const QByteArray path = name.toLocal8Bit();
+    shm_unlink(path.constData());   // left behind by a crashed run
+    const int fd = shm_open(path.constData(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        return systemError(QStringLiteral("shm_open ") + name);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        const QString error = systemError(QStringLiteral("ftruncate ") + name);
+        ::close(fd);
+        shm_unlink(path.constData());
+        return error;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        const QString error = systemError(QStringLiteral("mmap ") + name);
+        shm_unlink(path.constData());
+        return error;
+    }
+    map->base = base;
+#endif
+
+    // WHY touch every page now: the first lap would otherwise page-fault on
+    // the driver thread once per 4 KiB — exactly the latency this avoids.
+    // Zeroing also clears the slot sequence words of a reused mapping.
+    std::memset(map->base, 0, size);
+
+    map->header = static_cast<alr_header*>(map->base);
+    map->ring   = reinterpret_cast<alr_slot*>(static_cast<uint8_t*>(map->base) + ALR_HEADER_SIZE);
+    map->mask   = uint64_t(count) - 1;
+
+    alr_header* h = map->header;
+    h->version     = ALR_VERSION;
+    h->header_size = ALR_HEADER_SIZE;
+    h->slot_size   = ALR_SLOT_SIZE;
+    h->slot_count  = uint32_t(count);
+    h->session     = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::system_clock::now().time_since_epoch()).count());
+    h->writer_pid  = uint32_t(QCoreApplication::applicationPid());
+    h->state       = ALR_STATE_OPEN;
+    atomicAt(h->magic).store(ALR_MAGIC, std::memory_order_release);   // valid from here on
+
+    m_name = name;
+    std::atomic_store(&m_map, std::move(map));
+    qDebug() << "[SharedFrameRing] Publishing to" << name << "—" << count << "slots,"
+             << (size >> 20) << "MiB";
+    return {};
+}
+
+void SharedFrameRing::close()
+{
+    const std::shared_ptr<Mapping> map = std::atomic_exchange(&m_map, std::shared_ptr<Mapping>());
+    if (!map)
+        return;
+
+    atomicAt(map->header->state).store(ALR_STATE_CLOSED, std::memory_order_release);
+#ifndef Q_OS_WIN
+    shm_unlink(m_name.toLocal8Bit().constData());   // readers keep their mapping
+#endif
+    qDebug() << "[SharedFrameRing] Closed" << m_name << "after"
+             << atomicAt(map->header->write_seq).load(std::memory_order_relaxed) << "frames";
+}
+
+quint64 SharedFrameRing::published() const
+{
+    const auto map = std::atomic_load(&m_map);
+    return map ? atomicAt(map->header->write_seq).load(std::memory_order_relaxed) : 0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Publish — the only per-frame code
+// ─────────────────────────────────────────────────────────────────────────────
+
+void SharedFrameRing::publish(const CANMessage& msg)
+{
+    const std::shared_ptr<Mapping> map = std::atomic_load(&m_map);
+    if (!map)
+        return;
+
+    const uint64_t n    = atomicAt(map->header->write_seq).fetch_add(1, std::memory_order_relaxed);
+    alr_slot&      slot = map->ring[n & map->mask];
+    auto&          seq  = atomicAt(slot.seq);
+
+    // Odd sequence first: a reader that copies while we write sees the
+    // change on its second look and discards the copy.
+    seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    alr_frame& f   = slot.frame;
+    f.timestamp_ns = msg.timestamp;
+    f.id           = msg.id;
+    f.channel      = msg.channel;
+    f.dlc          = msg.dlc;
+    f.len          = uint8_t(msg.dataLength());
+    f.flags        = frameFlags(msg);
+    std::memcpy(f.data, msg.data, sizeof(f.data));   // fixed size: no stale bytes, no branch
+
+    seq.store(2 * n + 2, std::memory_order_release);
+}
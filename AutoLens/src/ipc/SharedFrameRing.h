@@ -0,0 +1,77 @@
+#pragma once
+/**
+ * @file SharedFrameRing.h
+ * @brief Publishes received frames into a named shared-memory ring.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHERE IT SITS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    driver RX thread ── messageReceived ─┬─ direct ─► GatewayEngine::process()
+ *                                         ├─ direct ─► SharedFrameRing::publish()
+ *                                         │              one slot write, no syscall
+ *                                         └─ queued ─► AppController::onFrameReceived
+ *
+ *  External processes (Python analysis, a HIL controller) map the same
+ *  memory read-only and poll it — they see a frame as soon as the driver
+ *  thread has emitted it, without a socket, a file or a copy in between.
+ *  The layout, the sequence-lock protocol and a C reader live in
+ *  ipc/autolens_ring.h; that header is all a consumer needs.
+ *
+ *  The writer never waits: readers keep their own cursors, a reader that
+ *  falls a whole ring behind skips ahead and counts the loss itself.
+ *  publish() is safe from several threads (the Demo driver emits from the
+ *  UI thread and its DBC worker); each frame claims its slot with one
+ *  fetch_add on the shared write counter.
+ *
+ *  open()/close() swap the mapping atomically (like the gateway's route
+ *  table), so the unmap happens only after the last in-flight publish().
+ */
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+#include "hardware/CANInterface.h"
+
+class SharedFrameRing : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_SLOTS = 65536;     ///< 8 MiB, several seconds of a full bus
+    static constexpr int MIN_SLOTS     = 1024;
+    static constexpr int MAX_SLOTS     = 1 << 22;   ///< 512 MiB
+
+    /** "/autolens_frames" (POSIX) or "Local\\autolens_frames" (Windows). */
+    static QString defaultName();
+
+    explicit SharedFrameRing(QObject* parent = nullptr);
+    ~SharedFrameRing() override;
+
+    /**
+     * @brief Create (or replace) the ring @p name with @p slotCount slots.
+     * @p slotCount is rounded up to a power of two.
+     * @return Empty string on success, otherwise the error.
+     */
+    QString open(const QString& name, int slotCount);
+
+    /** Mark the ring closed for readers and unlink the name. */
+    void close();
+
+    bool    isOpen() const { return std::atomic_load(&m_map) != nullptr; }
+    QString name()   const { return m_name; }
+
+    /** Frames written since open(). */
+    quint64 published() const;
+
+    /** Write one frame into the next slot.  Any thread, never blocks. */
+    void publish(const CANManager::CANMessage& msg);
+
+private:
+    struct Mapping;   ///< platform mapping + slot pointers, see .cpp
+
+    std::shared_ptr<Mapping> m_map;   ///< accessed with std::atomic_load/store
+    QString m_name;
+};
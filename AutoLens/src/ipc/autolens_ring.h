@@ -0,0 +1,349 @@
+/*
+ * autolens_ring.h — AutoLens shared-memory frame ring: layout and reader.
+ *
+ * Single-header C99 library for processes on the same machine that want the
+ * live CAN frame stream of a running AutoLens (enable "Share frames" in the
+ * CAN configuration dialog).  No dependencies beyond the OS; copy this file
+ * into your project.  AutoLens itself builds the writer side from the same
+ * definitions, so the layout below is the contract.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  OBJECT
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  POSIX:   shm_open("/autolens_frames")       → /dev/shm/autolens_frames
+ *  Windows: OpenFileMapping("Local\\autolens_frames")
+ *
+ *  The name is configurable ("Share/name" in the AutoLens settings).  The
+ *  object is created when sharing is enabled and unlinked when it is
+ *  disabled or AutoLens exits; a reader that stays mapped keeps the old
+ *  memory and sees ALR_STATE_CLOSED — reopen to follow a new writer.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  LAYOUT (little-endian, all offsets in bytes)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    0     header       ALR_HEADER_SIZE (128)
+ *            0  u32  magic        ALR_MAGIC ("ALR1"), written last
+ *            4  u16  version      ALR_VERSION
+ *            6  u16  header_size  offset of slot 0
+ *            8  u32  slot_size    ALR_SLOT_SIZE (128)
+ *           12  u32  slot_count   power of two
+ *           16  u64  session      changes whenever the ring is recreated
+ *           24  u32  writer_pid
+ *           28  u32  state        ALR_STATE_OPEN / ALR_STATE_CLOSED
+ *           64  u64  write_seq    frames claimed so far (own cache line)
+ *    128   slot[0 … slot_count-1], frame n lives in slot[n & (slot_count-1)]
+ *            0  u64  seq          2n+1 while frame n is written, 2n+2 after
+ *            8  u64  timestamp_ns CANMessage::timestamp (driver time base)
+ *           16  u32  id
+ *           20  u8   channel      1-based
+ *           21  u8   dlc
+ *           22  u8   len          payload bytes in data[]
+ *           23  u8   flags        ALR_FLAG_*
+ *           24  u8   data[64]
+ *           88  …    reserved (zero)
+ *
+ *  Slots are cache-line aligned and two lines long, so a reader of frame n
+ *  never shares a line with the writer of frame n+1.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  PROTOCOL (per-slot sequence lock)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Writer:  n = write_seq++;  slot.seq = 2n+1;  <release fence>
+ *           copy frame;       slot.seq = 2n+2  (release)
+ *
+ *  Reader:  keeps its own cursor n — the writer never waits for readers and
+ *           any number of them can attach.
+ *           s1 = slot.seq (acquire)
+ *             s1 <  2n+2  → frame n not published yet, try again later
+ *             s1 >  2n+2  → lapped: the writer is a full ring ahead
+ *             s1 == 2n+2  → copy (or use in place), <acquire fence>,
+ *                           re-read slot.seq; unchanged → the copy is valid
+ *
+ *  A lapped reader resumes ALR_RESYNC_SLOTS past the oldest frame still in
+ *  the ring and counts the skipped frames in alr_reader.lost.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  USAGE
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    alr_reader r;
+ *    alr_frame  f;
+ *    if (alr_open(&r, ALR_DEFAULT_NAME) != 0) return 1;
+ *    while (alr_writer_alive(&r)) {
+ *        while (alr_next(&r, &f) > 0)
+ *            printf("%u %03X [%u]\n", f.channel, f.id, f.len);
+ *        usleep(100);                     // or spin for lowest latency
+ *    }
+ *    alr_close(&r);
+ *
+ *  Zero-copy variant: alr_peek() returns the slot in place; after using it,
+ *  alr_commit() returns 1 if the slot was not overwritten meanwhile.
+ *
+ *  Python: mmap /dev/shm/autolens_frames and unpack the slots with
+ *  struct.unpack_from("<QQIBBBB64s", buf, 128 + (n % slot_count) * 128),
+ *  applying the same seq check before and after.
+ */
+
+#ifndef AUTOLENS_RING_H
+#define AUTOLENS_RING_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALR_MAGIC        0x31524C41u   /* "ALR1" */
+#define ALR_VERSION      1
+#define ALR_HEADER_SIZE  128
+#define ALR_SLOT_SIZE    128
+#define ALR_STATE_CLOSED 0
+#define ALR_STATE_OPEN   1
+
+#ifdef _WIN32
+#define ALR_DEFAULT_NAME "Local\\autolens_frames"
+#else
+#define ALR_DEFAULT_NAME "/autolens_frames"
+#endif
+
+enum {
+    ALR_FLAG_EXTENDED = 0x01,
+    ALR_FLAG_FD       = 0x02,
+    ALR_FLAG_BRS      = 0x04,
+    ALR_FLAG_REMOTE   = 0x08,
+    ALR_FLAG_ERROR    = 0x10,
+    ALR_FLAG_TX       = 0x20    /* our own transmission (TX confirmation) */
+};
+
+typedef struct alr_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t slot_size;
+    uint32_t slot_count;
+    uint64_t session;
+    uint32_t writer_pid;
+    uint32_t state;
+    uint8_t  reserved0[32];
+    uint64_t write_seq;
+    uint8_t  reserved1[56];
+} alr_header;
+
+typedef struct alr_frame {
+    uint64_t timestamp_ns;
+    uint32_t id;
+    uint8_t  channel;
+    uint8_t  dlc;
+    uint8_t  len;
+    uint8_t  flags;
+    uint8_t  data[64];
+} alr_frame;
+
+typedef struct alr_slot {
+    uint64_t  seq;
+    alr_frame frame;
+    uint8_t   reserved[40];
+} alr_slot;
+
+/* C11 _Static_assert is not C99; a negative array size fails just as well. */
+typedef char alr_check_header[sizeof(alr_header) == ALR_HEADER_SIZE ? 1 : -1];
+typedef char alr_check_slot[sizeof(alr_slot) == ALR_SLOT_SIZE ? 1 : -1];
+
+/* ── Atomics ───────────────────────────────────────────────────────────────
+ * Plain aligned 64-bit loads with acquire ordering.  The writer uses
+ * std::atomic on the same words, which is lock-free on every target
+ * AutoLens builds for. */
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#if defined(_M_ARM64)
+static __inline uint64_t alr_load_acquire(const uint64_t* p)
+{ return __ldar64((unsigned __int64 volatile*)p); }
+#define alr_fence_acquire() __dmb(_ARM64_BARRIER_ISHLD)
+#else   /* x64: loads are not reordered with other loads */
+static __inline uint64_t alr_load_acquire(const uint64_t* p)
+{ uint64_t v = *(const volatile uint64_t*)p; _ReadWriteBarrier(); return v; }
+#define alr_fence_acquire() _ReadWriteBarrier()
+#endif
+#define ALR_INLINE static __inline
+#else
+#define alr_load_acquire(p)  __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define alr_fence_acquire()  __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define ALR_INLINE static inline
+#endif
+
+/* ── Reader ────────────────────────────────────────────────────────────── */
+
+typedef struct alr_reader {
+    const alr_header* header;
+    const alr_slot*   ring;      /* slot 0 (not "slots": a Qt keyword macro) */
+    uint64_t          mask;
+    uint64_t          next;      /* sequence number of the next frame */
+    uint64_t          session;
+    uint64_t          lost;      /* frames skipped after being lapped */
+    const alr_slot*   peeked;
+    size_t            map_size;
+    void*             handle;    /* Windows mapping handle */
+} alr_reader;
+
+/* Resume this many slots ahead of the oldest frame after being lapped, so
+ * the writer does not overtake the reader again straight away. */
+#define ALR_RESYNC_SLOTS(r) (((r)->mask + 1) / 8)
+
+ALR_INLINE void alr_close(alr_reader* r)
+{
+    if (r->header) {
+#ifdef _WIN32
+        UnmapViewOfFile((LPCVOID)r->header);
+        CloseHandle((HANDLE)r->handle);
+#else
+        munmap((void*)r->header, r->map_size);
+#endif
+    }
+    memset(r, 0, sizeof(*r));
+}
+
+/* Map the ring and position the cursor at the live end.
+ * Returns 0, or -1 if it does not exist (yet) or is not a valid ring. */
+ALR_INLINE int alr_open(alr_reader* r, const char* name)
+{
+    const alr_header* h;
+    memset(r, 0, sizeof(*r));
+#ifdef _WIN32
+    {
+        MEMORY_BASIC_INFORMATION info;
+        HANDLE map = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+        void* base;
+        if (!map) return -1;
+        base = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+        if (!base || !VirtualQuery(base, &info, sizeof(info))) {
+            if (base) UnmapViewOfFile(base);
+            CloseHandle(map);
+            return -1;
+        }
+        r->handle   = map;
+        r->map_size = info.RegionSize;
+        h = (const alr_header*)base;
+    }
+#else
+    {
+        struct stat st;
+        void* base;
+        const int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) return -1;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < ALR_HEADER_SIZE) {
+            close(fd);
+            return -1;
+        }
+        base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) return -1;
+        r->map_size = (size_t)st.st_size;
+        h = (const alr_header*)base;
+    }
+#endif
+    r->header = h;
+    if (*(const volatile uint32_t*)&h->magic != ALR_MAGIC || h->version != ALR_VERSION
+        || h->slot_size != ALR_SLOT_SIZE || h->slot_count == 0
+        || (h->slot_count & (h->slot_count - 1)) != 0
+        || r->map_size < (size_t)h->header_size + (size_t)h->slot_count * ALR_SLOT_SIZE) {
+        alr_close(r);
+        return -1;
+    }
+    r->ring   = (const alr_slot*)((const uint8_t*)h + h->header_size);
+    r->mask    = h->slot_count - 1;
+    r->session = h->session;
+    r->next    = alr_load_acquire(&h->write_seq);
+    return 0;
+}
+
+/* 1 while the writer that created this mapping is still publishing. */
+ALR_INLINE int alr_writer_alive(const alr_reader* r)
+{
+    return *(const volatile uint32_t*)&r->header->state == ALR_STATE_OPEN
+        && r->header->session == r->session;
+}
+
+/* Move the cursor to the oldest frame still in the ring. */
+ALR_INLINE void alr_seek_oldest(alr_reader* r)
+{
+    const uint64_t head = alr_load_acquire(&r->header->write_seq);
+    r->next = head > r->mask + 1 ? head - (r->mask + 1) + ALR_RESYNC_SLOTS(r) : 0;
+}
+
+/* Lapped: skip ahead of the writer's oldest frame and count the loss. */
+ALR_INLINE void alr_skip_lapped(alr_reader* r)
+{
+    const uint64_t before = r->next;
+    alr_seek_oldest(r);
+    if (r->next <= before) r->next = before + 1;
+    r->lost += r->next - before;
+}
+
+/* The slot of the next frame in place, or NULL if it is not published yet.
+ * Check alr_commit() after reading it. */
+ALR_INLINE const alr_slot* alr_peek(alr_reader* r)
+{
+    for (;;) {
+        const alr_slot* s    = &r->ring[r->next & r->mask];
+        const uint64_t  want = 2 * r->next + 2;
+        const uint64_t  seq  = alr_load_acquire(&s->seq);
+        if (seq == want) {
+            r->peeked = s;
+            return s;
+        }
+        if (seq < want)
+            return NULL;
+        alr_skip_lapped(r);
+    }
+}
+
+/* Advance past the peeked slot; 1 if it stayed intact while it was used. */
+ALR_INLINE int alr_commit(alr_reader* r)
+{
+    const alr_slot* s = r->peeked;
+    uint64_t seq;
+    if (!s) return 0;
+    alr_fence_acquire();
+    seq = *(const volatile uint64_t*)&s->seq;
+    r->peeked = NULL;
+    if (seq != 2 * r->next + 2) {
+        alr_skip_lapped(r);
+        return 0;
+    }
+    ++r->next;
+    return 1;
+}
+
+/* Copy the next frame into *out.  Returns 1, or 0 if none is available. */
+ALR_INLINE int alr_next(alr_reader* r, alr_frame* out)
+{
+    const alr_slot* s;
+    while ((s = alr_peek(r)) != NULL) {
+        memcpy(out, &s->frame, sizeof(*out));
+        if (alr_commit(r)) return 1;
+    }
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUTOLENS_RING_H */
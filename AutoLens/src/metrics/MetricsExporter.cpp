@@ -0,0 +1,186 @@
+/**
+ * @file MetricsExporter.cpp
+ * @brief Minimal HTTP endpoint and periodic file writer for OpenMetrics text.
+ */
+
+#include "metrics/MetricsExporter.h"
+#include "metrics/MetricsRegistry.h"
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QSaveFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+
+constexpr int  kMaxRequestBytes = 8192;
+constexpr int  kRequestTimeoutMs = 5000;
+constexpr char kContentType[] =
+    "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+QByteArray httpResponse(const char* status, const char* contentType, const QByteArray& body)
+{
+    QByteArray out;
+    out.reserve(body.size() + 160);
+    out += "HTTP/1.1 ";
+    out += status;
+    out += "\r\nContent-Type: ";
+    out += contentType;
+    out += "\r\nContent-Length: " + QByteArray::number(body.size());
+    out += "\r\nConnection: close\r\n\r\n";
+    out += body;
+    return out;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Lifecycle (UI thread)
+// ─────────────────────────────────────────────────────────────────────────────
+
+MetricsExporter::MetricsExporter(QObject* parent)
+    : QObject(parent)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stop();
+}
+
+QString MetricsExporter::start(quint16 port, const QString& filePath, int fileIntervalMs)
+{
+    stop();
+
+    if (port == 0 && filePath.isEmpty())
+        return "Metrics export needs a port or a file";
+
+    m_thread = new QThread;
+    m_thread->setObjectName("AutoLens_Metrics");
+    m_context = new QObject;
+    m_context->moveToThread(m_thread);
+    m_thread->start();
+
+    QString error;
+    QMetaObject::invokeMethod(m_context, [this, port, filePath, fileIntervalMs, &error]() {
+        if (port != 0) {
+            m_server = new QTcpServer;
+            if (!m_server->listen(QHostAddress::LocalHost, port)) {
+                error = QString("Cannot listen on 127.0.0.1:%1: %2")
+                            .arg(port).arg(m_server->errorString());
+                delete m_server;
+                m_server = nullptr;
+                return;
+            }
+            connect(m_server, &QTcpServer::newConnection, m_server,
+                    [this]() { onNewConnection(); });
+        }
+        if (!filePath.isEmpty()) {
+            m_filePath  = filePath;
+            m_fileTimer = new QTimer;
+            m_fileTimer->setInterval(qMax(MIN_FILE_INTERVAL_MS, fileIntervalMs));
+            connect(m_fileTimer, &QTimer::timeout, m_fileTimer, [this]() { writeFile(); });
+            m_fileTimer->start();
+            writeFile();
+        }
+    }, Qt::BlockingQueuedConnection);
+
+    if (!error.isEmpty()) {
+        stop();
+        return error;
+    }
+    m_port = port;
+    qDebug() << "[Metrics] Exporting" << (port ? QString("on 127.0.0.1:%1").arg(port) : QString())
+             << (filePath.isEmpty() ? QString() : QString("to %1").arg(filePath));
+    return {};
+}
+
+void MetricsExporter::stop()
+{
+    if (!m_thread)
+        return;
+
+    QMetaObject::invokeMethod(m_context, [this]() {
+        if (m_fileTimer)
+            writeFile();   // final snapshot
+        delete m_fileTimer;
+        m_fileTimer = nullptr;
+        delete m_server;   // open sockets are its children
+        m_server = nullptr;
+    }, Qt::BlockingQueuedConnection);
+
+    m_thread->quit();
+    m_thread->wait();
+    delete m_context;
+    delete m_thread;
+    m_context = nullptr;
+    m_thread  = nullptr;
+    m_port    = 0;
+    m_filePath.clear();
+    qDebug() << "[Metrics] Stopped";
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HTTP (exporter thread)
+// ─────────────────────────────────────────────────────────────────────────────
+
+void MetricsExporter::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        // Drop half-open or idle connections instead of keeping them forever.
+        QTimer::singleShot(kRequestTimeoutMs, socket, [socket]() { socket->abort(); });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+
+        connect(socket, &QTcpSocket::readyRead, socket, [socket]() {
+            // Only the request line matters; wait for the end of the headers
+            // so the client is not reset while still sending them.
+            const QByteArray head = socket->peek(kMaxRequestBytes);
+            if (!head.contains("\r\n\r\n") && !head.contains("\n\n")) {
+                if (head.size() >= kMaxRequestBytes)
+                    socket->abort();
+                return;
+            }
+            socket->readAll();
+            disconnect(socket, &QTcpSocket::readyRead, nullptr, nullptr);
+
+            const QList<QByteArray> line = head.left(head.indexOf('\n')).trimmed().split(' ');
+            const QByteArray method = line.value(0);
+            QByteArray path = line.value(1);
+            path = path.left(path.indexOf('?') < 0 ? path.size() : path.indexOf('?'));
+
+            if (method != "GET" && method != "HEAD") {
+                socket->write(httpResponse("405 Method Not Allowed", "text/plain", "GET only\n"));
+            } else if (path != "/metrics" && path != "/") {
+                socket->write(httpResponse("404 Not Found", "text/plain", "Try /metrics\n"));
+            } else {
+                QByteArray response = httpResponse("200 OK", kContentType,
+                                                   MetricsRegistry::instance().render());
+                if (method == "HEAD")
+                    response.truncate(response.indexOf("\r\n\r\n") + 4);
+                socket->write(response);
+            }
+            socket->disconnectFromHost();
+        });
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  File (exporter thread)
+// ─────────────────────────────────────────────────────────────────────────────
+
+void MetricsExporter::writeFile()
+{
+    // QSaveFile writes a temp file and renames it over the target, so a
+    // collector polling the path never reads half a snapshot.
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[Metrics] Cannot write" << m_filePath << ':' << file.errorString();
+        return;
+    }
+    file.write(MetricsRegistry::instance().render());
+    if (!file.commit())
+        qWarning() << "[Metrics] Cannot write" << m_filePath << ':' << file.errorString();
+}
@@ -0,0 +1,64 @@
+#pragma once
+/**
+ * @file MetricsExporter.h
+ * @brief Serves MetricsRegistry as OpenMetrics over HTTP and to a file.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHERE IT SITS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    hot paths ── relaxed atomics ──► MetricsRegistry ◄── AppController
+ *                                          │               1 Hz gauges
+ *                       exporter thread ───┤
+ *                                          ├─► GET /metrics on 127.0.0.1
+ *                                          └─► periodic file (atomic replace)
+ *
+ *  Prometheus, a node_exporter textfile collector or plain curl can read
+ *  either output.  The exporter runs on its own thread so a scrape still
+ *  answers while the UI thread is stalled — which is exactly when the
+ *  numbers are most interesting.
+ *
+ *  The HTTP side is deliberately minimal: one request per connection,
+ *  GET /metrics (or /) only, response then close.
+ */
+
+#include <QObject>
+#include <QString>
+
+class QThread;
+class QTcpServer;
+class QTimer;
+
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr quint16 DEFAULT_PORT             = 9464;
+    static constexpr int     DEFAULT_FILE_INTERVAL_MS = 5000;
+    static constexpr int     MIN_FILE_INTERVAL_MS     = 250;
+
+    explicit MetricsExporter(QObject* parent = nullptr);
+    ~MetricsExporter() override;
+
+    /**
+     * @brief Start serving.  @p port 0 disables HTTP, an empty @p filePath
+     * disables the file.  Returns "" or the error (nothing is left running).
+     */
+    QString start(quint16 port, const QString& filePath, int fileIntervalMs);
+    void    stop();
+    bool    isRunning() const { return m_thread != nullptr; }
+    quint16 port()      const { return m_port; }
+    QString filePath()  const { return m_filePath; }
+
+private:
+    void onNewConnection();
+    void writeFile();
+
+    QThread*    m_thread    = nullptr;
+    QObject*    m_context   = nullptr;   ///< lives on m_thread (invokeMethod target)
+    QTcpServer* m_server    = nullptr;   ///< exporter thread
+    QTimer*     m_fileTimer = nullptr;   ///< exporter thread
+    quint16     m_port      = 0;
+    QString     m_filePath;
+};
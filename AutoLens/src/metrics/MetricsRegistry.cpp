@@ -0,0 +1,179 @@
+/**
+ * @file MetricsRegistry.cpp
+ * @brief Metric registration and OpenMetrics text rendering.
+ */
+
+#include "metrics/MetricsRegistry.h"
+
+#include <QMutexLocker>
+
+namespace {
+
+/** Shortest round-trippable text for a sample value ("+Inf"-free). */
+QByteArray number(double v)
+{
+    if (v == double(qint64(v)) && v < 9.0e15 && v > -9.0e15)
+        return QByteArray::number(qint64(v));
+    return QByteArray::number(v, 'g', 15);
+}
+
+QByteArray sampleName(const QString& name, const char* suffix,
+                      const QString& labels, const QString& extraLabel = {})
+{
+    QByteArray out = name.toUtf8();
+    out += suffix;
+    if (!labels.isEmpty() || !extraLabel.isEmpty()) {
+        out += '{';
+        out += labels.toUtf8();
+        if (!labels.isEmpty() && !extraLabel.isEmpty())
+            out += ',';
+        out += extraLabel.toUtf8();
+        out += '}';
+    }
+    return out;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  MetricHistogram
+// ─────────────────────────────────────────────────────────────────────────────
+
+MetricHistogram::MetricHistogram(QVector<quint64> bounds)
+    : m_bounds(std::move(bounds))
+    , m_buckets(new std::atomic<quint64>[m_bounds.size() + 1])
+{
+    for (int i = 0; i <= m_bounds.size(); ++i)
+        m_buckets[i].store(0, std::memory_order_relaxed);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Registration
+// ─────────────────────────────────────────────────────────────────────────────
+
+QVector<quint64> MetricsRegistry::latencyBoundsNs()
+{
+    return { 10'000, 30'000, 100'000, 300'000, 1'000'000, 3'000'000,
+             10'000'000, 30'000'000, 100'000'000, 300'000'000, 1'000'000'000 };
+}
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Series& MetricsRegistry::series(const QString& name, const QString& help,
+                                                 Type type, const QString& labels,
+                                                 double scale)
+{
+    Family* family = nullptr;
+    for (const auto& f : m_families)
+        if (f->name == name) { family = f.get(); break; }
+
+    if (!family) {
+        m_families.push_back(std::make_unique<Family>());
+        family        = m_families.back().get();
+        family->name  = name;
+        family->help  = help;
+        family->type  = type;
+        family->scale = scale;
+    }
+    Q_ASSERT(family->type == type);
+
+    for (Series& s : family->series)
+        if (s.labels == labels)
+            return s;
+
+    family->series.push_back(Series{});
+    family->series.back().labels = labels;
+    return family->series.back();
+}
+
+MetricCounter* MetricsRegistry::counter(const QString& name, const QString& help,
+                                        const QString& labels, double scale)
+{
+    QMutexLocker lock(&m_mutex);
+    Series& s = series(name, help, Type::Counter, labels, scale);
+    if (!s.counter)
+        s.counter = std::make_unique<MetricCounter>();
+    return s.counter.get();
+}
+
+MetricGauge* MetricsRegistry::gauge(const QString& name, const QString& help,
+                                    const QString& labels)
+{
+    QMutexLocker lock(&m_mutex);
+    Series& s = series(name, help, Type::Gauge, labels, 1.0);
+    if (!s.gauge)
+        s.gauge = std::make_unique<MetricGauge>();
+    return s.gauge.get();
+}
+
+MetricHistogram* MetricsRegistry::histogram(const QString& name, const QString& help,
+                                            const QVector<quint64>& bounds,
+                                            const QString& labels, double scale)
+{
+    QMutexLocker lock(&m_mutex);
+    Series& s = series(name, help, Type::Histogram, labels, scale);
+    if (!s.histogram)
+        s.histogram = std::make_unique<MetricHistogram>(bounds);
+    return s.histogram.get();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  OpenMetrics text
+// ─────────────────────────────────────────────────────────────────────────────
+
+QByteArray MetricsRegistry::render() const
+{
+    QMutexLocker lock(&m_mutex);
+
+    QByteArray out;
+    out.reserve(16 * 1024);
+
+    for (const auto& f : m_families) {
+        const char* type = f->type == Type::Counter ? "counter"
+                         : f->type == Type::Gauge   ? "gauge" : "histogram";
+        out += "# TYPE " + f->name.toUtf8() + ' ' + type + '\n';
+        out += "# HELP " + f->name.toUtf8() + ' ' + f->help.toUtf8() + '\n';
+
+        for (const Series& s : f->series) {
+            switch (f->type) {
+            case Type::Counter:
+                out += sampleName(f->name, "_total", s.labels) + ' '
+                     + number(double(s.counter->value()) * f->scale) + '\n';
+                break;
+
+            case Type::Gauge:
+                out += sampleName(f->name, "", s.labels) + ' '
+                     + number(s.gauge->value()) + '\n';
+                break;
+
+            case Type::Histogram: {
+                // Buckets are cumulative; read each bucket once so _count
+                // is consistent with the +Inf bucket even mid-update.
+                const MetricHistogram& h = *s.histogram;
+                quint64 cumulative = 0;
+                for (int i = 0; i <= h.bounds().size(); ++i) {
+                    cumulative += h.bucket(i);
+                    const QString le = i < h.bounds().size()
+                        ? QString("le=\"%1\"").arg(QString::fromLatin1(
+                              number(double(h.bounds()[i]) * f->scale)))
+                        : QStringLiteral("le=\"+Inf\"");
+                    out += sampleName(f->name, "_bucket", s.labels, le) + ' '
+                         + QByteArray::number(cumulative) + '\n';
+                }
+                out += sampleName(f->name, "_count", s.labels) + ' '
+                     + QByteArray::number(cumulative) + '\n';
+                out += sampleName(f->name, "_sum", s.labels) + ' '
+                     + number(double(h.sum()) * f->scale) + '\n';
+                break;
+            }
+            }
+        }
+    }
+
+    out += "# EOF\n";
+    return out;
+}
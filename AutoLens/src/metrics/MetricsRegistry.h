@@ -0,0 +1,139 @@
+#pragma once
+/**
+ * @file MetricsRegistry.h
+ * @brief Lock-free pipeline counters, gauges and histograms (OpenMetrics).
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  HOT PATH vs COLD PATH
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Registration (counter(), gauge(), histogram()) takes a mutex and happens
+ *  once, at construction of the component that owns the metric; it returns
+ *  a pointer that stays valid for the life of the process.  Updating a
+ *  metric is a single relaxed atomic RMW or store on that pointer — no
+ *  lock, no lookup, no allocation — so the driver thread and the decode
+ *  workers can count every frame.
+ *
+ *  render() walks the registry under the mutex and formats OpenMetrics
+ *  text.  Relaxed loads mean a scrape may see counter A from slightly
+ *  before counter B; each value on its own is exact.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  NAMING
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Families are "autolens_<what>[_<unit>]"; counter samples get "_total"
+ *  appended when rendered.  Labels are passed pre-formatted, e.g.
+ *  channel="1".  Integer counters can carry a render scale so hot paths
+ *  count nanoseconds and the export shows seconds.
+ */
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+class MetricCounter
+{
+public:
+    void    add(quint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    /** Mirror an existing monotonic counter (sampled, not incremented). */
+    void    set(quint64 v)     { m_value.store(v, std::memory_order_relaxed); }
+    quint64 value() const      { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<quint64> m_value{0};
+};
+
+class MetricGauge
+{
+public:
+    void   set(double v) { m_bits.store(toBits(v), std::memory_order_relaxed); }
+    double value() const { return fromBits(m_bits.load(std::memory_order_relaxed)); }
+
+private:
+    static quint64 toBits(double v)   { quint64 b; memcpy(&b, &v, sizeof b); return b; }
+    static double  fromBits(quint64 b) { double v; memcpy(&v, &b, sizeof v); return v; }
+
+    std::atomic<quint64> m_bits{0};
+};
+
+/** Fixed-bucket histogram of integer observations (e.g. nanoseconds). */
+class MetricHistogram
+{
+public:
+    explicit MetricHistogram(QVector<quint64> bounds);
+
+    void observe(quint64 v)
+    {
+        int i = 0;
+        while (i < m_bounds.size() && v > m_bounds[i])   // ≤ 16 buckets: linear is fastest
+            ++i;
+        m_buckets[i].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(v, std::memory_order_relaxed);
+    }
+
+    const QVector<quint64>& bounds() const { return m_bounds; }
+    quint64 bucket(int i) const { return m_buckets[i].load(std::memory_order_relaxed); }
+    quint64 sum() const         { return m_sum.load(std::memory_order_relaxed); }
+
+private:
+    QVector<quint64>                       m_bounds;    ///< upper bounds, ascending
+    std::unique_ptr<std::atomic<quint64>[]> m_buckets;  ///< bounds.size() + 1 (+Inf)
+    std::atomic<quint64>                   m_sum{0};
+};
+
+class MetricsRegistry
+{
+public:
+    /** Bucket bounds in ns: 10 µs … 1 s, roughly ×3 per step. */
+    static QVector<quint64> latencyBoundsNs();
+
+    static MetricsRegistry& instance();
+
+    /**
+     * @param labels  Pre-formatted label set, e.g. "channel=\"1\"", or empty.
+     * @param scale   Multiplier applied when rendering (1e-9: ns → seconds).
+     * Registering the same (name, labels) twice returns the same metric.
+     */
+    MetricCounter*   counter(const QString& name, const QString& help,
+                             const QString& labels = {}, double scale = 1.0);
+    MetricGauge*     gauge(const QString& name, const QString& help,
+                           const QString& labels = {});
+    MetricHistogram* histogram(const QString& name, const QString& help,
+                               const QVector<quint64>& bounds,
+                               const QString& labels = {}, double scale = 1.0);
+
+    /** The whole registry as OpenMetrics text, terminated by "# EOF". */
+    QByteArray render() const;
+
+private:
+    MetricsRegistry() = default;
+
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Series
+    {
+        QString labels;
+        std::unique_ptr<MetricCounter>   counter;
+        std::unique_ptr<MetricGauge>     gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+
+    struct Family
+    {
+        QString name;
+        QString help;
+        Type    type  = Type::Counter;
+        double  scale = 1.0;
+        std::vector<Series> series;
+    };
+
+    Series& series(const QString& name, const QString& help, Type type,
+                   const QString& labels, double scale);
+
+    mutable QMutex m_mutex;
+    std::vector<std::unique_ptr<Family>> m_families;   ///< registration order
+};
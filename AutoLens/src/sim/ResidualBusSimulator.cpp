@@ -0,0 +1,427 @@
+/**
+ * @file ResidualBusSimulator.cpp
+ * @brief Timing-wheel scheduler + incremental payload encoding.
+ */
+
+#include "sim/ResidualBusSimulator.h"
+#include "sim/TimingWheel.h"
+#include "util/ThreadPlacement.h"
+
+#include <QDebug>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+using namespace CANManager;
+using namespace DBCManager;
+
+namespace {
+
+// How far ahead of a deadline the thread stops sleeping and starts
+// yielding.  Windows' default sleep granularity is ~1 ms (15.6 ms without
+// timeBeginPeriod), Linux hrtimers wake within tens of µs.
+#ifdef Q_OS_WIN
+constexpr int64_t kSleepSlackNs = 1500000;
+#else
+constexpr int64_t kSleepSlackNs = 80000;
+#endif
+
+/// Longest single sleep — bounds stop() latency and update-apply latency.
+constexpr int64_t kMaxSleepNs = 20000000;
+
+int64_t steadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool isMuxSelector(const DBCSignal& sig) { return sig.muxIndicator == QLatin1String("M"); }
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Ctor / Dtor
+// ─────────────────────────────────────────────────────────────────────────────
+
+ResidualBusSimulator::ResidualBusSimulator(QObject* parent)
+    : QObject(parent)
+{}
+
+ResidualBusSimulator::~ResidualBusSimulator()
+{
+    stop();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Configuration
+// ─────────────────────────────────────────────────────────────────────────────
+
+void ResidualBusSimulator::setChannelDatabase(int channel, const DBCDatabase& db)
+{
+    if (isRunning() || channel < 1 || channel > MAX_CHANNELS) return;
+    m_channelDbs[channel - 1] = db;
+}
+
+void ResidualBusSimulator::clearConfiguration()
+{
+    if (isRunning()) return;
+    for (auto& db : m_channelDbs) db = DBCDatabase();
+    m_enabledNodes.clear();
+}
+
+QVector<ResidualBusSimulator::NodeInfo> ResidualBusSimulator::nodes() const
+{
+    QVector<NodeInfo> result;
+
+    for (int ch = 1; ch <= MAX_CHANNELS; ++ch) {
+        const DBCDatabase& db = m_channelDbs[ch - 1];
+        if (db.isEmpty()) continue;
+
+        // Count messages per sender once instead of per node × message.
+        QHash<QString, QPair<int, int>> counts;   // sender → (all, cyclic)
+        for (const auto& msg : db.messages) {
+            auto& c = counts[msg.sender];
+            ++c.first;
+            if (msg.cycleTimeMs > 0) ++c.second;
+        }
+
+        for (const auto& node : db.nodes) {
+            NodeInfo info;
+            info.channel      = ch;
+            info.name         = node.name;
+            info.messageCount = counts.value(node.name).first;
+            info.cyclicCount  = counts.value(node.name).second;
+            info.enabled      = m_enabledNodes.contains(nodeKey(ch, node.name));
+            result.append(info);
+        }
+    }
+    return result;
+}
+
+void ResidualBusSimulator::setNodeEnabled(int channel, const QString& node, bool enabled)
+{
+    if (isRunning()) return;
+    const QString key = nodeKey(channel, node);
+    if (enabled) m_enabledNodes.insert(key);
+    else         m_enabledNodes.remove(key);
+}
+
+void ResidualBusSimulator::setAllNodesEnabled(bool enabled)
+{
+    if (isRunning()) return;
+    m_enabledNodes.clear();
+    if (!enabled) return;
+
+    for (int ch = 1; ch <= MAX_CHANNELS; ++ch) {
+        const DBCDatabase& db = m_channelDbs[ch - 1];
+        for (const auto& node : db.nodes)
+            m_enabledNodes.insert(nodeKey(ch, node.name));
+        // Messages from senders not declared in BU_ (e.g. Vector__XXX)
+        for (const auto& msg : db.messages)
+            m_enabledNodes.insert(nodeKey(ch, msg.sender));
+    }
+}
+
+QStringList ResidualBusSimulator::enabledNodeKeys() const
+{
+    QStringList keys(m_enabledNodes.begin(), m_enabledNodes.end());
+    keys.sort();
+    return keys;
+}
+
+void ResidualBusSimulator::setEnabledNodeKeys(const QStringList& keys)
+{
+    if (isRunning()) return;
+    m_enabledNodes = QSet<QString>(keys.begin(), keys.end());
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Schedule construction
+// ─────────────────────────────────────────────────────────────────────────────
+
+ResidualBusSimulator::HandleTable ResidualBusSimulator::buildSchedule()
+{
+    m_messages.clear();
+    HandleTable table;
+
+    for (int ch = 1; ch <= MAX_CHANNELS; ++ch) {
+        const DBCDatabase& db = m_channelDbs[ch - 1];
+        for (const DBCMessage& def : db.messages) {
+            if (!m_enabledNodes.contains(nodeKey(ch, def.sender)))
+                continue;
+
+            const int cycleMs = def.cycleTimeMs > 0 ? def.cycleTimeMs : m_defaultCycleMs;
+            if (cycleMs <= 0)
+                continue;   // event-driven message — scripts/stimulus only
+
+            SimMessage sim;
+            sim.def         = &def;   // m_channelDbs is frozen while running
+            sim.periodTicks = qMax<uint64_t>(1, uint64_t(cycleMs) * 1000000 / TICK_NS);
+
+            CANMessage& f = sim.frame;
+            f.id         = def.id;
+            f.isExtended = def.isExtended;
+            f.channel    = static_cast<uint8_t>(ch);
+            const int len = qBound(0, static_cast<int>(def.dlc), 64);
+            f.isFD       = len > 8;
+            f.dlc        = f.isFD ? lengthToDlc(len) : static_cast<uint8_t>(len);
+
+            // ── Initial payload: encode every start value exactly once ──────
+            //  For multiplexed messages only the branch selected by the
+            //  selector's start value is encoded, so overlapping branches
+            //  don't overwrite each other.
+            const int dataLen = f.dataLength();
+            int64_t activeMux = -1;
+            for (const auto& sig : def.signalList) {
+                if (isMuxSelector(sig)) {
+                    sig.encode(sig.initialValue, f.data, dataLen);
+                    activeMux = sig.physicalToRaw(sig.initialValue);
+                    break;
+                }
+            }
+            for (const auto& sig : def.signalList) {
+                if (isMuxSelector(sig)) continue;
+                if (sig.muxValue >= 0 && activeMux >= 0 && sig.muxValue != activeMux)
+                    continue;
+                sig.encode(sig.initialValue, f.data, dataLen);
+            }
+
+            QStringList names;
+            names.reserve(def.signalList.size());
+            for (const auto& sig : def.signalList)
+                names.append(sig.name);
+            table.byName.insert(QString::number(ch) + QLatin1Char(':') + def.name,
+                                static_cast<int>(m_messages.size()));
+            table.signalNames.append(names);
+            m_messages.push_back(sim);
+        }
+    }
+    return table;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Run control
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool ResidualBusSimulator::start()
+{
+    if (isRunning()) return true;
+
+    HandleTable table = buildSchedule();
+    if (m_messages.empty()) {
+        qDebug() << "[ResidualBus] Nothing to simulate (no enabled node sends cyclic messages)";
+        return false;
+    }
+
+    // Discard stimulus queued against a previous schedule's handles.
+    SignalUpdate stale;
+    while (m_updates.tryPop(stale)) {}
+
+    m_framesSent.store(0, std::memory_order_relaxed);
+    m_latenessSumNs.store(0, std::memory_order_relaxed);
+    m_latenessMaxNs.store(0, std::memory_order_relaxed);
+    m_droppedUpdates.store(0, std::memory_order_relaxed);
+    m_stop.store(false, std::memory_order_relaxed);
+
+    table.generation = ++m_generation;
+    {
+        QMutexLocker lock(&m_handlesMutex);
+        m_handles = HandleTablePtr(new HandleTable(std::move(table)));
+    }
+
+    m_thread = QThread::create([this]() { threadLoop(); });
+    m_thread->setObjectName(QStringLiteral("AutoLens_ResidualBus"));
+    m_thread->start(QThread::TimeCriticalPriority);
+
+    qDebug() << "[ResidualBus] Started:" << m_messages.size() << "messages from"
+             << m_enabledNodes.size() << "node(s)";
+    emit runningChanged();
+    return true;
+}
+
+void ResidualBusSimulator::stop()
+{
+    if (!isRunning()) return;
+
+    // Withdraw the handle table first so no new stimulus is accepted.
+    {
+        QMutexLocker lock(&m_handlesMutex);
+        m_handles.reset();
+    }
+
+    m_stop.store(true, std::memory_order_release);
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    qDebug() << "[ResidualBus] Stopped after" << m_framesSent.load() << "frames";
+
+    m_messages.clear();
+    emit runningChanged();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Stimulus
+// ─────────────────────────────────────────────────────────────────────────────
+
+ResidualBusSimulator::HandleTablePtr ResidualBusSimulator::handleTable() const
+{
+    QMutexLocker lock(&m_handlesMutex);
+    return m_handles;
+}
+
+int ResidualBusSimulator::messageHandle(int channel, const QString& messageName) const
+{
+    const HandleTablePtr table = handleTable();
+    if (!table) return -1;
+    return table->byName.value(QString::number(channel) + QLatin1Char(':') + messageName, -1);
+}
+
+int ResidualBusSimulator::signalIndex(int handle, const QString& signalName) const
+{
+    const HandleTablePtr table = handleTable();
+    if (!table || handle < 0 || handle >= table->signalNames.size()) return -1;
+    return table->signalNames[handle].indexOf(signalName);
+}
+
+const DBCMessage* ResidualBusSimulator::messageDefinition(int handle) const
+{
+    if (handle < 0 || handle >= static_cast<int>(m_messages.size())) return nullptr;
+    return m_messages[handle].def;
+}
+
+bool ResidualBusSimulator::setSignalValue(int handle, int sigIndex, double physical)
+{
+    const HandleTablePtr table = handleTable();
+    if (!table) return false;
+    return pushUpdate(*table, handle, sigIndex, physical);
+}
+
+bool ResidualBusSimulator::setSignalValue(int channel, const QString& messageName,
+                                          const QString& signalName, double physical)
+{
+    // One snapshot for both lookups and the push.
+    const HandleTablePtr table = handleTable();
+    if (!table) return false;
+    const int h = table->byName.value(QString::number(channel) + QLatin1Char(':') + messageName, -1);
+    if (h < 0) return false;
+    return pushUpdate(*table, h, table->signalNames[h].indexOf(signalName), physical);
+}
+
+bool ResidualBusSimulator::pushUpdate(const HandleTable& table, int handle, int sigIndex,
+                                      double physical)
+{
+    if (handle < 0 || handle >= table.signalNames.size()) return false;
+    if (sigIndex < 0 || sigIndex >= table.signalNames[handle].size()) return false;
+
+    SignalUpdate u;
+    u.handle     = handle;
+    u.sigIndex   = sigIndex;
+    u.generation = table.generation;
+    u.value      = physical;
+    if (!m_updates.tryPush(std::move(u))) {
+        m_droppedUpdates.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void ResidualBusSimulator::applyPendingUpdates()
+{
+    // Sim thread only: this is the single writer of every cached payload.
+    SignalUpdate u;
+    while (m_updates.tryPop(u)) {
+        // Resolved against an earlier schedule (raced a restart) — drop it.
+        if (u.generation != m_generation) continue;
+        SimMessage& sim = m_messages[u.handle];
+        const auto& list = sim.def->signalList;
+        if (u.sigIndex < 0 || u.sigIndex >= list.size()) continue;
+
+        // Re-encode just this signal's bits — the rest of the payload stays.
+        list[u.sigIndex].encode(u.value, sim.frame.data, sim.frame.dataLength());
+    }
+}
+
+ResidualBusSimulator::Stats ResidualBusSimulator::stats() const
+{
+    Stats s;
+    s.framesSent     = m_framesSent.load(std::memory_order_relaxed);
+    s.scheduled      = scheduledMessageCount();
+    s.maxLatenessUs  = m_latenessMaxNs.load(std::memory_order_relaxed) / 1000.0;
+    s.avgLatenessUs  = s.framesSent
+                         ? (m_latenessSumNs.load(std::memory_order_relaxed) / 1000.0) / s.framesSent
+                         : 0.0;
+    s.droppedUpdates = m_droppedUpdates.load(std::memory_order_relaxed);
+    return s;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Scheduler thread
+// ─────────────────────────────────────────────────────────────────────────────
+
+void ResidualBusSimulator::threadLoop()
+{
+    ThreadPlacement::Scope placement(ThreadPlacement::Transmit);
+    const int count = static_cast<int>(m_messages.size());
+
+    TimingWheel wheel(count);
+    wheel.clear(0);
+
+    // Stagger first transmissions across one tick per message (modulo the
+    // period) so 2000 messages with a 100 ms cycle don't all fire at t=0.
+    for (int h = 0; h < count; ++h)
+        wheel.schedule(h, static_cast<uint64_t>(h) % m_messages[h].periodTicks);
+
+    QVector<CANMessage> batch;
+    batch.reserve(256);
+
+    const int64_t epochNs = steadyNs();
+
+    while (!m_stop.load(std::memory_order_acquire)) {
+        applyPendingUpdates();
+
+        const int64_t  nowNs   = steadyNs() - epochNs;
+        const uint64_t nowTick = static_cast<uint64_t>(nowNs / TICK_NS);
+
+        batch.clear();
+        quint64 lateSum = 0, lateMax = 0;
+
+        wheel.advance(nowTick, [&](int h, uint64_t dueTick) {
+            SimMessage& sim = m_messages[h];
+            const int64_t dueNs = static_cast<int64_t>(dueTick) * TICK_NS;
+
+            batch.append(sim.frame);
+            batch.last().timestamp = static_cast<uint64_t>(dueNs);
+
+            const quint64 late = nowNs > dueNs ? quint64(nowNs - dueNs) : 0;
+            lateSum += late;
+            if (late > lateMax) lateMax = late;
+
+            wheel.schedule(h, dueTick + sim.periodTicks);   // drift-free
+        });
+
+        if (!batch.isEmpty()) {
+            if (m_sink) m_sink(batch);
+            m_framesSent.fetch_add(batch.size(), std::memory_order_relaxed);
+            m_latenessSumNs.fetch_add(lateSum, std::memory_order_relaxed);
+            if (lateMax > m_latenessMaxNs.load(std::memory_order_relaxed))
+                m_latenessMaxNs.store(lateMax, std::memory_order_relaxed);
+        }
+
+        // ── Sleep until the next due tick ─────────────────────────────────
+        const uint64_t nextTick = wheel.nextExpiryTick();
+        const int64_t  deadline = epochNs + static_cast<int64_t>(nextTick) * TICK_NS;
+        for (;;) {
+            if (m_stop.load(std::memory_order_relaxed)) break;
+            const int64_t remaining = deadline - steadyNs();
+            if (remaining <= 0) break;
+            if (remaining > kSleepSlackNs) {
+                const int64_t sleepNs = qMin(remaining - kSleepSlackNs, kMaxSleepNs);
+                std::this_thread::sleep_for(std::chrono::nanoseconds(sleepNs));
+                if (sleepNs == kMaxSleepNs) break;   // re-check updates
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
@@ -0,0 +1,222 @@
+#pragma once
+/**
+ * @file ResidualBusSimulator.h
+ * @brief DBC-driven residual bus simulation (simulate the ECUs that are absent).
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHAT IT DOES
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  On a bench only some ECUs are physically present.  The rest of the
+ *  network — every message their DBC nodes (BU_) would send — must be
+ *  generated so the real ECUs see a complete bus.  The user picks which
+ *  nodes to simulate per channel; every message those nodes send is
+ *  transmitted at its GenMsgCycleTime.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  DESIGN
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    UI / script thread                      "AutoLens_ResidualBus" thread
+ *    ──────────────────                      ─────────────────────────────
+ *    setSignalValue(msg, sig, v) ──► m_updates ──► encode ONE signal into
+ *                                   (lock-free)   the cached payload
+ *
+ *                                   TimingWheel (100 µs ticks)
+ *                                     │ fires due messages
+ *                                     ▼
+ *                                   copy cached payload → batch → FrameSink
+ *
+ *  • Payloads are encoded once at start from the signals' start values
+ *    (GenSigStartValue) and afterwards only the signal that changed is
+ *    re-encoded.  Sending a frame is a 64-byte copy, not a DBC encode.
+ *  • The hierarchical timing wheel makes each tick cost O(due messages),
+ *    so thousands of messages across 4 channels stay cheap.
+ *  • Rescheduling is drift-free: next = scheduled + period, never
+ *    now + period, so a late wakeup does not shift the whole schedule.
+ *  • The thread sleeps until the next due tick and spins only for the last
+ *    stretch (see kSleepSlackNs) — sub-ms accuracy without a busy core.
+ *
+ *  The simulator does not know how frames reach the bus.  The owner
+ *  installs a FrameSink: AppController transmits through the active
+ *  driver, DemoCANDriver emits them as received traffic.
+ */
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <array>
+#include <atomic>
+#include <functional>
+
+#include "hardware/CANInterface.h"
+#include "dbc/DBCParser.h"
+#include "util/MpmcQueue.h"
+
+class ResidualBusSimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int     MAX_CHANNELS = 4;
+    static constexpr int64_t TICK_NS      = 100000;   ///< wheel resolution: 100 µs
+
+    /**
+     * @brief Receives every batch of due frames, on the simulator thread.
+     *
+     * msg.timestamp is the *scheduled* send time in ns since start().
+     * Must not block for long — it delays the next tick.
+     */
+    using FrameSink = std::function<void(const QVector<CANManager::CANMessage>&)>;
+
+    /** One DBC node (BU_) on one channel, as shown in the Simulation page. */
+    struct NodeInfo
+    {
+        int     channel      = 1;   ///< 1-based
+        QString name;
+        int     messageCount = 0;   ///< messages this node sends (BO_ sender)
+        int     cyclicCount  = 0;   ///< of which have GenMsgCycleTime > 0
+        bool    enabled      = false;
+    };
+
+    struct Stats
+    {
+        quint64 framesSent     = 0;
+        int     scheduled      = 0;    ///< messages in the timing wheel
+        double  avgLatenessUs  = 0.0;  ///< actual wakeup − scheduled time
+        double  maxLatenessUs  = 0.0;
+        quint64 droppedUpdates = 0;    ///< setSignalValue() calls lost to a full queue
+    };
+
+    explicit ResidualBusSimulator(QObject* parent = nullptr);
+    ~ResidualBusSimulator() override;
+
+    void setFrameSink(FrameSink sink) { m_sink = std::move(sink); }
+
+    // ── Configuration (only while stopped) ───────────────────────────────────
+
+    /** Replace the database for @p channel (1-based).  Empty db = unused channel. */
+    void setChannelDatabase(int channel, const DBCManager::DBCDatabase& db);
+
+    /** Remove all databases and node selections. */
+    void clearConfiguration();
+
+    /** All nodes of all configured channels with their selection state. */
+    QVector<NodeInfo> nodes() const;
+
+    void setNodeEnabled(int channel, const QString& node, bool enabled);
+    void setAllNodesEnabled(bool enabled);
+    QStringList enabledNodeKeys() const;             ///< "ch:node" — for QSettings
+    void setEnabledNodeKeys(const QStringList& keys);
+
+    /**
+     * @brief Period for messages without GenMsgCycleTime.
+     * 0 (default) = event messages are not simulated.
+     */
+    void setDefaultCycleMs(int ms) { m_defaultCycleMs = qMax(0, ms); }
+
+    // ── Run control ──────────────────────────────────────────────────────────
+
+    /** Build the schedule from the enabled nodes and start the thread. */
+    bool start();
+    void stop();
+    bool isRunning() const { return m_thread != nullptr; }
+
+    /** Number of messages in the current schedule (0 when stopped). */
+    int scheduledMessageCount() const { return static_cast<int>(m_messages.size()); }
+
+    // ── Stimulus (any thread) ────────────────────────────────────────────────
+    //
+    //  Lookups go through an immutable handle table published by start()
+    //  and withdrawn by stop(), so a script thread racing a restart sees
+    //  either the old or the new schedule — never a half-built one.  An
+    //  update queued against a previous schedule is dropped by the sim
+    //  thread (generation mismatch).
+
+    /**
+     * @brief Look up a simulated message; the handle is valid until stop().
+     * @return -1 if the message is not in the schedule.
+     */
+    int messageHandle(int channel, const QString& messageName) const;
+    int signalIndex(int handle, const QString& signalName) const;
+
+    /** Change one signal; only that signal is re-encoded into the payload. */
+    bool setSignalValue(int handle, int signalIndex, double physical);
+    bool setSignalValue(int channel, const QString& messageName,
+                        const QString& signalName, double physical);
+
+    /**
+     * @brief Signal definition for a handle (read-only; valid until stop()).
+     * Controlling thread only — the one that calls start()/stop().
+     */
+    const DBCManager::DBCMessage* messageDefinition(int handle) const;
+
+    Stats stats() const;
+
+signals:
+    void runningChanged();
+
+private:
+    struct SimMessage
+    {
+        const DBCManager::DBCMessage* def = nullptr;   ///< points into m_channelDbs
+        CANManager::CANMessage        frame;           ///< cached, pre-encoded payload
+        uint64_t                      periodTicks = 1;
+    };
+
+    struct SignalUpdate
+    {
+        int32_t  handle     = -1;
+        int32_t  sigIndex   = -1;
+        uint32_t generation = 0;     ///< schedule the handle was resolved against
+        double   value      = 0.0;
+    };
+
+    /** Name → handle lookup, immutable once published. */
+    struct HandleTable
+    {
+        uint32_t                 generation = 0;
+        QHash<QString, int>      byName;        ///< "ch:MsgName" → handle
+        QVector<QStringList>     signalNames;   ///< handle → signal names
+    };
+    using HandleTablePtr = QSharedPointer<const HandleTable>;
+
+    HandleTablePtr handleTable() const;
+    bool pushUpdate(const HandleTable& table, int handle, int sigIndex, double physical);
+
+    static QString nodeKey(int channel, const QString& node)
+    {
+        return QString::number(channel) + QLatin1Char(':') + node;
+    }
+
+    HandleTable buildSchedule();
+    void threadLoop();
+    void applyPendingUpdates();
+
+    FrameSink                                              m_sink;
+    std::array<DBCManager::DBCDatabase, MAX_CHANNELS>      m_channelDbs;
+    QSet<QString>                                          m_enabledNodes;
+    int                                                    m_defaultCycleMs = 0;
+
+    // ── Built by start(); payloads owned by the sim thread while running ────
+    std::vector<SimMessage>   m_messages;
+    uint32_t                  m_generation = 0;   ///< bumped by every start()
+
+    mutable QMutex            m_handlesMutex;     ///< guards the pointer only
+    HandleTablePtr            m_handles;          ///< null while stopped
+
+    MpmcQueue<SignalUpdate>   m_updates{4096};
+    QThread*                  m_thread = nullptr;
+    std::atomic<bool>         m_stop{false};
+
+    // ── Statistics (relaxed atomics — written by the sim thread only) ───────
+    std::atomic<quint64>      m_framesSent{0};
+    std::atomic<quint64>      m_latenessSumNs{0};
+    std::atomic<quint64>      m_latenessMaxNs{0};
+    std::atomic<quint64>      m_droppedUpdates{0};
+};
@@ -0,0 +1,137 @@
+/**
+ * @file ScriptHost.cpp
+ * @brief Script thread lifecycle and the lock-free frame filter.
+ */
+
+#include "sim/ScriptHost.h"
+#include "sim/ScriptRuntime.h"
+
+#include <QDebug>
+#include <QMetaObject>
+
+using namespace CANManager;
+using namespace DBCManager;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Constructor / Destructor
+// ─────────────────────────────────────────────────────────────────────────────
+
+ScriptHost::ScriptHost(QObject* parent)
+    : QObject(parent)
+{
+    m_thread.setObjectName(QStringLiteral("AutoLens_Scripts"));
+}
+
+ScriptHost::~ScriptHost()
+{
+    unload();
+}
+
+void ScriptHost::setChannelDatabase(int channel, const DBCDatabase& db)
+{
+    if (channel < 1 || channel > MAX_CHANNELS) return;
+    m_channelDbs[channel - 1] = db;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Load / Unload
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool ScriptHost::load(const QStringList& paths)
+{
+    unload();
+    if (paths.isEmpty()) return false;
+
+    m_paths = paths;
+    m_thread.start();
+
+    // The runtime is created here but lives on the script thread; the engine
+    // itself is created inside start(), i.e. on that thread.
+    m_runtime = new ScriptRuntime(this, m_channelDbs);
+    m_runtime->moveToThread(&m_thread);
+
+    ScriptRuntime* rt = m_runtime;
+    QMetaObject::invokeMethod(rt, [rt, paths]() { rt->start(paths); }, Qt::QueuedConnection);
+
+    qDebug() << "[ScriptHost] Loading" << paths.size() << "node script(s)";
+    emit runningChanged();
+    return true;
+}
+
+void ScriptHost::unload()
+{
+    if (!m_runtime) return;
+
+    // 1. No new frames: clear the subscription bitmap.
+    for (auto& word : m_filter)
+        word.store(0, std::memory_order_relaxed);
+
+    // 2. Break out of a handler stuck in a loop, then destroy the runtime
+    //    on its own thread (QJSValues and QTimers must die there).
+    m_runtime->interrupt();
+    ScriptRuntime* rt = m_runtime;
+    QMetaObject::invokeMethod(rt, [rt]() { delete rt; }, Qt::BlockingQueuedConnection);
+    m_runtime = nullptr;
+
+    m_thread.quit();
+    m_thread.wait();
+
+    CANMessage stale;
+    while (m_inbox.tryPop(stale)) {}
+    m_drainPending.store(false, std::memory_order_relaxed);
+
+    m_paths.clear();
+    qDebug() << "[ScriptHost] Scripts unloaded";
+    emit runningChanged();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Frame path
+// ─────────────────────────────────────────────────────────────────────────────
+
+void ScriptHost::dispatch(const CANMessage& msg)
+{
+    const int ch = (msg.channel >= 1 && msg.channel <= MAX_CHANNELS) ? msg.channel - 1 : 0;
+    const uint32_t bit = filterBit(msg.id, msg.isExtended);
+    const uint64_t word = m_filter[ch * FILTER_WORDS + (bit >> 6)].load(std::memory_order_relaxed);
+    if (!(word & (uint64_t(1) << (bit & 63))))
+        return;   // nobody subscribed — the common case
+
+    if (!m_inbox.tryPush(msg)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // One queued drain per burst (same pattern as DecodePipeline).
+    if (!m_drainPending.exchange(true, std::memory_order_acq_rel)) {
+        ScriptRuntime* rt = m_runtime;
+        if (rt)
+            QMetaObject::invokeMethod(rt, [rt]() { rt->drain(); }, Qt::QueuedConnection);
+    }
+}
+
+void ScriptHost::subscribe(int channel, uint32_t id, bool extended)
+{
+    const uint32_t bit  = filterBit(id, extended);
+    const uint64_t mask = uint64_t(1) << (bit & 63);
+    for (int ch = 0; ch < MAX_CHANNELS; ++ch) {
+        if (channel != 0 && channel != ch + 1) continue;
+        m_filter[ch * FILTER_WORDS + (bit >> 6)].fetch_or(mask, std::memory_order_relaxed);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Stats
+// ─────────────────────────────────────────────────────────────────────────────
+
+void ScriptHost::publishStats(const QVector<HandlerStats>& stats)
+{
+    QMutexLocker lock(&m_statsMutex);
+    m_stats = stats;
+}
+
+QVector<ScriptHost::HandlerStats> ScriptHost::handlerStats() const
+{
+    QMutexLocker lock(&m_statsMutex);
+    return m_stats;
+}
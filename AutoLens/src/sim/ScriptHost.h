@@ -0,0 +1,155 @@
+#pragma once
+/**
+ * @file ScriptHost.h
+ * @brief JavaScript node scripts (CAPL-like) on a dedicated QJSEngine thread.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHAT IT DOES
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Each loaded .js file is one simulated node.  It registers handlers on the
+ *  global `can` object and reacts to bus traffic without recompiling:
+ *
+ *    can.onMessage(1, "EngineData", function (msg) {
+ *        if (msg.signals.EngineSpeed > 3000)
+ *            can.output(1, "Warning", { OverRev: 1 });
+ *    });
+ *    can.onSignal(1, "Gear", "GearPos", function (value, previous) { ... });
+ *    can.onTimer(100, function () { can.output(1, 0x7DF, [2, 1, 0]); });
+ *
+ *  Full API: see ScriptRuntime.h.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  FRAME PATH
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    driver / UI thread                     "AutoLens_Scripts" thread
+ *    ──────────────────                     ─────────────────────────
+ *    dispatch(msg)
+ *      subscription bitmap test ── miss ──► return   (the common case)
+ *      hit → m_inbox (lock-free) ─────────► ScriptRuntime::drain()
+ *                                              (channel, id) dispatch table
+ *                                              → only the subscribed handlers
+ *
+ *  The bitmap holds one bit per 11-bit ID per channel plus a hashed area
+ *  for 29-bit IDs, so a frame nobody subscribed to costs two loads and a
+ *  test.  False positives from the hash are dropped by the exact table on
+ *  the script thread.
+ *
+ *  QJSEngine is single-threaded: the engine, all handlers and their timers
+ *  live on the script thread.  Signals are decoded/encoded with precompiled
+ *  SignalCodecs, and every handler call is timed (handlerStats()).
+ */
+
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <array>
+#include <atomic>
+#include <functional>
+
+#include "hardware/CANInterface.h"
+#include "dbc/DBCParser.h"
+#include "util/MpmcQueue.h"
+
+class ScriptRuntime;
+
+class ScriptHost : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_CHANNELS = 4;
+    static constexpr int INBOX_FRAMES = 8192;
+
+    /** Sends a frame for a script (called on the script thread). */
+    using TransmitFn  = std::function<bool(const CANManager::CANMessage&)>;
+    /** Forwards can.setSignal() to the residual bus (called on the script thread). */
+    using SetSignalFn = std::function<bool(int channel, const QString& message,
+                                           const QString& signalName, double value)>;
+
+    /** Execution profile of one registered handler. */
+    struct HandlerStats
+    {
+        QString node;          ///< script file base name
+        QString description;   ///< e.g. "onMessage CH1 EngineData"
+        quint64 calls  = 0;
+        quint64 errors = 0;    ///< calls that threw
+        double  avgUs  = 0.0;
+        double  maxUs  = 0.0;
+    };
+
+    explicit ScriptHost(QObject* parent = nullptr);
+    ~ScriptHost() override;
+
+    void setTransmit(TransmitFn fn)   { m_transmit = std::move(fn); }
+    void setSetSignal(SetSignalFn fn) { m_setSignal = std::move(fn); }
+
+    /** DBC for @p channel (1-based); takes effect on the next load(). */
+    void setChannelDatabase(int channel, const DBCManager::DBCDatabase& db);
+
+    /**
+     * @brief Start the script thread and evaluate @p paths, one node each.
+     *
+     * Replaces any previously loaded scripts.  Evaluation errors are
+     * reported through scriptError(); the other scripts still run.
+     */
+    bool load(const QStringList& paths);
+
+    /** Stop all handlers and timers and tear down the engine. */
+    void unload();
+
+    bool        isRunning() const     { return m_runtime != nullptr; }
+    QStringList loadedScripts() const { return m_paths; }
+
+    /**
+     * @brief Offer a frame to the scripts.  Any thread, never blocks.
+     * Frames no handler subscribed to are rejected by the bitmap test.
+     */
+    void dispatch(const CANManager::CANMessage& msg);
+
+    /** Snapshot of per-handler timings (refreshed ~4× per second). */
+    QVector<HandlerStats> handlerStats() const;
+
+    /** Frames lost because the script thread fell behind. */
+    quint64 droppedFrames() const { return m_dropped.load(std::memory_order_relaxed); }
+
+signals:
+    void runningChanged();
+    void scriptLog(const QString& line);
+    void scriptError(const QString& message);
+
+private:
+    friend class ScriptRuntime;
+
+    static constexpr int FILTER_BITS  = 4096;   ///< per channel: 2048 std + 2048 hashed ext
+    static constexpr int FILTER_WORDS = FILTER_BITS / 64;
+
+    static uint32_t filterBit(uint32_t id, bool extended)
+    {
+        return extended ? 2048u + ((id * 2654435761u) >> 21)   // Fibonacci hash → 11 bits
+                        : (id & 0x7FFu);
+    }
+
+    // ── Called by ScriptRuntime on the script thread ────────────────────────
+    void subscribe(int channel, uint32_t id, bool extended);   ///< channel 0 = all
+    void publishStats(const QVector<HandlerStats>& stats);
+
+    TransmitFn  m_transmit;
+    SetSignalFn m_setSignal;
+    std::array<DBCManager::DBCDatabase, MAX_CHANNELS> m_channelDbs;
+
+    QThread        m_thread;
+    ScriptRuntime* m_runtime = nullptr;   ///< lives on m_thread
+    QStringList    m_paths;
+
+    // ── Frame path (lock-free) ──────────────────────────────────────────────
+    std::array<std::atomic<uint64_t>, MAX_CHANNELS * FILTER_WORDS> m_filter{};
+    MpmcQueue<CANManager::CANMessage> m_inbox{INBOX_FRAMES};
+    std::atomic<bool>    m_drainPending{false};
+    std::atomic<quint64> m_dropped{0};
+
+    mutable QMutex        m_statsMutex;
+    QVector<HandlerStats> m_stats;
+};
@@ -0,0 +1,486 @@
+/**
+ * @file ScriptRuntime.cpp
+ * @brief QJSEngine host, handler dispatch and the `can` script API.
+ */
+
+#include "sim/ScriptRuntime.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJSValueIterator>
+
+using namespace CANManager;
+using namespace DBCManager;
+
+namespace {
+
+constexpr int kStatsIntervalMs = 250;
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Constructor / Destructor
+// ─────────────────────────────────────────────────────────────────────────────
+
+ScriptRuntime::ScriptRuntime(ScriptHost* host,
+                             const std::array<DBCDatabase, ScriptHost::MAX_CHANNELS>& dbs)
+    : m_host(host)
+    , m_dbs(dbs)
+    , m_statsTimer(this)   // parented so moveToThread() takes it along
+{
+    m_statsTimer.setInterval(kStatsIntervalMs);
+    connect(&m_statsTimer, &QTimer::timeout, this, &ScriptRuntime::publishStats);
+}
+
+ScriptRuntime::~ScriptRuntime()
+{
+    // Runs on the script thread (ScriptHost::unload): timers and QJSValues
+    // must die on the thread that owns the engine.
+    m_statsTimer.stop();
+    publishStats();
+    m_engineForInterrupt.store(nullptr);
+    m_handlers.clear();
+    delete m_engine;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Startup — create the engine and evaluate every node script
+// ─────────────────────────────────────────────────────────────────────────────
+
+void ScriptRuntime::start(const QStringList& paths)
+{
+    m_engine = new QJSEngine;
+    m_engine->installExtensions(QJSEngine::ConsoleExtension);
+    m_engineForInterrupt.store(m_engine);
+
+    QJSEngine::setObjectOwnership(this, QJSEngine::CppOwnership);
+    const QJSValue api = m_engine->newQObject(this);
+
+    for (const QString& path : paths) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            reportError(QString("Cannot open script: %1").arg(path));
+            continue;
+        }
+
+        // WHY wrap in a function: every node gets its own scope, so two
+        // scripts can both declare `var counter` without clobbering each
+        // other.  Line 0 is the wrapper, so script line numbers match.
+        const QString source = QStringLiteral("(function (can) {\n")
+                             + QString::fromUtf8(file.readAll())
+                             + QStringLiteral("\n})");
+
+        m_currentNode = QFileInfo(path).completeBaseName();
+        QJSValue fn = m_engine->evaluate(source, path, 0);
+        if (!fn.isError())
+            fn = fn.call({api});
+
+        if (fn.isError()) {
+            reportError(QString("%1:%2: %3")
+                            .arg(QFileInfo(path).fileName())
+                            .arg(fn.property("lineNumber").toInt())
+                            .arg(fn.toString()));
+        } else {
+            qDebug() << "[Scripts] Loaded node" << m_currentNode;
+        }
+    }
+    m_currentNode.clear();
+
+    m_statsTimer.start();
+    publishStats();
+}
+
+void ScriptRuntime::interrupt()
+{
+    if (QJSEngine* e = m_engineForInterrupt.load())
+        e->setInterrupted(true);   // documented as callable from any thread
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Message compilation
+// ─────────────────────────────────────────────────────────────────────────────
+
+int ScriptRuntime::compile(int channel, const DBCMessage& def)
+{
+    const quint64 key = dispatchKey(channel, def.id, def.isExtended);
+    const auto it = m_compiledByKey.constFind(key);
+    if (it != m_compiledByKey.constEnd())
+        return it.value();
+
+    CompiledMessage cm;
+    cm.def     = &def;   // m_dbs is never modified after construction
+    cm.channel = channel;
+    cm.codecs.reserve(def.signalList.size());
+    for (int i = 0; i < def.signalList.size(); ++i) {
+        const DBCSignal& sig = def.signalList[i];
+        cm.codecs.append(SignalCodec(sig));
+        cm.indexByName.insert(sig.name, i);
+        if (sig.muxIndicator == QLatin1String("M"))
+            cm.muxSelector = i;
+    }
+
+    m_compiled.push_back(std::move(cm));
+    const int index = static_cast<int>(m_compiled.size()) - 1;
+    m_compiledByKey.insert(key, index);
+    return index;
+}
+
+int ScriptRuntime::compiledFor(int channel, const QString& name)
+{
+    // channel 0 = first channel whose DBC defines the message
+    for (int ch = 1; ch <= ScriptHost::MAX_CHANNELS; ++ch) {
+        if (channel != 0 && channel != ch) continue;
+        if (const DBCMessage* def = m_dbs[ch - 1].messageByName(name))
+            return compile(ch, *def);
+    }
+    return -1;
+}
+
+int ScriptRuntime::compiledFor(int channel, uint32_t id, bool extended)
+{
+    if (channel < 1 || channel > ScriptHost::MAX_CHANNELS)
+        return -1;
+
+    const auto it = m_compiledByKey.constFind(dispatchKey(channel, id, extended));
+    if (it != m_compiledByKey.constEnd())
+        return it.value();
+
+    const DBCMessage* def = m_dbs[channel - 1].messageById(id);
+    if (!def || def->isExtended != extended)
+        return -1;
+    return compile(channel, *def);
+}
+
+bool ScriptRuntime::isSignalActive(const CompiledMessage& cm, int signal,
+                                   const uint8_t* data, int len) const
+{
+    const DBCSignal& sig = cm.def->signalList[signal];
+    if (sig.muxValue < 0 || cm.muxSelector < 0 || signal == cm.muxSelector)
+        return true;
+    return cm.codecs[cm.muxSelector].decodeRaw(data, len) == sig.muxValue;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Handler registration  (the `can` API)
+// ─────────────────────────────────────────────────────────────────────────────
+
+int ScriptRuntime::addHandler(Handler h, int channel, uint32_t id, bool extended)
+{
+    h.node = m_currentNode;
+    m_handlers.push_back(std::move(h));
+    const int index = static_cast<int>(m_handlers.size()) - 1;
+
+    if (m_handlers[index].kind != Handler::Kind::Timer) {
+        m_dispatch[dispatchKey(channel, id, extended)].append(index);
+        m_host->subscribe(channel, id, extended);
+    }
+    return index;
+}
+
+int ScriptRuntime::onMessage(int channel, const QJSValue& message, const QJSValue& fn,
+                             bool extended)
+{
+    if (!fn.isCallable()) {
+        reportError("can.onMessage: handler is not a function");
+        return -1;
+    }
+
+    uint32_t id = 0;
+    QString  label;
+
+    if (message.isString()) {
+        const int c = compiledFor(channel, message.toString());
+        if (c < 0) {
+            reportError(QString("can.onMessage: unknown message '%1'").arg(message.toString()));
+            return -1;
+        }
+        id       = m_compiled[c].def->id;
+        extended = m_compiled[c].def->isExtended;
+        label    = m_compiled[c].def->name;
+    } else {
+        id       = message.toUInt();
+        extended = extended || id > 0x7FF;
+        label    = QString("0x%1").arg(id, extended ? 8 : 3, 16, QChar('0')).toUpper();
+    }
+
+    Handler h;
+    h.kind        = Handler::Kind::Message;
+    h.fn          = fn;
+    h.description = QString("onMessage CH%1 %2")
+                        .arg(channel == 0 ? QStringLiteral("*") : QString::number(channel), label);
+    return addHandler(std::move(h), channel, id, extended);
+}
+
+int ScriptRuntime::onSignal(int channel, const QString& message,
+                            const QString& signalName, const QJSValue& fn)
+{
+    if (!fn.isCallable()) {
+        reportError("can.onSignal: handler is not a function");
+        return -1;
+    }
+
+    const int c = compiledFor(channel, message);
+    const int s = c >= 0 ? m_compiled[c].indexByName.value(signalName, -1) : -1;
+    if (s < 0) {
+        reportError(QString("can.onSignal: unknown signal '%1.%2'").arg(message, signalName));
+        return -1;
+    }
+
+    const CompiledMessage& cm = m_compiled[c];
+    Handler h;
+    h.kind        = Handler::Kind::Signal;
+    h.fn          = fn;
+    h.compiled    = c;
+    h.signal      = s;
+    h.description = QString("onSignal CH%1 %2.%3")
+                        .arg(channel == 0 ? QStringLiteral("*") : QString::number(channel),
+                             message, signalName);
+    return addHandler(std::move(h), channel, cm.def->id, cm.def->isExtended);
+}
+
+int ScriptRuntime::onTimer(int intervalMs, const QJSValue& fn, bool repeat)
+{
+    if (!fn.isCallable() || intervalMs <= 0) {
+        reportError("can.onTimer: needs an interval > 0 and a function");
+        return -1;
+    }
+
+    Handler h;
+    h.kind        = Handler::Kind::Timer;
+    h.fn          = fn;
+    h.description = QString("onTimer %1 ms%2").arg(intervalMs).arg(repeat ? "" : " (once)");
+    h.timer       = new QTimer(this);
+    h.timer->setTimerType(intervalMs < 20 ? Qt::PreciseTimer : Qt::CoarseTimer);
+    h.timer->setInterval(intervalMs);
+    h.timer->setSingleShot(!repeat);
+
+    const int index = addHandler(std::move(h), 0, 0, false);
+    connect(m_handlers[index].timer, &QTimer::timeout, this, [this, index]() {
+        callHandler(index, {});
+    });
+    m_handlers[index].timer->start();
+    return index;
+}
+
+void ScriptRuntime::cancelTimer(int timerId)
+{
+    if (timerId < 0 || timerId >= static_cast<int>(m_handlers.size()))
+        return;
+    Handler& h = m_handlers[timerId];
+    if (h.kind != Handler::Kind::Timer) return;
+    h.timer->stop();
+    h.active = false;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Output
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool ScriptRuntime::output(int channel, const QJSValue& message,
+                           const QJSValue& payload, bool extended)
+{
+    if (!m_host->m_transmit) return false;
+
+    CANMessage msg;
+    msg.channel = static_cast<uint8_t>(qBound(1, channel, ScriptHost::MAX_CHANNELS));
+
+    if (message.isString()) {
+        const int c = compiledFor(channel, message.toString());
+        if (c < 0) {
+            reportError(QString("can.output: unknown message '%1'").arg(message.toString()));
+            return false;
+        }
+        const CompiledMessage& cm = m_compiled[c];
+        const int len = qBound(0, static_cast<int>(cm.def->dlc), 64);
+        msg.id         = cm.def->id;
+        msg.isExtended = cm.def->isExtended;
+        msg.isFD       = len > 8;
+        msg.dlc        = lengthToDlc(len);
+
+        // Start from the DBC start values, then apply what the script set.
+        for (int i = 0; i < cm.codecs.size(); ++i)
+            cm.codecs[i].encode(cm.def->signalList[i].initialValue, msg.data, len);
+
+        if (payload.isObject() && !payload.isArray()) {
+            QJSValueIterator it(payload);
+            while (it.hasNext()) {
+                it.next();
+                const int s = cm.indexByName.value(it.name(), -1);
+                if (s < 0) {
+                    reportError(QString("can.output: %1 has no signal '%2'")
+                                    .arg(cm.def->name, it.name()));
+                    continue;
+                }
+                cm.codecs[s].encode(it.value().toNumber(), msg.data, len);
+            }
+        } else if (payload.isArray()) {
+            const int n = qMin(payload.property("length").toInt(), len);
+            for (int i = 0; i < n; ++i)
+                msg.data[i] = static_cast<uint8_t>(payload.property(i).toUInt());
+        }
+    } else {
+        msg.id         = message.toUInt();
+        msg.isExtended = extended || msg.id > 0x7FF;
+
+        const int n = qBound(0, payload.property("length").toInt(), 64);
+        for (int i = 0; i < n; ++i)
+            msg.data[i] = static_cast<uint8_t>(payload.property(i).toUInt());
+        msg.isFD = n > 8;
+        msg.dlc  = lengthToDlc(n);
+    }
+
+    return m_host->m_transmit(msg);
+}
+
+bool ScriptRuntime::setSignal(int channel, const QString& message,
+                              const QString& signalName, double value)
+{
+    return m_host->m_setSignal && m_host->m_setSignal(channel, message, signalName, value);
+}
+
+void ScriptRuntime::log(const QString& text)
+{
+    const QString line = m_currentNode.isEmpty() ? text
+                                                 : QString("[%1] %2").arg(m_currentNode, text);
+    qDebug().noquote() << "[Scripts]" << line;
+    emit m_host->scriptLog(line);
+}
+
+void ScriptRuntime::reportError(const QString& text)
+{
+    qWarning().noquote() << "[Scripts]" << text;
+    emit m_host->scriptError(text);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Frame dispatch
+// ─────────────────────────────────────────────────────────────────────────────
+
+QJSValue ScriptRuntime::makeMessageObject(const CANMessage& msg, int compiled)
+{
+    const int len = msg.dataLength();
+
+    QJSValue obj = m_engine->newObject();
+    obj.setProperty("channel",  msg.channel);
+    obj.setProperty("id",       static_cast<uint>(msg.id));
+    obj.setProperty("extended", msg.isExtended);
+    obj.setProperty("dlc",      msg.dlc);
+    obj.setProperty("time",     static_cast<double>(msg.timestamp) / 1e9);
+
+    QJSValue data = m_engine->newArray(static_cast<uint>(len));
+    for (int i = 0; i < len; ++i)
+        data.setProperty(static_cast<quint32>(i), msg.data[i]);
+    obj.setProperty("data", data);
+
+    if (compiled >= 0) {
+        const CompiledMessage& cm = m_compiled[compiled];
+        QJSValue sigs = m_engine->newObject();
+        for (int i = 0; i < cm.codecs.size(); ++i) {
+            if (!isSignalActive(cm, i, msg.data, len)) continue;
+            sigs.setProperty(cm.def->signalList[i].name, cm.codecs[i].decode(msg.data, len));
+        }
+        obj.setProperty("signals", sigs);
+    }
+    return obj;
+}
+
+void ScriptRuntime::drain()
+{
+    m_host->m_drainPending.store(false, std::memory_order_release);
+
+    CANMessage msg;
+    while (m_host->m_inbox.tryPop(msg)) {
+        const quint64 keys[2] = {
+            dispatchKey(msg.channel, msg.id, msg.isExtended),
+            dispatchKey(0,           msg.id, msg.isExtended)
+        };
+        // A channel-0 frame maps both keys to the wildcard list — walk it once.
+        const int keyCount = msg.channel == 0 ? 1 : 2;
+
+        QJSValue msgObj;   // built once per frame, only if a message handler needs it
+        const int len = msg.dataLength();
+
+        for (int k = 0; k < keyCount; ++k) {
+            const auto it = m_dispatch.constFind(keys[k]);
+            if (it == m_dispatch.constEnd()) continue;   // bitmap false positive
+
+            const QVector<int> indices = it.value();   // handlers may register more
+            for (const int index : indices) {
+                Handler& h = m_handlers[index];
+                if (!h.active) continue;
+
+                if (h.kind == Handler::Kind::Message) {
+                    if (msgObj.isUndefined())
+                        msgObj = makeMessageObject(msg, compiledFor(msg.channel, msg.id, msg.isExtended));
+                    callHandler(index, {msgObj});
+                    continue;
+                }
+
+                // Signal handler: decode one signal, call only on change.
+                const CompiledMessage& cm = m_compiled[h.compiled];
+                if (!isSignalActive(cm, h.signal, msg.data, len)) continue;
+                const double value = cm.codecs[h.signal].decode(msg.data, len);
+                if (h.hasLast && value == h.last) continue;
+
+                const QJSValue previous = h.hasLast ? QJSValue(h.last) : QJSValue();
+                h.hasLast = true;
+                h.last    = value;
+                callHandler(index, {QJSValue(value), previous});
+            }
+        }
+    }
+}
+
+void ScriptRuntime::callHandler(int index, const QJSValueList& args)
+{
+    // Copy what the call needs: the handler may register new handlers,
+    // which can reallocate m_handlers.
+    const QJSValue fn = m_handlers[index].fn;
+    m_currentNode = m_handlers[index].node;
+
+    QElapsedTimer timer;
+    timer.start();
+    const QJSValue result = fn.call(args);
+    const quint64 ns = static_cast<quint64>(timer.nsecsElapsed());
+
+    Handler& h = m_handlers[index];
+    ++h.calls;
+    h.totalNs += ns;
+    if (ns > h.maxNs) h.maxNs = ns;
+
+    if (result.isError()) {
+        ++h.errors;
+        // Only the first error per handler — a failing 10 ms timer would
+        // otherwise flood the UI.
+        if (h.errors == 1) {
+            reportError(QString("%1 (%2) line %3: %4")
+                            .arg(h.node, h.description)
+                            .arg(result.property("lineNumber").toInt())
+                            .arg(result.toString()));
+        }
+    }
+    m_currentNode.clear();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Stats
+// ─────────────────────────────────────────────────────────────────────────────
+
+void ScriptRuntime::publishStats()
+{
+    QVector<ScriptHost::HandlerStats> out;
+    out.reserve(static_cast<int>(m_handlers.size()));
+    for (const Handler& h : m_handlers) {
+        ScriptHost::HandlerStats s;
+        s.node        = h.node;
+        s.description = h.description;
+        s.calls       = h.calls;
+        s.errors      = h.errors;
+        s.avgUs       = h.calls ? (h.totalNs / 1000.0) / h.calls : 0.0;
+        s.maxUs       = h.maxNs / 1000.0;
+        out.append(s);
+    }
+    m_host->publishStats(out);
+}
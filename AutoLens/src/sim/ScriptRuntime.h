@@ -0,0 +1,135 @@
+#pragma once
+/**
+ * @file ScriptRuntime.h
+ * @brief Script-thread side of ScriptHost: QJSEngine, handlers, timers.
+ *
+ * Exposed to every script as the global `can` object:
+ *
+ *   can.onMessage(channel, idOrName, fn(msg), extended = false) → handler id
+ *   can.onSignal(channel, message, signal, fn(v, prev)) → handler id
+ *       fires when the decoded value changes (and on the first frame)
+ *   can.onTimer(ms, fn(), repeat = true)                → timer id
+ *   can.cancelTimer(timerId)
+ *   can.output(channel, idOrName, bytes | {Signal: value, …}, extended = false)
+ *   can.setSignal(channel, message, signal, value)       — residual bus stimulus
+ *   can.log(text)
+ *
+ *   channel 0 in onMessage/onSignal = any channel.
+ *   Numeric IDs are standard unless `extended` is true (IDs above 0x7FF
+ *   can only be extended and are promoted automatically).
+ *
+ *   msg = { channel, id, extended, dlc, time (s), data: [bytes],
+ *           signals: { Name: physical, … } }   // when the DBC knows the ID
+ *
+ * Everything here runs on the "AutoLens_Scripts" thread.  Only ScriptHost
+ * creates and destroys it.
+ */
+
+#include <QHash>
+#include <QJSEngine>
+#include <QJSValue>
+#include <QObject>
+#include <QTimer>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+#include "dbc/SignalCodec.h"
+#include "sim/ScriptHost.h"
+
+class ScriptRuntime : public QObject
+{
+    Q_OBJECT
+
+public:
+    ScriptRuntime(ScriptHost* host,
+                  const std::array<DBCManager::DBCDatabase, ScriptHost::MAX_CHANNELS>& dbs);
+    ~ScriptRuntime() override;
+
+    /** Create the engine and evaluate the node scripts (script thread). */
+    void start(const QStringList& paths);
+
+    /** Run the handlers for everything in ScriptHost::m_inbox (script thread). */
+    void drain();
+
+    /** Abort a running handler — the only call allowed from another thread. */
+    void interrupt();
+
+    // ── `can` API ───────────────────────────────────────────────────────────
+    Q_INVOKABLE int  onMessage(int channel, const QJSValue& message, const QJSValue& fn,
+                               bool extended = false);
+    Q_INVOKABLE int  onSignal(int channel, const QString& message,
+                              const QString& signalName, const QJSValue& fn);
+    Q_INVOKABLE int  onTimer(int intervalMs, const QJSValue& fn, bool repeat = true);
+    Q_INVOKABLE void cancelTimer(int timerId);
+    Q_INVOKABLE bool output(int channel, const QJSValue& message,
+                            const QJSValue& payload, bool extended = false);
+    Q_INVOKABLE bool setSignal(int channel, const QString& message,
+                               const QString& signalName, double value);
+    Q_INVOKABLE void log(const QString& text);
+
+private:
+    /** One DBC message with its signals precompiled. */
+    struct CompiledMessage
+    {
+        const DBCManager::DBCMessage*      def = nullptr;
+        int                                channel = 1;
+        QVector<DBCManager::SignalCodec>   codecs;         ///< parallel to def->signalList
+        QHash<QString, int>                indexByName;
+        int                                muxSelector = -1;   ///< index of the "M" signal
+    };
+
+    struct Handler
+    {
+        enum class Kind { Message, Signal, Timer };
+
+        Kind     kind     = Kind::Message;
+        QJSValue fn;
+        QString  node;
+        QString  description;
+        bool     active   = true;
+
+        int      compiled = -1;    ///< Signal: index into m_compiled
+        int      signal   = -1;    ///< Signal: index into the message's codecs
+        bool     hasLast  = false;
+        double   last     = 0.0;
+        QTimer*  timer    = nullptr;
+
+        quint64  calls    = 0;
+        quint64  errors   = 0;
+        quint64  totalNs  = 0;
+        quint64  maxNs    = 0;
+    };
+
+    static quint64 dispatchKey(int channel, uint32_t id, bool extended)
+    {
+        return (quint64(channel) << 32) | (extended ? 0x80000000u : 0u) | (id & 0x1FFFFFFFu);
+    }
+
+    /** Resolve a DBC message by name or ID; -1 if unknown. Compiles on first use. */
+    int  compiledFor(int channel, const QString& name);
+    int  compiledFor(int channel, uint32_t id, bool extended);
+    int  compile(int channel, const DBCManager::DBCMessage& def);
+
+    int  addHandler(Handler h, int channel, uint32_t id, bool extended);
+    void callHandler(int index, const QJSValueList& args);
+    QJSValue makeMessageObject(const CANManager::CANMessage& msg, int compiled);
+    bool isSignalActive(const CompiledMessage& cm, int signal,
+                        const uint8_t* data, int len) const;
+    void publishStats();
+    void reportError(const QString& text);
+
+    ScriptHost* m_host;
+    std::array<DBCManager::DBCDatabase, ScriptHost::MAX_CHANNELS> m_dbs;
+
+    QJSEngine*               m_engine = nullptr;
+    std::atomic<QJSEngine*>  m_engineForInterrupt{nullptr};
+    QString                  m_currentNode;
+
+    std::deque<CompiledMessage>     m_compiled;           ///< stable addresses
+    QHash<quint64, int>             m_compiledByKey;      ///< dispatchKey → m_compiled
+    std::vector<Handler>            m_handlers;
+    QHash<quint64, QVector<int>>    m_dispatch;           ///< dispatchKey → handlers
+    QTimer                          m_statsTimer;
+};
@@ -0,0 +1,279 @@
+#pragma once
+/**
+ * @file TimingWheel.h
+ * @brief Hierarchical timing wheel for periodic message scheduling.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY a timing wheel?
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  The old demo scheduler checked every message on every 10 ms tick:
+ *  O(messages) per tick even when nothing is due.  A residual-bus
+ *  simulation of a full vehicle network has thousands of messages with
+ *  cycle times from 5 ms to several seconds, so that scan dominates.
+ *
+ *  A timing wheel makes schedule / cancel O(1) and the per-tick cost
+ *  proportional to the number of timers that actually expire.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  LAYOUT  (4 levels × 256 slots, tick = caller-defined, e.g. 100 µs)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    level 0: slot = expiry        & 0xFF   covers the next 256 ticks
+ *    level 1: slot = expiry >>  8  & 0xFF   covers the next 65 536 ticks
+ *    level 2: slot = expiry >> 16  & 0xFF   covers the next 2^24 ticks
+ *    level 3: slot = expiry >> 24  & 0xFF   covers the next 2^32 ticks
+ *
+ *  A timer is stored in the lowest level whose span contains its delta.
+ *  Every time level N wraps, the matching slot of level N+1 is "cascaded":
+ *  its timers are re-inserted and land one level lower (eventually level
+ *  0, where they fire).  Each timer cascades at most 3 times per period.
+ *
+ *  Timers are plain integer handles (0..capacity-1) into an intrusive
+ *  doubly-linked slot list — no allocation after construction.  A 256-bit
+ *  occupancy bitmap per level lets nextExpiryTick() find the next busy
+ *  slot with a few count-trailing-zero operations instead of a scan.
+ *
+ *  Not thread-safe: owned by one scheduler thread.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TimingWheel
+{
+public:
+    static constexpr int      LEVELS     = 4;
+    static constexpr int      SLOT_BITS  = 8;
+    static constexpr int      SLOTS      = 1 << SLOT_BITS;
+    static constexpr uint32_t SLOT_MASK  = SLOTS - 1;
+    static constexpr int32_t  NIL        = -1;
+
+    explicit TimingWheel(int capacity = 0) { reserve(capacity); }
+
+    /** Grow the handle space (handles are 0..capacity-1). */
+    void reserve(int capacity)
+    {
+        if (capacity > static_cast<int>(m_timers.size()))
+            m_timers.resize(static_cast<std::size_t>(capacity));
+    }
+
+    int capacity() const { return static_cast<int>(m_timers.size()); }
+
+    /** Current wheel time in ticks. */
+    uint64_t now() const { return m_now; }
+
+    /** Reset to an empty wheel positioned at @p tick. */
+    void clear(uint64_t tick = 0)
+    {
+        for (auto& level : m_slots) level.fill(NIL);
+        for (auto& bits  : m_occupied) bits.fill(0);
+        for (auto& t : m_timers) t = Timer{};
+        m_now     = tick;
+        m_pending = 0;
+    }
+
+    bool isScheduled(int handle) const { return m_timers[handle].level >= 0; }
+    int  pendingCount() const { return m_pending; }
+
+    /**
+     * @brief Arm @p handle to fire at absolute tick @p expiry.
+     * Re-arming an already scheduled handle moves it.  Expiries in the past
+     * fire on the next advance().
+     */
+    void schedule(int handle, uint64_t expiry)
+    {
+        if (isScheduled(handle)) unlink(handle);
+        m_timers[handle].expiry = expiry < m_now ? m_now : expiry;
+        link(handle);
+        ++m_pending;
+    }
+
+    void cancel(int handle)
+    {
+        if (!isScheduled(handle)) return;
+        unlink(handle);
+        --m_pending;
+    }
+
+    /**
+     * @brief Advance wheel time up to and including @p target, invoking
+     *        fire(handle, expiryTick) for every timer that expires.
+     *
+     * The callback may re-schedule the handle it was given (the usual way to
+     * implement a periodic timer: schedule(h, expiry + period)).
+     */
+    template <typename Fn>
+    void advance(uint64_t target, Fn&& fire)
+    {
+        while (m_now <= target) {
+            // Cascade higher levels when the lower level wraps to slot 0.
+            if ((m_now & SLOT_MASK) == 0 && m_now != 0)
+                cascadeFrom(1);
+
+            const uint32_t slot = static_cast<uint32_t>(m_now & SLOT_MASK);
+            int32_t h = m_slots[0][slot];
+            if (h != NIL) {
+                // Detach the whole list first so re-scheduling from inside
+                // fire() into this same slot (period == 0) cannot loop.
+                m_slots[0][slot] = NIL;
+                clearBit(0, slot);
+                while (h != NIL) {
+                    const int32_t next = m_timers[h].next;
+                    m_timers[h].level = -1;
+                    m_timers[h].next = m_timers[h].prev = NIL;
+                    --m_pending;
+                    fire(static_cast<int>(h), m_timers[h].expiry);
+                    h = next;
+                }
+            }
+
+            if (m_now == target) { ++m_now; break; }
+
+            // Fast-forward over empty level-0 ticks, but never past a
+            // cascade boundary or past the target.
+            const uint64_t nextBusy = nextExpiryTick();
+            uint64_t jump = m_now + 1;
+            if (nextBusy > jump) {
+                const uint64_t boundary = (m_now | SLOT_MASK) + 1;
+                jump = nextBusy < boundary ? nextBusy : boundary;
+                if (jump > target) jump = target;
+                if (jump <= m_now) jump = m_now + 1;
+            }
+            m_now = jump;
+        }
+    }
+
+    /**
+     * @brief Earliest tick at which advance() has work to do.
+     *
+     * Exact for level-0 timers.  For timers parked in higher levels it
+     * returns the cascade boundary where they move down — the scheduler
+     * wakes there, cascades, and asks again.  Returns UINT64_MAX if empty.
+     */
+    uint64_t nextExpiryTick() const
+    {
+        if (m_pending == 0) return UINT64_MAX;
+
+        // Sitting on a level-0 wrap that advance() has not processed yet:
+        // higher-level timers may be about to cascade into the next ticks.
+        if ((m_now & SLOT_MASK) == 0 && m_now != 0)
+            return m_now;
+
+        const uint32_t slot0 = static_cast<uint32_t>(m_now & SLOT_MASK);
+        const int found = findSetBitFrom(0, slot0);
+        if (found >= 0)
+            return (m_now & ~static_cast<uint64_t>(SLOT_MASK)) + static_cast<uint32_t>(found);
+
+        // Nothing left in this level-0 revolution: next event is the wrap.
+        return (m_now | SLOT_MASK) + 1;
+    }
+
+private:
+    struct Timer
+    {
+        uint64_t expiry = 0;
+        int32_t  next   = NIL;
+        int32_t  prev   = NIL;
+        int16_t  level  = -1;   ///< -1 = not scheduled
+        uint16_t slot   = 0;
+    };
+
+    void link(int32_t h)
+    {
+        Timer& t = m_timers[h];
+        const uint64_t delta = t.expiry - m_now;
+
+        int level = 0;
+        while (level < LEVELS - 1
+               && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))
+            ++level;
+
+        const uint32_t slot =
+            static_cast<uint32_t>((t.expiry >> (SLOT_BITS * level)) & SLOT_MASK);
+
+        t.level = static_cast<int16_t>(level);
+        t.slot  = static_cast<uint16_t>(slot);
+        t.prev  = NIL;
+        t.next  = m_slots[level][slot];
+        if (t.next != NIL) m_timers[t.next].prev = h;
+        m_slots[level][slot] = h;
+        setBit(level, slot);
+    }
+
+    void unlink(int32_t h)
+    {
+        Timer& t = m_timers[h];
+        if (t.prev != NIL) m_timers[t.prev].next = t.next;
+        else               m_slots[t.level][t.slot] = t.next;
+        if (t.next != NIL) m_timers[t.next].prev = t.prev;
+        if (m_slots[t.level][t.slot] == NIL) clearBit(t.level, t.slot);
+        t.level = -1;
+        t.next = t.prev = NIL;
+    }
+
+    void cascadeFrom(int level)
+    {
+        if (level >= LEVELS) return;
+
+        const uint32_t slot =
+            static_cast<uint32_t>((m_now >> (SLOT_BITS * level)) & SLOT_MASK);
+
+        // Level N wrapped too → cascade the level above first.
+        if (slot == 0) cascadeFrom(level + 1);
+
+        int32_t h = m_slots[level][slot];
+        m_slots[level][slot] = NIL;
+        clearBit(level, slot);
+        while (h != NIL) {
+            const int32_t next = m_timers[h].next;
+            link(h);   // delta is now smaller → lands in a lower level
+            h = next;
+        }
+    }
+
+    // ── Occupancy bitmap helpers ─────────────────────────────────────────────
+    void setBit(int level, uint32_t slot)
+    {
+        m_occupied[level][slot >> 6] |= (uint64_t(1) << (slot & 63));
+    }
+    void clearBit(int level, uint32_t slot)
+    {
+        m_occupied[level][slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+    }
+    int findSetBitFrom(int level, uint32_t from) const
+    {
+        for (uint32_t word = from >> 6; word < SLOTS / 64; ++word) {
+            uint64_t bits = m_occupied[level][word];
+            if (word == (from >> 6))
+                bits &= ~uint64_t(0) << (from & 63);
+            if (bits)
+                return static_cast<int>(word * 64 + ctz64(bits));
+        }
+        return -1;
+    }
+    static uint32_t ctz64(uint64_t v)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint32_t>(__builtin_ctzll(v));
+#else
+        uint32_t n = 0;
+        while (!(v & 1)) { v >>= 1; ++n; }
+        return n;
+#endif
+    }
+
+    std::vector<Timer>                                   m_timers;
+    std::array<std::array<int32_t, SLOTS>, LEVELS>       m_slots = make_empty_slots();
+    std::array<std::array<uint64_t, SLOTS / 64>, LEVELS> m_occupied{};
+    uint64_t                                             m_now     = 0;
+    int                                                  m_pending = 0;
+
+    static std::array<std::array<int32_t, SLOTS>, LEVELS> make_empty_slots()
+    {
+        std::array<std::array<int32_t, SLOTS>, LEVELS> s{};
+        for (auto& level : s) level.fill(NIL);
+        return s;
+    }
+};
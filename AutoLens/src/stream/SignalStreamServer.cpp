@@ -0,0 +1,661 @@
+/**
+ * @file SignalStreamServer.cpp
+ * @brief Signal subscriptions, WebSocket/raw TCP framing and delta updates.
+ */
+
+#include "stream/SignalStreamServer.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace DBCManager;
+
+namespace {
+
+constexpr char kWsGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+constexpr int  kMaxHandshakeBytes = 8192;
+
+constexpr uint8_t kWsText   = 0x1;
+constexpr uint8_t kWsBinary = 0x2;
+constexpr uint8_t kWsClose  = 0x8;
+constexpr uint8_t kWsPing   = 0x9;
+constexpr uint8_t kWsPong   = 0xA;
+
+constexpr int kKindJson   = 1;
+constexpr int kKindUpdate = 2;
+
+constexpr uint8_t kUpdateType     = 1;
+constexpr uint8_t kUpdateSnapshot = 0x01;
+constexpr int     kUpdateHeader   = 16;
+
+void putVarint(QByteArray& out, quint32 v)
+{
+    while (v >= 0x80) {
+        out.append(char(v | 0x80));
+        v >>= 7;
+    }
+    out.append(char(v));
+}
+
+void putF64(QByteArray& out, double v)
+{
+    char bytes[8];
+    qToLittleEndian(v, bytes);
+    out.append(bytes, 8);
+}
+
+/** Browsers send Origin; only pages served from this machine may connect. */
+bool originAllowed(const QByteArray& origin)
+{
+    if (origin.isEmpty() || origin == "null" || origin.startsWith("file://"))
+        return true;
+    const QByteArray host = origin.mid(origin.indexOf("://") + 3).split('/').first();
+    const QByteArray name = host.startsWith('[') ? host.left(host.indexOf(']') + 1)
+                                                 : host.split(':').first();
+    return name == "localhost" || name == "127.0.0.1" || name == "[::1]";
+}
+
+/** Split "[channel:][Message.]Signal"; channel 0 = any. */
+void parseName(const QString& name, int& channel, QString& msgName, QString& sigName)
+{
+    QString rest = name;
+    channel = 0;
+    const int colon = rest.indexOf(':');
+    if (colon > 0) {
+        channel = rest.left(colon).toInt();
+        rest    = rest.mid(colon + 1);
+    }
+    const int dot = rest.lastIndexOf('.');
+    msgName = dot > 0 ? rest.left(dot) : QString();
+    sigName = dot > 0 ? rest.mid(dot + 1) : rest;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Client — server thread only (counters are read under m_mutex)
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct SignalStreamServer::Client
+{
+    QTcpSocket* socket = nullptr;
+    QTimer*     timer  = nullptr;
+    QByteArray  inBuf;
+    bool        handshakeDone = false;
+    bool        webSocket     = false;
+    QByteArray  wsMessage;           ///< fragmented text message so far
+
+    QVector<int>     slotIndex;      ///< client index → m_slots index
+    QVector<quint64> sentVersion;    ///< per client index
+    bool     snapshotPending = false;
+    quint32  sequence = 0;
+    QByteArray updateBuf;            ///< reused per tick
+
+    ClientStats stats;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Lifecycle (UI thread)
+// ─────────────────────────────────────────────────────────────────────────────
+
+SignalStreamServer::SignalStreamServer(QObject* parent)
+    : QObject(parent)
+{
+}
+
+SignalStreamServer::~SignalStreamServer()
+{
+    stop();
+}
+
+QString SignalStreamServer::start(quint16 port)
+{
+    stop();
+
+    m_thread = new QThread;
+    m_thread->setObjectName("AutoLens_SignalStream");
+    m_context = new QObject;
+    m_context->moveToThread(m_thread);
+    m_thread->start();
+
+    // Listen on the server thread so the QTcpServer and every socket it
+    // creates belong to that thread's event loop.
+    QString error;
+    QMetaObject::invokeMethod(m_context, [this, port, &error]() {
+        m_server = new QTcpServer;
+        if (!m_server->listen(QHostAddress::LocalHost, port)) {
+            error = m_server->errorString();
+            delete m_server;
+            m_server = nullptr;
+            return;
+        }
+        connect(m_server, &QTcpServer::newConnection, m_server,
+                [this]() { onNewConnection(); });
+    }, Qt::BlockingQueuedConnection);
+
+    if (!error.isEmpty()) {
+        stop();
+        return QString("Cannot listen on 127.0.0.1:%1: %2").arg(port).arg(error);
+    }
+    m_port = port;
+    qDebug() << "[SignalStream] Listening on 127.0.0.1:" << port;
+    return {};
+}
+
+void SignalStreamServer::stop()
+{
+    if (!m_thread)
+        return;
+
+    QMetaObject::invokeMethod(m_context, [this]() {
+        const QVector<Client*> clients = m_clients;
+        for (Client* c : clients)
+            dropClient(c);
+        delete m_server;
+        m_server = nullptr;
+    }, Qt::BlockingQueuedConnection);
+
+    m_thread->quit();
+    m_thread->wait();
+    delete m_context;
+    delete m_thread;
+    m_context = nullptr;
+    m_thread  = nullptr;
+    qDebug() << "[SignalStream] Stopped";
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Value slots and name resolution (under m_mutex)
+// ─────────────────────────────────────────────────────────────────────────────
+
+void SignalStreamServer::setDatabase(const DBCDatabase& db)
+{
+    QMutexLocker lock(&m_mutex);
+    m_db = std::make_shared<const DBCDatabase>(db);
+    for (int i = 0; i < m_slots.size(); ++i)
+        if (m_slots[i].refs > 0)
+            resolveSlot(i);
+    rebuildWatches();
+}
+
+int SignalStreamServer::acquireSlot(const QString& name)
+{
+    const auto it = m_slotByName.constFind(name);
+    if (it != m_slotByName.constEnd()) {
+        ++m_slots[*it].refs;
+        return *it;
+    }
+
+    int index = -1;
+    for (int i = 0; i < m_slots.size(); ++i)
+        if (m_slots[i].refs == 0) { index = i; break; }
+    if (index < 0) {
+        index = m_slots.size();
+        m_slots.append(Slot());
+    }
+
+    m_slots[index] = Slot();
+    m_slots[index].name = name;
+    m_slots[index].refs = 1;
+    m_slotByName.insert(name, index);
+    resolveSlot(index);
+    return index;
+}
+
+void SignalStreamServer::releaseSlot(int index)
+{
+    Slot& slot = m_slots[index];
+    if (--slot.refs > 0)
+        return;
+    m_slotByName.remove(slot.name);
+    slot = Slot();
+}
+
+void SignalStreamServer::resolveSlot(int index)
+{
+    // Only unit and "found" are stored here; rebuildWatches() turns every
+    // slot into per-ID watches.
+    Slot& slot = m_slots[index];
+    slot.found = false;
+    slot.unit.clear();
+    if (!m_db)
+        return;
+
+    int channel;
+    QString msgName, sigName;
+    parseName(slot.name, channel, msgName, sigName);
+
+    for (const DBCMessage& msg : m_db->messages) {
+        if (!msgName.isEmpty() && msg.name != msgName)
+            continue;
+        if (const DBCSignal* sig = msg.signal(sigName)) {
+            slot.found = true;
+            slot.unit  = sig->unit;
+            return;
+        }
+    }
+}
+
+void SignalStreamServer::rebuildWatches()
+{
+    m_watches.clear();
+    if (m_db) {
+        for (int i = 0; i < m_slots.size(); ++i) {
+            const Slot& slot = m_slots[i];
+            if (slot.refs == 0 || !slot.found)
+                continue;
+
+            int channel;
+            QString msgName, sigName;
+            parseName(slot.name, channel, msgName, sigName);
+
+            // A bare signal name follows every message that carries it.
+            for (const DBCMessage& msg : m_db->messages) {
+                if ((!msgName.isEmpty() && msg.name != msgName) || !msg.signal(sigName))
+                    continue;
+                Watch w;
+                w.signal  = sigName;
+                w.channel = channel;
+                w.slot    = i;
+                m_watches[watchKey(msg.id, msg.isExtended)].append(w);
+            }
+        }
+    }
+    m_anyWatch.store(!m_watches.isEmpty(), std::memory_order_relaxed);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Ingest — UI thread, once per decoded batch
+// ─────────────────────────────────────────────────────────────────────────────
+
+void SignalStreamServer::ingest(const QVector<TraceEntry>& entries)
+{
+    if (!m_anyWatch.load(std::memory_order_relaxed))
+        return;
+
+    QMutexLocker lock(&m_mutex);
+    for (const TraceEntry& e : entries) {
+        if (e.decodedSignals.isEmpty())
+            continue;
+        const auto it = m_watches.find(watchKey(e.msg.id, e.msg.isExtended));
+        if (it == m_watches.end())
+            continue;
+
+        const QVector<SignalRow>& rows = e.decodedSignals;
+        for (Watch& w : *it) {
+            if (w.channel != 0 && w.channel != e.msg.channel)
+                continue;
+
+            // Rows come out in DBC order, so the last position almost always
+            // matches; multiplexed messages fall back to a search.
+            int row = w.rowHint;
+            if (row >= rows.size() || rows[row].name != w.signal) {
+                row = -1;
+                for (int i = 0; i < rows.size(); ++i)
+                    if (rows[i].name == w.signal) { row = i; break; }
+                if (row < 0)
+                    continue;   // not in the active mux branch
+                w.rowHint = row;
+            }
+
+            Slot& slot = m_slots[w.slot];
+            slot.value = rows[row].value;
+            slot.tsNs  = e.msg.timestamp;
+            ++slot.version;
+        }
+    }
+}
+
+QVector<SignalStreamServer::ClientStats> SignalStreamServer::clientStats() const
+{
+    QMutexLocker lock(&m_mutex);
+    QVector<ClientStats> out;
+    out.reserve(m_clients.size());
+    for (const Client* c : m_clients)
+        out.append(c->stats);
+    return out;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Connections (server thread)
+// ─────────────────────────────────────────────────────────────────────────────
+
+void SignalStreamServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        auto* c = new Client;
+        c->socket = socket;
+        c->stats.peer = QString("%1:%2").arg(socket->peerAddress().toString())
+                                          .arg(socket->peerPort());
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+        c->timer = new QTimer(socket);
+        c->timer->setTimerType(Qt::PreciseTimer);
+        c->timer->setInterval(1000 / DEFAULT_RATE_HZ);
+        connect(c->timer, &QTimer::timeout, socket, [this, c]() { sendUpdate(c); });
+
+        connect(socket, &QTcpSocket::readyRead, socket, [this, c]() { onReadyRead(c); });
+        connect(socket, &QTcpSocket::disconnected, socket, [this, c]() { dropClient(c); });
+
+        int count = 0;
+        {
+            QMutexLocker lock(&m_mutex);
+            m_clients.append(c);
+            count = m_clients.size();
+        }
+        qDebug() << "[SignalStream] Client connected:" << c->stats.peer;
+        emit clientCountChanged(count);
+    }
+}
+
+void SignalStreamServer::dropClient(Client* c)
+{
+    int count = 0;
+    {
+        QMutexLocker lock(&m_mutex);
+        if (!m_clients.removeOne(c))
+            return;   // already dropped (disconnected() after abort())
+        for (int slot : c->slotIndex)
+            releaseSlot(slot);
+        rebuildWatches();
+        count = m_clients.size();
+    }
+    qDebug() << "[SignalStream] Client dropped:" << c->stats.peer;
+
+    c->timer->stop();
+    c->socket->disconnect();   // no disconnected() → dropClient() re-entry
+    c->socket->abort();
+    c->socket->deleteLater();   // also deletes the timer (child)
+    delete c;
+    emit clientCountChanged(count);
+}
+
+void SignalStreamServer::onReadyRead(Client* c)
+{
+    c->inBuf.append(c->socket->readAll());
+
+    if (!c->handshakeDone) {
+        if (c->inBuf.size() < 4)
+            return;
+        if (c->inBuf.startsWith("GET ")) {
+            if (!handshake(c))
+                return;   // waiting for the rest, or dropped
+        } else {
+            c->handshakeDone = true;   // raw TCP
+        }
+    }
+
+    if (c->webSocket) {
+        readWebSocketFrames(c);
+        return;
+    }
+
+    // Raw TCP: newline-terminated JSON commands
+    int nl;
+    while ((nl = c->inBuf.indexOf('\n')) >= 0) {
+        const QByteArray line = c->inBuf.left(nl).trimmed();
+        c->inBuf.remove(0, nl + 1);
+        if (!line.isEmpty())
+            handleCommand(c, line);
+        if (!m_clients.contains(c))
+            return;
+    }
+    if (c->inBuf.size() > MAX_COMMAND_BYTES)
+        dropClient(c);
+}
+
+bool SignalStreamServer::handshake(Client* c)
+{
+    const int end = c->inBuf.indexOf("\r\n\r\n");
+    if (end < 0) {
+        if (c->inBuf.size() > kMaxHandshakeBytes)
+            dropClient(c);
+        return false;
+    }
+
+    QByteArray key, origin;
+    const QList<QByteArray> lines = c->inBuf.left(end).split('\n');
+    for (const QByteArray& raw : lines) {
+        const int sep = raw.indexOf(':');
+        if (sep <= 0)
+            continue;
+        const QByteArray field = raw.left(sep).trimmed().toLower();
+        if (field == "sec-websocket-key")
+            key = raw.mid(sep + 1).trimmed();
+        else if (field == "origin")
+            origin = raw.mid(sep + 1).trimmed().toLower();
+    }
+    c->inBuf.remove(0, end + 4);
+
+    if (key.isEmpty() || !originAllowed(origin)) {
+        c->socket->write(key.isEmpty() ? "HTTP/1.1 400 Bad Request\r\n\r\n"
+                                       : "HTTP/1.1 403 Forbidden\r\n\r\n");
+        c->socket->flush();
+        dropClient(c);
+        return false;
+    }
+
+    const QByteArray accept = QCryptographicHash::hash(key + kWsGuid,
+                                                       QCryptographicHash::Sha1).toBase64();
+    c->socket->write("HTTP/1.1 101 Switching Protocols\r\n"
+                     "Upgrade: websocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: " + accept + "\r\n\r\n");
+    c->handshakeDone   = true;
+    c->webSocket       = true;
+    c->stats.webSocket = true;
+    return true;
+}
+
+void SignalStreamServer::readWebSocketFrames(Client* c)
+{
+    for (;;) {
+        const auto* p = reinterpret_cast<const uint8_t*>(c->inBuf.constData());
+        const int   avail = c->inBuf.size();
+        if (avail < 2)
+            return;
+
+        const bool    fin    = p[0] & 0x80;
+        const uint8_t opcode = p[0] & 0x0F;
+        const bool    masked = p[1] & 0x80;
+        quint64 len = p[1] & 0x7F;
+        int pos = 2;
+        if (len == 126) {
+            if (avail < 4) return;
+            len = qFromBigEndian<quint16>(p + 2);
+            pos = 4;
+        } else if (len == 127) {
+            if (avail < 10) return;
+            len = qFromBigEndian<quint64>(p + 2);
+            pos = 10;
+        }
+        if (!masked || len > quint64(MAX_COMMAND_BYTES)) {
+            dropClient(c);   // clients must mask (RFC 6455 §5.1)
+            return;
+        }
+        if (avail < pos + 4 + int(len))
+            return;
+
+        const uint8_t* mask = p + pos;
+        QByteArray payload(int(len), Qt::Uninitialized);
+        for (int i = 0; i < int(len); ++i)
+            payload[i] = char(p[pos + 4 + i] ^ mask[i & 3]);
+        c->inBuf.remove(0, pos + 4 + int(len));
+
+        switch (opcode) {
+        case 0x0:   // continuation
+        case kWsText:
+            c->wsMessage += payload;
+            if (c->wsMessage.size() > MAX_COMMAND_BYTES) {
+                dropClient(c);
+                return;
+            }
+            if (fin) {
+                const QByteArray message = c->wsMessage;
+                c->wsMessage.clear();
+                handleCommand(c, message);
+                if (!m_clients.contains(c))
+                    return;
+            }
+            break;
+        case kWsPing: {
+            QByteArray frame;
+            frame.append(char(0x80 | kWsPong)).append(char(payload.size())).append(payload);
+            c->socket->write(frame);
+            break;
+        }
+        case kWsClose:
+            c->socket->write(QByteArray("\x88\x00", 2));
+            c->socket->flush();
+            dropClient(c);
+            return;
+        default:
+            break;   // binary from the client and pongs are ignored
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Commands and updates (server thread)
+// ─────────────────────────────────────────────────────────────────────────────
+
+void SignalStreamServer::handleCommand(Client* c, const QByteArray& json)
+{
+    QJsonParseError parseError;
+    const QJsonObject cmd = QJsonDocument::fromJson(json, &parseError).object();
+    if (parseError.error != QJsonParseError::NoError) {
+        sendMessage(c, kKindJson, QJsonDocument(QJsonObject{
+            { "type", "error" }, { "message", parseError.errorString() } })
+            .toJson(QJsonDocument::Compact));
+        return;
+    }
+
+    if (cmd.contains("rateHz")) {
+        c->stats.rateHz = std::clamp(cmd.value("rateHz").toInt(DEFAULT_RATE_HZ), 1, MAX_RATE_HZ);
+        c->timer->setInterval(std::max(1, 1000 / c->stats.rateHz));
+    }
+
+    QJsonArray signalList;
+    if (cmd.contains("subscribe")) {
+        QStringList names;
+        for (const QJsonValue& v : cmd.value("subscribe").toArray()) {
+            const QString name = v.toString().trimmed();
+            if (!name.isEmpty() && !names.contains(name))
+                names.append(name);
+        }
+
+        QMutexLocker lock(&m_mutex);
+        // Acquire before releasing, so slots shared with the old set survive
+        QVector<int> wanted;
+        wanted.reserve(names.size());
+        for (const QString& name : names)
+            wanted.append(acquireSlot(name));
+        for (int slot : c->slotIndex)
+            releaseSlot(slot);
+        c->slotIndex = wanted;
+        c->sentVersion.fill(0, wanted.size());
+        c->stats.signalCount = wanted.size();
+        c->snapshotPending = true;
+        rebuildWatches();
+
+        for (int i = 0; i < wanted.size(); ++i) {
+            const Slot& slot = m_slots[wanted[i]];
+            signalList.append(QJsonObject{
+                { "index", i }, { "name", slot.name }, { "unit", slot.unit },
+                { "found", slot.found } });
+        }
+    }
+
+    if (!c->timer->isActive() && !c->slotIndex.isEmpty())
+        c->timer->start();
+    else if (c->slotIndex.isEmpty())
+        c->timer->stop();
+
+    sendMessage(c, kKindJson, QJsonDocument(QJsonObject{
+        { "type", "subscribed" }, { "rateHz", c->stats.rateHz }, { "signals", signalList } })
+        .toJson(QJsonDocument::Compact));
+}
+
+void SignalStreamServer::sendUpdate(Client* c)
+{
+    const qint64 pending = c->socket->bytesToWrite();
+
+    QByteArray& out = c->updateBuf;
+    out.resize(kUpdateHeader);
+    int     count  = 0;
+    int     prev   = -1;
+    quint64 newest = 0;
+    const bool snapshot = c->snapshotPending;
+    {
+        QMutexLocker lock(&m_mutex);
+        c->stats.pending = pending;
+        if (pending > MAX_PENDING_BYTES) {
+            ++c->stats.skipped;   // versions stay unsent → next tick has the latest
+            return;
+        }
+        for (int i = 0; i < c->slotIndex.size(); ++i) {
+            const Slot& slot = m_slots[c->slotIndex[i]];
+            if (slot.version == 0 || slot.version == c->sentVersion[i])
+                continue;
+            c->sentVersion[i] = slot.version;
+            putVarint(out, quint32(i - prev - 1));
+            putF64(out, slot.value);
+            newest = std::max(newest, slot.tsNs);
+            prev = i;
+            ++count;
+        }
+        if (count > 0 || snapshot)
+            ++c->stats.updates;
+    }
+    if (count == 0 && !snapshot)
+        return;
+    c->snapshotPending = false;
+
+    auto* h = reinterpret_cast<uchar*>(out.data());
+    h[0] = kUpdateType;
+    h[1] = snapshot ? kUpdateSnapshot : 0;
+    qToLittleEndian<quint16>(quint16(count), h + 2);
+    qToLittleEndian<quint32>(c->sequence++, h + 4);
+    qToLittleEndian<quint64>(newest, h + 8);
+    sendMessage(c, kKindUpdate, out);
+}
+
+void SignalStreamServer::sendMessage(Client* c, int kind, const QByteArray& payload)
+{
+    char header[10];
+    int  headerLen;
+    if (c->webSocket) {
+        header[0] = char(0x80 | (kind == kKindJson ? kWsText : kWsBinary));
+        if (payload.size() < 126) {
+            header[1] = char(payload.size());
+            headerLen = 2;
+        } else if (payload.size() <= 0xFFFF) {
+            header[1] = 126;
+            qToBigEndian<quint16>(quint16(payload.size()), header + 2);
+            headerLen = 4;
+        } else {
+            header[1] = 127;
+            qToBigEndian<quint64>(quint64(payload.size()), header + 2);
+            headerLen = 10;
+        }
+    } else {
+        qToLittleEndian<quint32>(quint32(payload.size()), header);
+        header[4] = char(kind);
+        headerLen = 5;
+    }
+    c->socket->write(header, headerLen);
+    c->socket->write(payload);
+}
@@ -0,0 +1,182 @@
+#pragma once
+/**
+ * @file SignalStreamServer.h
+ * @brief Localhost server that streams decoded signal values to dashboards.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHERE IT SITS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    DecodePipeline ─► AppController::onDecodedBatches ─► TraceModel
+ *                                  │
+ *                                  └─ ingest(entries)   UI thread, per batch
+ *                                       │  copy subscribed SignalRow::value
+ *                                       ▼  into shared value slots
+ *                                  value slots (latest value + version)
+ *                                       │
+ *                      server thread ───┤  per-client timer (rateHz)
+ *                                       ▼  changed slots only
+ *                                  client socket (WebSocket or raw TCP)
+ *
+ *  Signals are decoded once, by the trace decode stage — the server only
+ *  reads the numbers it already produced, so ten clients watching the same
+ *  signal cost the same as one.  Values flow while a measurement runs.
+ *
+ *  Backpressure: each client keeps "last version sent" per signal.  If its
+ *  socket still holds more than MAX_PENDING_BYTES, the tick is skipped and
+ *  nothing is marked as sent — the next tick sends the then-latest values.
+ *  A slow client therefore sees a lower update rate, never a growing
+ *  queue, and capture never waits on a socket.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  PROTOCOL
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Listens on 127.0.0.1 only.  A connection that starts with "GET " is a
+ *  WebSocket (RFC 6455; text = JSON, binary = updates); anything else is a
+ *  raw TCP client that sends newline-terminated JSON and receives
+ *  [u32 LE length][u8 kind: 1 JSON, 2 update][payload] frames.
+ *
+ *  Client → server (JSON):
+ *    { "subscribe": ["EngineSpeed", "EngineData.EngineTemp", "2:Gear"],
+ *      "rateHz": 20 }
+ *  "subscribe" replaces the subscription set; names are
+ *  [channel:][Message.]Signal against the merged DBC.  Both keys optional.
+ *
+ *  Server → client (JSON) after each subscribe:
+ *    { "type": "subscribed", "rateHz": 20,
+ *      "signals": [ { "index": 0, "name": "EngineSpeed", "unit": "rpm",
+ *                     "found": true }, … ] }
+ *
+ *  Server → client (binary update, little-endian):
+ *    u8  type = 1
+ *    u8  flags        bit 0: snapshot (all known values, after a subscribe)
+ *    u16 count
+ *    u32 sequence     per client, +1 per update
+ *    u64 timestamp_ns newest frame timestamp among the values
+ *    count × { varint index gap (index − previous index − 1), f64 value }
+ *
+ *  Only signals whose value changed since the client's last update are
+ *  sent; with sorted indices the gaps are mostly a single 0 byte.
+ *
+ *  Threading: start/stop/setDatabase/ingest on the UI thread; sockets and
+ *  timers live on the server thread.  Shared state is under m_mutex.
+ */
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+#include "trace/TraceModel.h"
+
+class QThread;
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+class SignalStreamServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr quint16 DEFAULT_PORT      = 8765;
+    static constexpr int     DEFAULT_RATE_HZ   = 20;
+    static constexpr int     MAX_RATE_HZ       = 1000;
+    static constexpr qint64  MAX_PENDING_BYTES = 256 * 1024;   ///< per client, then ticks are skipped
+    static constexpr int     MAX_COMMAND_BYTES = 64 * 1024;    ///< larger requests drop the client
+
+    struct ClientStats
+    {
+        QString peer;
+        bool    webSocket = false;
+        int     signalCount = 0;
+        int     rateHz    = DEFAULT_RATE_HZ;
+        quint64 updates   = 0;
+        quint64 skipped   = 0;   ///< ticks skipped for backpressure
+        qint64  pending   = 0;   ///< bytes queued at the last tick
+    };
+
+    explicit SignalStreamServer(QObject* parent = nullptr);
+    ~SignalStreamServer() override;
+
+    /** Start listening on 127.0.0.1:@p port.  Returns "" or the error. */
+    QString start(quint16 port);
+    void    stop();
+    bool    isRunning() const { return m_thread != nullptr; }
+    quint16 port()      const { return m_port; }
+
+    /** Replace the DBC used to resolve subscriptions (re-resolves them). */
+    void setDatabase(const DBCManager::DBCDatabase& db);
+
+    /** Take the subscribed values from a decoded batch.  UI thread. */
+    void ingest(const QVector<TraceEntry>& entries);
+
+    QVector<ClientStats> clientStats() const;
+
+signals:
+    void clientCountChanged(int count);
+
+private:
+    /** Latest value of one subscribed name, shared by all its clients. */
+    struct Slot
+    {
+        QString name;
+        QString unit;
+        double  value   = 0.0;
+        quint64 tsNs    = 0;
+        quint64 version = 0;   ///< 0 = no value yet
+        int     refs    = 0;
+        bool    found   = false;
+    };
+
+    /** One (message, signal) feeding a slot. */
+    struct Watch
+    {
+        QString signal;
+        int     channel = 0;   ///< 0 = any
+        int     slot    = 0;
+        int     rowHint = 0;   ///< last index in TraceEntry::decodedSignals
+    };
+
+    struct Client;
+
+    // --- server thread ---
+    void onNewConnection();
+    void onReadyRead(Client* c);
+    bool handshake(Client* c);
+    void readWebSocketFrames(Client* c);
+    void handleCommand(Client* c, const QByteArray& json);
+    void sendUpdate(Client* c);
+    void sendMessage(Client* c, int kind, const QByteArray& payload);
+    void dropClient(Client* c);
+
+    // --- under m_mutex ---
+    int  acquireSlot(const QString& name);
+    void releaseSlot(int index);
+    void resolveSlot(int index);
+    void rebuildWatches();
+
+    /** A standard and an extended ID with the same number are different messages. */
+    static quint64 watchKey(uint32_t id, bool extended)
+    {
+        return quint64(id) | (extended ? (1ull << 32) : 0);
+    }
+
+    QThread*    m_thread  = nullptr;
+    QObject*    m_context = nullptr;   ///< lives on m_thread (invokeMethod target)
+    QTcpServer* m_server  = nullptr;   ///< server thread
+    quint16     m_port    = DEFAULT_PORT;
+
+    mutable QMutex                 m_mutex;
+    std::shared_ptr<const DBCManager::DBCDatabase> m_db;
+    QVector<Slot>                  m_slots;
+    QHash<QString, int>            m_slotByName;
+    QHash<quint64, QVector<Watch>> m_watches;   ///< watchKey(id, extended) → watches
+    std::atomic<bool>              m_anyWatch{false};   ///< ingest() fast path
+    QVector<Client*>               m_clients;
+};
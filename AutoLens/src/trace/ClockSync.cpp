@@ -0,0 +1,154 @@
+/**
+ * @file ClockSync.cpp
+ * @brief Reference matching and the streaming offset/drift regression.
+ */
+
+#include "trace/ClockSync.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace CANManager;
+
+quint64 ClockSync::fingerprint(const CANMessage& msg)
+{
+    // FNV-1a over the fields both loggers agree on.
+    quint64 h = 1469598103934665603ull;
+    auto mix = [&h](uint8_t b) {
+        h ^= b;
+        h *= 1099511628211ull;
+    };
+    for (int s = 0; s < 32; s += 8)
+        mix(uint8_t(msg.id >> s));
+    mix(uint8_t((msg.isExtended ? 0x80 : 0) | (msg.isFD ? 0x40 : 0) | (msg.dlc & 0x0F)));
+    const int len = msg.isRemote ? 0 : msg.dataLength();
+    for (int i = 0; i < len; ++i)
+        mix(msg.data[i]);
+    return h;
+}
+
+void ClockSync::addReference(const CANMessage& msg)
+{
+    if (msg.isError)
+        return;
+    QVector<quint64>& times = m_reference[fingerprint(msg)];
+    if (!times.isEmpty() && times.last() > msg.timestamp)
+        m_sorted = false;
+    times.append(msg.timestamp);
+}
+
+void ClockSync::sortReference()
+{
+    for (auto it = m_reference.begin(); it != m_reference.end(); ++it)
+        std::sort(it->begin(), it->end());
+    m_sorted = true;
+}
+
+bool ClockSync::observe(const CANMessage& msg)
+{
+    if (msg.isError)
+        return false;
+    if (!m_sorted)
+        sortReference();
+
+    const auto it = m_reference.constFind(fingerprint(msg));
+    if (it == m_reference.constEnd())
+        return false;
+    const QVector<quint64>& times = it.value();
+
+    // ── Bootstrap: unique fingerprints only, no prediction needed ───────────
+    if (!m_bootstrapped) {
+        if (times.size() != 1)
+            return false;
+        m_bootstrap.append(qint64(times.first() - msg.timestamp));
+        if (m_bootstrap.size() < BOOTSTRAP)
+            return false;
+
+        auto mid = m_bootstrap.begin() + m_bootstrap.size() / 2;
+        std::nth_element(m_bootstrap.begin(), mid, m_bootstrap.end());
+        m_coarseOffset = *mid;
+        m_bootstrapped = true;
+        m_bootstrap.clear();
+        m_bootstrap.squeeze();
+        return false;
+    }
+
+    // ── Track: nearest reference occurrence to the prediction ───────────────
+    const qint64 predicted = map(msg.timestamp);
+    const auto pos = std::lower_bound(times.begin(), times.end(), quint64(std::max<qint64>(0, predicted)));
+    qint64 best = -1;
+    qint64 bestErr = std::numeric_limits<qint64>::max();
+    for (auto p : { pos, pos == times.begin() ? pos : pos - 1 }) {
+        if (p == times.end()) continue;
+        const qint64 err = std::abs(qint64(*p) - predicted);
+        if (err < bestErr) {
+            bestErr = err;
+            best    = qint64(*p);
+        }
+    }
+
+    const Estimate e = estimate();
+    const qint64 window = e.valid
+        ? std::clamp(qint64(e.residualUs * 1000.0 * 4.0), WINDOW_MIN_NS, WINDOW_START_NS)
+        : WINDOW_START_NS;
+    if (best < 0 || bestErr > window)
+        return false;
+
+    addSample(msg.timestamp, quint64(best));
+    return true;
+}
+
+void ClockSync::addSample(quint64 localNs, quint64 referenceNs)
+{
+    if (m_n == 0)
+        m_x0 = localNs;
+
+    const double x = double(qint64(localNs - m_x0));
+    const double y = double(qint64(referenceNs - localNs));
+
+    ++m_n;
+    const double dx = x - m_meanX;
+    const double dy = y - m_meanY;
+    m_meanX += dx / double(m_n);
+    m_meanY += dy / double(m_n);
+    m_cxx += dx * (x - m_meanX);
+    m_cxy += dx * (y - m_meanY);
+    m_cyy += dy * (y - m_meanY);
+
+    if (!m_bootstrapped) {
+        m_coarseOffset = qint64(y);
+        m_bootstrapped = true;
+    }
+}
+
+ClockSync::Estimate ClockSync::estimate() const
+{
+    Estimate e;
+    e.pairs = m_n;
+    if (m_n == 0) {
+        e.offsetNs = double(m_coarseOffset);
+        return e;
+    }
+
+    // A slope from a handful of close pairs is mostly noise — offset only
+    // until MIN_PAIRS are in.
+    const double slope = (m_n >= quint64(MIN_PAIRS) && m_cxx > 0.0) ? m_cxy / m_cxx : 0.0;
+    e.offsetNs = m_meanY - slope * m_meanX;
+    e.driftPpm = slope * 1e6;
+
+    const double residualVar = std::max(0.0, (m_cyy - slope * m_cxy) / double(m_n));
+    e.residualUs = std::sqrt(residualVar) / 1000.0;
+    e.valid = m_n >= quint64(MIN_PAIRS);
+    return e;
+}
+
+qint64 ClockSync::map(quint64 localNs) const
+{
+    if (m_n == 0)
+        return qint64(localNs) + m_coarseOffset;
+
+    const Estimate e = estimate();
+    const double x = double(qint64(localNs - m_x0));
+    return qint64(localNs) + qint64(std::llround(e.offsetNs + e.driftPpm * 1e-6 * x));
+}
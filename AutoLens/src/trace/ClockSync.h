@@ -0,0 +1,97 @@
+#pragma once
+/**
+ * @file ClockSync.h
+ * @brief Offset and drift between two frame sources from shared frames.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Two loggers (or two interfaces without hardware sync) stamp frames with
+ *  their own clocks: different zero points, and oscillators that disagree
+ *  by tens of ppm — 36 ms per hour at 10 ppm.  Appending one log to the
+ *  other gives two timelines that neither start nor run together.
+ *
+ *  When both sources see the same bus, every frame present in both is a
+ *  reference pair (local time, reference time).  A straight-line fit over
+ *  the pairs gives the mapping  ref = local + offset + drift · (local − x0).
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  HOW
+ * ═══════════════════════════════════════════════════════════════════════════
+ *    addReference()  index the reference source by frame fingerprint
+ *                    (id, ext, dlc, payload — not the channel, which the
+ *                    two loggers may number differently)
+ *    observe()       for each local frame with a known fingerprint:
+ *        bootstrap   the first BOOTSTRAP frames whose fingerprint is unique
+ *                    in the reference give a coarse offset (median)
+ *        track       afterwards, the reference occurrence nearest to the
+ *                    predicted time is accepted if inside the search window
+ *                    and fed to the regression; the window narrows with the
+ *                    residual, so periodic frames with repeating payloads
+ *                    cannot pair with the wrong cycle
+ *    map()           local timestamp → reference timebase
+ *
+ *  The regression is streaming (Welford co-moments, centred — no large
+ *  sums of squared nanoseconds), so the estimate is available at any
+ *  point and costs O(1) per pair.
+ */
+
+#include <QHash>
+#include <QVector>
+#include <cstdint>
+
+#include "hardware/CANInterface.h"
+
+class ClockSync
+{
+public:
+    static constexpr int    BOOTSTRAP        = 32;        ///< unique pairs for the coarse offset
+    static constexpr int    MIN_PAIRS        = 16;        ///< before estimate().valid
+    static constexpr qint64 WINDOW_START_NS  = 5000000;   ///< 5 ms search window after bootstrap
+    static constexpr qint64 WINDOW_MIN_NS    = 50000;     ///< never narrower than 50 µs
+
+    struct Estimate
+    {
+        bool    valid      = false;
+        double  offsetNs   = 0.0;   ///< at the first paired local timestamp
+        double  driftPpm   = 0.0;   ///< local clock slow (+) / fast (−) vs reference
+        quint64 pairs      = 0;
+        double  residualUs = 0.0;   ///< RMS of the fit
+    };
+
+    /** Index one frame of the reference source (any order). */
+    void addReference(const CANManager::CANMessage& msg);
+
+    /** Match one local frame (timestamp order); returns true if it was paired. */
+    bool observe(const CANManager::CANMessage& msg);
+
+    /** Add a pair directly (e.g. from a hardware sync pulse). */
+    void addSample(quint64 localNs, quint64 referenceNs);
+
+    Estimate estimate() const;
+
+    /**
+     * @p localNs in the reference timebase (identity until bootstrapped).
+     * Negative for frames logged before the reference trace's zero — the
+     * caller rebases or rejects those; never cast straight to a timestamp.
+     */
+    qint64 map(quint64 localNs) const;
+
+private:
+    static quint64 fingerprint(const CANManager::CANMessage& msg);
+    void sortReference();
+
+    QHash<quint64, QVector<quint64>> m_reference;   ///< fingerprint → sorted times
+    bool    m_sorted = true;
+
+    // Bootstrap: offsets of local frames with a unique reference fingerprint
+    QVector<qint64> m_bootstrap;
+    bool    m_bootstrapped = false;
+    qint64  m_coarseOffset = 0;
+
+    // Streaming regression of  offset(x) = ref − local  over  x = local − x0
+    quint64 m_x0    = 0;
+    quint64 m_n     = 0;
+    double  m_meanX = 0.0, m_meanY = 0.0;
+    double  m_cxx   = 0.0, m_cxy   = 0.0, m_cyy = 0.0;
+};
@@ -0,0 +1,122 @@
+/**
+ * @file DecodeMemo.cpp
+ * @brief Sharded (channel, id, payload) → decoded rows cache.
+ */
+
+#include "trace/DecodeMemo.h"
+#include "metrics/MetricsRegistry.h"
+
+#include <cstring>
+
+using namespace CANManager;
+
+static_assert(DecodeMemo::SHARDS == 16, "shardFor() takes the top four hash bits");
+
+DecodeMemo::DecodeMemo()
+{
+    // Every memo feeds the same two series; the registry hands back the
+    // existing counters when a new DBC snapshot creates a new memo.
+    auto& metrics = MetricsRegistry::instance();
+    m_hits   = metrics.counter("autolens_decode_memo_lookups",
+                               "Signal decodes served from / missing in the decode memo",
+                               "result=\"hit\"");
+    m_misses = metrics.counter("autolens_decode_memo_lookups",
+                               "Signal decodes served from / missing in the decode memo",
+                               "result=\"miss\"");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Key
+// ─────────────────────────────────────────────────────────────────────────────
+
+quint64 DecodeMemo::hashOf(const CANMessage& msg, int len)
+{
+    // FNV-1a over the key fields, then a final avalanche so the top bits
+    // (used for the shard) depend on every input byte.
+    quint64 h = 1469598103934665603ull;
+    auto mix = [&h](uint8_t b) { h = (h ^ b) * 1099511628211ull; };
+    for (int i = 0; i < 4; ++i)
+        mix(uint8_t(msg.id >> (8 * i)));
+    mix(msg.channel);
+    mix(uint8_t(len));
+    for (int i = 0; i < len; ++i)
+        mix(msg.data[i]);
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+bool DecodeMemo::matches(const Entry& e, const CANMessage& msg, int len)
+{
+    return e.used && e.id == msg.id && e.channel == msg.channel && e.len == len
+        && memcmp(e.data, msg.data, size_t(len)) == 0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  lookup / insert (any decode worker)
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool DecodeMemo::lookup(const CANMessage& msg, int len,
+                        QString& name, QVector<SignalRow>& rows)
+{
+    const quint64 hash = hashOf(msg, len);
+    Shard& shard = shardFor(hash);
+    {
+        QMutexLocker lock(&shard.mutex);
+        const auto it = shard.index.constFind(hash);
+        if (it != shard.index.cend()) {
+            const Entry& e = shard.entries[it.value()];
+            if (matches(e, msg, len)) {
+                name = e.name;     // shared copies — no allocation
+                rows = e.rows;
+                lock.unlock();
+                m_hits->add();
+                return true;
+            }
+        }
+    }
+    m_misses->add();
+    return false;
+}
+
+void DecodeMemo::insert(const CANMessage& msg, int len,
+                        const QString& name, const QVector<SignalRow>& rows)
+{
+    if (len < 0 || len > 64)
+        return;
+
+    const quint64 hash = hashOf(msg, len);
+    Shard& shard = shardFor(hash);
+    QMutexLocker lock(&shard.mutex);
+
+    // Same hash already cached: either another worker decoded the same
+    // payload meanwhile (keep it), or a different payload collided — then
+    // the newer one takes the slot, so a colliding payload still gets cached.
+    int pos;
+    const auto it = shard.index.constFind(hash);
+    if (it != shard.index.cend()) {
+        pos = it.value();
+        if (matches(shard.entries[pos], msg, len))
+            return;
+    } else if (shard.entries.size() < SHARD_CAPACITY) {
+        pos = shard.entries.size();
+        shard.entries.append(Entry{});
+    } else {
+        pos = shard.next;
+        shard.next = (shard.next + 1) % SHARD_CAPACITY;
+        shard.index.remove(shard.entries[pos].hash);
+    }
+
+    Entry& e = shard.entries[pos];
+    e.hash    = hash;
+    e.id      = msg.id;
+    e.channel = msg.channel;
+    e.len     = uint8_t(len);
+    e.used    = true;
+    memcpy(e.data, msg.data, size_t(len));
+    e.name    = name;
+    e.rows    = rows;
+    shard.index.insert(hash, pos);
+}
@@ -0,0 +1,91 @@
+#pragma once
+/**
+ * @file DecodeMemo.h
+ * @brief Bounded cache of decoded signal rows, shared by the decode workers.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Most periodic frames repeat a payload their ID has carried before —
+ *  status words, configuration frames, counters that wrap.  Decoding one
+ *  means QString::number, unit concatenation and a value-table lookup for
+ *  every signal, and it yields exactly the same rows each time.  The memo
+ *  maps (channel, id, payload) to the rows built the first time; a hit
+ *  costs one hash over the payload plus two reference-count increments
+ *  (QString / QVector are implicitly shared).
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  LAYOUT
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  SHARDS independent shards, chosen by the top bits of the payload hash,
+ *  each a fixed ring of SHARD_CAPACITY entries under its own short mutex —
+ *  decode workers rarely contend on the same shard.  A full shard
+ *  overwrites its oldest entry (FIFO), so memory stays bounded whatever
+ *  the traffic.  Entries keep the payload bytes and are compared on hit,
+ *  so a hash collision is a miss, never a wrong decode; insert() then lets
+ *  the newer payload take the slot.
+ *
+ *  A memo belongs to one DBC snapshot: DecodePipeline::setDatabase()
+ *  starts a new one, and jobs keep theirs alive like they keep the DBC.
+ *
+ *  Hits and misses are exported as autolens_decode_memo_lookups{result}.
+ */
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <array>
+
+#include "trace/TraceModel.h"   // SignalRow, CANMessage
+
+class MetricCounter;
+
+class DecodeMemo
+{
+public:
+    static constexpr int SHARDS         = 16;
+    static constexpr int SHARD_CAPACITY = 1024;
+
+    DecodeMemo();
+
+    /**
+     * @brief Fetch the decode of @p msg (first @p len payload bytes).
+     * @return false on a miss; @p name / @p rows are untouched then.
+     */
+    bool lookup(const CANManager::CANMessage& msg, int len,
+                QString& name, QVector<SignalRow>& rows);
+
+    /** Remember the decode of @p msg; evicts the shard's oldest entry if full. */
+    void insert(const CANManager::CANMessage& msg, int len,
+                const QString& name, const QVector<SignalRow>& rows);
+
+private:
+    struct Entry
+    {
+        quint64  hash    = 0;
+        uint32_t id      = 0;
+        uint8_t  channel = 0;
+        uint8_t  len     = 0;
+        bool     used    = false;
+        uint8_t  data[64] = {};
+        QString            name;
+        QVector<SignalRow> rows;
+    };
+
+    struct Shard
+    {
+        QMutex               mutex;
+        QHash<quint64, int>  index;     ///< hash -> position in entries
+        QVector<Entry>       entries;   ///< ring, SHARD_CAPACITY once full
+        int                  next = 0;  ///< oldest entry once full
+    };
+
+    static quint64 hashOf(const CANManager::CANMessage& msg, int len);
+    static bool    matches(const Entry& e, const CANManager::CANMessage& msg, int len);
+    Shard&         shardFor(quint64 hash) { return m_shards[hash >> 60]; }
+
+    std::array<Shard, SHARDS> m_shards;
+    MetricCounter*            m_hits   = nullptr;
+    MetricCounter*            m_misses = nullptr;
+};
@@ -0,0 +1,273 @@
+/**
+ * @file DecodePipeline.cpp
+ * @brief Long-lived decode workers fed by lock-free job queues.
+ */
+
+#include "trace/DecodePipeline.h"
+#include "trace/TraceEntryBuilder.h"
+#include "metrics/MetricsRegistry.h"
+#include "util/ThreadPlacement.h"
+
+#include <QDebug>
+#include <QMetaObject>
+
+#include <chrono>
+
+using namespace CANManager;
+using namespace DBCManager;
+
+namespace {
+
+qint64 steadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Constructor / Destructor
+// ─────────────────────────────────────────────────────────────────────────────
+
+DecodePipeline::DecodePipeline(QObject* parent)
+    : QObject(parent)
+    , m_db(std::make_shared<const DBCDatabase>())
+    , m_memo(std::make_shared<DecodeMemo>())
+{
+    auto& metrics = MetricsRegistry::instance();
+    m_metricDecoded = metrics.counter("autolens_decode_frames",
+                                      "Frames decoded by the trace pipeline");
+    m_metricBusyNs  = metrics.counter("autolens_decode_busy_seconds",
+                                      "Worker time spent decoding", {}, 1e-9);
+    m_metricLatency = metrics.histogram("autolens_decode_latency_seconds",
+                                        "Time from submit to collection by the UI thread, per job",
+                                        MetricsRegistry::latencyBoundsNs(), {}, 1e-9);
+}
+
+DecodePipeline::~DecodePipeline()
+{
+    stop();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Worker lifecycle
+// ─────────────────────────────────────────────────────────────────────────────
+
+void DecodePipeline::start(int workerCount)
+{
+    if (isRunning()) return;
+
+    // WHY half the cores: the receive thread, the UI/render thread and the
+    // QML scene graph need their own cores.  Decode is a few µs per frame,
+    // so 2–4 workers keep up with a fully loaded CAN FD bus.
+    if (workerCount <= 0)
+        workerCount = QThread::idealThreadCount() / 2;
+    workerCount = qBound(1, workerCount, MAX_WORKERS);
+
+    m_stopping.store(false, std::memory_order_relaxed);
+
+    for (int i = 0; i < workerCount; ++i) {
+        QThread* t = QThread::create([this]() { workerLoop(); });
+        t->setObjectName(QStringLiteral("AutoLens_Decode_%1").arg(i));
+        t->start(QThread::NormalPriority);
+        m_workers.append(t);
+    }
+
+    qDebug() << "[DecodePipeline] Started" << workerCount << "decode worker(s)";
+}
+
+void DecodePipeline::stop()
+{
+    if (!isRunning()) return;
+
+    m_stopping.store(true, std::memory_order_release);
+    m_workAvailable.release(m_workers.size());   // wake everyone so they see m_stopping
+
+    for (QThread* t : m_workers) {
+        t->wait();
+        delete t;
+    }
+    m_workers.clear();
+
+    // Workers are joined — nothing else touches the queues now.
+    Job* job = nullptr;
+    while (m_jobQueue.tryPop(job))  delete job;
+    while (m_doneQueue.tryPop(job)) delete job;
+    for (auto& kv : m_reorder)      delete kv.second;
+    m_reorder.clear();
+    qDeleteAll(m_freeJobs);
+    m_freeJobs.clear();
+    m_jobsAllocated = 0;
+
+    // Leftover permits would make restarted workers spin once per permit.
+    while (m_workAvailable.tryAcquire()) {}
+
+    m_nextSeq = m_nextSubmitSeq;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  DBC snapshot
+// ─────────────────────────────────────────────────────────────────────────────
+
+void DecodePipeline::setDatabase(const DBCDatabase& db)
+{
+    // Jobs already queued keep their own shared_ptr to the old snapshot.
+    m_db   = std::make_shared<const DBCDatabase>(db);
+    m_memo = std::make_shared<DecodeMemo>();   // old rows are wrong for the new DBC
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Job pool (UI thread)
+// ─────────────────────────────────────────────────────────────────────────────
+
+DecodePipeline::Job* DecodePipeline::acquireJob()
+{
+    if (!m_freeJobs.isEmpty())
+        return m_freeJobs.takeLast();
+
+    // Capping the number of Job objects at MAX_JOBS is what guarantees the
+    // two MpmcQueues (capacity MAX_JOBS each) can never overflow on push.
+    if (m_jobsAllocated >= MAX_JOBS)
+        return nullptr;
+
+    ++m_jobsAllocated;
+    auto* job = new Job;
+    job->frames.reserve(JOB_FRAMES);
+    job->entries.reserve(JOB_FRAMES);
+    return job;
+}
+
+void DecodePipeline::recycleJob(Job* job)
+{
+    // clear() keeps capacity in Qt 6, so steady-state capture allocates
+    // nothing per flush — the vectors are reused job after job.
+    job->frames.clear();
+    job->entries.clear();
+    job->db.reset();
+    job->memo.reset();
+    m_freeJobs.append(job);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  submit — UI thread, never blocks
+// ─────────────────────────────────────────────────────────────────────────────
+
+int DecodePipeline::submit(QVector<CANMessage>& frames)
+{
+    if (frames.isEmpty() || !isRunning()) return 0;
+
+    const int total = frames.size();
+    int offset = 0;
+
+    while (offset < total) {
+        Job* job = acquireJob();
+        if (!job) break;   // ring full — caller keeps the rest for next tick
+
+        const int n = qMin(JOB_FRAMES, total - offset);
+        job->seq      = m_nextSubmitSeq++;
+        job->submitNs = steadyNs();
+        job->db       = m_db;
+        job->memo     = m_memo;
+        job->frames.append(frames.constData() + offset, n);
+
+        m_jobQueue.tryPush(std::move(job));   // cannot fail, see acquireJob()
+        m_workAvailable.release();
+        offset += n;
+    }
+
+    if (offset == total)
+        frames.clear();
+    else if (offset > 0)
+        frames.remove(0, offset);
+
+    return offset;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  workerLoop — decode thread body
+// ─────────────────────────────────────────────────────────────────────────────
+
+void DecodePipeline::workerLoop()
+{
+    ThreadPlacement::Scope placement(ThreadPlacement::Decode);
+    for (;;) {
+        m_workAvailable.acquire();
+        if (m_stopping.load(std::memory_order_acquire))
+            return;
+
+        Job* job = nullptr;
+        if (!m_jobQueue.tryPop(job))
+            continue;   // permit raced with another worker — harmless
+
+        const qint64 t0 = steadyNs();
+        const DBCDatabase* db = job->db.get();
+        DecodeMemo* memo = job->memo.get();
+        for (const CANMessage& msg : std::as_const(job->frames))
+            job->entries.append(TraceEntryBuilder::build(msg, db, memo));
+        m_metricBusyNs->add(quint64(steadyNs() - t0));
+        m_metricDecoded->add(quint64(job->frames.size()));
+
+        m_doneQueue.tryPush(std::move(job));
+
+        // One queued notification per burst: only the worker that flips the
+        // flag from false → true posts to the UI thread.
+        if (!m_notifyPending.exchange(true, std::memory_order_acq_rel)) {
+            QMetaObject::invokeMethod(this, [this]() {
+                m_notifyPending.store(false, std::memory_order_release);
+                emit batchesReady();
+            }, Qt::QueuedConnection);
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  takeCompleted — UI thread, reorders by sequence number
+// ─────────────────────────────────────────────────────────────────────────────
+
+int DecodePipeline::takeCompleted(QVector<TraceEntry>& out)
+{
+    Job* job = nullptr;
+    while (m_doneQueue.tryPop(job)) {
+        if (job->seq < m_nextSeq)
+            recycleJob(job);            // submitted before reset() — stale
+        else
+            m_reorder.emplace(job->seq, job);
+    }
+
+    // Size the in-order run first so @p out grows once per call, not per job.
+    int     pending = 0;
+    quint64 seq     = m_nextSeq;
+    for (auto scan = m_reorder.begin();
+         scan != m_reorder.end() && scan->first == seq; ++scan, ++seq)
+        pending += scan->second->entries.size();
+    if (pending > 0)
+        out.reserve(out.size() + pending);
+
+    int appended = 0;
+    const qint64 nowNs = steadyNs();
+    auto it = m_reorder.begin();
+    while (it != m_reorder.end() && it->first == m_nextSeq) {
+        Job* ready = it->second;
+        m_metricLatency->observe(quint64(qMax<qint64>(0, nowNs - ready->submitNs)));
+        for (TraceEntry& e : ready->entries)
+            out.append(std::move(e));
+        appended += ready->entries.size();
+
+        recycleJob(ready);
+        it = m_reorder.erase(it);
+        ++m_nextSeq;
+    }
+    return appended;
+}
+
+void DecodePipeline::reset()
+{
+    for (auto& kv : m_reorder)
+        recycleJob(kv.second);
+    m_reorder.clear();
+
+    // Everything submitted so far is now "old"; it will be recycled as it
+    // trickles out of the workers instead of reaching the model.
+    m_nextSeq = m_nextSubmitSeq;
+}
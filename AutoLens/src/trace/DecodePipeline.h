@@ -0,0 +1,172 @@
+#pragma once
+/**
+ * @file DecodePipeline.h
+ * @brief Persistent decode workers between frame capture and TraceModel.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY a persistent pipeline instead of QtConcurrent::blockingMapped?
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  The old flush path called blockingMapped every 50 ms.  The UI thread sat
+ *  in that call until every worker finished, and each call allocated a set
+ *  of futures plus a fresh result QVector.  Under bus load that wait showed
+ *  up directly as dropped render frames.
+ *
+ *  Now the UI thread only *submits* work and later *collects* finished
+ *  work — it never waits on decoding:
+ *
+ *    UI thread                 worker threads (N)            UI thread
+ *    ─────────                 ──────────────────            ─────────
+ *    submit(frames)
+ *      split into jobs ──► m_jobQueue ──► TraceEntryBuilder ──► m_doneQueue
+ *      seq = 0,1,2,…        (lock-free)    ::build() per frame   (lock-free)
+ *                                                                   │
+ *                                             batchesReady() ◄──────┘
+ *                                             takeCompleted()
+ *                                               reorder by seq → entries
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  ORDERING
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Workers finish jobs in any order.  Every job carries the sequence number
+ *  it was submitted with; takeCompleted() parks early arrivals in a small
+ *  reorder map and only releases the contiguous run starting at m_nextSeq,
+ *  so TraceModel always sees frames in capture order.
+ *
+ *  reset() moves m_nextSeq past everything already submitted — jobs still
+ *  in flight then carry a stale seq and are silently recycled.  Used by
+ *  clearTrace() so old frames cannot reappear after a clear.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  DBC SNAPSHOTS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Workers must never read AppController::m_dbcDb directly — the UI thread
+ *  rebuilds it when the channel config changes.  setDatabase() stores an
+ *  immutable copy in a shared_ptr; each job captures the snapshot that was
+ *  current at submit time and keeps it alive until the job is recycled.
+ *  DBCDatabase is built from implicitly-shared Qt containers, so the copy
+ *  is cheap.  A DecodeMemo travels with each snapshot, so repeated payloads
+ *  are decoded once per DBC, not once per frame.
+ *
+ *  Threading contract: submit(), reset(), setDatabase() and takeCompleted()
+ *  are UI-thread only.  Everything else runs on the workers.
+ */
+
+#include <QObject>
+#include <QSemaphore>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <map>
+#include <memory>
+
+#include "trace/DecodeMemo.h"
+#include "trace/TraceModel.h"
+#include "util/MpmcQueue.h"
+
+class MetricCounter;
+class MetricHistogram;
+
+class DecodePipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** Frames per job — small enough that a big flush spreads over all workers. */
+    static constexpr int JOB_FRAMES    = 256;
+    /** Job slots in flight (submitted + finished but not yet collected). */
+    static constexpr int MAX_JOBS      = 1024;
+    /** Upper bound on worker threads (decode is cheap; more just adds wakeups). */
+    static constexpr int MAX_WORKERS   = 4;
+
+    explicit DecodePipeline(QObject* parent = nullptr);
+    ~DecodePipeline() override;
+
+    /**
+     * @brief Spawn the worker threads (idempotent).
+     * @param workerCount  0 = pick from QThread::idealThreadCount().
+     */
+    void start(int workerCount = 0);
+
+    /** Stop and join all workers; pending jobs are discarded. */
+    void stop();
+
+    bool isRunning() const { return !m_workers.isEmpty(); }
+    int  workerCount() const { return m_workers.size(); }
+
+    /** Replace the DBC snapshot used for jobs submitted from now on. */
+    void setDatabase(const DBCManager::DBCDatabase& db);
+
+    /**
+     * @brief Hand a batch of frames to the workers.  Never blocks.
+     *
+     * Frames are consumed from the front of @p frames.  If the job ring is
+     * full, the remaining frames are left in @p frames so the caller can
+     * retry on the next tick (back-pressure instead of unbounded growth).
+     *
+     * @return Number of frames accepted.
+     */
+    int submit(QVector<CANManager::CANMessage>& frames);
+
+    /**
+     * @brief Collect finished entries in capture order.
+     *
+     * Appends (by move) to @p out every entry whose job is next in sequence.
+     * @return Number of entries appended.
+     */
+    int takeCompleted(QVector<TraceEntry>& out);
+
+    /** Drop everything in flight; see ORDERING above. */
+    void reset();
+
+    /** Jobs submitted but not yet collected (approximate, for stats). */
+    int jobsInFlight() const
+    {
+        return static_cast<int>(m_nextSubmitSeq - m_nextSeq);
+    }
+
+signals:
+    /**
+     * @brief At least one job finished since the last notification.
+     *
+     * Coalesced: many finished jobs produce one queued emission, so the UI
+     * event queue is not flooded at high frame rates.
+     */
+    void batchesReady();
+
+private:
+    struct Job
+    {
+        quint64                                          seq = 0;
+        qint64                                           submitNs = 0;   ///< steady clock, for latency
+        std::shared_ptr<const DBCManager::DBCDatabase>   db;
+        std::shared_ptr<DecodeMemo>                      memo;   ///< belongs to db
+        QVector<CANManager::CANMessage>                  frames;
+        QVector<TraceEntry>                              entries;
+    };
+
+    void workerLoop();
+    Job* acquireJob();
+    void recycleJob(Job* job);
+
+    // ── Shared between UI thread and workers ────────────────────────────────
+    MpmcQueue<Job*>    m_jobQueue{MAX_JOBS};    ///< UI → workers
+    MpmcQueue<Job*>    m_doneQueue{MAX_JOBS};   ///< workers → UI
+    QSemaphore         m_workAvailable;         ///< one permit per queued job
+    std::atomic<bool>  m_stopping{false};
+    std::atomic<bool>  m_notifyPending{false};  ///< coalesces batchesReady()
+
+    // ── Metrics (registry-owned, relaxed atomics) ───────────────────────────
+    MetricCounter*     m_metricDecoded = nullptr;   ///< frames decoded
+    MetricCounter*     m_metricBusyNs  = nullptr;   ///< worker time spent decoding
+    MetricHistogram*   m_metricLatency = nullptr;   ///< submit → collect, per job
+
+    // ── UI-thread only ───────────────────────────────────────────────────────
+    QVector<QThread*>                               m_workers;
+    std::shared_ptr<const DBCManager::DBCDatabase>  m_db;
+    std::shared_ptr<DecodeMemo>                     m_memo;
+    std::map<quint64, Job*>                         m_reorder;   ///< finished early
+    QVector<Job*>                                   m_freeJobs;  ///< recycled, capacity kept
+    quint64                                         m_nextSubmitSeq = 0;
+    quint64                                         m_nextSeq       = 0;
+    int                                             m_jobsAllocated = 0;   ///< never exceeds MAX_JOBS
+};
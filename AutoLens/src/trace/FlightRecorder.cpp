@@ -0,0 +1,364 @@
+/**
+ * @file FlightRecorder.cpp
+ * @brief Frame packing, segment ring, background compression and BLF dumps.
+ */
+
+#include "trace/FlightRecorder.h"
+#include "trace/FramePacking.h"
+#include "trace/TraceExporter.h"
+#include "util/ThreadPlacement.h"
+
+#include <QDebug>
+#include <QMetaObject>
+#include <QThread>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace CANManager;
+using namespace FramePacking;
+
+namespace {
+
+constexpr int kMaxSealedBacklog = 64;   ///< segments waiting for the compressor
+constexpr int kMinRingSlots     = 16;
+constexpr int kCompressLevel    = 1;    ///< zlib: fastest; CAN payloads compress well anyway
+
+qint64 steadyMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Lifecycle (UI thread)
+// ─────────────────────────────────────────────────────────────────────────────
+
+FlightRecorder::FlightRecorder(QObject* parent)
+    : QObject(parent)
+    , m_trigger(std::make_shared<const Trigger>())
+{
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    stop();
+    if (m_dumpThread) {
+        m_dumpThread->wait();   // it references us — let it finish first
+        delete m_dumpThread;
+    }
+}
+
+void FlightRecorder::start(int windowMinutes, qint64 budgetMB)
+{
+    stop();
+
+    m_windowMin   = qBound(1, windowMinutes, MAX_WINDOW_MIN);
+    m_budgetBytes = qMax<qint64>(1, budgetMB) * 1024 * 1024;
+
+    // Enough slots for segments compressing 8:1 to fill the budget; the
+    // byte budget, not the slot count, is the usual limit.
+    const int slotCount = int(qMax<qint64>(kMinRingSlots, m_budgetBytes / (SEGMENT_RAW_BYTES / 8)));
+    {
+        QMutexLocker lock(&m_ringMutex);
+        m_ring = QVector<Segment>(slotCount);
+        m_ringHead = m_ringCount = 0;
+        m_ringBytes = 0;
+        m_evicted   = 0;
+    }
+    {
+        QMutexLocker lock(&m_stageMutex);
+        m_stage = Segment{};
+        m_stage.data.reserve(SEGMENT_RAW_BYTES + MAX_PACKED_FRAME);
+    }
+    m_framesRecorded.store(0);
+    m_stopCompressor = false;
+
+    m_compressor = QThread::create([this]() { compressorLoop(); });
+    m_compressor->setObjectName("AutoLens_FlightRecorder");
+    m_compressor->start(QThread::LowPriority);
+
+    m_running.store(true);
+    qDebug() << "[FlightRecorder] Recording the last" << m_windowMin << "min within"
+             << budgetMB << "MiB," << slotCount << "segment slots";
+}
+
+void FlightRecorder::stop()
+{
+    if (!m_compressor)
+        return;
+
+    m_running.store(false);
+    {
+        QMutexLocker lock(&m_sealMutex);
+        m_stopCompressor = true;
+        m_sealReady.wakeAll();
+    }
+    m_compressor->wait();
+    delete m_compressor;
+    m_compressor = nullptr;
+
+    // A record() that passed the m_running check may still be in the
+    // staging section; taking the locks in order waits it out.
+    QMutexLocker stage(&m_stageMutex);
+    QMutexLocker sealed(&m_sealMutex);
+    QMutexLocker ring(&m_ringMutex);
+    m_stage = Segment{};
+    m_sealed.clear();
+    m_ring.clear();
+    m_ringHead = m_ringCount = 0;
+    m_ringBytes = 0;
+    qDebug() << "[FlightRecorder] Stopped";
+}
+
+void FlightRecorder::setTrigger(const QSet<uint32_t>& ids, bool onErrorFrame)
+{
+    auto trigger = std::make_shared<Trigger>();
+    trigger->ids          = ids;
+    trigger->onErrorFrame = onErrorFrame;
+    std::atomic_store(&m_trigger, std::shared_ptr<const Trigger>(std::move(trigger)));
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  record — driver thread(s)
+// ─────────────────────────────────────────────────────────────────────────────
+
+void FlightRecorder::record(const CANMessage& msg)
+{
+    if (!m_running.load(std::memory_order_relaxed))
+        return;
+
+    checkTrigger(msg);
+
+    // Pack outside the lock; only the delta needs the previous timestamp.
+    uint8_t tail[MAX_PACKED_FRAME];
+    uint8_t* p = packBody(tail, msg);
+
+    QMutexLocker lock(&m_stageMutex);
+    if (!m_running.load(std::memory_order_relaxed))
+        return;   // stop() got here first
+
+    if (m_stage.frames == 0) {
+        m_stage.firstNs = msg.timestamp;
+        m_stagePrevNs   = msg.timestamp;
+    }
+    uint8_t head[10];
+    uint8_t* h = putVarint(head, zigzag(qint64(msg.timestamp - m_stagePrevNs)));
+    m_stage.data.append(reinterpret_cast<const char*>(head), int(h - head));
+    m_stage.data.append(reinterpret_cast<const char*>(tail), int(p - tail));
+    m_stagePrevNs  = msg.timestamp;
+    m_stage.lastNs = qMax(m_stage.lastNs, msg.timestamp);
+    ++m_stage.frames;
+
+    if (m_stage.data.size() >= SEGMENT_RAW_BYTES)
+        sealLocked();
+
+    m_framesRecorded.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FlightRecorder::checkTrigger(const CANMessage& msg)
+{
+    const auto trigger = std::atomic_load(&m_trigger);
+    const bool hit = (msg.isError && trigger->onErrorFrame)
+                  || (!trigger->ids.isEmpty() && trigger->ids.contains(msg.id));
+    if (!hit)
+        return;
+
+    // Hold-off: one trigger per TRIGGER_HOLDOFF_MS, whichever thread wins.
+    const qint64 now  = steadyMs();
+    qint64       last = m_lastTriggerMs.load(std::memory_order_relaxed);
+    if (last != 0 && now - last < TRIGGER_HOLDOFF_MS)
+        return;
+    if (!m_lastTriggerMs.compare_exchange_strong(last, now))
+        return;
+
+    emit triggered(msg.isError ? QString("error frame on CH%1").arg(msg.channel)
+                               : QString("ID 0x%1 on CH%2").arg(msg.id, 0, 16).arg(msg.channel));
+}
+
+void FlightRecorder::sealLocked()
+{
+    if (m_stage.frames == 0)
+        return;
+
+    m_stage.rawBytes = m_stage.data.size();
+    {
+        QMutexLocker lock(&m_sealMutex);
+        // Compressor far behind (should not happen at CAN rates): drop the
+        // oldest waiting segment rather than grow without bound.  Index 0
+        // is being compressed right now, so drop the one after it.
+        if (m_sealed.size() >= kMaxSealedBacklog) {
+            m_sealed.remove(1);
+            QMutexLocker ring(&m_ringMutex);
+            ++m_evicted;
+        }
+        m_sealed.append(std::move(m_stage));
+        m_sealReady.wakeOne();
+    }
+
+    m_stage = Segment{};
+    m_stage.data.reserve(SEGMENT_RAW_BYTES + MAX_PACKED_FRAME);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Compressor thread
+// ─────────────────────────────────────────────────────────────────────────────
+
+void FlightRecorder::compressorLoop()
+{
+    ThreadPlacement::Scope placement(ThreadPlacement::Logging);
+    for (;;) {
+        QByteArray raw;
+        {
+            QMutexLocker lock(&m_sealMutex);
+            while (m_sealed.isEmpty() && !m_stopCompressor)
+                m_sealReady.wait(&m_sealMutex);
+            if (m_stopCompressor)
+                return;
+            raw = m_sealed.front().data;   // shared, not copied
+        }
+
+        QByteArray packed = qCompress(raw, kCompressLevel);
+
+        // Hand-over under both locks so a dump snapshot sees the segment in
+        // exactly one place — sealed or ring.
+        QMutexLocker sealed(&m_sealMutex);
+        QMutexLocker ring(&m_ringMutex);
+        Segment seg  = std::move(m_sealed.front());
+        m_sealed.removeFirst();
+        seg.data       = std::move(packed);
+        seg.compressed = true;
+        pushSegment(std::move(seg));
+    }
+}
+
+void FlightRecorder::pushSegment(Segment&& seg)
+{
+    if (m_ring.isEmpty())
+        return;   // stopped
+
+    if (m_ringCount == m_ring.size())
+        retireOldest();
+
+    const int slot = (m_ringHead + m_ringCount) % m_ring.size();
+    m_ringBytes += seg.data.size();
+    m_ring[slot] = std::move(seg);
+    ++m_ringCount;
+
+    // Byte budget and time window, both measured from the newest segment.
+    const quint64 windowNs = quint64(m_windowMin) * 60ull * 1000000000ull;
+    const quint64 newestNs = m_ring[slot].lastNs;
+    while (m_ringCount > 1
+           && (m_ringBytes > m_budgetBytes
+               || m_ring[m_ringHead].lastNs + windowNs < newestNs))
+        retireOldest();
+}
+
+void FlightRecorder::retireOldest()
+{
+    Segment& oldest = m_ring[m_ringHead];
+    m_ringBytes -= oldest.data.size();
+    oldest = Segment{};   // releases the buffer
+    m_ringHead = (m_ringHead + 1) % m_ring.size();
+    --m_ringCount;
+    ++m_evicted;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Dump
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool FlightRecorder::dump(const QString& path)
+{
+    if (m_dumpThread || !isRunning())
+        return false;
+
+    // Snapshot: QByteArray copies only bump reference counts.  Locks in
+    // pipeline order, held just for the copies.
+    QVector<Segment> segments;
+    {
+        QMutexLocker stage(&m_stageMutex);
+        QMutexLocker sealed(&m_sealMutex);
+        QMutexLocker ring(&m_ringMutex);
+        segments.reserve(m_ringCount + m_sealed.size() + 1);
+        for (int i = 0; i < m_ringCount; ++i)
+            segments.append(m_ring[(m_ringHead + i) % m_ring.size()]);
+        segments.append(m_sealed);
+        if (m_stage.frames > 0) {
+            Segment tail = m_stage;
+            tail.data.detach();   // record() keeps appending to the original
+            segments.append(std::move(tail));
+        }
+    }
+    if (segments.isEmpty())
+        return false;
+
+    const quint64 windowNs = quint64(m_windowMin) * 60ull * 1000000000ull;
+    m_dumpThread = QThread::create([this, segments, path, windowNs]() {
+        ThreadPlacement::Scope placement(ThreadPlacement::Logging);
+        quint64 newestNs = 0;
+        int     total    = 0;
+        for (const Segment& seg : segments) {
+            newestNs = qMax(newestNs, seg.lastNs);
+            total   += seg.frames;
+        }
+        const quint64 fromNs = newestNs > windowNs ? newestNs - windowNs : 0;
+
+        QVector<CANMessage> frames;
+        frames.reserve(total);
+        for (const Segment& seg : segments)
+            if (seg.lastNs >= fromNs)
+                unpack(seg, frames);
+        frames.erase(std::remove_if(frames.begin(), frames.end(),
+                                    [fromNs](const CANMessage& m) { return m.timestamp < fromNs; }),
+                     frames.end());
+
+        const QString error = TraceExporter::saveAsBLF(path, frames);
+        const int     count = frames.size();
+        QMetaObject::invokeMethod(this, [this, path, error, count]() {
+            m_dumpThread->wait();
+            delete m_dumpThread;
+            m_dumpThread = nullptr;
+            emit dumpFinished(path, error, count);
+        }, Qt::QueuedConnection);
+    });
+    m_dumpThread->setObjectName("AutoLens_FlightDump");
+    m_dumpThread->start(QThread::LowPriority);
+    qDebug() << "[FlightRecorder] Dumping" << segments.size() << "segments to" << path;
+    return true;
+}
+
+void FlightRecorder::unpack(const Segment& seg, QVector<CANMessage>& out)
+{
+    const QByteArray raw = seg.compressed ? qUncompress(seg.data) : seg.data;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(raw.constData());
+    // Truncated segment: keep what decoded cleanly.
+    FramePacking::unpack(p, p + raw.size(), seg.firstNs, seg.frames, out);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Stats
+// ─────────────────────────────────────────────────────────────────────────────
+
+FlightRecorder::Stats FlightRecorder::stats() const
+{
+    Stats st;
+    st.frames = m_framesRecorded.load(std::memory_order_relaxed);
+
+    QMutexLocker lock(&m_ringMutex);
+    st.segments        = m_ringCount;
+    st.compressedBytes = m_ringBytes;
+    st.evicted         = m_evicted;
+    for (int i = 0; i < m_ringCount; ++i) {
+        const Segment& seg = m_ring[(m_ringHead + i) % m_ring.size()];
+        st.rawBytes += seg.rawBytes;
+    }
+    if (m_ringCount > 0) {
+        st.oldestNs = m_ring[m_ringHead].firstNs;
+        st.newestNs = m_ring[(m_ringHead + m_ringCount - 1) % m_ring.size()].lastNs;
+    }
+    return st;
+}
@@ -0,0 +1,175 @@
+#pragma once
+/**
+ * @file FlightRecorder.h
+ * @brief Always-on, bounded, compressed history of the last N minutes.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHERE IT SITS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    driver RX thread ── messageReceived ── direct ─► record()
+ *                                                       │ pack (≈ 15 B/frame)
+ *                                                       ▼
+ *                                                 staging segment
+ *                                                       │ full (256 KiB raw)
+ *                                                       ▼
+ *    compressor thread ◄──────────────────────── sealed queue
+ *          │ qCompress
+ *          ▼
+ *    segment ring  [oldest … newest]   fixed slot count, head index
+ *          │
+ *          └─ dump() ─► dump thread: inflate, unpack, window ─► BLF
+ *
+ *  Unlike TraceModel (a TraceEntry with pre-formatted strings and decoded
+ *  signals per frame — hundreds of bytes), the recorder keeps only what a
+ *  BLF needs, packed and zlib-compressed: a few bytes per frame.  It runs
+ *  whenever the driver delivers frames, measuring or not, so AutoLens can
+ *  sit on a bus for days and still hand over the minutes before a fault.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  THE RING
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Segments live in a fixed array used as a circular buffer: appending at
+ *  the head and retiring the tail are index moves, so overwriting the
+ *  oldest segment is O(1) no matter how long AutoLens has been running.
+ *  A segment is retired when the array is full, when the compressed total
+ *  exceeds the byte budget, or when its newest frame is older than the
+ *  window.  Memory is therefore bounded by the budget, whatever the
+ *  traffic.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  PACKED FRAME (inside a segment, before compression)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  See trace/FramePacking.h — varint timestamp delta and id, flags,
+ *  channel, dlc, data; about 15 bytes for a classic frame.  TraceJournal
+ *  writes the same encoding to disk.
+ *
+ *  Threading: record() from any thread; start/stop/setTrigger/dump on the
+ *  UI thread.  Staging, sealed queue and ring each have a short mutex,
+ *  always taken in that order.
+ */
+
+#include <QByteArray>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+
+#include "hardware/CANInterface.h"
+
+class QThread;
+
+class FlightRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int    SEGMENT_RAW_BYTES   = 256 * 1024;
+    static constexpr int    DEFAULT_WINDOW_MIN  = 10;
+    static constexpr int    MAX_WINDOW_MIN      = 24 * 60;
+    static constexpr qint64 DEFAULT_BUDGET_MB   = 256;
+    static constexpr int    TRIGGER_HOLDOFF_MS  = 10000;   ///< one trigger per 10 s at most
+
+    struct Stats
+    {
+        quint64 frames          = 0;   ///< recorded since start()
+        int     segments        = 0;   ///< compressed segments held
+        qint64  compressedBytes = 0;
+        qint64  rawBytes        = 0;   ///< packed size of the held segments
+        quint64 oldestNs        = 0;
+        quint64 newestNs        = 0;
+        quint64 evicted         = 0;   ///< segments retired since start()
+    };
+
+    explicit FlightRecorder(QObject* parent = nullptr);
+    ~FlightRecorder() override;
+
+    /** Start recording a @p windowMinutes window within @p budgetMB of memory. */
+    void start(int windowMinutes, qint64 budgetMB);
+    /** Stop and drop everything held. */
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_relaxed); }
+    int  windowMinutes() const { return m_windowMin; }
+
+    /** Frames with an id in @p ids (and error frames, if @p onErrorFrame) fire triggered(). */
+    void setTrigger(const QSet<uint32_t>& ids, bool onErrorFrame);
+
+    /** Append one frame.  Any thread; a few hundred ns, never blocks on I/O. */
+    void record(const CANManager::CANMessage& msg);
+
+    /**
+     * @brief Write the held window to the BLF file @p path in the background.
+     * @return false if a dump is already running or nothing is held.
+     * dumpFinished() reports the outcome.
+     */
+    bool dump(const QString& path);
+    bool isDumping() const { return m_dumpThread != nullptr; }
+
+    Stats stats() const;
+
+signals:
+    /** A trigger frame arrived (queued to the receiver's thread). */
+    void triggered(const QString& reason);
+    /** @p error is empty on success. */
+    void dumpFinished(const QString& path, const QString& error, int frames);
+
+private:
+    struct Segment
+    {
+        QByteArray data;           ///< packed frames, zlib-compressed once sealed
+        quint64    firstNs    = 0; ///< delta base and window start
+        quint64    lastNs     = 0;
+        int        frames     = 0;
+        int        rawBytes   = 0;
+        bool       compressed = false;
+    };
+
+    struct Trigger
+    {
+        QSet<uint32_t> ids;
+        bool           onErrorFrame = false;
+    };
+
+    void sealLocked();             ///< m_stageMutex held
+    void compressorLoop();
+    void pushSegment(Segment&& seg);   ///< m_ringMutex held
+    void retireOldest();               ///< m_ringMutex held
+    void checkTrigger(const CANManager::CANMessage& msg);
+
+    static void unpack(const Segment& seg, QVector<CANManager::CANMessage>& out);
+
+    std::atomic<bool>    m_running{false};
+    std::atomic<quint64> m_framesRecorded{0};
+    int                  m_windowMin = DEFAULT_WINDOW_MIN;
+    qint64               m_budgetBytes = DEFAULT_BUDGET_MB * 1024 * 1024;
+
+    // ── Trigger (swapped with std::atomic_load/store, like the gateway) ────────
+    std::shared_ptr<const Trigger> m_trigger;
+    std::atomic<qint64>  m_lastTriggerMs{0};
+
+    // ── Staging (record()) ──────────────────────────────────────────────────────
+    QMutex   m_stageMutex;
+    Segment  m_stage;
+    quint64  m_stagePrevNs = 0;
+
+    // ── Sealed, waiting for the compressor ─────────────────────────────────────
+    QMutex          m_sealMutex;
+    QWaitCondition  m_sealReady;
+    QVector<Segment> m_sealed;   ///< front is being compressed; removed once in the ring
+    bool            m_stopCompressor = false;
+    QThread*        m_compressor = nullptr;
+
+    // ── Ring ────────────────────────────────────────────────────────────────────
+    mutable QMutex   m_ringMutex;
+    QVector<Segment> m_ring;     ///< fixed capacity, circular
+    int              m_ringHead  = 0;   ///< index of the oldest segment
+    int              m_ringCount = 0;
+    qint64           m_ringBytes = 0;   ///< compressed bytes held
+    quint64          m_evicted   = 0;
+
+    QThread*         m_dumpThread = nullptr;   ///< UI thread only
+};
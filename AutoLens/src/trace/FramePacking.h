@@ -0,0 +1,118 @@
+#pragma once
+/**
+ * @file FramePacking.h
+ * @brief The packed frame encoding shared by FlightRecorder and TraceJournal.
+ *
+ *    varint  zigzag(timestamp − previous timestamp)   first frame: vs. block base
+ *    varint  id
+ *    u8      flags   bit0 ext, 1 FD, 2 BRS, 3 RTR, 4 error, 5 TX
+ *    u8      channel
+ *    u8      dlc
+ *    u8[n]   data    n = dataLength() (0 for remote/error frames)
+ *
+ *  packBody() writes everything after the timestamp delta, so callers can
+ *  pack outside their lock and add the delta once they hold it.
+ */
+
+#include <QVector>
+#include <cstdint>
+#include <cstring>
+
+#include "hardware/CANInterface.h"
+
+namespace FramePacking {
+
+constexpr int MAX_PACKED_FRAME = 10 + 5 + 3 + 64;   ///< delta + id + flags/channel/dlc + data
+
+enum : uint8_t {
+    FlagExt    = 0x01,
+    FlagFD     = 0x02,
+    FlagBRS    = 0x04,
+    FlagRemote = 0x08,
+    FlagError  = 0x10,
+    FlagTx     = 0x20,
+};
+
+inline uint8_t* putVarint(uint8_t* p, quint64 v)
+{
+    while (v >= 0x80) {
+        *p++ = uint8_t(v) | 0x80;
+        v >>= 7;
+    }
+    *p++ = uint8_t(v);
+    return p;
+}
+
+inline bool getVarint(const uint8_t*& p, const uint8_t* end, quint64& v)
+{
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const uint8_t b = *p++;
+        v |= quint64(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+inline quint64 zigzag(qint64 v)   { return (quint64(v) << 1) ^ quint64(v >> 63); }
+inline qint64  unzigzag(quint64 v) { return qint64(v >> 1) ^ -qint64(v & 1); }
+
+/** id, flags, channel, dlc, data → @p p; returns the end. */
+inline uint8_t* packBody(uint8_t* p, const CANManager::CANMessage& msg)
+{
+    const int len = (msg.isRemote || msg.isError) ? 0 : msg.dataLength();
+    const uint8_t flags = uint8_t((msg.isExtended  ? FlagExt    : 0)
+                                | (msg.isFD        ? FlagFD     : 0)
+                                | (msg.isBRS       ? FlagBRS    : 0)
+                                | (msg.isRemote    ? FlagRemote : 0)
+                                | (msg.isError     ? FlagError  : 0)
+                                | (msg.isTxConfirm ? FlagTx     : 0));
+    p = putVarint(p, msg.id);
+    *p++ = flags;
+    *p++ = msg.channel;
+    *p++ = msg.dlc;
+    memcpy(p, msg.data, size_t(len));
+    return p + len;
+}
+
+/**
+ * @brief Decode up to @p frames packed frames from [@p p, @p end).
+ * Stops at the first frame that does not decode cleanly (truncation).
+ * @return Frames appended to @p out.
+ */
+inline int unpack(const uint8_t* p, const uint8_t* end, quint64 baseNs, int frames,
+                  QVector<CANManager::CANMessage>& out)
+{
+    quint64 ts = baseNs;
+    int n = 0;
+    for (; n < frames && p < end; ++n) {
+        quint64 delta = 0, id = 0;
+        if (!getVarint(p, end, delta) || !getVarint(p, end, id) || end - p < 3)
+            break;
+
+        CANManager::CANMessage m;
+        ts += quint64(unzigzag(delta));
+        m.timestamp = ts;
+        m.id        = uint32_t(id);
+        const uint8_t flags = *p++;
+        m.channel   = *p++;
+        m.dlc       = *p++;
+        m.isExtended  = flags & FlagExt;
+        m.isFD        = flags & FlagFD;
+        m.isBRS       = flags & FlagBRS;
+        m.isRemote    = flags & FlagRemote;
+        m.isError     = flags & FlagError;
+        m.isTxConfirm = flags & FlagTx;
+
+        const int len = (m.isRemote || m.isError) ? 0 : m.dataLength();
+        if (end - p < len)
+            break;
+        memcpy(m.data, p, size_t(len));
+        p += len;
+        out.append(m);
+    }
+    return n;
+}
+
+} // namespace FramePacking
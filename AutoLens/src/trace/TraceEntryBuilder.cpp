@@ -0,0 +1,154 @@
+/**
+ * @file TraceEntryBuilder.cpp
+ * @brief Column formatting + DBC decode for one trace row.
+ */
+
+#include "trace/TraceEntryBuilder.h"
+#include "trace/DecodeMemo.h"
+#include "util/TextFormat.h"
+
+using namespace CANManager;
+using namespace DBCManager;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  build — one TraceEntry from a raw CANMessage
+// ─────────────────────────────────────────────────────────────────────────────
+
+TraceEntry TraceEntryBuilder::build(const CANMessage& msg, const DBCDatabase* db,
+                                    DecodeMemo* memo)
+{
+    // ── Interned strings for repeated values ─────────────────────────────
+    //  These are created once and reused across all frames.  QString uses
+    //  copy-on-write so assigning a static QString to a TraceEntry field
+    //  only increments a ref-count — zero allocation.
+    //
+    //  Function-local statics are initialised thread-safely (C++11 "magic
+    //  statics"), so concurrent decode workers may all call build().
+    static const QString s_can       = QStringLiteral("CAN");
+    static const QString s_canFD     = QStringLiteral("CAN FD");
+    static const QString s_canFdBrs  = QStringLiteral("CAN FD BRS");
+    static const QString s_error     = QStringLiteral("Error Frame");
+    static const QString s_remote    = QStringLiteral("Remote Frame");
+    static const QString s_rx        = QStringLiteral("Rx");
+    static const QString s_tx        = QStringLiteral("Tx");
+    // Channel number strings (1–4 cover all practical hardware)
+    static const QString s_ch1       = QStringLiteral("1");
+    static const QString s_ch2       = QStringLiteral("2");
+    static const QString s_ch3       = QStringLiteral("3");
+    static const QString s_ch4       = QStringLiteral("4");
+    // Common DLC strings (0–8 for classic CAN, plus common FD lengths)
+    static const QString s_dlc[9]    = {
+        QStringLiteral("0"), QStringLiteral("1"), QStringLiteral("2"),
+        QStringLiteral("3"), QStringLiteral("4"), QStringLiteral("5"),
+        QStringLiteral("6"), QStringLiteral("7"), QStringLiteral("8")
+    };
+
+    TraceEntry e;
+    e.msg = msg;
+
+    char buf[TextFormat::MAX_NUMBER_CHARS * 2];
+
+    // Col 0: Relative timestamp (hardware ns → display ms with 6 decimal places)
+    //        ns are already millionths of a ms — integer formatting, same
+    //        text as the former double(ns) / 1e6.
+    e.timeStr = QString::fromLatin1(buf, TextFormat::timestamp(buf, msg.timestamp, 6));
+
+    // Col 2: CAN ID — CANoe format "0C4h" (std) / "18DB33F1h" (ext)
+    {
+        int n = TextFormat::hexU32(buf, msg.id, msg.isExtended ? 8 : 3);
+        buf[n++] = 'h';
+        e.idStr = QString::fromLatin1(buf, n);
+    }
+
+    // Col 3: Channel number (interned for channels 1–4)
+    switch (msg.channel) {
+    case 1:  e.chnStr = s_ch1; break;
+    case 2:  e.chnStr = s_ch2; break;
+    case 3:  e.chnStr = s_ch3; break;
+    case 4:  e.chnStr = s_ch4; break;
+    default: e.chnStr = QString::number(msg.channel); break;
+    }
+
+    // Col 4: Event type (interned — priority: Error > Remote > FD variants > CAN)
+    if (msg.isError)
+        e.eventTypeStr = s_error;
+    else if (msg.isRemote)
+        e.eventTypeStr = s_remote;
+    else if (msg.isFD)
+        e.eventTypeStr = msg.isBRS ? s_canFdBrs : s_canFD;
+    else
+        e.eventTypeStr = s_can;
+
+    // Col 5: Direction (interned)
+    e.dirStr = msg.isTxConfirm ? s_tx : s_rx;
+
+    // Col 6: DLC (interned for 0–8, dynamic for FD extended lengths)
+    {
+        const int dlcVal = (msg.isFD && msg.dlc > 8)
+                               ? msg.dataLength()
+                               : static_cast<int>(msg.dlc);
+        if (dlcVal >= 0 && dlcVal <= 8)
+            e.dlcStr = s_dlc[dlcVal];
+        else
+            e.dlcStr = QString::number(dlcVal);
+    }
+
+    // Col 7: Data bytes (hex dump, space-separated, uppercase)
+    e.dataStr = TextFormat::hexBytes(msg.data, msg.dataLength());
+
+    // DBC decode → Col 1 name + signal child rows
+    if (db && !db->isEmpty()) {
+        const DBCMessage* dbcMsg = db->messageById(msg.id);
+        if (dbcMsg) {
+            const int dataLen = msg.dataLength();
+
+            // Same payload on the same ID as an earlier frame → same rows.
+            if (memo && memo->lookup(msg, dataLen, e.nameStr, e.decodedSignals))
+                return e;
+
+            e.nameStr = dbcMsg->name;
+            e.decodedSignals.reserve(dbcMsg->signalList.size());
+
+            // Evaluate mux selector first (muxIndicator == "M")
+            bool    hasMuxSelector = false;
+            int64_t activeMuxRaw   = -1;
+            for (const auto& sig : dbcMsg->signalList) {
+                if (sig.muxIndicator == QStringLiteral("M")) {
+                    hasMuxSelector = true;
+                    activeMuxRaw   = sig.rawValue(msg.data, dataLen);
+                    break;
+                }
+            }
+
+            for (const auto& sig : dbcMsg->signalList) {
+                const bool isMuxSel = (sig.muxIndicator == QStringLiteral("M"));
+                const bool isMuxed  = !sig.muxIndicator.isEmpty() && !isMuxSel;
+
+                // Skip muxed signals not belonging to the active mux branch
+                if (isMuxed && hasMuxSelector && sig.muxValue >= 0
+                    && sig.muxValue != activeMuxRaw)
+                    continue;
+
+                const int64_t rawValue     = sig.rawValue(msg.data, dataLen);
+                const double  physicalVal  = sig.decode(msg.data, dataLen);
+
+                QString valueText = QString::number(physicalVal, 'g', 8);
+                if (!sig.unit.isEmpty()) valueText += " " + sig.unit;
+                if (sig.valueDescriptions.contains(rawValue))
+                    valueText += QString(" (%1)").arg(sig.valueDescriptions.value(rawValue));
+
+                SignalRow sr;
+                sr.name     = sig.name;
+                sr.valueStr = valueText;
+                sr.rawStr   = QString("0x%1").arg(rawValue, 0, 16, QChar('0')).toUpper();
+                sr.value    = physicalVal;
+                e.decodedSignals.append(sr);
+            }
+
+            if (memo)
+                memo->insert(msg, dataLen, e.nameStr, e.decodedSignals);
+        }
+    }
+
+    return e;
+}
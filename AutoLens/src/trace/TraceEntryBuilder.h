@@ -0,0 +1,42 @@
+#pragma once
+/**
+ * @file TraceEntryBuilder.h
+ * @brief Turns a raw CANMessage into a fully formatted TraceEntry.
+ *
+ * This is the "decode stage" of the trace pipeline: column string
+ * formatting plus DBC signal decoding (including multiplexed signals).
+ *
+ * WHY a stateless helper instead of an AppController member: the decode
+ * workers (DecodePipeline) run it on their own threads against an
+ * immutable DBC snapshot.  Keeping it free of AppController state makes
+ * that thread-safety obvious — the only inputs are the frame and the
+ * database pointer passed in.
+ */
+
+#include "trace/TraceModel.h"   // TraceEntry, SignalRow, CANMessage, DBCDatabase
+
+class DecodeMemo;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  TraceEntryBuilder — stateless (all methods are static)
+// ─────────────────────────────────────────────────────────────────────────────
+
+class TraceEntryBuilder
+{
+public:
+    /**
+     * @brief Build the display entry for one frame.
+     *
+     * @param msg  Raw frame from the driver or importer.
+     * @param db   Decode database, or nullptr / empty for "no DBC".
+     *             Only read — safe to share between threads.
+     * @param memo Optional decode memo for @p db (see DecodeMemo.h);
+     *             repeated payloads then reuse the rows built before.
+     */
+    static TraceEntry build(const CANManager::CANMessage& msg,
+                            const DBCManager::DBCDatabase* db,
+                            DecodeMemo* memo = nullptr);
+
+private:
+    TraceEntryBuilder() = delete;
+};
@@ -11,8 +11,10 @@
  *  way to write typed binary data with explicit byte ordering.
  *
  *  QDataStream << quint32 writes 4 bytes in the chosen byte order.
- *  QFile::seek() lets us jump back to fill in fields we only know at the end
- *  (e.g., objectCount and last-timestamp in the BLF file header).
+ *  Both streams sit on an AsyncFileWriter instead of a QFile, so formatting
+ *  continues while earlier blocks are still being written.  That device is
+ *  append-only: fields we only know at the end (objectCount, last-timestamp
+ *  in the BLF file header) are registered with patch() and land in finish().
  *
  *  Timestamp conversion:
  *    CANMessage::timestamp  → nanoseconds from measurement start
@@ -21,24 +23,29 @@
  */
 
 #include "trace/TraceExporter.h"
+#include "util/AsyncFileWriter.h"
+#include "util/TextFormat.h"
 
 #include <QDataStream>
 #include <QDateTime>
-#include <QFile>
 #include <QFileInfo>
 #include <QTextStream>
 
+#include <cstring>
+
+using namespace CANManager;
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  saveAsAsc
 // ─────────────────────────────────────────────────────────────────────────────
 
-QString TraceExporter::saveAsAsc(const QString& filePath,
-                                  const std::deque<TraceEntry>& frames)
+QString TraceExporter::saveAsAsc(const QString& filePath, const TraceModel& model)
 {
     // ── Open file ─────────────────────────────────────────────────────────────
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        return QString("Cannot open for writing: %1").arg(filePath);
+    AsyncFileWriter file;
+    const QString openError = file.open(filePath, QIODevice::WriteOnly | QIODevice::Text);
+    if (!openError.isEmpty())
+        return openError;
 
     QTextStream out(&file);
 
@@ -59,103 +66,93 @@ QString TraceExporter::saveAsAsc(const QString& filePath,
     out << "Begin Triggerblock\n";
 
     // ── Frame loop ────────────────────────────────────────────────────────────
-    for (const TraceEntry& e : frames)
+    //
+    //  Each line is assembled in a char buffer (ascLine()) and handed to the
+    //  stream once — no temporary QString per field.
+    char line[ASC_LINE_MAX];
+    model.forEachMessage([&](const CANMessage& msg)
     {
-        const auto& msg = e.msg;
-
-        // Timestamp: nanoseconds → seconds with 6 decimal places.
-        // WHY 6 dp: CANoe resolution is 1 µs → 0.000001 s (6 dp sufficient).
-        const double ts_s = static_cast<double>(msg.timestamp) / 1.0e9;
-
-        // CAN ID in ASC format:
-        //   11-bit standard: 3 uppercase hex digits, no suffix  e.g. "0C4"
-        //   29-bit extended: 8 uppercase hex digits + 'x'       e.g. "18DB33F1x"
-        //
-        // WHY pad to 3 / 8 digits: CANalyzer column-aligns on width; some
-        // parsers are strict about the digit count.
-        QString idStr;
-        if (msg.isExtended)
-            idStr = QString::number(msg.id, 16).toUpper().rightJustified(8, '0') + "x";
-        else
-            idStr = QString::number(msg.id, 16).toUpper().rightJustified(3, '0');
-
-        // Direction: "Rx" for received, "Tx" for frames we transmitted.
-        const QString dir = msg.isTxConfirm ? "Tx" : "Rx";
-
-        // ── Error frame ───────────────────────────────────────────────────────
-        if (msg.isError) {
-            // ASC error frame: no data bytes, just the ErrorFrame keyword.
-            out << QString("   %1 %2  %3  %4   ErrorFrame\n")
-                       .arg(ts_s, 12, 'f', 6)
-                       .arg(msg.channel)
-                       .arg(idStr)
-                       .arg(dir, -4);
-            continue;
-        }
+        out << QLatin1String(line, ascLine(line, msg));
+    });
 
-        // ── Remote frame (RTR) ────────────────────────────────────────────────
-        if (msg.isRemote) {
-            // Remote frames carry a DLC but NO data bytes.
-            // ASC uses 'r' for remote instead of 'd' (data).
-            out << QString("   %1 %2  %3  %4   r %5\n")
-                       .arg(ts_s, 12, 'f', 6)
-                       .arg(msg.channel)
-                       .arg(idStr)
-                       .arg(dir, -4)
-                       .arg(msg.dlc);
-            continue;
-        }
+    out << "End TriggerBlock\n";
+    out.flush();
+    return file.finish();  // empty string = success
+}
 
-        // ── Build hex data string (shared by classic CAN and CAN FD) ─────────
-        const int len = msg.dataLength();   // respects CAN FD DLC table
-        QString dataHex;
-        dataHex.reserve(len * 3);
-        for (int i = 0; i < len; ++i) {
-            if (i > 0) dataHex += ' ';
-            dataHex += QString::number(msg.data[i], 16).toUpper().rightJustified(2, '0');
-        }
+// ─────────────────────────────────────────────────────────────────────────────
+//  ascLine() — one frame as an ASC line
+// ─────────────────────────────────────────────────────────────────────────────
 
-        // ── CAN FD data frame ─────────────────────────────────────────────────
-        if (msg.isFD) {
-            // ASC CAN FD format:
-            //   timestamp channel id dir CANFD dlc data... [BRS] [ESI]
-            //
-            // WHY "CANFD" keyword instead of "d": it tells the parser this is
-            // a flexible-data-rate frame with an extended payload.
-            //
-            // BRS = Bit-Rate Switch: data phase ran at a higher bitrate.
-            // ESI = Error-State Indicator: transmitting node was in error-passive.
-            QString fdFlags;
-            if (msg.isBRS) fdFlags += "  BRS";
-            // ESI is not tracked in our CANMessage struct (Vector HW sets it
-            // in the flags word); add this line if you extend CANMessage later:
-            //   if (msg.isESI) fdFlags += " ESI";
-
-            out << QString("   %1 %2  %3  %4   CANFD %5 %6%7\n")
-                       .arg(ts_s, 12, 'f', 6)
-                       .arg(msg.channel)
-                       .arg(idStr)
-                       .arg(dir, -4)
-                       .arg(msg.dlc)
-                       .arg(dataHex)
-                       .arg(fdFlags);
-            continue;
-        }
+int TraceExporter::ascLine(char* out, const CANMessage& msg)
+{
+    char* p = out;
+    auto put = [&p](const char* text, int n) { memcpy(p, text, size_t(n)); p += n; };
+
+    // Timestamp: nanoseconds → seconds with 6 decimal places, right-
+    // justified to 12 columns.
+    // WHY 6 dp: CANoe resolution is 1 µs → 0.000001 s (6 dp sufficient).
+    // Rounded to the µs exactly as the former ns / 1e9 double was.
+    put("   ", 3);
+    p += TextFormat::timestamp(p, msg.timestamp, 9, 12);
+    *p++ = ' ';
+    p += TextFormat::decimal(p, msg.channel);
+    put("  ", 2);
+
+    // CAN ID in ASC format:
+    //   11-bit standard: 3 uppercase hex digits, no suffix  e.g. "0C4"
+    //   29-bit extended: 8 uppercase hex digits + 'x'       e.g. "18DB33F1x"
+    //
+    // WHY pad to 3 / 8 digits: CANalyzer column-aligns on width; some
+    // parsers are strict about the digit count.
+    p += TextFormat::hexU32(p, msg.id, msg.isExtended ? 8 : 3);
+    if (msg.isExtended)
+        *p++ = 'x';
+    put("  ", 2);
+
+    // Direction: "Rx" for received, "Tx" for frames we transmitted,
+    // left-justified to 4 columns.
+    put(msg.isTxConfirm ? "Tx     " : "Rx     ", 7);
+
+    // ── Error frame ───────────────────────────────────────────────────────────
+    if (msg.isError) {
+        // ASC error frame: no data bytes, just the ErrorFrame keyword.
+        put("ErrorFrame\n", 11);
+        return int(p - out);
+    }
 
-        // ── Classic CAN data frame ────────────────────────────────────────────
-        //   timestamp channel id dir d dlc byte0 byte1 ...
-        out << QString("   %1 %2  %3  %4   d %5 %6\n")
-                   .arg(ts_s, 12, 'f', 6)
-                   .arg(msg.channel)
-                   .arg(idStr)
-                   .arg(dir, -4)
-                   .arg(msg.dlc)
-                   .arg(dataHex);
+    // ── Remote frame (RTR) ────────────────────────────────────────────────────
+    if (msg.isRemote) {
+        // Remote frames carry a DLC but NO data bytes.
+        // ASC uses 'r' for remote instead of 'd' (data).
+        put("r ", 2);
+        p += TextFormat::decimal(p, msg.dlc);
+        *p++ = '\n';
+        return int(p - out);
     }
 
-    out << "End TriggerBlock\n";
-    file.close();
-    return {};  // empty string = success
+    // ── CAN FD / classic CAN data frame ───────────────────────────────────────
+    //   timestamp channel id dir CANFD dlc data... [BRS] [ESI]
+    //   timestamp channel id dir d dlc byte0 byte1 ...
+    //
+    // WHY "CANFD" keyword instead of "d": it tells the parser this is
+    // a flexible-data-rate frame with an extended payload.
+    //
+    // BRS = Bit-Rate Switch: data phase ran at a higher bitrate.
+    // ESI = Error-State Indicator: transmitting node was in error-passive.
+    // ESI is not tracked in our CANMessage struct (Vector HW sets it
+    // in the flags word); append "  ESI" here if you extend CANMessage.
+    if (msg.isFD)
+        put("CANFD ", 6);
+    else
+        put("d ", 2);
+    p += TextFormat::decimal(p, msg.dlc);
+    *p++ = ' ';
+    p += TextFormat::hexBytes(p, msg.data, msg.dataLength());   // respects CAN FD DLC table
+    if (msg.isFD && msg.isBRS)
+        put("  BRS", 5);
+    *p++ = '\n';
+    return int(p - out);
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -196,13 +193,28 @@ void TraceExporter::writeBlfObjectHeader(QDataStream& ds,
 //  saveAsBLF
 // ─────────────────────────────────────────────────────────────────────────────
 
+QString TraceExporter::saveAsBLF(const QString& filePath, const TraceModel& model)
+{
+    return writeBlf(filePath, [&model](const auto& fn) { model.forEachMessage(fn); });
+}
+
 QString TraceExporter::saveAsBLF(const QString& filePath,
-                                  const std::deque<TraceEntry>& frames)
+                                  const QVector<CANMessage>& frames)
+{
+    return writeBlf(filePath, [&frames](const auto& fn) {
+        for (const CANMessage& m : frames)
+            fn(m);
+    });
+}
+
+template <typename ForEachFrame>
+QString TraceExporter::writeBlf(const QString& filePath, ForEachFrame forEachFrame)
 {
     // ── Open file ─────────────────────────────────────────────────────────────
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly))
-        return QString("Cannot open for writing: %1").arg(filePath);
+    AsyncFileWriter file;
+    const QString openError = file.open(filePath);
+    if (!openError.isEmpty())
+        return openError;
 
     // QDataStream in LittleEndian mode mirrors the native x86 byte order that
     // the BLF format mandates.  Every << operator writes in that order.
@@ -217,7 +229,7 @@ QString TraceExporter::saveAsBLF(const QString& filePath,
     //    • the measurement start and end times
     //
     //  We write placeholder zeros for fields we can only fill after the loop,
-    //  then seek back to patch them up before closing.
+    //  then register patches that finish() writes over them.
     //
     //  Offset breakdown:
     //    [0]   signature[4]         "BLF\0"
@@ -237,7 +249,8 @@ QString TraceExporter::saveAsBLF(const QString& filePath,
 
     // Lambda: write a Windows SYSTEMTIME (8 × uint16).
     // WHY this layout: Vector tools expect SYSTEMTIME, the Win32 structure.
-    auto writeSystemTime = [&](const QDateTime& dt) {
+    // Takes the stream so the end-time patch can be built the same way.
+    auto writeSystemTime = [](QDataStream& ds, const QDateTime& dt) {
         ds << static_cast<quint16>(dt.date().year());
         ds << static_cast<quint16>(dt.date().month());
         ds << static_cast<quint16>(dt.date().dayOfWeek() % 7); // Qt: Mon=1, Win: Sun=0
@@ -253,20 +266,20 @@ QString TraceExporter::saveAsBLF(const QString& filePath,
     ds << static_cast<quint32>(BLF_API_VERSION);           // [8..11] apiVersion
 
     // Placeholders — we come back to these after writing all frames.
-    const qint64 offsetObjectCount = file.pos();  // = 12
+    const qint64 offsetObjectCount = file.written();  // = 12
     ds << static_cast<quint32>(0);  // [12..15] objectCount   (back-patch)
     ds << static_cast<quint32>(0);  // [16..19] objectsRead   (back-patch)
     ds << static_cast<quint32>(0);  // [20..23] unspecified
 
     ds << static_cast<quint64>(0);  // [24..31] measureStartTs (0 = start)
 
-    const qint64 offsetLastObjTs = file.pos(); // = 32
+    const qint64 offsetLastObjTs = file.written(); // = 32
     ds << static_cast<quint64>(0);  // [32..39] lastObjectTs  (back-patch)
 
-    writeSystemTime(startDt);       // [40..55] startTime
+    writeSystemTime(ds, startDt);   // [40..55] startTime
 
-    const qint64 offsetEndTime = file.pos(); // = 56
-    writeSystemTime(startDt);       // [56..71] endTime       (back-patch, re-written at end)
+    const qint64 offsetEndTime = file.written(); // = 56
+    writeSystemTime(ds, startDt);   // [56..71] endTime       (back-patch, re-written at end)
 
     // Pad the statistics block to exactly 144 bytes.
     // WHY: tools verify statsSize == actual bytes consumed before the first LOBJ.
@@ -278,14 +291,12 @@ QString TraceExporter::saveAsBLF(const QString& filePath,
     quint32 objectCount = 0;
     quint64 lastTs10ns  = 0;
 
-    for (const TraceEntry& e : frames)
+    forEachFrame([&](const CANMessage& msg)
     {
-        const auto& msg = e.msg;
-
         // Skip error and remote frames — CAN_MESSAGE type expects data bytes.
         // (Vector BLF has dedicated error-object types we don't implement here.)
         if (msg.isError || msg.isRemote)
-            continue;
+            return;
 
         // Convert nanoseconds → 10-nanosecond ticks.
         // WHY divide by 10: BLF standard uses 10-ns resolution throughout.
@@ -362,45 +373,52 @@ QString TraceExporter::saveAsBLF(const QString& filePath,
         }
 
         ++objectCount;
-    }
+    });
 
     // ── Back-patch the file statistics block ──────────────────────────────────
     //
     //  WHY back-patch: we didn't know objectCount or the last timestamp while
-    //  writing frames.  QFile::seek() lets us jump back to offset 12 to fill
-    //  in those fields now that we have the final values.
+    //  writing frames.  The writer is append-only, so each field is encoded
+    //  into a small buffer and handed to patch(); finish() writes it at its
+    //  offset once the last frame block has landed.
     //
     //  This is a common binary-file writing pattern in C++ (used in WAV files,
     //  ZIP local headers, RIFF chunks, etc.).
 
     const QDateTime endDt = QDateTime::currentDateTime();
 
+    auto patchAt = [&file](qint64 offset, const auto& write) {
+        QByteArray bytes;
+        QDataStream p(&bytes, QIODevice::WriteOnly);
+        p.setByteOrder(QDataStream::LittleEndian);
+        write(p);
+        file.patch(offset, bytes);
+    };
+
     // Patch objectCount and objectsRead at offset 12.
-    file.seek(offsetObjectCount);
-    ds << objectCount;  // objectCount  [12..15]
-    ds << objectCount;  // objectsRead  [16..19] — same value; "objects read" = total
+    patchAt(offsetObjectCount, [&](QDataStream& p) {
+        p << objectCount;   // objectCount  [12..15]
+        p << objectCount;   // objectsRead  [16..19] — same value; "objects read" = total
+    });
 
     // Patch lastObjectTs at offset 32.
-    file.seek(offsetLastObjTs);
-    ds << lastTs10ns;   // lastObjectTs [32..39]
+    patchAt(offsetLastObjTs, [&](QDataStream& p) { p << lastTs10ns; });   // [32..39]
 
     // Patch endTime (SYSTEMTIME) at offset 56.
-    file.seek(offsetEndTime);
-    writeSystemTime(endDt);
+    patchAt(offsetEndTime, [&](QDataStream& p) { writeSystemTime(p, endDt); });
 
-    file.close();
-    return {};  // empty string = success
+    return file.finish();  // empty string = success
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  saveAsCsv — comma-separated values
 // ─────────────────────────────────────────────────────────────────────────────
-QString TraceExporter::saveAsCsv(const QString& filePath,
-                                 const std::deque<TraceEntry>& frames)
+QString TraceExporter::saveAsCsv(const QString& filePath, const TraceModel& model)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        return QStringLiteral("Cannot open for writing: %1").arg(filePath);
+    AsyncFileWriter file;
+    const QString openError = file.open(filePath, QIODevice::WriteOnly | QIODevice::Text);
+    if (!openError.isEmpty())
+        return openError;
 
     QTextStream out(&file);
     out << "Time(ms),Name,ID,Chn,EventType,Dir,DLC,Data\n";
@@ -411,9 +429,8 @@ QString TraceExporter::saveAsCsv(const QString& filePath,
         return s;
     };
 
-    for (const auto& f : frames)
+    model.forEachEntry([&](const TraceEntry& f)
     {
-        const auto& m = f.msg;
         out << f.timeStr << ","
             << f.nameStr << ","
             << f.idStr << ","
@@ -422,8 +439,8 @@ QString TraceExporter::saveAsCsv(const QString& filePath,
             << f.dirStr << ","
             << f.dlcStr << ","
             << quoted(f.dataStr) << "\n";
-    }
+    });
 
-    file.close();
-    return {};
+    out.flush();
+    return file.finish();
 }
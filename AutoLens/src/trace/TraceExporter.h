@@ -58,18 +58,15 @@
  *    #include "trace/TraceExporter.h"
  *
  *    // ASC
- *    QString err = TraceExporter::saveAsAsc("/path/to/trace.asc",
- *                                          traceModel.frames());
+ *    QString err = TraceExporter::saveAsAsc("/path/to/trace.asc", traceModel);
  *    if (!err.isEmpty())  qWarning() << err;
  *
  *    // BLF
- *    QString err = TraceExporter::saveAsBLF("/path/to/trace.blf",
- *                                          traceModel.frames());
+ *    QString err = TraceExporter::saveAsBLF("/path/to/trace.blf", traceModel);
  */
 
 #include <QString>
 #include <QVector>
-#include <deque>
 #include "trace/TraceModel.h"   // for TraceEntry + CANMessage
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -82,29 +79,40 @@ public:
     /**
      * @brief Save trace in Vector ASC (ASCII Log) format.
      * @param filePath  Destination file path (must be writable).
-     * @param frames    Frames from TraceModel::frames().
+     * @param model     Trace to export (read via TraceModel::forEachMessage()).
      * @return  Empty string on success; human-readable error message on failure.
      */
-    static QString saveAsAsc(const QString& filePath,
-                             const std::deque<TraceEntry>& frames);
+    static QString saveAsAsc(const QString& filePath, const TraceModel& model);
 
     /**
      * @brief Save trace in Vector BLF (Binary Log File) format.
      * @param filePath  Destination file path (must be writable).
-     * @param frames    Frames from TraceModel::frames().
+     * @param model     Trace to export (read via TraceModel::forEachMessage()).
      * @return  Empty string on success; human-readable error message on failure.
      */
+    static QString saveAsBLF(const QString& filePath, const TraceModel& model);
+
+    /** Same BLF output straight from raw frames (flight-recorder dumps). */
     static QString saveAsBLF(const QString& filePath,
-                             const std::deque<TraceEntry>& frames);
+                             const QVector<CANManager::CANMessage>& frames);
 
     /**
      * @brief Save trace as comma-separated values (CSV).
      * @param filePath  Destination file path (must be writable).
-     * @param frames    Frames from TraceModel::frames().
+     * @param model     Trace to export; uses the formatted column strings.
      * @return  Empty string on success; human-readable error message on failure.
      */
-    static QString saveAsCsv(const QString& filePath,
-                             const std::deque<TraceEntry>& frames);
+    static QString saveAsCsv(const QString& filePath, const TraceModel& model);
+
+    /// Longest ascLine(): CAN FD with 64 bytes is ≈ 260 chars.
+    static constexpr int ASC_LINE_MAX = 512;
+
+    /**
+     * @brief One frame as an ASC Triggerblock line, '\n' included.
+     * @param out  At least ASC_LINE_MAX bytes.
+     * @return  Number of characters written.
+     */
+    static int ascLine(char* out, const CANManager::CANMessage& msg);
 
 private:
     // ── BLF format constants ──────────────────────────────────────────────────
@@ -132,6 +140,10 @@ private:
 
     // ── BLF private helpers ───────────────────────────────────────────────────
 
+    /** Shared BLF writer; @p forEachFrame(fn) calls fn(const CANMessage&) per frame. */
+    template <typename ForEachFrame>
+    static QString writeBlf(const QString& filePath, ForEachFrame forEachFrame);
+
     /**
      * @brief Write the 24-byte LOBJ object header.
      *
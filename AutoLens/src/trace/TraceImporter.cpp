@@ -1,4 +1,5 @@
 #include "trace/TraceImporter.h"
+#include "trace/TraceJournal.h"
 
 #include <QDataStream>
 #include <QFile>
@@ -128,6 +129,8 @@ QString TraceImporter::load(const QString& filePath,
         return loadAsc(filePath, outMessages);
     if (ext == "blf")
         return loadBlf(filePath, outMessages);
+    if (ext == "alj")
+        return TraceJournal::load(filePath, outMessages);
 
     return QString("Unsupported trace format: %1").arg(fi.suffix());
 }
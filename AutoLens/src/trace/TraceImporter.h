@@ -6,7 +6,7 @@
 #include "hardware/CANInterface.h"
 
 /**
- * @brief Offline trace import helpers for ASC and BLF log formats.
+ * @brief Offline trace import helpers for ASC, BLF and journal (.alj) logs.
  *
  * All methods are static and return an empty string on success.
  */
@@ -14,7 +14,10 @@ class TraceImporter
 {
 public:
     /**
-     * @brief Load a trace file based on extension (.asc / .blf).
+     * @brief Load a trace file based on extension (.asc / .blf / .alj).
+     *
+     * Journals are recovered with TraceJournal::load — a truncated one
+     * yields every intact block.
      * @param filePath     Source file path.
      * @param outMessages  Parsed CAN/CAN-FD frames.
      * @return Empty string on success, otherwise a human-readable error.
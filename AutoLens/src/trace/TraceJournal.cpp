@@ -0,0 +1,513 @@
+/**
+ * @file TraceJournal.cpp
+ * @brief Journal writer thread, block encoding and the recovery scan.
+ */
+
+#include "trace/TraceJournal.h"
+#include "trace/FramePacking.h"
+#include "util/ThreadPlacement.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QThread>
+#include <QtEndian>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace CANManager;
+
+namespace {
+
+constexpr char    kFileMagic[4]  = { 'A', 'L', 'J', '1' };
+constexpr char    kBlockMagic[4] = { 'A', 'L', 'J', 'B' };
+constexpr quint32 kVersion       = 1;
+constexpr int     kFileHeader    = 32;
+constexpr int     kBlockHeader   = 40;
+constexpr int     kEntryBytes    = 8 + 8 + 8 + 4 + 4;
+constexpr int     kScanWindow    = 64 * 1024;
+constexpr int     kCompressLevel = 1;
+constexpr quint32 kMaxPayload    = 64u * 1024 * 1024;   ///< sanity bound for torn headers
+
+enum : quint16 { kTypeFrames = 1, kTypeCheckpoint = 2 };
+enum : quint16 { kFlagCompressed = 0x0001 };
+
+quint32 crc32(const char* data, qint64 len)
+{
+    static const std::array<quint32, 256> table = [] {
+        std::array<quint32, 256> t{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    quint32 c = 0xFFFFFFFFu;
+    for (qint64 i = 0; i < len; ++i)
+        c = table[(c ^ uint8_t(data[i])) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+struct BlockHeader
+{
+    quint16 type        = 0;
+    quint16 flags       = 0;
+    quint32 payloadSize = 0;
+    quint32 count       = 0;
+    quint64 firstNs     = 0;
+    quint64 lastNs      = 0;
+    quint32 payloadCrc  = 0;
+};
+
+QByteArray encodeHeader(const BlockHeader& h)
+{
+    QByteArray out(kBlockHeader, Qt::Uninitialized);
+    char* p = out.data();
+    memcpy(p, kBlockMagic, 4);
+    qToLittleEndian<quint16>(h.type,        p + 4);
+    qToLittleEndian<quint16>(h.flags,       p + 6);
+    qToLittleEndian<quint32>(h.payloadSize, p + 8);
+    qToLittleEndian<quint32>(h.count,       p + 12);
+    qToLittleEndian<quint64>(h.firstNs,     p + 16);
+    qToLittleEndian<quint64>(h.lastNs,      p + 24);
+    qToLittleEndian<quint32>(h.payloadCrc,  p + 32);
+    qToLittleEndian<quint32>(crc32(p, 36),  p + 36);
+    return out;
+}
+
+/** Header at @p p valid (magic, CRC, plausible size)? */
+bool decodeHeader(const char* p, BlockHeader& h)
+{
+    if (memcmp(p, kBlockMagic, 4) != 0
+        || qFromLittleEndian<quint32>(p + 36) != crc32(p, 36))
+        return false;
+    h.type        = qFromLittleEndian<quint16>(p + 4);
+    h.flags       = qFromLittleEndian<quint16>(p + 6);
+    h.payloadSize = qFromLittleEndian<quint32>(p + 8);
+    h.count       = qFromLittleEndian<quint32>(p + 12);
+    h.firstNs     = qFromLittleEndian<quint64>(p + 16);
+    h.lastNs      = qFromLittleEndian<quint64>(p + 24);
+    h.payloadCrc  = qFromLittleEndian<quint32>(p + 32);
+    return (h.type == kTypeFrames || h.type == kTypeCheckpoint) && h.payloadSize <= kMaxPayload;
+}
+
+/**
+ * Block at @p offset intact — header, and the payload when @p payload is
+ * given?  The payload must lie wholly inside the file.
+ */
+bool readBlock(QFile& f, qint64 offset, BlockHeader& h, QByteArray* payload)
+{
+    char raw[kBlockHeader];
+    if (offset + kBlockHeader > f.size() || !f.seek(offset)
+        || f.read(raw, kBlockHeader) != kBlockHeader || !decodeHeader(raw, h))
+        return false;
+    if (offset + kBlockHeader + qint64(h.payloadSize) > f.size())
+        return false;
+    if (!payload)
+        return true;
+    *payload = f.read(h.payloadSize);
+    return payload->size() == int(h.payloadSize)
+        && crc32(payload->constData(), payload->size()) == h.payloadCrc;
+}
+
+struct Checkpoint
+{
+    qint64                      previous = 0;
+    QVector<TraceJournal::Block> blocks;
+};
+
+bool decodeCheckpoint(const QByteArray& payload, quint32 count, Checkpoint& cp)
+{
+    if (payload.size() != 16 + qint64(count) * kEntryBytes)
+        return false;
+    const char* p = payload.constData();
+    cp.previous = qint64(qFromLittleEndian<quint64>(p));
+    p += 16;   // previous, total frames
+    cp.blocks.resize(int(count));
+    for (TraceJournal::Block& b : cp.blocks) {
+        b.offset  = qint64(qFromLittleEndian<quint64>(p));
+        b.firstNs = qFromLittleEndian<quint64>(p + 8);
+        b.lastNs  = qFromLittleEndian<quint64>(p + 16);
+        b.frames  = qFromLittleEndian<quint32>(p + 24);
+        p += kEntryBytes;
+    }
+    return true;
+}
+
+void syncToDevice(QFile& file)
+{
+#if defined(Q_OS_WIN)
+    FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle())));
+#elif defined(Q_OS_LINUX)
+    ::fdatasync(file.handle());
+#else
+    ::fsync(file.handle());
+#endif
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Lifecycle (UI thread)
+// ─────────────────────────────────────────────────────────────────────────────
+
+TraceJournal::TraceJournal(QObject* parent)
+    : QObject(parent)
+{
+}
+
+TraceJournal::~TraceJournal()
+{
+    stop();
+}
+
+QString TraceJournal::start(const QString& path)
+{
+    stop();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return QString("Cannot open for writing: %1").arg(path);
+
+    QByteArray header(kFileHeader, '\0');
+    memcpy(header.data(), kFileMagic, 4);
+    qToLittleEndian<quint32>(kVersion,    header.data() + 4);
+    qToLittleEndian<quint32>(kFileHeader, header.data() + 8);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header.data() + 16);
+    if (m_file.write(header) != kFileHeader || !m_file.flush()) {
+        const QString error = m_file.errorString();
+        m_file.close();
+        return error;
+    }
+
+    {
+        QMutexLocker lock(&m_stageMutex);
+        m_stage = Pending{};
+        m_stage.data.reserve(BLOCK_RAW_BYTES + FramePacking::MAX_PACKED_FRAME);
+        m_stopWriter = false;
+    }
+    {
+        QMutexLocker lock(&m_statsMutex);
+        m_stats = Stats{};
+        m_stats.path  = path;
+        m_stats.bytes = kFileHeader;
+    }
+    m_sinceCheckpoint.clear();
+    m_lastCheckpoint = 0;
+
+    m_writer = QThread::create([this]() { writerLoop(); });
+    m_writer->setObjectName("AutoLens_Journal");
+    m_writer->start();
+
+    m_running.store(true);
+    qDebug() << "[TraceJournal] Journaling to" << path;
+    return {};
+}
+
+void TraceJournal::stop()
+{
+    if (!m_writer)
+        return;
+
+    m_running.store(false);
+    {
+        QMutexLocker lock(&m_stageMutex);
+        m_stopWriter = true;
+        m_wake.wakeAll();
+    }
+    m_writer->wait();
+    delete m_writer;
+    m_writer = nullptr;
+    m_file.close();
+
+    const Stats st = stats();
+    qDebug() << "[TraceJournal] Closed" << st.path << "-" << st.frames << "frames,"
+             << st.blocks << "blocks," << st.checkpoints << "checkpoints";
+}
+
+TraceJournal::Stats TraceJournal::stats() const
+{
+    QMutexLocker lock(&m_statsMutex);
+    return m_stats;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  record — driver thread(s)
+// ─────────────────────────────────────────────────────────────────────────────
+
+void TraceJournal::record(const CANMessage& msg)
+{
+    if (!m_running.load(std::memory_order_relaxed))
+        return;
+
+    uint8_t tail[FramePacking::MAX_PACKED_FRAME];
+    uint8_t* p = FramePacking::packBody(tail, msg);
+
+    QMutexLocker lock(&m_stageMutex);
+    if (!m_running.load(std::memory_order_relaxed))
+        return;   // stop() got here first
+
+    if (m_stage.frames == 0) {
+        m_stage.firstNs = msg.timestamp;
+        m_stagePrevNs   = msg.timestamp;
+    }
+    uint8_t head[10];
+    uint8_t* h = FramePacking::putVarint(head, FramePacking::zigzag(qint64(msg.timestamp - m_stagePrevNs)));
+    m_stage.data.append(reinterpret_cast<const char*>(head), int(h - head));
+    m_stage.data.append(reinterpret_cast<const char*>(tail), int(p - tail));
+    m_stagePrevNs  = msg.timestamp;
+    m_stage.lastNs = qMax(m_stage.lastNs, msg.timestamp);
+    ++m_stage.frames;
+
+    if (m_stage.data.size() >= BLOCK_RAW_BYTES)
+        m_wake.wakeOne();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Writer thread
+// ─────────────────────────────────────────────────────────────────────────────
+
+void TraceJournal::writerLoop()
+{
+    ThreadPlacement::Scope placement(ThreadPlacement::Logging);
+    QElapsedTimer sinceCheckpoint;
+    sinceCheckpoint.start();
+    bool failed = false;
+
+    for (;;) {
+        Pending batch;
+        bool stopping = false;
+        {
+            QMutexLocker lock(&m_stageMutex);
+            if (!m_stopWriter && m_stage.data.size() < BLOCK_RAW_BYTES)
+                m_wake.wait(&m_stageMutex, FLUSH_MS);
+            batch = std::move(m_stage);
+            m_stage = Pending{};
+            m_stage.data.reserve(BLOCK_RAW_BYTES + FramePacking::MAX_PACKED_FRAME);
+            stopping = m_stopWriter;
+        }
+
+        if (!failed && batch.frames > 0) {
+            const QByteArray packed = qCompress(batch.data, kCompressLevel);
+            const bool compress = packed.size() < batch.data.size();
+            const qint64 offset = m_file.pos();
+            failed = !writeBlock(kTypeFrames, compress ? packed : batch.data, batch.frames,
+                                 batch.firstNs, batch.lastNs, compress);
+            if (!failed)
+                m_sinceCheckpoint.append({ offset, batch.firstNs, batch.lastNs, batch.frames });
+        }
+
+        // The final checkpoint is written even when nothing arrived since
+        // the last one: a file ending in a checkpoint was closed cleanly.
+        if (!failed && (stopping || (!m_sinceCheckpoint.isEmpty()
+                                     && sinceCheckpoint.elapsed() >= CHECKPOINT_MS))) {
+            failed = !writeCheckpoint();
+            sinceCheckpoint.restart();
+        }
+
+        if (stopping)
+            return;
+    }
+}
+
+bool TraceJournal::writeBlock(quint16 type, const QByteArray& payload, quint32 count,
+                              quint64 firstNs, quint64 lastNs, bool compressed)
+{
+    BlockHeader h;
+    h.type        = type;
+    h.flags       = compressed ? kFlagCompressed : 0;
+    h.payloadSize = quint32(payload.size());
+    h.count       = count;
+    h.firstNs     = firstNs;
+    h.lastNs      = lastNs;
+    h.payloadCrc  = crc32(payload.constData(), payload.size());
+
+    // flush() hands the block to the OS: a crash of AutoLens itself loses
+    // nothing written so far.  Power loss is covered by the sync at each
+    // checkpoint.
+    if (m_file.write(encodeHeader(h)) != kBlockHeader
+        || m_file.write(payload) != payload.size()
+        || !m_file.flush()) {
+        fail(m_file.errorString());
+        return false;
+    }
+
+    QMutexLocker lock(&m_statsMutex);
+    m_stats.bytes += kBlockHeader + payload.size();
+    if (type == kTypeFrames) {
+        m_stats.frames += count;
+        ++m_stats.blocks;
+    } else {
+        ++m_stats.checkpoints;
+    }
+    return true;
+}
+
+bool TraceJournal::writeCheckpoint()
+{
+    const quint64 total = stats().frames;
+    QByteArray payload(16 + m_sinceCheckpoint.size() * kEntryBytes, '\0');
+    char* p = payload.data();
+    qToLittleEndian<quint64>(quint64(m_lastCheckpoint), p);
+    qToLittleEndian<quint64>(total, p + 8);
+    p += 16;
+    for (const Block& b : std::as_const(m_sinceCheckpoint)) {
+        qToLittleEndian<quint64>(quint64(b.offset), p);
+        qToLittleEndian<quint64>(b.firstNs, p + 8);
+        qToLittleEndian<quint64>(b.lastNs,  p + 16);
+        qToLittleEndian<quint32>(b.frames,  p + 24);
+        p += kEntryBytes;
+    }
+
+    const quint64 firstNs = m_sinceCheckpoint.isEmpty() ? 0 : m_sinceCheckpoint.first().firstNs;
+    const quint64 lastNs  = m_sinceCheckpoint.isEmpty() ? 0 : m_sinceCheckpoint.last().lastNs;
+    const qint64  offset  = m_file.pos();
+    if (!writeBlock(kTypeCheckpoint, payload, quint32(m_sinceCheckpoint.size()),
+                    firstNs, lastNs, false))
+        return false;
+
+    syncToDevice(m_file);
+    m_lastCheckpoint = offset;
+    m_sinceCheckpoint.clear();
+    return true;
+}
+
+void TraceJournal::fail(const QString& error)
+{
+    // Keep the thread alive until stop() so record() stays cheap; it just
+    // stops being called.
+    m_running.store(false);
+    {
+        QMutexLocker lock(&m_statsMutex);
+        if (m_stats.error.isEmpty())
+            m_stats.error = error;
+    }
+    qWarning() << "[TraceJournal] Write failed:" << error;
+    QMetaObject::invokeMethod(this, [this, error]() { emit writeFailed(error); },
+                              Qt::QueuedConnection);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Recovery
+// ─────────────────────────────────────────────────────────────────────────────
+
+QString TraceJournal::scan(const QString& path, Index& out)
+{
+    out = Index{};
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return QString("Cannot open %1").arg(path);
+
+    out.fileBytes = f.size();
+    const QByteArray header = f.read(kFileHeader);
+    if (header.size() < kFileHeader || memcmp(header.constData(), kFileMagic, 4) != 0)
+        return QString("%1 is not an AutoLens journal").arg(path);
+    if (qFromLittleEndian<quint32>(header.constData() + 4) > kVersion)
+        return QString("%1: journal version %2 is newer than this AutoLens")
+                   .arg(path).arg(qFromLittleEndian<quint32>(header.constData() + 4));
+    out.startEpochMs = qFromLittleEndian<qint64>(header.constData() + 16);
+
+    // ── 1. Newest intact checkpoint, searching backwards ─────────────────────
+    qint64     newest = -1;
+    BlockHeader h;
+    QByteArray payload;
+    for (qint64 end = out.fileBytes; end > kFileHeader && newest < 0; ) {
+        const qint64 from = qMax<qint64>(kFileHeader, end - kScanWindow);
+        f.seek(from);
+        const QByteArray window = f.read(qMin<qint64>(end + 3, out.fileBytes) - from);
+        for (int i = window.lastIndexOf(QByteArray(kBlockMagic, 4)); i >= 0 && newest < 0;
+             i = i > 0 ? window.lastIndexOf(QByteArray(kBlockMagic, 4), i - 1) : -1) {
+            if (readBlock(f, from + i, h, nullptr) && h.type == kTypeCheckpoint
+                && readBlock(f, from + i, h, &payload))
+                newest = from + i;
+        }
+        end = from;
+    }
+
+    // ── 2. Index from the checkpoint chain ───────────────────────────────────
+    qint64 forwardFrom = kFileHeader;
+    if (newest >= 0) {
+        QVector<QVector<Block>> chain;
+        bool intact = true;
+        for (qint64 at = newest; at != 0; ) {
+            Checkpoint cp;
+            if (!readBlock(f, at, h, &payload) || h.type != kTypeCheckpoint
+                || !decodeCheckpoint(payload, h.count, cp) || cp.previous >= at) {
+                intact = false;
+                break;
+            }
+            chain.append(std::move(cp.blocks));
+            ++out.checkpoints;
+            at = cp.previous;
+        }
+        if (intact) {
+            for (int i = chain.size() - 1; i >= 0; --i)
+                out.blocks += chain[i];
+            readBlock(f, newest, h, nullptr);
+            forwardFrom = newest + kBlockHeader + h.payloadSize;
+        } else {
+            // Damaged chain: fall back to walking every block.
+            qWarning() << "[TraceJournal] Checkpoint chain broken in" << path << "- full scan";
+            out.checkpoints = 0;
+        }
+    }
+
+    // ── 3. Blocks written after it ───────────────────────────────────────────
+    qint64 at = forwardFrom;
+    bool   endsWithCheckpoint = newest >= 0 && forwardFrom > kFileHeader;
+    while (readBlock(f, at, h, &payload)) {
+        if (h.type == kTypeFrames) {
+            out.blocks.append({ at, h.firstNs, h.lastNs, h.count });
+            ++out.tailBlocks;
+        }
+        endsWithCheckpoint = h.type == kTypeCheckpoint;
+        at += kBlockHeader + h.payloadSize;
+    }
+    out.validBytes = at;
+    out.clean      = endsWithCheckpoint && at == out.fileBytes;
+    for (const Block& b : std::as_const(out.blocks))
+        out.frames += b.frames;
+
+    qDebug() << "[TraceJournal] Scanned" << path << "-" << out.blocks.size() << "blocks,"
+             << out.frames << "frames," << out.checkpoints << "checkpoints,"
+             << out.tailBlocks << "after the last;"
+             << (out.clean ? "closed cleanly"
+                           : QString("recovered %1 of %2 bytes").arg(out.validBytes).arg(out.fileBytes));
+    return {};
+}
+
+QString TraceJournal::load(const QString& path, QVector<CANMessage>& out)
+{
+    Index index;
+    const QString error = scan(path, index);
+    if (!error.isEmpty())
+        return error;
+
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return QString("Cannot open %1").arg(path);
+
+    out.reserve(out.size() + int(qMin<quint64>(index.frames, quint64(INT_MAX / 2))));
+    BlockHeader h;
+    QByteArray  payload;
+    for (const Block& b : std::as_const(index.blocks)) {
+        if (!readBlock(f, b.offset, h, &payload) || h.type != kTypeFrames)
+            continue;   // listed by a checkpoint but damaged since
+        const QByteArray raw = (h.flags & kFlagCompressed) ? qUncompress(payload) : payload;
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(raw.constData());
+        FramePacking::unpack(p, p + raw.size(), h.firstNs, int(h.count), out);
+    }
+    return {};
+}
@@ -0,0 +1,171 @@
+#pragma once
+/**
+ * @file TraceJournal.h
+ * @brief Crash-safe, append-only capture log (.alj) and its recovery scan.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  A BLF is written with placeholder header fields that are patched at the
+ *  end (object count, end time).  If AutoLens, the PC or its power dies
+ *  mid-capture, those fields are never written and the file is useless —
+ *  and a crash is exactly the moment the capture matters.
+ *
+ *  The journal never goes back: every block describes itself, and a
+ *  checkpoint block every few seconds indexes the blocks before it.
+ *  Whatever reached the disk before the crash is readable; nothing is
+ *  rewritten at close either — stop() just appends a last checkpoint.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  FILE LAYOUT (little-endian)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *    file header   32 B   "ALJ1", version, header size, start time (ms
+ *                         since epoch)
+ *    block         40 B header + payload, repeated:
+ *       u32  magic "ALJB"
+ *       u16  type          1 = frames, 2 = checkpoint
+ *       u16  flags         bit0 payload zlib-compressed
+ *       u32  payloadSize   bytes on disk
+ *       u32  count         frames / checkpoint entries
+ *       u64  firstNs, lastNs
+ *       u32  payloadCrc    CRC-32 of the payload as stored
+ *       u32  headerCrc     CRC-32 of the 36 bytes before it
+ *
+ *    frames payload       packed frames (trace/FramePacking.h)
+ *    checkpoint payload   u64 previous checkpoint offset (0 = first),
+ *                         u64 total frames, then per block since the
+ *                         previous checkpoint:
+ *                         u64 offset, u64 firstNs, u64 lastNs, u32 frames,
+ *                         u32 reserved
+ *
+ *  Frame blocks are sealed every FLUSH_MS or at BLOCK_RAW_BYTES, so a
+ *  crash loses at most the last FLUSH_MS of traffic.  Checkpoints (every
+ *  CHECKPOINT_MS, flushed to the device) bound the recovery work.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  RECOVERY — scan()
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  1. Search backwards from the end for the newest checkpoint whose header
+ *     and payload CRCs hold.
+ *  2. Follow its previous-checkpoint chain: the whole index, one read per
+ *     checkpoint — no frame block is touched.
+ *  3. Walk forward from that checkpoint over the blocks written after it,
+ *     verifying each, and stop at the first torn or missing one.
+ *
+ *  A file that stops mid-block is read up to the last whole block.
+ *  Without any checkpoint (a crash in the first seconds) step 3 starts at
+ *  the file header.
+ */
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+
+#include "hardware/CANInterface.h"
+
+class QThread;
+
+class TraceJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int BLOCK_RAW_BYTES = 64 * 1024;
+    static constexpr int FLUSH_MS        = 250;
+    static constexpr int CHECKPOINT_MS   = 2000;
+
+    /** One frame block, as listed by a checkpoint or found by the scan. */
+    struct Block
+    {
+        qint64  offset  = 0;
+        quint64 firstNs = 0;
+        quint64 lastNs  = 0;
+        quint32 frames  = 0;
+    };
+
+    /** What scan() recovered. */
+    struct Index
+    {
+        QVector<Block> blocks;
+        quint64 frames        = 0;
+        qint64  startEpochMs  = 0;
+        qint64  fileBytes     = 0;
+        qint64  validBytes    = 0;   ///< end of the last intact block
+        int     checkpoints   = 0;   ///< followed in the chain
+        int     tailBlocks    = 0;   ///< found after the newest checkpoint
+        bool    clean         = false;   ///< ends with a checkpoint — closed by stop()
+    };
+
+    struct Stats
+    {
+        quint64 frames      = 0;
+        quint64 blocks      = 0;
+        quint64 checkpoints = 0;
+        qint64  bytes       = 0;
+        QString path;
+        QString error;               ///< first write error, if any
+    };
+
+    explicit TraceJournal(QObject* parent = nullptr);
+    ~TraceJournal() override;
+
+    /** Create @p path and start journaling.  Returns "" or the error. */
+    QString start(const QString& path);
+    /** Seal the pending frames, append the final checkpoint and close. */
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_relaxed); }
+
+    /** Append one frame.  Any thread; never blocks on I/O. */
+    void record(const CANManager::CANMessage& msg);
+
+    Stats stats() const;
+
+    /** Rebuild the block index of @p path (recovery).  "" or the error. */
+    static QString scan(const QString& path, Index& out);
+
+    /** scan() and decode every intact block.  "" or the error. */
+    static QString load(const QString& path, QVector<CANManager::CANMessage>& out);
+
+signals:
+    /** A write failed; journaling has stopped writing (queued). */
+    void writeFailed(const QString& error);
+
+private:
+    struct Pending
+    {
+        QByteArray data;
+        quint64    firstNs = 0;
+        quint64    lastNs  = 0;
+        quint32    frames  = 0;
+    };
+
+    void writerLoop();
+    bool writeBlock(quint16 type, const QByteArray& payload, quint32 count,
+                    quint64 firstNs, quint64 lastNs, bool compressed);
+    bool writeCheckpoint();
+    void fail(const QString& error);
+
+    std::atomic<bool> m_running{false};
+
+    // ── Staging (record()) ──────────────────────────────────────────────────────
+    QMutex         m_stageMutex;
+    QWaitCondition m_wake;
+    Pending        m_stage;
+    quint64        m_stagePrevNs = 0;
+    bool           m_stopWriter  = false;
+
+    // ── Writer thread only ──────────────────────────────────────────────────────
+    QFile          m_file;
+    QVector<Block> m_sinceCheckpoint;
+    qint64         m_lastCheckpoint = 0;
+    QThread*       m_writer = nullptr;
+
+    // ── Shared stats ────────────────────────────────────────────────────────────
+    mutable QMutex m_statsMutex;
+    Stats          m_stats;
+};
@@ -33,8 +33,14 @@
  */
 
 #include "TraceModel.h"
+#include "trace/TraceEntryBuilder.h"
 #include <QColor>
 #include <QDebug>
+#include <QThread>
+
+#include <algorithm>
+
+static_assert(TraceRow::COLUMNS == TraceModel::ColCount, "TraceRow must hold every column");
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  Constructor
@@ -43,11 +49,31 @@
 TraceModel::TraceModel(QObject* parent)
     : QAbstractItemModel(parent)
     , m_displayMode(DisplayMode::Append)
-{}
+{
+    m_clock.start();
+
+    m_compressThread = new QThread;
+    m_compressThread->setObjectName("AutoLens_TraceCompress");
+    m_compressContext = new QObject;
+    m_compressContext->moveToThread(m_compressThread);
+    m_compressThread->start(QThread::LowestPriority);
+
+    m_coldTimer.setInterval(COLD_SCAN_MS);
+    connect(&m_coldTimer, &QTimer::timeout, this, &TraceModel::compressColdSegments);
+    m_coldTimer.start();
+}
 
-quint64 TraceModel::makeEntryKey(const TraceEntry& entry)
+TraceModel::~TraceModel()
+{
+    // Replies still queued for this object are dropped with it.
+    m_compressThread->quit();
+    m_compressThread->wait();
+    delete m_compressContext;
+    delete m_compressThread;
+}
+
+quint64 TraceModel::makeEntryKey(const CANManager::CANMessage& msg)
 {
-    const auto& msg = entry.msg;
     quint64 key = static_cast<quint64>(msg.id);
     key |= (static_cast<quint64>(msg.channel) & 0xFFull) << 32;
     key |= (msg.isExtended  ? 1ull : 0ull) << 40;
@@ -69,7 +95,7 @@ void TraceModel::setDisplayMode(DisplayMode mode)
         return;
     }
 
-    if (m_frames.empty()) {
+    if (frameCount() == 0) {
         m_inPlaceRows.clear();
         return;
     }
@@ -78,28 +104,72 @@ void TraceModel::setDisplayMode(DisplayMode mode)
     beginResetModel();
 
     QVector<TraceEntry> compact;
-    compact.reserve(static_cast<int>(m_frames.size()));
-
+    QVector<bool>       needsBuild;   // row's latest frame came from a sealed segment
     QHash<quint64, int> keyToRow;
-    keyToRow.reserve(static_cast<int>(m_frames.size()));
+
+    // Sealed frames: keep only the raw message until the scan is done, so a
+    // key seen a million times is built once, not a million times.
+    QVector<CANManager::CANMessage> decoded;
+    for (const SealedSegment& sealed : m_sealed) {
+        sealed.segment.decode(decoded);
+        for (const CANManager::CANMessage& msg : decoded) {
+            const quint64 key = makeEntryKey(msg);
+            auto it = keyToRow.find(key);
+            if (it == keyToRow.end()) {
+                keyToRow.insert(key, compact.size());
+                compact.append(TraceEntry{});
+                compact.last().msg = msg;
+                needsBuild.append(true);
+            } else {
+                compact[it.value()].msg = msg;
+                needsBuild[it.value()] = true;
+            }
+        }
+    }
 
     for (const TraceEntry& frame : m_frames) {
-        const quint64 key = makeEntryKey(frame);
+        const quint64 key = makeEntryKey(frame.msg);
         auto it = keyToRow.find(key);
         if (it == keyToRow.end()) {
             keyToRow.insert(key, compact.size());
             compact.append(frame);
+            needsBuild.append(false);
         } else {
             compact[it.value()] = frame;
+            needsBuild[it.value()] = false;
         }
     }
 
+    for (int row = 0; row < compact.size(); ++row) {
+        if (needsBuild[row])
+            compact[row] = TraceEntryBuilder::build(compact[row].msg, m_db.get());
+    }
+
+    m_rowBase    += frameCount();   // new rows must not reuse old keys
+    m_sealed.clear();
+    m_sealedRows  = 0;
+    m_sealedBytes = 0;
+    dropCaches();
+
     m_frames.assign(compact.begin(), compact.end());
     m_inPlaceRows = keyToRow;
 
     endResetModel();
 }
 
+void TraceModel::setDatabase(const DBCManager::DBCDatabase& db)
+{
+    m_db = std::make_shared<const DBCManager::DBCDatabase>(db);
+
+    // Cached sealed rows were built with the old DBC.
+    m_rowCache.clear();
+    m_rowCacheOrder.clear();
+    for (Snapshot& snap : m_snapshots)
+        snap.key = -1;
+    if (m_sealedRows > 0)
+        emit dataChanged(index(0, 0), index(m_sealedRows - 1, ColCount - 1));
+}
+
 void TraceModel::rebuildInPlaceIndex()
 {
     m_inPlaceRows.clear();
@@ -107,16 +177,28 @@ void TraceModel::rebuildInPlaceIndex()
 
     m_inPlaceRows.reserve(static_cast<int>(m_frames.size()));
     for (int row = 0; row < static_cast<int>(m_frames.size()); ++row)
-        m_inPlaceRows.insert(makeEntryKey(m_frames[row]), row);
+        m_inPlaceRows.insert(makeEntryKey(m_frames[row].msg), row);
 }
 
 void TraceModel::purgeOldestRows(int count)
 {
-    if (count <= 0 || m_frames.empty()) return;
-
-    count = qMin(count, static_cast<int>(m_frames.size()));
-    beginRemoveRows(QModelIndex{}, 0, count - 1);
-    m_frames.erase(m_frames.begin(), m_frames.begin() + count);  // O(1) amortised for std::deque
+    if (count <= 0 || frameCount() == 0) return;
+
+    // Sealed segments can only go whole — round up to the next boundary.
+    const int segments = qMin(static_cast<int>(m_sealed.size()),
+                              (count + SEGMENT_FRAMES - 1) / SEGMENT_FRAMES);
+    const int fromSealed = segments * SEGMENT_FRAMES;
+    const int fromTail   = qBound(0, count - fromSealed, static_cast<int>(m_frames.size()));
+    const int removed    = fromSealed + fromTail;
+
+    beginRemoveRows(QModelIndex{}, 0, removed - 1);
+    for (int i = 0; i < segments; ++i) {
+        m_sealedBytes -= m_sealed.front().segment.bytes();
+        m_sealed.pop_front();
+    }
+    m_sealedRows -= fromSealed;
+    m_frames.erase(m_frames.begin(), m_frames.begin() + fromTail);  // O(1) amortised for std::deque
+    m_rowBase += removed;   // cached rows keep their absolute keys
     endRemoveRows();
 
     if (m_displayMode == DisplayMode::InPlace)
@@ -145,6 +227,7 @@ void TraceModel::updateInPlaceRow(int row, const TraceEntry& entry)
     }
 
     m_frames[row] = entry;
+    dropSnapshot(row);
     emit dataChanged(index(row, 0, QModelIndex{}),
                      index(row, ColCount - 1, QModelIndex{}));
 
@@ -159,7 +242,7 @@ void TraceModel::addEntriesAppend(const QVector<TraceEntry>& entries)
     if (entries.isEmpty()) return;
 
     const int incoming = entries.size();
-    const int current  = static_cast<int>(m_frames.size());
+    const int current  = frameCount();
 
 #ifndef QT_NO_DEBUG
     qDebug() << "[TraceModel::Append] incoming=" << incoming
@@ -173,18 +256,239 @@ void TraceModel::addEntriesAppend(const QVector<TraceEntry>& entries)
         purgeOldestRows(toRemove);
     }
 
-    const int first = static_cast<int>(m_frames.size());
+    const int first = frameCount();
     const int last  = first + incoming - 1;
 
     beginInsertRows(QModelIndex{}, first, last);
     m_frames.insert(m_frames.end(), entries.begin(), entries.end());
     endInsertRows();
 
+    while (static_cast<int>(m_frames.size()) >= HOT_FRAMES + SEGMENT_FRAMES)
+        sealOldest();
+
 #ifndef QT_NO_DEBUG
-    qDebug() << "[TraceModel::Append] after insert, m_frames.size()=" << static_cast<int>(m_frames.size());
+    qDebug() << "[TraceModel::Append] after insert, frameCount()=" << frameCount()
+             << "sealed=" << m_sealedRows;
 #endif
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  Sealed segments
+// ─────────────────────────────────────────────────────────────────────────────
+
+void TraceModel::sealOldest()
+{
+    QVector<CANManager::CANMessage> block;
+    block.reserve(SEGMENT_FRAMES);
+    for (int i = 0; i < SEGMENT_FRAMES; ++i)
+        block.append(m_frames[i].msg);
+
+    SealedSegment sealed;
+    sealed.segment   = TraceSegment::encode(block.constData(), block.size());
+    sealed.lastUseMs = m_clock.elapsed();
+    m_sealedBytes += sealed.segment.bytes();
+    m_sealed.push_back(std::move(sealed));
+    m_sealedRows  += SEGMENT_FRAMES;
+    m_frames.erase(m_frames.begin(), m_frames.begin() + SEGMENT_FRAMES);
+}
+
+const QVector<CANManager::CANMessage>& TraceModel::sealedFrames(int segment) const
+{
+    const qint64 firstRow = m_rowBase + qint64(segment) * SEGMENT_FRAMES;
+    m_sealed[segment].lastUseMs = m_clock.elapsed();
+    for (const DecodedSegment& cached : m_segmentCache) {
+        if (cached.firstRow == firstRow)
+            return cached.frames;
+    }
+
+    // Round-robin replacement is enough for four slots: the view scrolls
+    // through neighbouring segments, it does not jump between many.
+    DecodedSegment& slot = m_segmentCache[m_segmentCacheNext];
+    m_segmentCacheNext = (m_segmentCacheNext + 1) % SEGMENT_CACHE_SIZE;
+    slot.firstRow = firstRow;
+    m_sealed[segment].segment.decode(slot.frames);
+    return slot.frames;
+}
+
+const TraceEntry& TraceModel::entryAt(int row) const
+{
+    if (row >= m_sealedRows)
+        return m_frames[row - m_sealedRows];
+
+    const qint64 key = m_rowBase + row;
+    auto it = m_rowCache.constFind(key);
+    if (it != m_rowCache.cend())
+        return it.value();
+
+    if (m_rowCache.size() >= ROW_CACHE_SIZE) {
+        m_rowCache.remove(m_rowCacheOrder.front());
+        m_rowCacheOrder.pop_front();
+    }
+
+    const QVector<CANManager::CANMessage>& frames = sealedFrames(row / SEGMENT_FRAMES);
+    m_rowCacheOrder.push_back(key);
+    return m_rowCache.insert(key, TraceEntryBuilder::build(frames[row % SEGMENT_FRAMES],
+                                                           m_db.get())).value();
+}
+
+void TraceModel::dropCaches()
+{
+    m_rowCache.clear();
+    m_rowCacheOrder.clear();
+    for (DecodedSegment& cached : m_segmentCache) {
+        cached.firstRow = -1;
+        cached.frames.clear();
+    }
+    for (Snapshot& snap : m_snapshots)
+        snap = Snapshot{};
+}
+
+TraceRow TraceModel::rowSnapshot(int row) const
+{
+    // Direct-mapped: the visible window is a run of consecutive rows, so
+    // each gets its own slot as long as it is shorter than the cache.
+    const qint64 key = m_rowBase + row;
+    Snapshot& slot = m_snapshots[key % SNAPSHOT_CACHE_SIZE];
+    if (slot.key == key)
+        return slot.row;
+
+    ++m_viewStats.snapshotBuilds;
+    const TraceEntry& e = entryAt(row);
+    TraceRow& r = slot.row;
+    r.cells[ColTime]      = e.timeStr;
+    r.cells[ColName]      = e.nameStr;
+    r.cells[ColID]        = e.idStr;
+    r.cells[ColChn]       = e.chnStr;
+    r.cells[ColEventType] = e.eventTypeStr;
+    r.cells[ColDir]       = e.dirStr;
+    r.cells[ColDLC]       = e.dlcStr;
+    r.cells[ColData]      = e.dataStr;
+    r.isFrame   = true;
+    r.isError   = e.msg.isError;
+    r.isFD      = e.msg.isFD;
+    r.isDecoded = !e.nameStr.isEmpty();
+    r.isTx      = e.msg.isTxConfirm;
+    r.channel   = e.msg.channel;
+    slot.key = key;
+    return r;
+}
+
+void TraceModel::dropSnapshot(int row)
+{
+    Snapshot& slot = m_snapshots[(m_rowBase + row) % SNAPSHOT_CACHE_SIZE];
+    if (slot.key == m_rowBase + row)
+        slot.key = -1;
+}
+
+int TraceModel::rowAtTime(quint64 timestampNs) const
+{
+    if (m_displayMode != DisplayMode::Append || frameCount() == 0)
+        return -1;
+
+    // In the hot tail?
+    if (!m_frames.empty() && (m_sealed.empty() || m_frames.front().msg.timestamp <= timestampNs)) {
+        const auto it = std::lower_bound(m_frames.begin(), m_frames.end(), timestampNs,
+                                         [](const TraceEntry& e, quint64 ts) {
+                                             return e.msg.timestamp < ts;
+                                         });
+        return it == m_frames.end() ? frameCount() - 1
+                                    : m_sealedRows + int(it - m_frames.begin());
+    }
+
+    // Last segment starting at or before the time (or the first one).
+    const auto seg = std::upper_bound(m_sealed.begin(), m_sealed.end(), timestampNs,
+                                      [](quint64 ts, const SealedSegment& s) {
+                                          return ts < s.segment.firstNs();
+                                      });
+    const int segment = qMax(0, int(seg - m_sealed.begin()) - 1);
+    const QVector<CANManager::CANMessage>& frames = sealedFrames(segment);
+    const auto it = std::lower_bound(frames.begin(), frames.end(), timestampNs,
+                                     [](const CANManager::CANMessage& m, quint64 ts) {
+                                         return m.timestamp < ts;
+                                     });
+    // Past the segment's last frame → first row of whatever follows it.
+    return qMin(segment * SEGMENT_FRAMES + int(it - frames.begin()), frameCount() - 1);
+}
+
+CANManager::CANMessage TraceModel::messageAt(int row) const
+{
+    if (row < 0 || row >= frameCount())
+        return {};
+    if (row >= m_sealedRows)
+        return m_frames[size_t(row - m_sealedRows)].msg;
+    return sealedFrames(row / SEGMENT_FRAMES)[row % SEGMENT_FRAMES];
+}
+
+void TraceModel::compressColdSegments()
+{
+    const qint64 now = m_clock.elapsed();
+    int queued = 0;
+    for (int i = 0; i < static_cast<int>(m_sealed.size()) && queued < COLD_BATCH; ++i) {
+        SealedSegment& sealed = m_sealed[i];
+        if (sealed.queued || now - sealed.lastUseMs < COLD_AFTER_MS)
+            continue;
+
+        sealed.queued = true;
+        ++queued;
+
+        // The QByteArray is implicitly shared: the compressor thread reads
+        // its own reference while the UI thread may still decode from it.
+        const qint64     firstRow = m_rowBase + qint64(i) * SEGMENT_FRAMES;
+        const QByteArray encoded  = sealed.segment.encoded();
+        QMetaObject::invokeMethod(m_compressContext, [this, firstRow, encoded]() {
+            const QByteArray packed = qCompress(encoded, 1);
+            if (packed.size() >= encoded.size())
+                return;   // incompressible — keep it as is
+            QMetaObject::invokeMethod(this, [this, firstRow, packed]() {
+                adoptCompressed(firstRow, packed);
+            }, Qt::QueuedConnection);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void TraceModel::adoptCompressed(qint64 firstRow, const QByteArray& packed)
+{
+    // The segment may have been purged or cleared while it was compressed.
+    const qint64 offset = firstRow - m_rowBase;
+    if (offset < 0 || offset % SEGMENT_FRAMES != 0)
+        return;
+    const qint64 i = offset / SEGMENT_FRAMES;
+    if (i >= static_cast<qint64>(m_sealed.size()))
+        return;
+
+    TraceSegment& segment = m_sealed[size_t(i)].segment;
+    if (segment.isCompressed())
+        return;
+    m_sealedBytes += packed.size() - segment.bytes();
+    segment.adoptCompressed(packed);
+}
+
+void TraceModel::forEachMessage(const std::function<void(const CANManager::CANMessage&)>& fn) const
+{
+    QVector<CANManager::CANMessage> decoded;
+    for (const SealedSegment& sealed : m_sealed) {
+        sealed.segment.decode(decoded);
+        for (const CANManager::CANMessage& msg : decoded)
+            fn(msg);
+    }
+    for (const TraceEntry& e : m_frames)
+        fn(e.msg);
+}
+
+void TraceModel::forEachEntry(const std::function<void(const TraceEntry&)>& fn) const
+{
+    // Built locally, not through entryAt(): an export would flush the row
+    // cache the view is using.
+    QVector<CANManager::CANMessage> decoded;
+    for (const SealedSegment& sealed : m_sealed) {
+        sealed.segment.decode(decoded);
+        for (const CANManager::CANMessage& msg : decoded)
+            fn(TraceEntryBuilder::build(msg, m_db.get()));
+    }
+    for (const TraceEntry& e : m_frames)
+        fn(e);
+}
+
 void TraceModel::addEntriesInPlace(const QVector<TraceEntry>& entries)
 {
     if (entries.isEmpty()) return;
@@ -195,7 +499,7 @@ void TraceModel::addEntriesInPlace(const QVector<TraceEntry>& entries)
 #endif
 
     for (const TraceEntry& entry : entries) {
-        const quint64 key = makeEntryKey(entry);
+        const quint64 key = makeEntryKey(entry.msg);
         const auto it = m_inPlaceRows.constFind(key);
 
         if (it != m_inPlaceRows.cend()) {
@@ -239,7 +543,7 @@ QModelIndex TraceModel::index(int row, int col, const QModelIndex& parent) const
     {
         // ── Root level → frame items ─────────────────────────────────────────
         // parent invalid means "give me a root-level child".
-        if (row < 0 || row >= static_cast<int>(m_frames.size())) return {};
+        if (row < 0 || row >= frameCount()) return {};
 
         // nullptr internalPointer = sentinel meaning "I am a frame item"
         return createIndex(row, col, nullptr);
@@ -250,9 +554,9 @@ QModelIndex TraceModel::index(int row, int col, const QModelIndex& parent) const
     if (isSignalIndex(parent)) return {};   // signals have no children
 
     const int frameRow = parent.row();
-    if (frameRow < 0 || frameRow >= static_cast<int>(m_frames.size())) return {};
+    if (frameRow < 0 || frameRow >= frameCount()) return {};
 
-    const QVector<SignalRow>& sigs = m_frames[frameRow].decodedSignals;
+    const QVector<SignalRow>& sigs = entryAt(frameRow).decodedSignals;
     if (row < 0 || row >= sigs.size()) return {};
 
     // Encode (frameRow + 1) as an integer into the pointer field.
@@ -274,7 +578,7 @@ QModelIndex TraceModel::parent(const QModelIndex& child) const
 
     // Signal item: recover the frame row from internalPointer
     const int frameRow = frameRowOf(child);
-    if (frameRow < 0 || frameRow >= static_cast<int>(m_frames.size())) return {};
+    if (frameRow < 0 || frameRow >= frameCount()) return {};
 
     // Qt convention: parent indices always use column 0.
     return createIndex(frameRow, 0, nullptr);
@@ -287,15 +591,15 @@ QModelIndex TraceModel::parent(const QModelIndex& child) const
 int TraceModel::rowCount(const QModelIndex& parent) const
 {
     if (!parent.isValid())
-        return static_cast<int>(m_frames.size());          // root → total frame count
+        return frameCount();             // root → total frame count
 
     if (isSignalIndex(parent))
         return 0;                        // signal rows have no children
 
     // Frame item → number of decoded signals (child rows when expanded)
     const int frameRow = parent.row();
-    if (frameRow < 0 || frameRow >= static_cast<int>(m_frames.size())) return 0;
-    return m_frames[frameRow].decodedSignals.size();
+    if (frameRow < 0 || frameRow >= frameCount()) return 0;
+    return entryAt(frameRow).decodedSignals.size();
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -315,8 +619,9 @@ int TraceModel::columnCount(const QModelIndex& /*parent*/) const
  * @brief Return display or style data for one cell.
  *
  * PERFORMANCE CONTRACT: O(1) — no string formatting here.
- * All display strings were pre-built in AppController::buildEntry()
- * at insertion time and stored in TraceEntry / SignalRow.
+ * All display strings were pre-built in TraceEntryBuilder::build()
+ * at insertion time and stored in TraceEntry / SignalRow.  Sealed rows
+ * are the exception: entryAt() builds them once and caches the result.
  *
  * Role dispatch order:
  *   1. DisplayRole  — most common, handled first
@@ -325,6 +630,7 @@ int TraceModel::columnCount(const QModelIndex& /*parent*/) const
  */
 QVariant TraceModel::data(const QModelIndex& index, int role) const
 {
+    ++m_viewStats.dataCalls;
     if (!index.isValid()) return {};
 
     const int col = index.column();
@@ -336,14 +642,25 @@ QVariant TraceModel::data(const QModelIndex& index, int role) const
     if (isSignalIndex(index))
     {
         const int frameRow = frameRowOf(index);
-        if (frameRow < 0 || frameRow >= static_cast<int>(m_frames.size())) return {};
+        if (frameRow < 0 || frameRow >= frameCount()) return {};
 
-        const QVector<SignalRow>& sigs = m_frames[frameRow].decodedSignals;
+        const QVector<SignalRow>& sigs = entryAt(frameRow).decodedSignals;
         const int sigRow = index.row();
         if (sigRow < 0 || sigRow >= sigs.size()) return {};
 
         const SignalRow& sig = sigs[sigRow];
 
+        // ── Row snapshot (built on demand — signal rows are few) ──────────────
+        if (role == RowRole)
+        {
+            ++m_viewStats.rowCalls;
+            TraceRow r;
+            r.cells[ColName] = sig.name;
+            r.cells[ColID]   = sig.valueStr;
+            r.cells[ColData] = sig.rawStr;
+            return QVariant::fromValue(r);
+        }
+
         // ── Display text ─────────────────────────────────────────────────────
         if (role == Qt::DisplayRole)
         {
@@ -386,9 +703,16 @@ QVariant TraceModel::data(const QModelIndex& index, int role) const
     // ══════════════════════════════════════════════════════════════════════════
 
     const int row = index.row();
-    if (row < 0 || row >= static_cast<int>(m_frames.size())) return {};
+    if (row < 0 || row >= frameCount()) return {};
+
+    // ── Row snapshot — one call per cell instead of one per role ─────────────
+    if (role == RowRole)
+    {
+        ++m_viewStats.rowCalls;
+        return QVariant::fromValue(rowSnapshot(row));
+    }
 
-    const TraceEntry& e = m_frames[row];
+    const TraceEntry& e = entryAt(row);
 
     // ── Qt::DisplayRole — text shown in cell ─────────────────────────────────
     if (role == Qt::DisplayRole)
@@ -543,6 +867,7 @@ QVariant TraceModel::headerData(int section, Qt::Orientation orientation,
  *   color: model.isError  ? "#ff6666" : "#c8daf0"
  *   color: model.channel  === 2 ? "#ff8c4d" : "#4da8ff"
  *   visible: model.isFrame && model.isDecoded
+ *   text:    model.rowData.cell(column)      (RowRole — everything at once)
  */
 QHash<int, QByteArray> TraceModel::roleNames() const
 {
@@ -555,6 +880,7 @@ QHash<int, QByteArray> TraceModel::roleNames() const
     roles[SignalNameRole]  = "sigName";
     roles[SignalValueRole] = "sigValue";
     roles[SignalRawRole]   = "sigRaw";
+    roles[RowRole]         = "rowData";
     return roles;
 }
 
@@ -576,12 +902,17 @@ void TraceModel::addEntries(const QVector<TraceEntry>& entries)
 
 void TraceModel::clear()
 {
-    if (m_frames.empty() && m_inPlaceRows.isEmpty()) return;
+    if (frameCount() == 0 && m_inPlaceRows.isEmpty()) return;
 
     // beginResetModel / endResetModel is the most efficient way to clear —
     // it tells the view to discard all cached positions and start fresh.
     beginResetModel();
+    m_rowBase += frameCount();   // late compressor replies must not match new rows
     m_frames.clear();
+    m_sealed.clear();
+    m_sealedRows  = 0;
+    m_sealedBytes = 0;
+    dropCaches();
     m_inPlaceRows.clear();
     endResetModel();
 }
@@ -29,8 +29,36 @@
  *                                               ^^ non-null = signal
  *                                               +1 so it's never nullptr
  *
- *  This lets the model hold 100 000+ frames + millions of signals with
- *  zero per-item heap overhead beyond the m_frames QVector itself.
+ *  No per-item node objects, then: up to MAX_ROWS (5 000 000) frames cost
+ *  only their storage — full TraceEntry objects for the std::deque hot
+ *  tail (m_frames), compact TraceSegments for everything older (see
+ *  SEALED SEGMENTS below).
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  SEALED SEGMENTS  (Append mode)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  Only the newest frames are kept as full TraceEntry objects (the hot
+ *  tail).  Once the tail holds more than HOT_FRAMES + SEGMENT_FRAMES rows,
+ *  its oldest SEGMENT_FRAMES are encoded into a TraceSegment — ~10 bytes
+ *  per frame instead of several hundred — and dropped from the tail:
+ *
+ *    rows  [0 ……………………………… sealedRows) [sealedRows ……… frameCount)
+ *          m_sealed: TraceSegment × N            m_frames: TraceEntry
+ *          SEGMENT_FRAMES rows each              (hot tail)
+ *
+ *  Row numbers do not move when a block is sealed, so no model signals are
+ *  needed.  entryAt() rebuilds a sealed row with TraceEntryBuilder when the
+ *  view asks for it; a small row cache and a decoded-segment cache keep
+ *  scrolling through old data cheap.  Sealed rows are re-decoded with the
+ *  DBC last passed to setDatabase(), not the one active when they arrived.
+ *
+ *  Segments not touched for COLD_AFTER_MS are zlib-compressed (level 1)
+ *  on a lowest-priority thread, roughly halving them again.  The result
+ *  is swapped in on the UI thread; TraceSegment::decode() inflates it
+ *  when the view or an exporter reads the segment, and the
+ *  decoded-segment cache keeps the few segments being looked at inflated.
+ *
+ *  In-place mode keeps one row per key, so it never seals.
  *
  * ═══════════════════════════════════════════════════════════════════════════
  *  8-COLUMN LAYOUT  (matches Vector CANalyzer / CANoe trace window)
@@ -52,17 +80,37 @@
  *   Col 2  Physical value  "1450 rpm"
  *   Col 7  Raw value       "0x05A6"
  *   All other columns: empty string
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  ROW SNAPSHOTS (RowRole → TraceRow)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  A delegate asking for display, channel, isError, isFD and isDecoded
+ *  separately costs one data() call and one QVariant per role per cell —
+ *  by its bindings six per cell, 48 per row.  RowRole returns a TraceRow
+ *  gadget with every column and flag instead, so a cell needs one call.
+ *  Snapshots live in a direct-mapped cache of SNAPSHOT_CACHE_SIZE rows
+ *  (more than a screenful), so the eight cells of a row — and rows
+ *  scrolled back into view — share one build.  Those figures come from
+ *  reading the bindings; the observed ones are what viewStats() counts per
+ *  scroll step (AppController::traceViewStats(), bench_trace_scroll).
  */
 
 #include <QAbstractItemModel>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QTimer>
 #include <QVector>
 #include <QString>
 #include <cstdint>
 #include <deque>
+#include <functional>
+#include <memory>
 
 #include "hardware/CANInterface.h"
 #include "dbc/DBCParser.h"
+#include "trace/TraceSegment.h"
+
+class QThread;
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  SignalRow — one decoded DBC signal (appears as a child tree row)
@@ -79,6 +127,7 @@ struct SignalRow
     QString name;       ///< Signal name,       e.g. "EngineSpeed"
     QString valueStr;   ///< Physical value,    e.g. "1450 rpm"
     QString rawStr;     ///< Raw hex value,     e.g. "0x05A6"
+    double  value = 0;  ///< Physical value as a number (SignalStreamServer)
 };
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -88,7 +137,7 @@ struct SignalRow
 /**
  * @brief One frame row in the trace tree.
  *
- * All display strings are pre-computed in AppController::buildEntry()
+ * All display strings are pre-computed in TraceEntryBuilder::build()
  * at insertion time so TraceModel::data() is a trivial array lookup
  * (O(1), no QString formatting on the hot render path).
  *
@@ -115,6 +164,50 @@ struct TraceEntry
     QVector<SignalRow> decodedSignals;
 };
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  TraceRow — everything a delegate shows for one row (RowRole)
+// ─────────────────────────────────────────────────────────────────────────────
+
+/**
+ * @brief Snapshot of one frame or signal row for QML.
+ *
+ * The strings are implicitly shared with the TraceEntry, so a snapshot is
+ * eight reference-count bumps, not eight copies.
+ *
+ *   readonly property var row: model.rowData
+ *   text:  row.cell(column)
+ *   color: row.isError ? … : …
+ */
+struct TraceRow
+{
+    Q_GADGET
+    Q_PROPERTY(bool isFrame   MEMBER isFrame)
+    Q_PROPERTY(bool isError   MEMBER isError)
+    Q_PROPERTY(bool isFD      MEMBER isFD)
+    Q_PROPERTY(bool isDecoded MEMBER isDecoded)
+    Q_PROPERTY(bool isTx      MEMBER isTx)
+    Q_PROPERTY(int  channel   MEMBER channel)
+
+public:
+    static constexpr int COLUMNS = 8;
+
+    /** Display text of @p column (same as Qt::DisplayRole). */
+    Q_INVOKABLE QString cell(int column) const
+    {
+        return (column >= 0 && column < COLUMNS) ? cells[column] : QString();
+    }
+
+    QString cells[COLUMNS];
+    bool    isFrame   = false;
+    bool    isError   = false;
+    bool    isFD      = false;
+    bool    isDecoded = false;
+    bool    isTx      = false;
+    int     channel   = 0;
+};
+
+Q_DECLARE_METATYPE(TraceRow)
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  TraceModel — QAbstractItemModel for a 2-level CAN trace tree
 // ─────────────────────────────────────────────────────────────────────────────
@@ -167,7 +260,17 @@ public:
         ChannelRole,                        ///< int:  hardware channel number (1 or 2)
         SignalNameRole,                     ///< QString: (signal rows) signal name
         SignalValueRole,                    ///< QString: (signal rows) "1450 rpm"
-        SignalRawRole                       ///< QString: (signal rows) "0x05A6"
+        SignalRawRole,                      ///< QString: (signal rows) "0x05A6"
+        RowRole                             ///< TraceRow: all of the above at once
+    };
+
+    /** data() traffic since resetViewStats() — see ROW SNAPSHOTS above. */
+    struct ViewStats
+    {
+        quint64 dataCalls      = 0;   ///< every data() call
+        quint64 rowCalls       = 0;   ///< of those, RowRole
+        quint64 snapshotBuilds = 0;   ///< RowRole misses (TraceRow built)
+        quint64 scrollSteps    = 0;   ///< noteScrollStep() calls
     };
 
     // ── Configuration constants ───────────────────────────────────────────────
@@ -176,17 +279,33 @@ public:
      * @brief Maximum number of frames to keep in memory.
      *
      * When exceeded, PURGE_CHUNK oldest frames are removed at once
-     * (bulk remove is cheaper than per-frame removes).
+     * (bulk remove is cheaper than per-frame removes).  With sealed
+     * segments the oldest whole segments go, so slightly more may be removed.
      */
-    static constexpr int MAX_ROWS    = 100000;
+    static constexpr int MAX_ROWS    = 5000000;
     static constexpr int PURGE_CHUNK = 5000;
 
+    /// Frames per sealed segment, and full entries always kept in the hot tail.
+    static constexpr int SEGMENT_FRAMES = 4096;
+    static constexpr int HOT_FRAMES     = 8192;
+
+    /// Sealed segments untouched this long are compressed in the background.
+    static constexpr int COLD_AFTER_MS     = 30000;
+    static constexpr int COLD_SCAN_MS      = 2000;
+    static constexpr int COLD_BATCH        = 8;    ///< segments queued per scan
+
+    /// Rows whose TraceRow snapshot is kept — comfortably above one screen.
+    static constexpr int SNAPSHOT_CACHE_SIZE = 256;
+
     explicit TraceModel(QObject* parent = nullptr);
-    ~TraceModel() override = default;
+    ~TraceModel() override;
 
     void setDisplayMode(DisplayMode mode);
     DisplayMode displayMode() const { return m_displayMode; }
 
+    /** DBC used to rebuild sealed rows (the model keeps its own snapshot). */
+    void setDatabase(const DBCManager::DBCDatabase& db);
+
     // ── QAbstractItemModel interface (required overrides) ─────────────────────
 
     /**
@@ -264,22 +383,58 @@ public:
     void clear();
 
     /** Current frame count (for status bar display). */
-    int frameCount() const { return static_cast<int>(m_frames.size()); }
+    int frameCount() const { return m_sealedRows + static_cast<int>(m_frames.size()); }
+
+    /**
+     * @brief First row at or after @p timestampNs (binary search), or -1.
+     *
+     * Append mode only — rows are in capture order there.  Sealed segments
+     * are bisected by their first timestamp, so at most one is decoded.
+     */
+    int rowAtTime(quint64 timestampNs) const;
+
+    /** Raw frame of @p row (sealed rows are decoded, not rebuilt). */
+    CANManager::CANMessage messageAt(int row) const;
+
+    /** Bytes held by sealed segments (the hot tail is not counted). */
+    qint64 encodedBytes() const { return m_sealedBytes; }
+
+    /**
+     * @brief Visit every frame's raw CANMessage, oldest first.
+     *
+     * WHY not expose the storage: the trace exporter (TraceExporter) needs
+     * the raw CANMessage fields (id, timestamp, dlc, data[], flags) to write
+     * ASC/BLF files, but most rows no longer exist as TraceEntry objects.
+     * Sealed segments are decoded one at a time, so this never materialises
+     * the whole trace.  Do not mutate the model from @p fn.
+     */
+    void forEachMessage(const std::function<void(const CANManager::CANMessage&)>& fn) const;
 
     /**
-     * @brief Direct read-only access to raw frame data.
+     * @brief Visit every frame as a display entry, oldest first.
      *
-     * WHY expose this? The trace exporter (TraceExporter) needs the raw
-     * CANMessage fields (id, timestamp, dlc, data[], flags) to write ASC/BLF
-     * files.  Using data(index, DisplayRole) would work but means parsing
-     * pre-formatted strings back to numbers — fragile and wasteful.
-     * A const reference is zero-copy and safe as long as the caller does not
-     * hold it across model mutations.
+     * Sealed rows are rebuilt on the fly (see entryAt()), so prefer
+     * forEachMessage() when only the raw frame is needed.
      */
-    const std::deque<TraceEntry>& frames() const { return m_frames; }
+    void forEachEntry(const std::function<void(const TraceEntry&)>& fn) const;
+
+    /** Snapshot of frame @p row (cached; see ROW SNAPSHOTS). */
+    TraceRow rowSnapshot(int row) const;
+
+    ViewStats viewStats() const { return m_viewStats; }
+    void      resetViewStats() { m_viewStats = ViewStats{}; }
+
+    /** The view scrolled (TreeView contentY changed) — for viewStats(). */
+    Q_INVOKABLE void noteScrollStep() { ++m_viewStats.scrollSteps; }
 
 private:
-    static quint64 makeEntryKey(const TraceEntry& entry);
+    static quint64 makeEntryKey(const CANManager::CANMessage& msg);
+    const TraceEntry& entryAt(int row) const;
+    const QVector<CANManager::CANMessage>& sealedFrames(int segment) const;
+    void sealOldest();
+    void dropCaches();
+    void compressColdSegments();
+    void adoptCompressed(qint64 firstRow, const QByteArray& packed);
     void rebuildInPlaceIndex();
     void purgeOldestRows(int count);
     void addEntriesAppend(const QVector<TraceEntry>& entries);
@@ -313,7 +468,55 @@ private:
                    reinterpret_cast<quintptr>(idx.internalPointer())) - 1;
     }
 
-    std::deque<TraceEntry> m_frames;   ///< All stored frames (root-level items)
+    std::deque<TraceEntry> m_frames;   ///< Hot tail: rows [m_sealedRows, frameCount())
     DisplayMode         m_displayMode = DisplayMode::Append;
     QHash<quint64, int> m_inPlaceRows; ///< key -> row index (only used in in-place mode)
+
+    // ── Sealed segments (rows [0, m_sealedRows)) ─────────────────────────────
+    struct SealedSegment
+    {
+        TraceSegment   segment;
+        mutable qint64 lastUseMs = 0;       ///< m_clock time of the last view access
+        bool           queued    = false;   ///< handed to the compressor (once only)
+    };
+
+    std::deque<SealedSegment> m_sealed;
+    int     m_sealedRows  = 0;
+    qint64  m_sealedBytes = 0;
+    qint64  m_rowBase     = 0;   ///< absolute number of row 0 — only grows, so
+                                 ///< cache and compressor keys never repeat
+
+    // ── Cold-segment compression ─────────────────────────────────────────────
+    QElapsedTimer m_clock;
+    QTimer        m_coldTimer;
+    QThread*      m_compressThread  = nullptr;
+    QObject*      m_compressContext = nullptr;   ///< lives on m_compressThread
+    std::shared_ptr<const DBCManager::DBCDatabase> m_db;
+
+    // ── Caches for sealed rows (mutable: filled from const data()) ──────────
+    static constexpr int ROW_CACHE_SIZE     = 1024;
+    static constexpr int SEGMENT_CACHE_SIZE = 4;
+
+    struct DecodedSegment
+    {
+        qint64 firstRow = -1;   ///< absolute row (m_rowBase + row) of frame 0
+        QVector<CANManager::CANMessage> frames;
+    };
+
+    mutable QHash<qint64, TraceEntry> m_rowCache;        ///< absolute row -> entry
+    mutable std::deque<qint64>        m_rowCacheOrder;   ///< FIFO eviction
+    mutable DecodedSegment            m_segmentCache[SEGMENT_CACHE_SIZE];
+    mutable int                       m_segmentCacheNext = 0;
+
+    // ── Row snapshots: slot = absolute row % SNAPSHOT_CACHE_SIZE ────────────
+    struct Snapshot
+    {
+        qint64   key = -1;   ///< absolute row, −1 = empty
+        TraceRow row;
+    };
+
+    void dropSnapshot(int row);
+
+    mutable Snapshot  m_snapshots[SNAPSHOT_CACHE_SIZE];
+    mutable ViewStats m_viewStats;
 };
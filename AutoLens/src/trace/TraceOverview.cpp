@@ -0,0 +1,213 @@
+/**
+ * @file TraceOverview.cpp
+ * @brief Bucket pyramid behind the trace minimap.
+ */
+
+#include "trace/TraceOverview.h"
+#include "hardware/CANBitTiming.h"
+
+#include <algorithm>
+
+using namespace CANManager;
+using namespace DBCManager;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Bucket
+// ─────────────────────────────────────────────────────────────────────────────
+
+void TraceOverview::Bucket::merge(const Bucket& other)
+{
+    for (int ch = 0; ch < CHANNELS; ++ch) {
+        frames[ch] += other.frames[ch];
+        busyNs[ch] += other.busyNs[ch];
+    }
+    errors += other.errors;
+
+    if (other.hasSignal) {
+        signalMin = hasSignal ? std::min(signalMin, other.signalMin) : other.signalMin;
+        signalMax = hasSignal ? std::max(signalMax, other.signalMax) : other.signalMax;
+        hasSignal = true;
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Configuration
+// ─────────────────────────────────────────────────────────────────────────────
+
+void TraceOverview::clear()
+{
+    m_levels.clear();
+    m_originNs  = 0;
+    m_dirtyFrom = 0;
+}
+
+void TraceOverview::setBitTiming(int nominalBitrate, int dataBitrate, bool fdEnabled)
+{
+    m_bitrate     = nominalBitrate;
+    m_dataBitrate = dataBitrate;
+    m_fdEnabled   = fdEnabled;
+}
+
+void TraceOverview::setSignal(uint32_t messageId, const DBCSignal& sig,
+                              const DBCSignal* muxSelector)
+{
+    m_signalSet       = true;
+    m_signalMessageId = messageId;
+    m_signal          = sig;
+    m_hasMuxSelector  = muxSelector != nullptr;
+    m_muxSelector     = muxSelector ? *muxSelector : DBCSignal();
+
+    for (QVector<Bucket>& level : m_levels) {
+        for (Bucket& b : level)
+            b.hasSignal = false;
+    }
+    m_dirtyFrom = 0;
+}
+
+void TraceOverview::clearSignal()
+{
+    setSignal(0, DBCSignal());
+    m_signalSet = false;
+}
+
+qint64 TraceOverview::widthOf(int level)
+{
+    qint64 w = BASE_BUCKET_NS;
+    for (int i = 0; i < level; ++i)
+        w *= FANOUT;
+    return w;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  add — one frame into level 0
+// ─────────────────────────────────────────────────────────────────────────────
+
+int TraceOverview::bucketIndex(quint64 timestampNs)
+{
+    if (isEmpty()) {
+        m_levels.resize(1);
+        m_originNs = qint64(timestampNs) - qint64(timestampNs) % BASE_BUCKET_NS;
+    }
+
+    // Slightly out-of-order frames (a second channel, an appended import
+    // that starts earlier) are clamped rather than growing the front.
+    const qint64 offset = qMax<qint64>(0, qint64(timestampNs) - m_originNs);
+    return int(qMin<qint64>(offset / BASE_BUCKET_NS, MAX_BASE_BUCKETS - 1));
+}
+
+TraceOverview::Bucket& TraceOverview::baseBucket(const CANMessage& msg)
+{
+    const int idx = bucketIndex(msg.timestamp);
+    QVector<Bucket>& base = m_levels[0];
+    if (idx >= base.size())
+        base.resize(idx + 1);
+    m_dirtyFrom = qMin(m_dirtyFrom, idx);
+    return base[idx];
+}
+
+void TraceOverview::add(const CANMessage& msg)
+{
+    Bucket& b = baseBucket(msg);
+    const int ch = msg.channel - 1;
+
+    if (msg.isError) {
+        ++b.errors;
+    } else if (ch >= 0 && ch < CHANNELS) {
+        ++b.frames[ch];
+        b.busyNs[ch] += CANBitTiming::frameDurationNs(msg, m_bitrate, m_dataBitrate, m_fdEnabled);
+    }
+
+    addSignal(msg);
+}
+
+void TraceOverview::addSignal(const CANMessage& msg)
+{
+    if (!m_signalSet || msg.id != m_signalMessageId || msg.isError || msg.isRemote)
+        return;
+
+    const int len = msg.dataLength();
+    if (m_hasMuxSelector && m_signal.muxValue >= 0
+        && m_muxSelector.rawValue(msg.data, len) != m_signal.muxValue)
+        return;
+
+    const float v = float(m_signal.decode(msg.data, len));
+    Bucket& b = baseBucket(msg);
+    b.signalMin = b.hasSignal ? std::min(b.signalMin, v) : v;
+    b.signalMax = b.hasSignal ? std::max(b.signalMax, v) : v;
+    b.hasSignal = true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  rollUp — rebuild coarser levels from the first changed bucket on
+// ─────────────────────────────────────────────────────────────────────────────
+
+void TraceOverview::rollUp()
+{
+    if (isEmpty() || m_dirtyFrom >= m_levels[0].size())
+        return;
+
+    int dirty = m_dirtyFrom;
+    for (int level = 1; m_levels[level - 1].size() > 1; ++level) {
+        if (level >= m_levels.size())
+            m_levels.resize(level + 1);
+
+        const QVector<Bucket>& child = m_levels[level - 1];
+        QVector<Bucket>&       parent = m_levels[level];
+        const int parentSize = (child.size() + FANOUT - 1) / FANOUT;
+        dirty /= FANOUT;
+
+        parent.resize(parentSize);
+        for (int j = dirty; j < parentSize; ++j) {
+            Bucket sum;
+            const int end = qMin(child.size(), (j + 1) * FANOUT);
+            for (int c = j * FANOUT; c < end; ++c)
+                sum.merge(child[c]);
+            parent[j] = sum;
+        }
+    }
+
+    m_dirtyFrom = m_levels[0].size();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  query — one merged bucket per column
+// ─────────────────────────────────────────────────────────────────────────────
+
+QVector<TraceOverview::Column> TraceOverview::query(qint64 fromNs, qint64 toNs, int columns)
+{
+    QVector<Column> out;
+    if (columns <= 0 || toNs <= fromNs || isEmpty())
+        return out;
+
+    rollUp();
+
+    // Coarsest level whose buckets are no wider than a column.
+    const double columnNs = double(toNs - fromNs) / columns;
+    int level = 0;
+    while (level + 1 < m_levels.size() && double(widthOf(level + 1)) <= columnNs)
+        ++level;
+
+    const QVector<Bucket>& buckets = m_levels[level];
+    const qint64 width = widthOf(level);
+
+    out.resize(columns);
+    for (int c = 0; c < columns; ++c) {
+        // A bucket belongs to the column its start falls in, so no frame
+        // is counted twice.
+        const qint64 a = fromNs + qint64(columnNs * c) - m_originNs;
+        const qint64 b = fromNs + qint64(columnNs * (c + 1)) - m_originNs;
+        auto ceilDiv = [width](qint64 v) { return v <= 0 ? 0 : (v + width - 1) / width; };
+        int first = int(qMin<qint64>(ceilDiv(a), buckets.size()));
+        int last  = int(qMin<qint64>(ceilDiv(b), buckets.size()));
+        if (last <= first && a >= 0 && a / width < buckets.size()) {
+            first = int(a / width);   // zoomed in past level 0: show its bucket
+            last  = first + 1;
+        }
+
+        Column& col = out[c];
+        for (int i = first; i < last; ++i)
+            col.sum.merge(buckets[i]);
+        col.coveredNs = qint64(last - first) * width;
+    }
+    return out;
+}
@@ -0,0 +1,118 @@
+#pragma once
+/**
+ * @file TraceOverview.h
+ * @brief Multi-resolution per-time-bucket aggregates for the trace minimap.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  A multi-hour trace holds millions of rows; a scrollbar gives no idea
+ *  where the bursts, the error frames or the interesting signal values
+ *  are.  The minimap needs one value per pixel column, and computing that
+ *  from the frames would be O(frames) per repaint.  Instead every frame is
+ *  counted once, as it reaches the trace, into a pyramid of buckets:
+ *
+ *    level 0   ▕▏▕▏▕▏▕▏▕▏▕▏▕▏▕▏▕▏▕▏▕▏▕▏▕▏▕▏▕▏▕▏   BASE_BUCKET_NS each
+ *    level 1   ▕   ▏▕   ▏▕   ▏▕   ▏                 FANOUT level-0 buckets
+ *    level 2   ▕               ▏                      …
+ *
+ *  Only level 0 is written by add().  Coarser levels are derived from the
+ *  level below by rollUp(), and only from the first bucket that changed —
+ *  during capture that is the last one or two per level.  query() picks
+ *  the coarsest level whose buckets are still narrower than a pixel
+ *  column, so each column merges at most FANOUT + 1 buckets: a repaint is
+ *  O(pixels), whatever the trace length.
+ *
+ *  Per bucket: frames per channel, error frames, on-wire time per channel
+ *  (→ bus load) and min/max of one chosen DBC signal.
+ *
+ *  Not thread-safe: AppController feeds and queries it on the UI thread.
+ */
+
+#include <QVector>
+#include <cstdint>
+
+#include "hardware/CANInterface.h"
+#include "dbc/DBCParser.h"
+
+class TraceOverview
+{
+public:
+    static constexpr int    CHANNELS         = 4;
+    static constexpr qint64 BASE_BUCKET_NS   = 100 * 1000 * 1000;   ///< 100 ms
+    static constexpr int    FANOUT           = 4;
+    static constexpr int    MAX_BASE_BUCKETS = 1 << 21;             ///< ~58 h; later frames land in the last bucket
+
+    struct Bucket
+    {
+        quint32 frames[CHANNELS] = {};
+        quint32 errors           = 0;
+        quint64 busyNs[CHANNELS] = {};   ///< on-wire time, for bus load
+        float   signalMin        = 0;
+        float   signalMax        = 0;
+        bool    hasSignal        = false;
+
+        void merge(const Bucket& other);
+    };
+
+    /** One minimap column from query(). */
+    struct Column
+    {
+        Bucket  sum;
+        qint64  coveredNs = 0;   ///< bucket time merged into @c sum (load denominator)
+    };
+
+    /** Drop all buckets (new capture / trace cleared). */
+    void clear();
+
+    /** Bit timing used to turn frames into on-wire time. */
+    void setBitTiming(int nominalBitrate, int dataBitrate, bool fdEnabled);
+
+    /**
+     * @brief Track min/max of @p sig in frames with @p messageId.
+     *
+     * For a multiplexed signal pass the message's selector as
+     * @p muxSelector; frames of other mux branches are then skipped.
+     * Resets the signal statistics of every bucket — replay the trace
+     * through addSignal() to fill them for frames already held.
+     */
+    void setSignal(uint32_t messageId, const DBCManager::DBCSignal& sig,
+                   const DBCManager::DBCSignal* muxSelector = nullptr);
+    void clearSignal();
+    bool hasSignal() const { return m_signalSet; }
+
+    /** Count one frame (frames, errors, bus time and signal). */
+    void add(const CANManager::CANMessage& msg);
+    /** Only update the signal min/max (see setSignal()). */
+    void addSignal(const CANManager::CANMessage& msg);
+
+    bool   isEmpty() const { return m_levels.isEmpty() || m_levels[0].isEmpty(); }
+    qint64 firstNs() const { return m_originNs; }
+    qint64 endNs() const
+    {
+        return isEmpty() ? m_originNs : m_originNs + qint64(m_levels[0].size()) * BASE_BUCKET_NS;
+    }
+
+    /** Aggregate [@p fromNs, @p toNs) into @p columns equal-width columns. */
+    QVector<Column> query(qint64 fromNs, qint64 toNs, int columns);
+
+private:
+    int     bucketIndex(quint64 timestampNs);
+    Bucket& baseBucket(const CANManager::CANMessage& msg);
+    void    rollUp();
+    static qint64 widthOf(int level);
+
+    QVector<QVector<Bucket>> m_levels;      ///< [0] = finest
+    qint64  m_originNs  = 0;                ///< start of bucket 0
+    int     m_dirtyFrom = 0;                ///< first level-0 bucket changed since rollUp()
+
+    int     m_bitrate     = 500000;
+    int     m_dataBitrate = 2000000;
+    bool    m_fdEnabled   = false;
+
+    bool                  m_signalSet = false;
+    uint32_t              m_signalMessageId = 0;
+    DBCManager::DBCSignal m_signal;
+    bool                  m_hasMuxSelector = false;
+    DBCManager::DBCSignal m_muxSelector;
+};
@@ -0,0 +1,191 @@
+/**
+ * @file TraceSegment.cpp
+ * @brief Delta/XOR frame encoding for sealed trace segments.
+ */
+
+#include "trace/TraceSegment.h"
+
+#include <QHash>
+
+#include <array>
+#include <cstring>
+
+using namespace CANManager;
+
+namespace {
+
+enum : uint8_t {
+    kFlagExt         = 0x01,
+    kFlagFD          = 0x02,
+    kFlagBRS         = 0x04,
+    kFlagRemote      = 0x08,
+    kFlagError       = 0x10,
+    kFlagTx          = 0x20,
+    kFlagSamePayload = 0x40,
+};
+
+using Payload = std::array<uint8_t, 64>;
+
+inline quint64 baseKey(uint32_t id, uint8_t channel, bool ext)
+{
+    return quint64(id) | (quint64(channel) << 32) | (ext ? (1ull << 40) : 0);
+}
+
+inline void putVarint(QByteArray& out, quint64 v)
+{
+    char buf[10];
+    int  n = 0;
+    while (v >= 0x80) {
+        buf[n++] = char(uint8_t(v) | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = char(v);
+    out.append(buf, n);
+}
+
+inline quint64 getVarint(const uint8_t*& p, const uint8_t* end)
+{
+    quint64 v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const uint8_t b = *p++;
+        v |= quint64(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            break;
+    }
+    return v;
+}
+
+inline quint64 zigzag(qint64 v)    { return (quint64(v) << 1) ^ quint64(v >> 63); }
+inline qint64  unzigzag(quint64 v) { return qint64(v >> 1) ^ -qint64(v & 1); }
+
+inline int payloadLength(const CANMessage& m)
+{
+    return (m.isRemote || m.isError) ? 0 : m.dataLength();
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  encode
+// ─────────────────────────────────────────────────────────────────────────────
+
+TraceSegment TraceSegment::encode(const CANMessage* frames, int count)
+{
+    TraceSegment seg;
+    seg.m_count = count;
+    if (count <= 0)
+        return seg;
+
+    seg.m_firstNs = frames[0].timestamp;
+    seg.m_data.reserve(count * 12);
+
+    QHash<quint64, Payload> previous;   // XOR base per key, zero-initialised
+    quint64 prevNs = seg.m_firstNs;
+
+    for (int i = 0; i < count; ++i) {
+        const CANMessage& m = frames[i];
+        const int len = payloadLength(m);
+
+        Payload& base = previous[baseKey(m.id, m.channel, m.isExtended)];
+        const bool same = memcmp(base.data(), m.data, size_t(len)) == 0;
+
+        uint8_t flags = uint8_t((m.isExtended  ? kFlagExt    : 0)
+                              | (m.isFD        ? kFlagFD     : 0)
+                              | (m.isBRS       ? kFlagBRS    : 0)
+                              | (m.isRemote    ? kFlagRemote : 0)
+                              | (m.isError     ? kFlagError  : 0)
+                              | (m.isTxConfirm ? kFlagTx     : 0));
+        if (same)
+            flags |= kFlagSamePayload;
+
+        seg.m_data.append(char(flags));
+        putVarint(seg.m_data, zigzag(qint64(m.timestamp - prevNs)));
+        putVarint(seg.m_data, m.id);
+        if (m.channel > 0 && m.channel < 16) {
+            seg.m_data.append(char((m.channel << 4) | (m.dlc & 0x0F)));
+        } else {
+            seg.m_data.append(char(m.dlc & 0x0F));
+            seg.m_data.append(char(m.channel));
+        }
+        prevNs = m.timestamp;
+
+        if (same || len == 0)
+            continue;
+
+        // Mask of changed bytes, then the changed bytes XOR their base.
+        uint8_t mask[8] = {};
+        uint8_t diff[64];
+        int     nDiff = 0;
+        for (int b = 0; b < len; ++b) {
+            const uint8_t x = m.data[b] ^ base[b];
+            if (x) {
+                mask[b >> 3] |= uint8_t(1u << (b & 7));
+                diff[nDiff++] = x;
+            }
+        }
+        seg.m_data.append(reinterpret_cast<const char*>(mask), (len + 7) / 8);
+        seg.m_data.append(reinterpret_cast<const char*>(diff), nDiff);
+        memcpy(base.data(), m.data, size_t(len));
+    }
+
+    seg.m_data.squeeze();
+    return seg;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  decode
+// ─────────────────────────────────────────────────────────────────────────────
+
+void TraceSegment::decode(QVector<CANMessage>& out) const
+{
+    out.clear();
+    out.reserve(m_count);
+
+    const QByteArray data = m_compressed ? qUncompress(m_data) : m_data;
+
+    QHash<quint64, Payload> previous;
+    const uint8_t* p   = reinterpret_cast<const uint8_t*>(data.constData());
+    const uint8_t* end = p + data.size();
+    quint64 ts = m_firstNs;
+
+    for (int i = 0; i < m_count && p < end; ++i) {
+        CANMessage m;
+        const uint8_t flags = *p++;
+        m.isExtended  = flags & kFlagExt;
+        m.isFD        = flags & kFlagFD;
+        m.isBRS       = flags & kFlagBRS;
+        m.isRemote    = flags & kFlagRemote;
+        m.isError     = flags & kFlagError;
+        m.isTxConfirm = flags & kFlagTx;
+
+        ts += quint64(unzigzag(getVarint(p, end)));
+        m.timestamp = ts;
+        m.id        = uint32_t(getVarint(p, end));
+        if (p >= end)
+            break;
+        const uint8_t chanDlc = *p++;
+        m.dlc     = chanDlc & 0x0F;
+        m.channel = chanDlc >> 4;
+        if (m.channel == 0 && p < end)
+            m.channel = *p++;
+
+        const int len = payloadLength(m);
+        Payload& base = previous[baseKey(m.id, m.channel, m.isExtended)];
+        if (len > 0 && !(flags & kFlagSamePayload)) {
+            const int maskBytes = (len + 7) / 8;
+            if (end - p < maskBytes)
+                break;
+            const uint8_t* mask = p;
+            p += maskBytes;
+            for (int b = 0; b < len; ++b) {
+                if (mask[b >> 3] & (1u << (b & 7))) {
+                    if (p >= end)
+                        break;
+                    base[b] ^= *p++;
+                }
+            }
+        }
+        memcpy(m.data, base.data(), size_t(len));
+        out.append(m);
+    }
+}
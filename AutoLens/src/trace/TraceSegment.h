@@ -0,0 +1,75 @@
+#pragma once
+/**
+ * @file TraceSegment.h
+ * @brief Compact encoding for a sealed run of trace frames.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  A TraceEntry carries the full CANMessage (64 data bytes even for a
+ *  classic frame), eight pre-formatted QStrings and the decoded signal
+ *  rows — several hundred bytes per frame.  Periodic traffic is highly
+ *  redundant: the same IDs at steady intervals, payloads that differ from
+ *  the previous frame of that ID in one counter byte.  Once a block of
+ *  frames has scrolled out of the live tail, TraceModel keeps it in this
+ *  form instead and rebuilds a TraceEntry only for rows that are shown.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  FORMAT (per frame, in capture order)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *    u8      flags     bit0 ext, 1 FD, 2 BRS, 3 RTR, 4 error, 5 TX,
+ *                      bit6 payload identical to the previous frame of
+ *                           the same (channel, id, ext) — nothing follows
+ *    varint  zigzag(timestamp − previous timestamp)
+ *    varint  id
+ *    u8      channel << 4 | dlc     (channel nibble 0 → extra u8 channel)
+ *    payload, unless bit6 or RTR/error:
+ *      u8[(len+7)/8]  mask — bit i set: byte i differs from the previous
+ *                     frame of the same key
+ *      u8[popcount]   those bytes XOR the previous ones
+ *
+ *  The XOR base starts at all zeros in every segment, so a segment decodes
+ *  on its own — no state crosses segment boundaries.
+ *
+ *  A steady 8-byte frame with one changing counter byte costs ~9 bytes.
+ *
+ *  Segments nobody has looked at for a while are additionally zlib-
+ *  compressed by TraceModel (compressed(), adoptCompressed()); decode()
+ *  inflates them transparently.
+ */
+
+#include <QByteArray>
+#include <QVector>
+
+#include "hardware/CANInterface.h"
+
+class TraceSegment
+{
+public:
+    /** Encode @p count frames starting at @p frames. */
+    static TraceSegment encode(const CANManager::CANMessage* frames, int count);
+
+    /** Append the frames of this segment to @p out (cleared first). */
+    void decode(QVector<CANManager::CANMessage>& out) const;
+
+    int     count() const { return m_count; }
+    quint64 firstNs() const { return m_firstNs; }   ///< timestamp of frame 0
+    qint64 bytes() const { return m_data.size(); }   ///< as held (compressed or not)
+    bool   isCompressed() const { return m_compressed; }
+
+    /** The encoded bytes to compress elsewhere (shared copy, no allocation). */
+    QByteArray encoded() const { return m_data; }
+
+    /** Replace the held bytes with @p packed, the qCompress() of encoded(). */
+    void adoptCompressed(const QByteArray& packed)
+    {
+        m_data       = packed;
+        m_compressed = true;
+    }
+
+private:
+    QByteArray m_data;
+    quint64    m_firstNs    = 0;
+    int        m_count      = 0;
+    bool       m_compressed = false;
+};
@@ -0,0 +1,546 @@
+/**
+ * @file AsyncFileWriter.cpp
+ * @brief Buffer management, the io_uring engine and the positional-write pool.
+ */
+
+#include "util/AsyncFileWriter.h"
+#include "util/ThreadPlacement.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(Q_OS_LINUX) && __has_include(<linux/io_uring.h>)
+#define AUTOLENS_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Engine interface
+// ─────────────────────────────────────────────────────────────────────────────
+
+/** Backend: takes whole buffers, reports them back when written. */
+class AsyncFileWriter::Engine
+{
+public:
+    virtual ~Engine() = default;
+
+    /** Queue @p len bytes of buffer @p slot at @p offset.  Does not block. */
+    virtual void submit(int slot, const char* data, qint64 len, qint64 offset) = 0;
+
+    /** Block until one write completes; its slot, or −1 if nothing is in flight. */
+    virtual int waitOne() = 0;
+
+    int     inFlight = 0;
+    QString error;            ///< first failure
+};
+
+namespace {
+
+QString systemError(int code)
+{
+#if defined(Q_OS_WIN)
+    return QString("Windows error %1").arg(code);
+#else
+    return QString::fromLocal8Bit(strerror(code));
+#endif
+}
+
+/** Write all of @p len at @p offset; "" or the error. */
+QString positionalWrite(qintptr handle, const char* data, qint64 len, qint64 offset)
+{
+    while (len > 0) {
+#if defined(Q_OS_WIN)
+        OVERLAPPED ov{};
+        ov.Offset     = DWORD(quint64(offset) & 0xFFFFFFFFu);
+        ov.OffsetHigh = DWORD(quint64(offset) >> 32);
+        DWORD n = 0;
+        const DWORD chunk = DWORD(qMin<qint64>(len, 1 << 30));
+        if (!WriteFile(reinterpret_cast<HANDLE>(handle), data, chunk, &n, &ov))
+            return systemError(int(GetLastError()));
+#else
+        const ssize_t n = ::pwrite(int(handle), data, size_t(len), off_t(offset));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return systemError(errno);
+        }
+#endif
+        if (n == 0)
+            return QStringLiteral("write returned 0 bytes");
+        data   += n;
+        len    -= qint64(n);
+        offset += qint64(n);
+    }
+    return {};
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  ThreadPool engine — positional writes from POOL_THREADS workers
+// ─────────────────────────────────────────────────────────────────────────────
+
+class PoolEngine : public AsyncFileWriter::Engine
+{
+public:
+    explicit PoolEngine(qintptr handle) : m_handle(handle)
+    {
+        for (int i = 0; i < AsyncFileWriter::POOL_THREADS; ++i) {
+            QThread* t = QThread::create([this]() { workerLoop(); });
+            t->setObjectName(QStringLiteral("AutoLens_FileWriter_%1").arg(i));
+            t->start();
+            m_workers.append(t);
+        }
+    }
+
+    ~PoolEngine() override
+    {
+        {
+            QMutexLocker lock(&m_mutex);
+            m_stop = true;
+            m_jobReady.wakeAll();
+        }
+        for (QThread* t : m_workers) {
+            t->wait();
+            delete t;
+        }
+    }
+
+    void submit(int slot, const char* data, qint64 len, qint64 offset) override
+    {
+        QMutexLocker lock(&m_mutex);
+        m_jobs.push_back({ slot, data, len, offset });
+        ++inFlight;
+        m_jobReady.wakeOne();
+    }
+
+    int waitOne() override
+    {
+        QMutexLocker lock(&m_mutex);
+        if (inFlight == 0)
+            return -1;
+        while (m_done.empty())
+            m_jobDone.wait(&m_mutex);
+        const int slot = m_done.front();
+        m_done.pop_front();
+        --inFlight;
+        return slot;
+    }
+
+private:
+    struct Job { int slot; const char* data; qint64 len; qint64 offset; };
+
+    void workerLoop()
+    {
+        ThreadPlacement::Scope placement(ThreadPlacement::Logging);
+        for (;;) {
+            Job job;
+            {
+                QMutexLocker lock(&m_mutex);
+                while (m_jobs.empty() && !m_stop)
+                    m_jobReady.wait(&m_mutex);
+                if (m_jobs.empty())
+                    return;
+                job = m_jobs.front();
+                m_jobs.pop_front();
+            }
+            const QString err = positionalWrite(m_handle, job.data, job.len, job.offset);
+
+            QMutexLocker lock(&m_mutex);
+            if (!err.isEmpty() && error.isEmpty())
+                error = err;
+            m_done.push_back(job.slot);
+            m_jobDone.wakeAll();
+        }
+    }
+
+    qintptr           m_handle;
+    QMutex            m_mutex;
+    QWaitCondition    m_jobReady;
+    QWaitCondition    m_jobDone;
+    std::deque<Job>   m_jobs;
+    std::deque<int>   m_done;
+    QVector<QThread*> m_workers;
+    bool              m_stop = false;
+};
+
+#ifdef AUTOLENS_HAVE_IO_URING
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  io_uring engine — raw syscalls, no liburing dependency
+// ─────────────────────────────────────────────────────────────────────────────
+
+class UringEngine : public AsyncFileWriter::Engine
+{
+public:
+    /** Check ok() afterwards; on failure the caller falls back to the pool. */
+    UringEngine(int fd, char* const* buffers) : m_fd(fd)
+    {
+        io_uring_params p{};
+        m_ring = int(syscall(__NR_io_uring_setup, unsigned(AsyncFileWriter::QUEUE_DEPTH), &p));
+        if (m_ring < 0)
+            return;
+
+        m_sqSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        m_cqSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single)
+            m_sqSize = m_cqSize = qMax(m_sqSize, m_cqSize);
+
+        m_sq = mmap(nullptr, m_sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    m_ring, IORING_OFF_SQ_RING);
+        m_cq = single ? m_sq
+                      : mmap(nullptr, m_cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             m_ring, IORING_OFF_CQ_RING);
+        m_sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = static_cast<io_uring_sqe*>(mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE,
+                                                 MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES));
+        if (m_sq == MAP_FAILED || m_cq == MAP_FAILED || m_sqes == MAP_FAILED)
+            return;
+
+        auto at = [](void* base, unsigned off) { return reinterpret_cast<unsigned*>(static_cast<char*>(base) + off); };
+        m_sqTail  = at(m_sq, p.sq_off.tail);
+        m_sqMask  = *at(m_sq, p.sq_off.ring_mask);
+        m_sqArray = at(m_sq, p.sq_off.array);
+        m_cqHead  = at(m_cq, p.cq_off.head);
+        m_cqTail  = at(m_cq, p.cq_off.tail);
+        m_cqMask  = *at(m_cq, p.cq_off.ring_mask);
+        m_cqes    = reinterpret_cast<io_uring_cqe*>(static_cast<char*>(m_cq) + p.cq_off.cqes);
+
+        // Registered once: the kernel pins the pages now instead of per write.
+        iovec iov[AsyncFileWriter::QUEUE_DEPTH];
+        for (int i = 0; i < AsyncFileWriter::QUEUE_DEPTH; ++i)
+            iov[i] = { buffers[i], size_t(AsyncFileWriter::BLOCK_SIZE) };
+        if (syscall(__NR_io_uring_register, m_ring, IORING_REGISTER_BUFFERS,
+                    iov, unsigned(AsyncFileWriter::QUEUE_DEPTH)) < 0)
+            return;   // RLIMIT_MEMLOCK too low, typically
+
+        m_ok = true;
+    }
+
+    ~UringEngine() override
+    {
+        if (m_sqes && m_sqes != MAP_FAILED) munmap(m_sqes, m_sqesSize);
+        if (m_cq && m_cq != MAP_FAILED && m_cq != m_sq) munmap(m_cq, m_cqSize);
+        if (m_sq && m_sq != MAP_FAILED) munmap(m_sq, m_sqSize);
+        if (m_ring >= 0) ::close(m_ring);
+    }
+
+    bool ok() const { return m_ok; }
+
+    void submit(int slot, const char* data, qint64 len, qint64 offset) override
+    {
+        // Single producer: only this thread writes the SQ tail.
+        const unsigned tail = *m_sqTail;
+        const unsigned idx  = tail & m_sqMask;
+        io_uring_sqe& sqe = m_sqes[idx];
+        std::memset(&sqe, 0, sizeof sqe);
+        sqe.opcode    = IORING_OP_WRITE_FIXED;
+        sqe.fd        = m_fd;
+        sqe.addr      = reinterpret_cast<quint64>(data);
+        sqe.len       = unsigned(len);
+        sqe.off       = quint64(offset);
+        sqe.buf_index = quint16(slot);
+        sqe.user_data = quint64(slot);
+        m_sqArray[idx] = idx;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        m_pending[slot] = { data, len, offset };
+        ++inFlight;
+        while (syscall(__NR_io_uring_enter, m_ring, 1u, 0u, 0u, nullptr, 0) < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            // Nothing was consumed: take the SQE back and write it here, so
+            // waitOne() still hands the slot back and finish() can't hang.
+            __atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+            const QString err = positionalWrite(qintptr(m_fd), data, len, offset);
+            if (!err.isEmpty()) fail(err);
+            m_written.push_back(slot);
+            break;
+        }
+    }
+
+    int waitOne() override
+    {
+        if (inFlight == 0)
+            return -1;
+        if (!m_written.empty()) {
+            const int slot = m_written.front();
+            m_written.pop_front();
+            --inFlight;
+            return slot;
+        }
+        for (;;) {
+            const unsigned head = *m_cqHead;
+            if (head != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+                const int slot = int(cqe.user_data);
+                const int res  = cqe.res;
+                __atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+                --inFlight;
+
+                const Pending& w = m_pending[slot];
+                if (res < 0) {
+                    fail(systemError(-res));
+                } else if (res < w.len) {
+                    // Short write (rare) — finish synchronously, from the last
+                    // aligned boundary: O_DIRECT refuses an unaligned remainder.
+                    const qint64 done = res / AsyncFileWriter::ALIGNMENT * AsyncFileWriter::ALIGNMENT;
+                    const QString err = positionalWrite(qintptr(m_fd), w.data + done,
+                                                        w.len - done, w.offset + done);
+                    if (!err.isEmpty()) fail(err);
+                }
+                return slot;
+            }
+            if (syscall(__NR_io_uring_enter, m_ring, 0u, 1u, unsigned(IORING_ENTER_GETEVENTS),
+                        nullptr, 0) < 0 && errno != EINTR) {
+                fail(systemError(errno));
+                inFlight = 0;   // the ring is unusable; don't wait forever
+                return -1;
+            }
+        }
+    }
+
+private:
+    struct Pending { const char* data = nullptr; qint64 len = 0; qint64 offset = 0; };
+
+    void fail(const QString& e) { if (error.isEmpty()) error = e; }
+
+    int           m_fd;
+    int           m_ring = -1;
+    bool          m_ok   = false;
+    void*         m_sq   = nullptr;
+    void*         m_cq   = nullptr;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t        m_sqSize = 0, m_cqSize = 0, m_sqesSize = 0;
+    unsigned*     m_sqTail  = nullptr;
+    unsigned*     m_sqArray = nullptr;
+    unsigned      m_sqMask  = 0;
+    unsigned*     m_cqHead  = nullptr;
+    unsigned*     m_cqTail  = nullptr;
+    unsigned      m_cqMask  = 0;
+    io_uring_cqe* m_cqes    = nullptr;
+    Pending       m_pending[AsyncFileWriter::QUEUE_DEPTH];
+    std::deque<int> m_written;   ///< slots written synchronously after a failed enter
+};
+
+#endif // AUTOLENS_HAVE_IO_URING
+
+char* alignedAlloc(qint64 size)
+{
+#if defined(Q_OS_WIN)
+    return static_cast<char*>(_aligned_malloc(size_t(size), size_t(AsyncFileWriter::ALIGNMENT)));
+#else
+    return static_cast<char*>(std::aligned_alloc(size_t(AsyncFileWriter::ALIGNMENT), size_t(size)));
+#endif
+}
+
+void alignedFree(char* p)
+{
+#if defined(Q_OS_WIN)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  AsyncFileWriter
+// ─────────────────────────────────────────────────────────────────────────────
+
+AsyncFileWriter::AsyncFileWriter(QObject* parent)
+    : QIODevice(parent)
+{
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    if (isOpen())
+        finish();
+    for (char*& b : m_buffers) {
+        if (b) alignedFree(b);
+        b = nullptr;
+    }
+}
+
+QString AsyncFileWriter::open(const QString& path, OpenMode mode)
+{
+    if (isOpen())
+        return QStringLiteral("Already open");
+
+    m_path = path;
+    m_written = m_nextOffset = m_fill = 0;
+    m_current = -1;
+    m_error.clear();
+    m_patches.clear();
+
+    for (char*& b : m_buffers) {
+        if (!b) b = alignedAlloc(BLOCK_SIZE);
+        if (!b) return QStringLiteral("Out of memory for write buffers");
+    }
+    m_free.clear();
+    for (int i = QUEUE_DEPTH - 1; i >= 0; --i)
+        m_free.append(i);
+
+#if defined(Q_OS_WIN)
+    const HANDLE h = CreateFileW(reinterpret_cast<LPCWSTR>(path.utf16()), GENERIC_WRITE,
+                                 FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE)
+        return QString("Cannot open for writing: %1").arg(path);
+    m_handle = reinterpret_cast<qintptr>(h);
+    m_direct = false;
+#else
+    const QByteArray native = QFile::encodeName(path);
+    int fd = -1;
+#ifdef O_DIRECT
+    // tmpfs and some network filesystems refuse O_DIRECT — buffered then.
+    fd = ::open(native.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_DIRECT, 0644);
+    m_direct = fd >= 0;
+#endif
+    if (fd < 0)
+        fd = ::open(native.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return QString("Cannot open for writing: %1 (%2)").arg(path, systemError(errno));
+    m_handle = fd;
+#endif
+
+    m_engine.reset();
+#ifdef AUTOLENS_HAVE_IO_URING
+    auto uring = std::make_unique<UringEngine>(int(m_handle), m_buffers);
+    if (uring->ok()) {
+        m_engine  = std::move(uring);
+        m_backend = Backend::IoUring;
+    }
+#endif
+    if (!m_engine) {
+        m_engine  = std::make_unique<PoolEngine>(m_handle);
+        m_backend = Backend::ThreadPool;
+    }
+
+    QIODevice::open(mode | WriteOnly);
+    return {};
+}
+
+qint64 AsyncFileWriter::readData(char*, qint64)
+{
+    return -1;
+}
+
+qint64 AsyncFileWriter::writeData(const char* data, qint64 len)
+{
+    if (!m_error.isEmpty())
+        return -1;
+
+    qint64 left = len;
+    while (left > 0) {
+        if (m_current < 0 && (m_current = acquireBuffer()) < 0)
+            return -1;
+        const qint64 n = qMin(left, BLOCK_SIZE - m_fill);
+        std::memcpy(m_buffers[m_current] + m_fill, data, size_t(n));
+        m_fill += n;
+        data   += n;
+        left   -= n;
+        if (m_fill == BLOCK_SIZE)
+            submitCurrent();
+    }
+    m_written += len;
+    return len;
+}
+
+int AsyncFileWriter::acquireBuffer()
+{
+    while (m_free.isEmpty()) {
+        const int slot = m_engine->waitOne();
+        if (!m_engine->error.isEmpty() && m_error.isEmpty())
+            m_error = m_engine->error;
+        if (slot < 0)
+            return -1;
+        m_free.append(slot);
+    }
+    if (!m_error.isEmpty())
+        return -1;
+    return m_free.takeLast();
+}
+
+void AsyncFileWriter::submitCurrent()
+{
+    // Only the tail is short; round it up for O_DIRECT and cut the file
+    // back in finish().
+    const qint64 len = (m_fill + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (len > m_fill)
+        std::memset(m_buffers[m_current] + m_fill, 0, size_t(len - m_fill));
+    m_engine->submit(m_current, m_buffers[m_current], len, m_nextOffset);
+    m_nextOffset += m_fill;
+    m_current = -1;
+    m_fill    = 0;
+}
+
+void AsyncFileWriter::patch(qint64 offset, const QByteArray& bytes)
+{
+    m_patches.append({ offset, bytes });
+}
+
+void AsyncFileWriter::close()
+{
+    finish();
+}
+
+QString AsyncFileWriter::finish()
+{
+    if (!isOpen())
+        return m_error;
+
+    if (m_current >= 0 && m_fill > 0 && m_error.isEmpty())
+        submitCurrent();
+    while (m_engine->waitOne() >= 0) {}
+    if (!m_engine->error.isEmpty() && m_error.isEmpty())
+        m_error = m_engine->error;
+    m_engine.reset();
+
+#if defined(Q_OS_WIN)
+    CloseHandle(reinterpret_cast<HANDLE>(m_handle));
+#else
+    ::close(int(m_handle));
+#endif
+    m_handle = -1;
+    QIODevice::close();
+
+    // Padding off, header fields in — through a plain buffered handle.
+    const bool padded = m_nextOffset % ALIGNMENT != 0;
+    if (m_error.isEmpty() && (padded || !m_patches.isEmpty())) {
+        QFile file(m_path);
+        if (!file.open(QIODevice::ReadWrite)) {
+            m_error = QString("Cannot reopen %1: %2").arg(m_path, file.errorString());
+        } else {
+            if (padded && !file.resize(m_written))
+                m_error = QString("Cannot truncate %1: %2").arg(m_path, file.errorString());
+            for (const auto& p : std::as_const(m_patches)) {
+                if (!file.seek(p.first) || file.write(p.second) != p.second.size()) {
+                    m_error = QString("Cannot patch %1: %2").arg(m_path, file.errorString());
+                    break;
+                }
+            }
+        }
+    }
+    m_patches.clear();
+    if (!m_error.isEmpty())
+        qWarning() << "[AsyncFileWriter]" << m_path << m_error;
+    return m_error;
+}
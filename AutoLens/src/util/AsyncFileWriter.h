@@ -0,0 +1,116 @@
+#pragma once
+/**
+ * @file AsyncFileWriter.h
+ * @brief Write-only QIODevice with several large aligned writes in flight.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  QFile writes synchronously: every flush of its buffer blocks the caller
+ *  until the page cache has taken the data, one buffer at a time.  For a
+ *  multi-GB trace the formatting thread spends much of its time waiting
+ *  for the kernel instead of producing the next block, and the device
+ *  never sees more than one request.
+ *
+ *  This device copies into BLOCK_SIZE buffers and hands full buffers to
+ *  the kernel without waiting; the caller only blocks when all
+ *  QUEUE_DEPTH buffers are in flight.  QTextStream and QDataStream work on
+ *  it unchanged.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  BACKENDS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *    IoUring     Linux: one ring, the buffers registered once
+ *                (IORING_OP_WRITE_FIXED — no per-write page pinning), the
+ *                file opened O_DIRECT when the filesystem allows it.
+ *                Submission and completion happen on the caller's thread;
+ *                the kernel does the I/O.
+ *    ThreadPool  everywhere else (and when io_uring is unavailable, e.g.
+ *                blocked by a container's seccomp profile): POOL_THREADS
+ *                workers issue positional writes (pwrite / WriteFile with
+ *                an offset), so writes still overlap.
+ *
+ *  O_DIRECT needs the file offset, the length and the buffer address
+ *  aligned to ALIGNMENT.  Blocks are a multiple of it and the buffers are
+ *  allocated aligned; the final partial block is padded and the file is
+ *  truncated to the logical size in finish().
+ *
+ *  The stream is append-only.  Header fields only known at the end (BLF
+ *  object count, end time) are registered with patch() and written in
+ *  finish(), after the last block has landed.
+ */
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+class AsyncFileWriter : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 ALIGNMENT    = 4096;      ///< O_DIRECT offset / length / address
+    static constexpr qint64 BLOCK_SIZE   = 1 << 20;   ///< bytes per write (multiple of ALIGNMENT)
+    static constexpr int    QUEUE_DEPTH  = 8;         ///< buffers = writes in flight
+    static constexpr int    POOL_THREADS = 4;         ///< ThreadPool backend workers
+
+    enum class Backend { IoUring, ThreadPool };
+
+    explicit AsyncFileWriter(QObject* parent = nullptr);
+    ~AsyncFileWriter() override;
+
+    /**
+     * @brief Create or truncate @p path and open the device.
+     * @param mode  WriteOnly, optionally | Text (QTextStream line endings).
+     * @return Empty string on success, otherwise the error.
+     */
+    QString open(const QString& path, OpenMode mode = WriteOnly);
+
+    /**
+     * @brief Write the tail, wait for every write, apply the patches, close.
+     * @return Empty string on success, otherwise the first I/O error.
+     */
+    QString finish();
+
+    /** Overwrite @p bytes at @p offset during finish() (header back-patching). */
+    void patch(qint64 offset, const QByteArray& bytes);
+
+    /** Bytes accepted so far — the file offset of the next write. */
+    qint64 written() const { return m_written; }
+
+    Backend backend() const { return m_backend; }
+    bool    isDirect() const { return m_direct; }
+
+    bool   isSequential() const override { return true; }
+    void   close() override;
+
+    class Engine;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 len) override;
+
+private:
+    /** A free buffer, waiting for a completion if all are in flight; −1 on error. */
+    int  acquireBuffer();
+    void submitCurrent();
+
+    QString                 m_path;
+    qintptr                 m_handle  = -1;   ///< fd / HANDLE
+    Backend                 m_backend = Backend::ThreadPool;
+    bool                    m_direct  = false;
+    std::unique_ptr<Engine> m_engine;
+
+    char*        m_buffers[QUEUE_DEPTH] = {};
+    QVector<int> m_free;
+    int          m_current = -1;              ///< buffer being filled
+    qint64       m_fill    = 0;
+    qint64       m_written = 0;               ///< logical size
+    qint64       m_nextOffset = 0;            ///< file offset of the current buffer
+    QString      m_error;
+
+    QVector<QPair<qint64, QByteArray>> m_patches;
+};
@@ -0,0 +1,138 @@
+#pragma once
+/**
+ * @file MpmcQueue.h
+ * @brief Bounded lock-free multi-producer / multi-consumer queue.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  ALGORITHM  (Dmitry Vyukov's bounded MPMC queue)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  A fixed power-of-two array of cells.  Every cell carries a sequence
+ *  number that tells producers and consumers whose turn it is:
+ *
+ *    cell.sequence == pos        → free, a producer at `pos` may write it
+ *    cell.sequence == pos + 1    → full, a consumer at `pos` may read it
+ *
+ *  Producers claim a slot with one CAS on m_enqueuePos, consumers with one
+ *  CAS on m_dequeuePos.  No locks, no allocation after construction, and a
+ *  full queue is reported (tryPush returns false) instead of blocking — the
+ *  caller decides whether to retry later or drop.
+ *
+ *  WHY not QQueue + QMutex: the decode pipeline pushes from the UI thread
+ *  and pops from several workers.  A mutex would let a preempted worker
+ *  stall the UI thread's submit — exactly the wait we are removing.
+ *
+ *  T must be default-constructible and movable.  Typical use is a pointer
+ *  to a pooled job object, so cells stay small.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+template <typename T>
+class MpmcQueue
+{
+public:
+    /**
+     * @param capacity  Rounded up to the next power of two (minimum 2).
+     */
+    explicit MpmcQueue(std::size_t capacity)
+    {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+
+        m_cells.reset(new Cell[cap]);
+        m_mask = cap - 1;
+        for (std::size_t i = 0; i < cap; ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+
+        m_enqueuePos.store(0, std::memory_order_relaxed);
+        m_dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&)            = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    /** @return false if the queue is full (value is left untouched). */
+    bool tryPush(T&& value)
+    {
+        Cell* cell = nullptr;
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff =
+                static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                                       std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;   // full
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPush(const T& value)
+    {
+        T copy(value);
+        return tryPush(std::move(copy));
+    }
+
+    /** @return false if the queue is empty. */
+    bool tryPop(T& out)
+    {
+        Cell* cell = nullptr;
+        std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff =
+                static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                                       std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;   // empty
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        out = std::move(cell->data);
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Approximate number of queued items (racy by nature — for stats only). */
+    std::size_t sizeApprox() const
+    {
+        const std::size_t enq = m_enqueuePos.load(std::memory_order_relaxed);
+        const std::size_t deq = m_dequeuePos.load(std::memory_order_relaxed);
+        return enq >= deq ? enq - deq : 0;
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T                        data{};
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t             m_mask = 0;
+
+    // Separate cache lines so producers and consumers don't false-share.
+    alignas(64) std::atomic<std::size_t> m_enqueuePos;
+    alignas(64) std::atomic<std::size_t> m_dequeuePos;
+};
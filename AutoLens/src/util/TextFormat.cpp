@@ -0,0 +1,192 @@
+/**
+ * @file TextFormat.cpp
+ * @brief Hex-pair table, SIMD nibble expansion and integer number formatting.
+ */
+
+#include "util/TextFormat.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#define AUTOLENS_HEX_SSSE3 1
+#include <tmmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define AUTOLENS_HEX_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace TextFormat {
+
+namespace {
+
+constexpr char kDigits[] = "0123456789ABCDEF";
+
+/** "00", "01", … "FF" — two chars per byte value. */
+constexpr std::array<char, 512> kHexPairs = [] {
+    std::array<char, 512> t{};
+    for (int i = 0; i < 256; ++i) {
+        t[i * 2]     = kDigits[i >> 4];
+        t[i * 2 + 1] = kDigits[i & 15];
+    }
+    return t;
+}();
+
+/** "XX " per byte from the pair table. */
+inline char* hexTriplesScalar(char* out, const uint8_t* data, int len)
+{
+    for (int i = 0; i < len; ++i) {
+        memcpy(out, &kHexPairs[data[i] * 2], 2);
+        out[2] = ' ';
+        out += 3;
+    }
+    return out;
+}
+
+#ifdef AUTOLENS_HEX_SSSE3
+/** 16 bytes → 48 chars "XX XX … XX " (with the trailing space). */
+inline void hexTriples16(char* out, const uint8_t* data)
+{
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kDigits));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i v      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+    const __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, nibble));
+
+    // Pairs of bytes 0–7 and 8–15, then spread each pair into a triple;
+    // -1 lanes become 0 and are OR-ed with the spaces.
+    const __m128i pairs[2] = { _mm_unpacklo_epi8(hi, lo), _mm_unpackhi_epi8(hi, lo) };
+    const __m128i spreadA = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+    const __m128i spreadB = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1,
+                                          -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i spaceA  = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0);
+    const __m128i spaceB  = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, 0, 0, 0, 0, 0, 0);
+    for (const __m128i& p : pairs) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                         _mm_or_si128(_mm_shuffle_epi8(p, spreadA), spaceA));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16),
+                         _mm_or_si128(_mm_shuffle_epi8(p, spreadB), spaceB));
+        out += 24;
+    }
+}
+#elif defined(AUTOLENS_HEX_NEON)
+inline void hexTriples16(char* out, const uint8_t* data)
+{
+    const uint8x16_t digits = vld1q_u8(reinterpret_cast<const uint8_t*>(kDigits));
+    const uint8x16_t v      = vld1q_u8(data);
+    uint8x16x3_t triples;
+    triples.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(v, 4));
+    triples.val[1] = vqtbl1q_u8(digits, vandq_u8(v, vdupq_n_u8(0x0F)));
+    triples.val[2] = vdupq_n_u8(' ');
+    vst3q_u8(reinterpret_cast<uint8_t*>(out), triples);   // interleaves hi, lo, ' '
+}
+#endif
+
+} // namespace
+
+int hexBytes(char* out, const uint8_t* data, int len)
+{
+    if (len <= 0)
+        return 0;
+
+    char* p = out;
+    int   i = 0;
+#if defined(AUTOLENS_HEX_SSSE3) || defined(AUTOLENS_HEX_NEON)
+    for (; i + 16 <= len; i += 16, p += 48)
+        hexTriples16(p, data + i);
+#endif
+    p = hexTriplesScalar(p, data + i, len - i);
+    return int(p - out) - 1;   // drop the trailing space
+}
+
+int hexU32(char* out, uint32_t value, int minDigits)
+{
+    int digits = 1;
+    for (uint32_t v = value >> 4; v; v >>= 4)
+        ++digits;
+    digits = qBound(digits, minDigits, 8);
+
+    // Whole pairs from the table, least significant first.
+    char* p = out + digits;
+    for (int left = digits; left > 0; left -= 2, value >>= 8) {
+        const char* pair = &kHexPairs[(value & 0xFF) * 2];
+        if (left >= 2) {
+            p -= 2;
+            memcpy(p, pair, 2);
+        } else {
+            *--p = pair[1];
+        }
+    }
+    return digits;
+}
+
+int decimal(char* out, quint64 value)
+{
+    char tmp[MAX_NUMBER_CHARS];
+    char* p = tmp + sizeof tmp;
+    do {
+        *--p = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    const int n = int(tmp + sizeof tmp - p);
+    memcpy(out, p, size_t(n));
+    return n;
+}
+
+int fixedPoint(char* out, quint64 units, int decimals, int width)
+{
+    quint64 scale = 1;
+    for (int i = 0; i < decimals; ++i)
+        scale *= 10;
+
+    char tmp[MAX_NUMBER_CHARS * 2];
+    int  n = decimal(tmp, units / scale);
+    if (decimals > 0) {
+        tmp[n++] = '.';
+        quint64 frac = units % scale;
+        for (int i = decimals - 1; i >= 0; --i) {
+            tmp[n + i] = char('0' + frac % 10);
+            frac /= 10;
+        }
+        n += decimals;
+    }
+
+    const int pad = qMax(0, width - n);
+    memset(out, ' ', size_t(pad));
+    memcpy(out + pad, tmp, size_t(n));
+    return pad + n;
+}
+
+int timestamp(char* out, quint64 ns, int unitDigits, int width)
+{
+    quint64 unit = 1;
+    for (int i = 0; i < unitDigits; ++i)
+        unit *= 10;
+    const quint64 step = qMax<quint64>(1, unit / 1000000);   // ns per sixth decimal
+    const quint64 half = step / 2;
+
+    // double(ns) / unit is within 2^-53 · ns of the true quotient.  Below
+    // these limits that is less than the distance to any rounding midpoint
+    // (1 ns, or ½ ns when nothing is rounded off), so integers agree.
+    const quint64 exactBelow = quint64(1) << (step > 1 ? 53 : 52);
+    if (ns < exactBelow && (step == 1 || ns % step != half))
+        return fixedPoint(out, (ns + half) / step, 6, width);
+
+    const QByteArray text = QByteArray::number(double(ns) / double(unit), 'f', 6);
+    const int pad = qMax(0, width - int(text.size()));
+    memset(out, ' ', size_t(pad));
+    memcpy(out + pad, text.constData(), size_t(text.size()));
+    return pad + int(text.size());
+}
+
+QString hexBytes(const uint8_t* data, int len)
+{
+    char buf[64 * 3];
+    if (len > 64) {
+        QByteArray big(len * 3, Qt::Uninitialized);
+        return QString::fromLatin1(big.constData(), hexBytes(big.data(), data, len));
+    }
+    return QString::fromLatin1(buf, hexBytes(buf, data, len));
+}
+
+} // namespace TextFormat
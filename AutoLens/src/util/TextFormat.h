@@ -0,0 +1,81 @@
+#pragma once
+/**
+ * @file TextFormat.h
+ * @brief Allocation-free formatting kernels for the trace columns and exporters.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  QString("%1").arg(byte, 2, 16, QChar('0')).toUpper() builds two
+ *  temporary QStrings per byte — 128 for a 64-byte FD frame — and
+ *  QString::number(double, 'f', 6) runs a full floating-point conversion
+ *  for a value that is an integer count of nanoseconds anyway.  Every
+ *  frame that enters the trace, and every frame of an export, pays this.
+ *
+ *  These kernels write ASCII into a caller-supplied char buffer and return
+ *  the length; the caller makes one QString (or QTextStream write) from
+ *  the finished text.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  HOW
+ * ═══════════════════════════════════════════════════════════════════════════
+ *    hexBytes    payload → "AA BB CC".  16 bytes at a time, the nibbles
+ *                are split and mapped to '0'..'F' with one table shuffle
+ *                (SSSE3 pshufb on x86, tbl + vst3 on AArch64); the rest,
+ *                and builds without those instruction sets, use a
+ *                256-entry table of ready-made hex pairs.
+ *    hexU32      id → "18DB33F1", zero-padded, from the same pair table.
+ *    fixedPoint  integer units → "1234.567890": the value is already
+ *                scaled by 10^decimals, so it is two integer conversions
+ *                — exact, no rounding, no locale.
+ *    timestamp   ns → ms or s with six decimals, character for character
+ *                what QString::number(ns / 1e6 or 1e9, 'f', 6) printed
+ *                before.  Integer rounding agrees with the double except
+ *                on an exact half-digit tie (or beyond 2^52 ns), where the
+ *                binary error of the quotient decides; those rare frames
+ *                still go through the double.
+ */
+
+#include <QString>
+#include <cstdint>
+
+namespace TextFormat {
+
+/** Longest hexU32 / decimal / fixedPoint output (u64 with sign room). */
+constexpr int MAX_NUMBER_CHARS = 24;
+
+/**
+ * @brief "AA BB CC …" for @p len bytes: len * 3 − 1 characters (0 if empty).
+ * @p out must hold len * 3 bytes.
+ */
+int hexBytes(char* out, const uint8_t* data, int len);
+
+/** Upper-case hex of @p value, zero-padded to at least @p minDigits. */
+int hexU32(char* out, uint32_t value, int minDigits);
+
+/** Decimal digits of @p value. */
+int decimal(char* out, quint64 value);
+
+/**
+ * @brief @p units / 10^@p decimals with exactly @p decimals fraction digits,
+ *        right-justified with spaces to @p width.
+ *
+ *   fixedPoint(out, 1234567890, 6)      → "1234.567890"
+ *   fixedPoint(out, 1500000, 6, 12)     → "    1.500000"
+ */
+int fixedPoint(char* out, quint64 units, int decimals, int width = 0);
+
+/**
+ * @brief @p ns in units of 10^@p unitDigits ns (6 → ms, 9 → s) with six
+ *        decimals, right-justified to @p width — the same text as
+ *        QString::number(double(ns) / 10^unitDigits, 'f', 6).
+ *
+ *   timestamp(out, 977063563200500, 9)  → "977063.563200"  (double tie-break)
+ *   timestamp(out, 1500000, 6)          → "1.500000"
+ */
+int timestamp(char* out, quint64 ns, int unitDigits, int width = 0);
+
+/** hexBytes() as a QString — one allocation. */
+QString hexBytes(const uint8_t* data, int len);
+
+} // namespace TextFormat
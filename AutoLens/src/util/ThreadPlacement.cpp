@@ -0,0 +1,401 @@
+/**
+ * @file ThreadPlacement.cpp
+ * @brief Placement parsing, the per-platform apply step and the wake-up probe.
+ */
+
+#include "util/ThreadPlacement.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <cerrno>
+#include <cstring>
+#elif defined(Q_OS_WIN)
+#include <QLibrary>
+#include <windows.h>
+#endif
+
+namespace {
+
+const char* const kRoleKeys[ThreadPlacement::RoleCount] = { "receive", "decode", "logging", "transmit" };
+
+/** [2, 3, "4-7"] or "4-7,9" → sorted unique CPU numbers. */
+bool parseCpus(const QJsonValue& value, QVector<int>& cpus, QString& error)
+{
+    QStringList parts;
+    if (value.isString()) {
+        parts = value.toString().split(QLatin1Char(','), Qt::SkipEmptyParts);
+    } else {
+        for (const QJsonValue& v : value.toArray())
+            parts.append(v.isDouble() ? QString::number(v.toInt()) : v.toString());
+    }
+
+    for (const QString& part : parts) {
+        const QStringList ends = part.trimmed().split(QLatin1Char('-'));
+        bool okA = false, okB = true;
+        const int a = ends.first().toInt(&okA);
+        const int b = ends.size() > 1 ? ends.last().toInt(&okB) : a;
+        if (!okA || !okB || ends.size() > 2 || a < 0 || b < a || b > 1023) {
+            error = QString("bad CPU \"%1\"").arg(part.trimmed());
+            return false;
+        }
+        for (int c = a; c <= b; ++c)
+            cpus.append(c);
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return true;
+}
+
+} // namespace
+
+ThreadPlacement& ThreadPlacement::instance()
+{
+    static ThreadPlacement placement;
+    return placement;
+}
+
+ThreadPlacement::ThreadPlacement()
+{
+    // The CPUs a thread goes back to when its role loses its "cpus" entry.
+#if defined(Q_OS_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof set, &set) == 0)
+        for (int c = 0; c < CPU_SETSIZE; ++c)
+            if (CPU_ISSET(c, &set)) m_processCpus.append(c);
+#elif defined(Q_OS_WIN)
+    DWORD_PTR processMask = 0, systemMask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+        for (int c = 0; c < int(sizeof(DWORD_PTR) * 8); ++c)
+            if (processMask & (DWORD_PTR(1) << c)) m_processCpus.append(c);
+#endif
+}
+
+QString ThreadPlacement::roleName(Role role)
+{
+    return (role >= 0 && role < RoleCount) ? QString::fromLatin1(kRoleKeys[role]) : QString();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Configuration
+// ─────────────────────────────────────────────────────────────────────────────
+
+QString ThreadPlacement::setConfig(const QString& json)
+{
+    std::array<Placement, RoleCount> placement;
+    QString priorityClass;
+    if (!json.trimmed().isEmpty()) {
+        const QString error = parse(json, placement, priorityClass);
+        if (!error.isEmpty())
+            return error;
+    }
+
+    QMutexLocker lock(&m_mutex);
+    m_placement     = placement;
+    m_priorityClass = priorityClass;
+    m_json          = json;
+    for (Live& t : m_live) {
+        t.result = apply(t, m_placement[t.role]);
+        if (!t.result.isEmpty())
+            qWarning() << "[ThreadPlacement]" << t.name << t.result;
+    }
+    const QString classError = applyPriorityClass();
+    if (!classError.isEmpty())
+        qWarning() << "[ThreadPlacement]" << classError;
+    qDebug() << "[ThreadPlacement] Applied to" << m_live.size() << "thread(s)";
+    return {};
+}
+
+QString ThreadPlacement::config() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_json;
+}
+
+QString ThreadPlacement::parse(const QString& json, std::array<Placement, RoleCount>& out,
+                               QString& priorityClass)
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+        return QString("JSON error at offset %1: %2").arg(parseError.offset).arg(parseError.errorString());
+    const QJsonObject root = doc.object();
+
+    for (int r = 0; r < RoleCount; ++r) {
+        const QString where = QString::fromLatin1(kRoleKeys[r]);
+        if (!root.contains(where))
+            continue;
+        const QJsonObject o = root.value(where).toObject();
+        Placement& p = out[r];
+        p.configured = true;
+
+        QString error;
+        if (o.contains(QStringLiteral("cpus")) && !parseCpus(o.value(QStringLiteral("cpus")), p.cpus, error))
+            return where + ": " + error;
+
+        const QString policy = o.value(QStringLiteral("policy")).toString(QStringLiteral("default")).toLower();
+        if (policy == QLatin1String("fifo"))
+            p.policy = Policy::Fifo;
+        else if (policy == QLatin1String("rr"))
+            p.policy = Policy::RoundRobin;
+        else if (policy != QLatin1String("default"))
+            return where + QString(": unknown policy \"%1\"").arg(policy);
+
+        p.priority = o.value(QStringLiteral("priority")).toInt(0);
+        if (p.policy != Policy::Default && (p.priority < 1 || p.priority > 99))
+            return where + ": priority must be 1..99 for fifo / rr";
+        p.mmcssTask = o.value(QStringLiteral("mmcss")).toString();
+    }
+
+    priorityClass = root.value(QStringLiteral("priorityClass")).toString().toLower();
+    static const QStringList classes = { QString(), QStringLiteral("normal"), QStringLiteral("above_normal"),
+                                         QStringLiteral("high"), QStringLiteral("realtime") };
+    if (!classes.contains(priorityClass))
+        return QString("unknown priorityClass \"%1\"").arg(priorityClass);
+    return {};
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Applying
+// ─────────────────────────────────────────────────────────────────────────────
+
+QString ThreadPlacement::apply(Live& t, const Placement& p) const
+{
+    // An unconfigured role restores what the thread started with, so
+    // removing an entry at runtime undoes it.
+    const QVector<int>& cpus = (p.configured && !p.cpus.isEmpty()) ? p.cpus : m_processCpus;
+    const bool realtime = p.configured && p.policy != Policy::Default;
+    QStringList errors;
+
+#if defined(Q_OS_LINUX)
+    const pthread_t thread = (pthread_t)t.handle;
+
+    if (!cpus.isEmpty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c : cpus)
+            if (c < CPU_SETSIZE) CPU_SET(c, &set);
+        if (const int e = pthread_setaffinity_np(thread, sizeof set, &set))
+            errors << QString("affinity: %1").arg(QString::fromLocal8Bit(strerror(e)));
+    }
+
+    int policy = t.originalPolicy;
+    sched_param sp{};
+    sp.sched_priority = t.originalPriority;
+    if (realtime) {
+        policy = p.policy == Policy::Fifo ? SCHED_FIFO : SCHED_RR;
+        sp.sched_priority = qBound(sched_get_priority_min(policy), p.priority,
+                                   sched_get_priority_max(policy));
+    }
+    if (const int e = pthread_setschedparam(thread, policy, &sp))
+        errors << (e == EPERM ? QStringLiteral("real-time policy: permission denied "
+                                               "(needs CAP_SYS_NICE or an rtprio limit)")
+                              : QString("policy: %1").arg(QString::fromLocal8Bit(strerror(e))));
+
+#elif defined(Q_OS_WIN)
+    const HANDLE thread = reinterpret_cast<HANDLE>(t.handle);
+    if (!thread)
+        return QStringLiteral("no thread handle");
+
+    DWORD_PTR mask = 0;
+    for (int c : cpus)
+        if (c < int(sizeof(DWORD_PTR) * 8)) mask |= DWORD_PTR(1) << c;
+    if (mask && !SetThreadAffinityMask(thread, mask))
+        errors << QString("affinity: error %1").arg(GetLastError());
+
+    // With MMCSS the scheduler service owns the priority.
+    if (!(p.configured && !p.mmcssTask.isEmpty())) {
+        int priority = t.originalPriority;
+        if (realtime)
+            priority = p.priority >= 90 ? THREAD_PRIORITY_TIME_CRITICAL
+                     : p.priority >= 50 ? THREAD_PRIORITY_HIGHEST
+                                        : THREAD_PRIORITY_ABOVE_NORMAL;
+        if (!SetThreadPriority(thread, priority))
+            errors << QString("priority: error %1").arg(GetLastError());
+    }
+
+#else
+    Q_UNUSED(t);
+    Q_UNUSED(cpus);
+    if (p.configured && (realtime || !p.cpus.isEmpty()))
+        errors << QStringLiteral("not supported on this platform");
+#endif
+
+    return errors.join(QStringLiteral("; "));
+}
+
+QString ThreadPlacement::applyPriorityClass() const
+{
+#if defined(Q_OS_WIN)
+    const DWORD cls = m_priorityClass == QLatin1String("realtime")     ? REALTIME_PRIORITY_CLASS
+                    : m_priorityClass == QLatin1String("high")         ? HIGH_PRIORITY_CLASS
+                    : m_priorityClass == QLatin1String("above_normal") ? ABOVE_NORMAL_PRIORITY_CLASS
+                                                                       : NORMAL_PRIORITY_CLASS;
+    if (!SetPriorityClass(GetCurrentProcess(), cls))
+        return QString("priority class: error %1").arg(GetLastError());
+#endif
+    return {};
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Scope
+// ─────────────────────────────────────────────────────────────────────────────
+
+ThreadPlacement::Scope::Scope(Role role)
+{
+    ThreadPlacement& tp = ThreadPlacement::instance();
+
+    Live t;
+    t.role = role;
+    t.name = QThread::currentThread()->objectName();
+#if defined(Q_OS_LINUX)
+    const pthread_t self = pthread_self();
+    sched_param sp{};
+    pthread_getschedparam(self, &t.originalPolicy, &sp);
+    t.handle           = (quintptr)self;
+    t.originalPriority = sp.sched_priority;
+#elif defined(Q_OS_WIN)
+    // GetCurrentThread() is a pseudo-handle that only means "me"; setConfig()
+    // re-applies from the UI thread, so keep a real one.
+    HANDLE real = nullptr;
+    DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &real,
+                    THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION, FALSE, 0);
+    t.handle           = reinterpret_cast<quintptr>(real);
+    t.originalPriority = GetThreadPriority(GetCurrentThread());
+#endif
+
+    QMutexLocker lock(&tp.m_mutex);
+    const Placement& p = tp.m_placement[role];
+    t.id     = tp.m_nextId++;
+    t.result = tp.apply(t, p);
+
+#if defined(Q_OS_WIN)
+    // MMCSS can only be joined by the thread itself.
+    if (p.configured && !p.mmcssTask.isEmpty()) {
+        using AvSetFn = HANDLE (WINAPI*)(LPCWSTR, LPDWORD);
+        static const auto avSet = reinterpret_cast<AvSetFn>(
+            QLibrary::resolve(QStringLiteral("avrt"), "AvSetMmThreadCharacteristicsW"));
+        DWORD taskIndex = 0;
+        m_mmcss = avSet ? avSet(reinterpret_cast<LPCWSTR>(p.mmcssTask.utf16()), &taskIndex) : nullptr;
+        if (!m_mmcss)
+            t.result += QString(t.result.isEmpty() ? "" : "; ")
+                        + QString("MMCSS \"%1\" unavailable").arg(p.mmcssTask);
+    }
+#endif
+
+    if (!t.result.isEmpty())
+        qWarning() << "[ThreadPlacement]" << t.name << t.result;
+    m_id = t.id;
+    tp.m_live.append(t);
+}
+
+ThreadPlacement::Scope::~Scope()
+{
+    ThreadPlacement& tp = ThreadPlacement::instance();
+
+#if defined(Q_OS_WIN)
+    if (m_mmcss) {
+        using AvRevertFn = BOOL (WINAPI*)(HANDLE);
+        static const auto avRevert = reinterpret_cast<AvRevertFn>(
+            QLibrary::resolve(QStringLiteral("avrt"), "AvRevertMmThreadCharacteristics"));
+        if (avRevert) avRevert(m_mmcss);
+    }
+#endif
+
+    QMutexLocker lock(&tp.m_mutex);
+    for (int i = 0; i < tp.m_live.size(); ++i) {
+        if (tp.m_live[i].id != m_id)
+            continue;
+#if defined(Q_OS_WIN)
+        if (tp.m_live[i].handle)
+            CloseHandle(reinterpret_cast<HANDLE>(tp.m_live[i].handle));
+#endif
+        tp.m_live.removeAt(i);
+        break;
+    }
+}
+
+QVector<ThreadPlacement::ThreadInfo> ThreadPlacement::threads() const
+{
+    QMutexLocker lock(&m_mutex);
+    QVector<ThreadInfo> out;
+    out.reserve(m_live.size());
+    for (const Live& t : m_live)
+        out.append({ t.name, t.role, t.result });
+    return out;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Wake-up latency probe
+// ─────────────────────────────────────────────────────────────────────────────
+
+QVector<ThreadPlacement::WakeStats> ThreadPlacement::measureWakeLatency(int durationMs, int periodUs)
+{
+    using Clock = std::chrono::steady_clock;
+    periodUs   = qBound(100, periodUs, 100000);
+    durationMs = qBound(100, durationMs, 60000);
+
+    QVector<WakeStats> out(RoleCount);
+    QVector<QThread*> probes;
+    for (int r = 0; r < RoleCount; ++r) {
+        QThread* probe = QThread::create([this, r, durationMs, periodUs, &out]() {
+            Scope placement(Role(r));
+            WakeStats& ws = out[r];
+            ws.role = Role(r);
+            {
+                QMutexLocker lock(&m_mutex);
+                for (const Live& t : m_live)
+                    if (t.id == placement.m_id) ws.result = t.result;
+            }
+
+            // Absolute deadlines, so a late wake-up does not shift the next one.
+            QVector<qint64> lateNs;
+            lateNs.reserve(int(qint64(durationMs) * 1000 / periodUs) + 1);
+            const auto period = std::chrono::microseconds(periodUs);
+            const auto end    = Clock::now() + std::chrono::milliseconds(durationMs);
+            auto next = Clock::now() + period;
+            while (next < end) {
+                std::this_thread::sleep_until(next);
+                const auto now = Clock::now();
+                lateNs.append(std::chrono::duration_cast<std::chrono::nanoseconds>(now - next).count());
+                next += period;
+                if (next < now)
+                    next = now + period;   // overran a whole period — don't burst
+            }
+            if (lateNs.isEmpty())
+                return;
+
+            ws.samples = quint64(lateNs.size());
+            qint64 sum = 0;
+            for (qint64 v : lateNs) sum += v;
+            ws.avgUs = double(sum) / double(lateNs.size()) / 1000.0;
+            const auto [lo, hi] = std::minmax_element(lateNs.begin(), lateNs.end());
+            ws.minUs = double(*lo) / 1000.0;
+            ws.maxUs = double(*hi) / 1000.0;
+            auto p99 = lateNs.begin() + (lateNs.size() * 99) / 100;
+            std::nth_element(lateNs.begin(), p99, lateNs.end());
+            ws.p99Us = double(*p99) / 1000.0;
+        });
+        probe->setObjectName(QStringLiteral("AutoLens_Probe_%1").arg(roleName(Role(r))));
+        probe->start();
+        probes.append(probe);
+    }
+
+    for (QThread* probe : probes) {
+        probe->wait();
+        delete probe;
+    }
+    return out;
+}
@@ -0,0 +1,155 @@
+#pragma once
+/**
+ * @file ThreadPlacement.h
+ * @brief CPU affinity and real-time scheduling for AutoLens' worker threads.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  WHY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  QThread priorities are hints: on Linux they map to SCHED_OTHER (where
+ *  they do nothing), on Windows to a relative priority inside the normal
+ *  class.  The receive thread then competes with the QML render thread and
+ *  the QtConcurrent pool for the same cores, and a late wake-up is a full
+ *  driver queue.  Pinning the latency-critical threads to their own cores
+ *  and giving them a real-time policy removes that competition.
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  CONFIG (JSON, persisted as "Threads/placement")
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ *    { "receive":  { "cpus": [2, 3], "policy": "fifo", "priority": 80,
+ *                    "mmcss": "Pro Audio" },
+ *      "decode":   { "cpus": "4-7" },
+ *      "logging":  { "cpus": [1] },
+ *      "transmit": { "cpus": [2], "policy": "rr", "priority": 70 },
+ *      "priorityClass": "high" }
+ *
+ *  A role without an entry keeps the thread's own settings.  "cpus" is a
+ *  list of numbers and/or "a-b" ranges.  "policy" is "default", "fifo" or
+ *  "rr" with a priority of 1..99:
+ *
+ *    Linux     SCHED_FIFO / SCHED_RR at that priority (needs CAP_SYS_NICE
+ *              or an rtprio limit — the error is reported per thread)
+ *    Windows   ≥ 90 TIME_CRITICAL, ≥ 50 HIGHEST, else ABOVE_NORMAL;
+ *              "mmcss" registers the thread with the Multimedia Class
+ *              Scheduler under that task name instead (avrt.dll, resolved
+ *              at runtime), "priorityClass" sets the process class
+ *              ("normal", "above_normal", "high", "realtime")
+ *
+ * ═══════════════════════════════════════════════════════════════════════════
+ *  USE
+ * ═══════════════════════════════════════════════════════════════════════════
+ *    QThread::create([this]() {
+ *        ThreadPlacement::Scope placement(ThreadPlacement::Receive);
+ *        …loop…
+ *    });
+ *
+ *  The Scope registers the running thread and applies its role's placement;
+ *  setConfig() re-applies to every registered thread (MMCSS, which only the
+ *  thread itself can join, takes effect on its next start).
+ *
+ *  measureWakeLatency() reports what the placement achieves: one probe
+ *  thread per role, placed like that role, sleeps to absolute deadlines
+ *  and records how late it wakes (the cyclictest method) while the real
+ *  threads keep running.
+ */
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <array>
+#include <cstdint>
+
+class ThreadPlacement
+{
+public:
+    enum Role { Receive, Decode, Logging, Transmit, RoleCount };
+
+    enum class Policy { Default, Fifo, RoundRobin };
+
+    struct Placement
+    {
+        bool         configured = false;   ///< false → leave the thread alone
+        QVector<int> cpus;                 ///< empty → every CPU of the process
+        Policy       policy   = Policy::Default;
+        int          priority = 0;         ///< 1..99 for Fifo / RoundRobin
+        QString      mmcssTask;            ///< Windows only
+    };
+
+    struct ThreadInfo
+    {
+        QString name;
+        Role    role = Receive;
+        QString result;                    ///< "" = applied, otherwise why not
+    };
+
+    struct WakeStats
+    {
+        Role    role    = Receive;
+        quint64 samples = 0;
+        double  minUs   = 0.0;
+        double  avgUs   = 0.0;
+        double  p99Us   = 0.0;
+        double  maxUs   = 0.0;
+        QString result;                    ///< placement error of the probe, if any
+    };
+
+    /** RAII: register the calling thread under @p role for its lifetime. */
+    class Scope
+    {
+    public:
+        explicit Scope(Role role);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        friend class ThreadPlacement;
+        int   m_id    = 0;
+        void* m_mmcss = nullptr;           ///< AvSetMmThreadCharacteristics handle
+    };
+
+    static ThreadPlacement& instance();
+    static QString roleName(Role role);
+
+    /**
+     * @brief Parse @p json and apply it to every registered thread.
+     * @return Empty string on success, otherwise the first parse error (the
+     *         previous placement stays active).  Per-thread failures are
+     *         reported by threads(), not here.
+     */
+    QString setConfig(const QString& json);
+    QString config() const;
+
+    QVector<ThreadInfo> threads() const;
+
+    /** Blocks for @p durationMs — call off the UI thread. */
+    QVector<WakeStats> measureWakeLatency(int durationMs, int periodUs = 1000);
+
+private:
+    ThreadPlacement();
+
+    struct Live
+    {
+        int      id   = 0;
+        Role     role = Receive;
+        QString  name;
+        QString  result;
+        quintptr handle = 0;               ///< pthread_t / duplicated HANDLE
+        int      originalPolicy   = 0;     ///< restored for Policy::Default
+        int      originalPriority = 0;
+    };
+
+    static QString parse(const QString& json, std::array<Placement, RoleCount>& out,
+                         QString& priorityClass);
+    QString apply(Live& t, const Placement& p) const;   // m_mutex held
+    QString applyPriorityClass() const;
+
+    mutable QMutex                      m_mutex;
+    std::array<Placement, RoleCount>    m_placement;
+    QString                             m_priorityClass;
+    QString                             m_json;
+    QVector<Live>                       m_live;
+    int                                 m_nextId = 1;
+    QVector<int>                        m_processCpus;   ///< affinity at startup
+};